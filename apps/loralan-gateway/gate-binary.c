@@ -0,0 +1,332 @@
+/*
+ * Copyright (C) 2016-2018 Unwired Devices LLC <info@unwds.com>
+
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @defgroup
+ * @ingroup
+ * @brief
+ * @{
+ * @file		gate-binary.c
+ * @brief       binary framing of the gate UART protocol
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdio.h>
+#include <string.h>
+
+#include "checksum/crc16_ccitt.h"
+#include "iolist.h"
+#include "xtimer.h"
+
+#include "gate-binary.h"
+
+#define ENABLE_DEBUG    (0)
+#include "debug.h"
+
+#define EOL '\r'
+
+/**
+ * @brief Binary records in the pending FIFO start with this byte, text replies never do
+ */
+#define GC_BIN_RECORD_MARKER ('\0')
+
+/**
+ * @brief Max. number of records batched into one frame
+ */
+#define GC_BIN_MAX_BATCH (16)
+
+typedef enum {
+	RX_HUNT = 0,	/**< Waiting for SOF */
+	RX_LEN_LO,
+	RX_LEN_HI,
+	RX_BODY,		/**< Receiving records and CRC */
+} rx_state_t;
+
+static volatile bool binary_mode = false;
+
+/* Receive state, accessed from UART ISR only */
+static rx_state_t rx_state = RX_HUNT;
+static uint16_t rx_len;
+static uint16_t rx_left;
+static char rx_line[4];
+static uint8_t rx_line_len;
+
+bool gc_bin_mode(void)
+{
+	return binary_mode;
+}
+
+void gc_bin_set_mode(bool binary)
+{
+	binary_mode = binary;
+	rx_state = RX_HUNT;
+	rx_line_len = 0;
+}
+
+uint8_t *gc_bin_reserve(gc_pending_fifo_t *fifo, gate_reply_type_t type, size_t max_len)
+{
+	if (max_len > GC_BIN_MAX_RECORD_LEN) {
+		return NULL;
+	}
+
+	char *slot = gc_pending_fifo_reserve(fifo, 1 + GC_BIN_RECORD_HDR_LEN + max_len);
+	if (slot == NULL) {
+		return NULL;
+	}
+
+	slot[0] = GC_BIN_RECORD_MARKER;
+	slot[1] = type;
+
+	return (uint8_t *) slot + 1 + GC_BIN_RECORD_HDR_LEN;
+}
+
+void gc_bin_commit(gc_pending_fifo_t *fifo, uint8_t *payload, size_t len)
+{
+	/* Record length precedes the payload */
+	payload[-1] = len;
+
+	gc_pending_fifo_commit(fifo, 1 + GC_BIN_RECORD_HDR_LEN + len);
+}
+
+bool gc_bin_push(gc_pending_fifo_t *fifo, gate_reply_type_t type, const void *payload, size_t len)
+{
+	uint8_t *p = gc_bin_reserve(fifo, type, len);
+	if (p == NULL) {
+		return false;
+	}
+
+	memcpy(p, payload, len);
+	gc_bin_commit(fifo, p, len);
+
+	return true;
+}
+
+/**
+ * @brief Collects printable bytes between frames to catch the text ping
+ */
+static bool rx_hunt_line(ringbuffer_t *rb, uint8_t data)
+{
+	if (data != EOL) {
+		if (rx_line_len < sizeof(rx_line)) {
+			rx_line[rx_line_len++] = data;
+		}
+		return false;
+	}
+
+	bool is_ping = (rx_line_len == 1) && (rx_line[0] == CMD_PING);
+	rx_line_len = 0;
+
+	if (!is_ping) {
+		return false;
+	}
+
+	/* Host lost track of the mode, let the text parser answer the ping */
+	binary_mode = false;
+	ringbuffer_add_one(rb, CMD_PING);
+	ringbuffer_add_one(rb, EOL);
+
+	return true;
+}
+
+bool gc_bin_rx_byte(ringbuffer_t *rb, uint8_t data)
+{
+	switch (rx_state) {
+		case RX_HUNT:
+			if (data == GC_BIN_SOF) {
+				rx_line_len = 0;
+				rx_state = RX_LEN_LO;
+				return false;
+			}
+
+			return rx_hunt_line(rb, data);
+
+		case RX_LEN_LO:
+			rx_len = data;
+			rx_state = RX_LEN_HI;
+			return false;
+
+		case RX_LEN_HI:
+			rx_len |= (uint16_t) data << 8;
+
+			/* Frame is kept in the buffer only when its length is sane */
+			if (rx_len == 0 || rx_len > GC_BIN_MAX_CMD_LEN) {
+				rx_state = RX_HUNT;
+				return false;
+			}
+
+			ringbuffer_add_one(rb, (char) GC_BIN_SOF);
+			ringbuffer_add_one(rb, rx_len & 0xFF);
+			ringbuffer_add_one(rb, rx_len >> 8);
+
+			rx_left = rx_len + GC_BIN_CRC_LEN;
+			rx_state = RX_BODY;
+			return false;
+
+		case RX_BODY:
+			ringbuffer_add_one(rb, data);
+
+			if (--rx_left == 0) {
+				rx_state = RX_HUNT;
+				return true;
+			}
+
+			return false;
+	}
+
+	return false;
+}
+
+bool gc_bin_parse_frame(ls_gate_t *ls, kernel_pid_t writer, gc_pending_fifo_t *fifo, ringbuffer_t *rb)
+{
+	uint8_t frame[GC_BIN_HEADER_LEN + GC_BIN_MAX_CMD_LEN + GC_BIN_CRC_LEN];
+
+	if (ringbuffer_get(rb, (char *) frame, GC_BIN_HEADER_LEN) != GC_BIN_HEADER_LEN) {
+		return false;
+	}
+
+	uint16_t len = frame[1] | ((uint16_t) frame[2] << 8);
+	if (frame[0] != GC_BIN_SOF || len > GC_BIN_MAX_CMD_LEN) {
+		return false;
+	}
+
+	if (ringbuffer_get(rb, (char *) frame + GC_BIN_HEADER_LEN, len + GC_BIN_CRC_LEN) != (unsigned) (len + GC_BIN_CRC_LEN)) {
+		return false;
+	}
+
+	uint8_t *records = frame + GC_BIN_HEADER_LEN;
+	uint16_t crc = records[len] | ((uint16_t) records[len + 1] << 8);
+
+	if (crc16_ccitt_calc(frame + 1, len + 2) != crc) {
+		puts("[error] Binary frame CRC mismatch");
+		return false;
+	}
+
+	/* Execute every record in the frame */
+	size_t pos = 0;
+	while (pos + GC_BIN_RECORD_HDR_LEN <= len) {
+		uint8_t type = records[pos];
+		uint8_t rec_len = records[pos + 1];
+
+		pos += GC_BIN_RECORD_HDR_LEN;
+		if (pos + rec_len > len) {
+			puts("[error] Binary record is truncated");
+			return false;
+		}
+
+		gc_parse_binary_command(ls, writer, fifo, type, records + pos, rec_len);
+		pos += rec_len;
+	}
+
+	return true;
+}
+
+static bool is_record(const char *entry)
+{
+	return entry[0] == GC_BIN_RECORD_MARKER;
+}
+
+/**
+ * @brief Writes all segments of the list to the UART, accounting time spent in blocking writes
+ */
+static void write_iolist(uart_t uart, const iolist_t *iol, gc_pending_stats_t *stats)
+{
+	uint32_t start = xtimer_now_usec();
+
+	for (; iol != NULL; iol = iol->iol_next) {
+		uart_write(uart, iol->iol_base, iol->iol_len);
+		stats->writes++;
+	}
+
+	stats->write_time_us += xtimer_now_usec() - start;
+}
+
+void gc_flush_pending(uart_t uart, gc_pending_fifo_t *fifo)
+{
+	/* Used by the writer thread only, kept off its small stack */
+	static iolist_t iol[GC_BIN_MAX_BATCH + 2];
+
+	gc_pending_iter_t it;
+	gc_pending_fifo_iter_init(fifo, &it);
+
+	char *entry;
+	size_t len;
+
+	while ((entry = gc_pending_fifo_iter_next(fifo, &it, &len)) != NULL) {
+		if (!is_record(entry)) {
+			iolist_t text = { .iol_next = NULL, .iol_base = entry, .iol_len = len };
+			write_iolist(uart, &text, &fifo->stats);
+
+			gc_pending_fifo_release_to(fifo, &it);
+			continue;
+		}
+
+		/* Gather consecutive records into one frame, marker byte is not sent */
+		unsigned num = 0;
+		uint16_t frame_len = 0;
+		gc_pending_iter_t batch_end;
+
+		do {
+			iol[1 + num].iol_base = entry + 1;
+			iol[1 + num].iol_len = len - 1;
+			frame_len += len - 1;
+			num++;
+
+			batch_end = it;
+			entry = gc_pending_fifo_iter_next(fifo, &it, &len);
+		} while (entry != NULL && is_record(entry) && num < GC_BIN_MAX_BATCH &&
+				 frame_len + len - 1 <= GC_BIN_MAX_FRAME_LEN);
+
+		/* Entry looked ahead is not a part of this frame */
+		it = batch_end;
+
+		uint8_t header[GC_BIN_HEADER_LEN] = { GC_BIN_SOF, frame_len & 0xFF, frame_len >> 8 };
+		uint16_t crc = crc16_ccitt_calc(header + 1, 2);
+
+		for (unsigned i = 1; i <= num; i++) {
+			crc = crc16_ccitt_update(crc, iol[i].iol_base, iol[i].iol_len);
+		}
+
+		uint8_t trailer[GC_BIN_CRC_LEN] = { crc & 0xFF, crc >> 8 };
+
+		iol[0].iol_base = header;
+		iol[0].iol_len = sizeof(header);
+		iol[num + 1].iol_base = trailer;
+		iol[num + 1].iol_len = sizeof(trailer);
+
+		for (unsigned i = 0; i <= num; i++) {
+			iol[i].iol_next = &iol[i + 1];
+		}
+		iol[num + 1].iol_next = NULL;
+
+		/* Records are written straight from the queue */
+		write_iolist(uart, iol, &fifo->stats);
+		gc_pending_fifo_release_to(fifo, &it);
+
+		DEBUG("gate-binary: %u records, %u bytes\n", num, (unsigned) frame_len);
+	}
+}
+
+#ifdef __cplusplus
+}
+#endif
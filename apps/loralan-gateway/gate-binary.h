@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2016-2018 Unwired Devices LLC <info@unwds.com>
+
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @defgroup
+ * @ingroup
+ * @brief
+ * @{
+ * @file		gate-binary.h
+ * @brief       binary framing of the gate UART protocol
+ *
+ * Frame:  SOF (0xA5) | length (2 bytes, LE) | records | CRC16-CCITT (2 bytes, LE)
+ * Record: type (1 byte, same codes as text commands/replies) | length (1 byte) | payload
+ *
+ * CRC covers the length field and the records. All multi-byte fields are little-endian.
+ * Binary mode is entered by the text ping "P01" and left by a binary ping record with
+ * payload 0x00 or by the text ping "P" sent while the gate is in binary mode.
+ */
+#ifndef GATE_BINARY_H_
+#define GATE_BINARY_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "periph/uart.h"
+#include "ringbuffer.h"
+#include "pending-fifo.h"
+#include "gate-commands.h"
+
+#define GC_BIN_VERSION			(1)		/**< Protocol version reported in pong */
+
+#define GC_BIN_SOF				(0xA5)
+#define GC_BIN_HEADER_LEN		(3)		/**< SOF and frame length */
+#define GC_BIN_CRC_LEN			(2)
+
+#define GC_BIN_MAX_FRAME_LEN	(1024)	/**< Max. length of records in a frame sent to the host */
+#define GC_BIN_MAX_CMD_LEN		(256)	/**< Max. length of records in a frame received from the host */
+
+#define GC_BIN_RECORD_HDR_LEN	(2)		/**< Record type and length */
+
+/**
+ * @brief Max. record payload length, record with marker byte must fit into one pending FIFO entry
+ */
+#define GC_BIN_MAX_RECORD_LEN	(GC_MAX_REPLY_LEN - 1 - GC_BIN_RECORD_HDR_LEN)
+
+/**
+ * @brief Binary device list entry: node ID (8), app ID (8), last seen [s] (2), class (1)
+ */
+#define GC_BIN_DEVLIST_ENTRY_LEN	(19)
+
+/**
+ * @brief Returns true if gate talks to the host with binary frames
+ */
+bool gc_bin_mode(void);
+
+/**
+ * @brief Switches between text and binary modes
+ */
+void gc_bin_set_mode(bool binary);
+
+/**
+ * @brief Reserves binary reply record in the pending FIFO.
+ *
+ * On success, record must be published with gc_bin_commit().
+ *
+ * @param	*fifo	pointer to the FIFO structure
+ * @param	type	reply type
+ * @param	max_len	max. payload length, up to GC_BIN_MAX_RECORD_LEN
+ *
+ * @return	pointer to the payload, NULL if FIFO is full
+ */
+uint8_t *gc_bin_reserve(gc_pending_fifo_t *fifo, gate_reply_type_t type, size_t max_len);
+
+/**
+ * @brief Publishes binary reply record reserved with gc_bin_reserve().
+ *
+ * @param	*fifo		pointer to the FIFO structure
+ * @param	*payload	pointer returned by gc_bin_reserve()
+ * @param	len			actual payload length, not more than reserved
+ */
+void gc_bin_commit(gc_pending_fifo_t *fifo, uint8_t *payload, size_t len);
+
+/**
+ * @brief Inserts binary reply record into the pending FIFO.
+ *
+ * @return	false if FIFO is full
+ */
+bool gc_bin_push(gc_pending_fifo_t *fifo, gate_reply_type_t type, const void *payload, size_t len);
+
+/**
+ * @brief Feeds byte received in binary mode into the receive buffer. Called from UART ISR.
+ *
+ * Bytes outside of frames are dropped, except a text ping which switches gate back to the text mode.
+ *
+ * @return	true if complete frame or text ping line is in the buffer
+ */
+bool gc_bin_rx_byte(ringbuffer_t *rb, uint8_t data);
+
+/**
+ * @brief Reads a frame from the receive buffer, checks it and executes contained commands.
+ *
+ * @return	false if frame is malformed
+ */
+bool gc_bin_parse_frame(ls_gate_t *ls, kernel_pid_t writer, gc_pending_fifo_t *fifo, ringbuffer_t *rb);
+
+/**
+ * @brief Writes all pending replies to the UART, batching consecutive binary records into frames.
+ */
+void gc_flush_pending(uart_t uart, gc_pending_fifo_t *fifo);
+
+#endif /* GATE_BINARY_H_ */
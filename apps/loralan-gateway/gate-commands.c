@@ -37,50 +37,258 @@ extern "C" {
 #include <stdlib.h>
 #include <string.h>
 
+#include "thread.h"
 #include "utils.h"
 #include "pending-fifo.h"
 #include "gate-commands.h"
+#include "gate-binary.h"
 #include "ls-gate.h"
 #include "ls-config.h"
 #include "ls-settings.h"
 #include "periph/rtc.h"
 
-static void exec_command(ls_gate_t *ls, kernel_pid_t writer, gc_pending_fifo_t *fifo, char *data) {
+/**
+ * @brief Replies to ping, switching protocol mode if requested
+ *
+ * @param	mode	requested mode, 0 - text, 1 - binary, -1 - keep current one
+ */
+static void send_pong(kernel_pid_t writer, gc_pending_fifo_t *fifo, int mode) {
+	if (gc_bin_mode()) {
+		uint8_t version = (mode == 0) ? 0 : GC_BIN_VERSION;
+		if (!gc_bin_push(fifo, REPLY_PONG, &version, 1)) {
+			puts("gc: pending fifo overflowed!");
+		}
+	}
+	else if (mode < 0) {
+		gc_pending_fifo_push(fifo, "!\n");
+	}
+	else {
+		gc_pending_fifo_push(fifo, (mode) ? "!01\n" : "!00\n");
+	}
+
+	/* Replies queued so far are written in the old mode, the rest in the new one */
+	if (mode >= 0) {
+		gc_bin_set_mode(mode);
+	}
+
+	/* Send flush message */
+	msg_t msg;
+	msg_send(&msg, writer);
+}
+
+/**
+ * @brief Lets the writer drain replies buffer when it is half full, so long replies are not dropped
+ */
+static void wait_for_writer(kernel_pid_t writer, gc_pending_fifo_t *fifo) {
+	if (gc_pending_fifo_used(fifo) < GC_PENDING_BUF_SIZE / 2) {
+		return;
+	}
+
+	/* Writer has the same priority, so yielding lets it run until the buffer is flushed */
+	msg_t msg;
+	msg_send(&msg, writer);
+	thread_yield();
+}
+
+static void send_devlist_binary(ls_gate_t *ls, kernel_pid_t writer, gc_pending_fifo_t *fifo) {
+	ls_gate_devices_t *devs = &ls->devices;
+	const size_t max_len = GC_BIN_MAX_RECORD_LEN - GC_BIN_MAX_RECORD_LEN % GC_BIN_DEVLIST_ENTRY_LEN;
+
+	uint8_t *rec = NULL;
+	size_t len = 0;
+
+	for (int i = 0; i < LS_GATE_MAX_NODES; i++) {
+		if (devs->nodes_free_list[i]) {
+			continue;
+		}
+
+		/* L: as many entries per record as fit */
+		if (rec == NULL) {
+			wait_for_writer(writer, fifo);
+
+			rec = gc_bin_reserve(fifo, REPLY_LIST, max_len);
+			if (rec == NULL) {
+				puts("gc: pending fifo overflowed!");
+				return;
+			}
+			len = 0;
+		}
+
+		ls_gate_node_t *node = &devs->nodes[i];
+		uint16_t last_seen = (ls->_internal.ping_count - node->last_seen) * LS_PING_TIMEOUT_S;
+
+		memcpy(rec + len, &node->node_id, 8);
+		memcpy(rec + len + 8, &node->app_id, 8);
+		memcpy(rec + len + 16, &last_seen, 2);
+		rec[len + 18] = node->node_class;
+		len += GC_BIN_DEVLIST_ENTRY_LEN;
+
+		if (len == max_len) {
+			gc_bin_commit(fifo, rec, len);
+			rec = NULL;
+		}
+	}
+
+	if (rec != NULL) {
+		gc_bin_commit(fifo, rec, len);
+	}
+}
+
+static void send_devlist(ls_gate_t *ls, kernel_pid_t writer, gc_pending_fifo_t *fifo) {
+	ls_gate_devices_t *devs = &ls->devices;
+
+	if (gc_bin_mode()) {
+		send_devlist_binary(ls, writer, fifo);
+		return;
+	}
+
+	for (int i = 0; i < LS_GATE_MAX_NODES; i++) {
+		if (!devs->nodes_free_list[i]) {
+			char buf[128];
+
+			wait_for_writer(writer, fifo);
+
+			/* L */
+			sprintf(buf, "%c%08X%08X%08X%08X%04X%04X\n", REPLY_LIST,
+					(unsigned int) (devs->nodes[i].node_id >> 32), (unsigned int) (devs->nodes[i].node_id & 0xFFFFFFFF),
+					(unsigned int) (devs->nodes[i].app_id >> 32), (unsigned int) (devs->nodes[i].app_id & 0xFFFFFFFF),
+					(unsigned int) ((ls->_internal.ping_count - devs->nodes[i].last_seen) * LS_PING_TIMEOUT_S),
+					(unsigned int) devs->nodes[i].node_class);
+
+			if (!gc_pending_fifo_push(fifo, buf)) {
+				puts("gc: pending fifo overflowed!");
+			}
+		}
+	}
+}
+
+static void send_to_node(ls_gate_t *ls, uint64_t nodeid, uint8_t *data, size_t len) {
+	ls_gate_node_t *node = ls_devlist_get_by_nodeid(&ls->devices, nodeid);
+	if (node == NULL) {
+		printf("[error] Node with ID %08X%08X was not found.\n",
+                (unsigned int) (nodeid >> 32),
+                (unsigned int) (nodeid & 0xFFFFFFFF));
+		return;
+	}
+
+	/* Send LoRa message */
+	ls_gate_send_to(ls, node->addr, data, len);
+}
+
+static void set_pending(ls_gate_t *ls, uint64_t nodeid, uint8_t num_pending) {
+	ls_gate_node_t *node = ls_devlist_get_by_nodeid(&ls->devices, nodeid);
+	if (node == NULL) {
+		puts("[error] Node with specified node ID is not found.\n");
+		return;
+	}
+
+	node->num_pending = num_pending;
+
+	printf("[pending] setting node 0x%08X%08X has %u frames pending\n",
+			(unsigned int) (node->node_id >> 32),
+			(unsigned int) (node->node_id & 0xFFFFFFFF), num_pending);
+}
+
+static void invite(ls_gate_t *ls, uint64_t nodeid) {
+	printf("[invite] Sending invite to node with ID 0x%08X%08X\n",
+			(unsigned int) (nodeid >> 32),
+			(unsigned int) (nodeid & 0xFFFFFFFF));
+
+	ls_gate_invite(ls, nodeid);
+}
+
+static void add_static_dev(ls_gate_t *ls, uint64_t nodeid, uint64_t appid, ls_addr_t addr, uint32_t dev_nonce, uint8_t channel) {
 	ls_gate_devices_t *devs = &ls->devices;
-	ls_gate_channel_t *channels = ls->channels;
 
+	if (addr >= LS_GATE_MAX_NODES) {
+		printf("[error] Unable to add node with address %u >= %u\n", (unsigned int) addr, (unsigned int) LS_GATE_MAX_NODES);
+		return;
+	}
+
+	if (channel >= ls->num_channels) {
+		printf("[error] Unable to add node on channel %u\n", (unsigned int) channel);
+		return;
+	}
+
+	printf("[gate-commands] Added device: ");
+	printf("eui: 0x%08X%08X ",
+					(unsigned int) (nodeid >> 32),
+					(unsigned int) (nodeid & 0xFFFFFFFF));
+	printf("appid: 0x%08X%08X ",
+					(unsigned int) (appid >> 32),
+					(unsigned int) (appid & 0xFFFFFFFF));
+
+	printf("addr: 0x%08X ", (unsigned int) addr);
+	printf("nonce: 0x%08X ", (unsigned int) dev_nonce);
+	printf("ch: 0x%02X\n", (unsigned int) channel);
+
+	/* Kick previous device if present */
+	if (ls_devlist_is_in_network(devs, addr)) {
+		ls_devlist_remove_device(devs, addr);
+	}
+
+	/* Add device with specified nonce and address */
+	ls_gate_node_t *node = ls_devlist_add_by_addr(devs, addr, nodeid, appid, dev_nonce, &ls->channels[channel]);
+	if (node == NULL)
+		return;
+
+	node->app_nonce = 0;
+}
+
+static void kick_all_static(ls_gate_t *ls) {
+	ls_gate_devices_t *devs = &ls->devices;
+
+	for (int i = 0; i < LS_GATE_MAX_NODES; i++) {
+		if (!devs->nodes_free_list[i]) {
+			if (devs->nodes[i].is_static) {
+				/* Remove device */
+				ls_devlist_remove_device(devs, i);
+			}
+		}
+	}
+
+	puts("[gate-commands] All statically personalized devices are kicked");
+}
+
+static void set_joinkey(uint8_t joinkey[16]) {
+	uint64_t appid64 = config_get_appid();
+
+	if (config_write_main_block(appid64, joinkey, 0)) {
+		char s[33] = {};
+		bytes_to_hex(joinkey, 16, s, false);
+		printf("[ok] JOINKEY = %s\n", s);
+	} else {
+		printf("[error] Error saving config\n");
+	}
+}
+
+static void reboot(bool to_bootloader) {
+	if (to_bootloader) {
+		rtc_save_backup(RTC_REGBACKUP_BOOTLOADER_VALUE, RTC_REGBACKUP_BOOTLOADER);
+	}
+
+	NVIC_SystemReset();
+}
+
+static void exec_command(ls_gate_t *ls, kernel_pid_t writer, gc_pending_fifo_t *fifo, char *data) {
 	gate_cmd_type_t c = data[0];
 	char *payload = data + 1;
 
 	switch (c) {
-	case CMD_PING:
-		/* Send pong response */
-		gc_pending_fifo_push(fifo, "!\n");
-
-		/* Send flush message */
-		msg_t msg;
-		msg_send(&msg, writer);
+	case CMD_PING: {
+		/* Optional two hex digits select the protocol mode */
+		uint8_t mode = 0;
+		if (strlen(payload) >= 2 + 1 && hex_to_bytesn(payload, 2, &mode, false)) {
+			send_pong(writer, fifo, mode ? 1 : 0);
+		} else {
+			send_pong(writer, fifo, -1);
+		}
 
 		break;
+	}
 
 	case CMD_DEVLIST:
-		for (int i = 0; i < LS_GATE_MAX_NODES; i++) {
-			if (!devs->nodes_free_list[i]) {
-				char buf[128];
-
-				/* L */
-				sprintf(buf, "%c%08X%08X%08X%08X%04X%04X\n", REPLY_LIST,
-						(unsigned int) (devs->nodes[i].node_id >> 32), (unsigned int) (devs->nodes[i].node_id & 0xFFFFFFFF),
-						(unsigned int) (devs->nodes[i].app_id >> 32), (unsigned int) (devs->nodes[i].app_id & 0xFFFFFFFF),
-						(unsigned int) ((ls->_internal.ping_count - devs->nodes[i].last_seen) * LS_PING_TIMEOUT_S),
-						(unsigned int) devs->nodes[i].node_class);
-
-				if (!gc_pending_fifo_push(fifo, buf)) {
-					puts("gc: pending fifo overflowed!");
-				}
-			}
-		}
-
+		send_devlist(ls, writer, fifo);
 		break;
 
 	case CMD_IND: {
@@ -96,14 +304,6 @@ static void exec_command(ls_gate_t *ls, kernel_pid_t writer, gc_pending_fifo_t *
 			return;
 		}
 
-		ls_gate_node_t *node = ls_devlist_get_by_nodeid(devs, nodeid);
-		if (node == NULL) {
-			printf("[error] Node with ID %08X%08X was not found.\n",
-                    (unsigned int) (nodeid >> 32),
-                    (unsigned int) (nodeid & 0xFFFFFFFF));
-			return;
-		}
-
 		/* Skip nodeid */
 		payload += 16;
 
@@ -120,8 +320,7 @@ static void exec_command(ls_gate_t *ls, kernel_pid_t writer, gc_pending_fifo_t *
 			return;
 		}
 
-		/* Send LoRa message */
-		ls_gate_send_to(ls, node->addr, a, numdigits / 2);
+		send_to_node(ls, nodeid, a, numdigits / 2);
 		break;
 	}
 
@@ -145,21 +344,10 @@ static void exec_command(ls_gate_t *ls, kernel_pid_t writer, gc_pending_fifo_t *
 			return;
 		}
 
-		ls_gate_node_t *node = ls_devlist_get_by_nodeid(devs, nodeid);
-		if (node == NULL) {
-			puts("[error] Node with specified node ID is not found.\n");
-			return;
-		}
-
 		/* Skip nodeid */
 		payload += 16;
 
-		uint8_t num_pending = strtol(payload, NULL, 16);
-		node->num_pending = num_pending;
-
-		printf("[pending] setting node 0x%08X%08X has %u frames pending\n",
-				(unsigned int) (node->node_id >> 32),
-				(unsigned int) (node->node_id & 0xFFFFFFFF), num_pending);
+		set_pending(ls, nodeid, strtol(payload, NULL, 16));
 
 		break;
 	}
@@ -177,11 +365,7 @@ static void exec_command(ls_gate_t *ls, kernel_pid_t writer, gc_pending_fifo_t *
 			return;
 		}
 
-		printf("[invite] Sending invite to node with ID 0x%08X%08X\n",
-				(unsigned int) (nodeid >> 32),
-				(unsigned int) (nodeid & 0xFFFFFFFF));
-
-		ls_gate_invite(ls, nodeid);
+		invite(ls, nodeid);
 		break;
 	}
 
@@ -235,11 +419,6 @@ static void exec_command(ls_gate_t *ls, kernel_pid_t writer, gc_pending_fifo_t *
 			return;
 		}
 
-		if (addr >= LS_GATE_MAX_NODES) {
-			printf("[error] Unable to add node with address %u >= %u\n", (unsigned int) addr, (unsigned int) LS_GATE_MAX_NODES);
-			return;
-		}
-
 		/* Skip address */
 		payload += 8;
 
@@ -258,47 +437,14 @@ static void exec_command(ls_gate_t *ls, kernel_pid_t writer, gc_pending_fifo_t *
 			return;
 		}
 
-		printf("[gate-commands] Added device: ");
-		printf("eui: 0x%08X%08X ",
-						(unsigned int) (nodeid >> 32),
-						(unsigned int) (nodeid & 0xFFFFFFFF));
-		printf("appid: 0x%08X%08X ",
-						(unsigned int) (appid >> 32),
-						(unsigned int) (appid & 0xFFFFFFFF));
-
-		printf("addr: 0x%08X ", (unsigned int) addr);
-		printf("nonce: 0x%08X ", (unsigned int) dev_nonce);
-		printf("ch: 0x%02X\n", (unsigned int) channel);
-
-		/* Kick previous device if present */
-		if (ls_devlist_is_in_network(devs, addr)) {
-			ls_devlist_remove_device(devs, addr);
-		}
-
-		/* Add device with specified nonce and address */
-		ls_gate_node_t *node = ls_devlist_add_by_addr(devs, addr, nodeid, appid, dev_nonce, &channels[channel]);
-		if (node == NULL)
-			return;
-
-		node->app_nonce = 0;
+		add_static_dev(ls, nodeid, appid, addr, dev_nonce, channel);
 
 		break;
 	}
 
-	case CMD_KICK_ALL_STATIC: {
-		for (int i = 0; i < LS_GATE_MAX_NODES; i++) {
-			if (!devs->nodes_free_list[i]) {
-				if (devs->nodes[i].is_static) {
-					/* Remove device */
-					ls_devlist_remove_device(devs, i);
-				}
-			}
-		}
-
-		puts("[gate-commands] All statically personalized devices are kicked");
-
+	case CMD_KICK_ALL_STATIC:
+		kick_all_static(ls);
 		break;
-	}
     
     case CMD_SET_REGION: {
         if (strlen(payload) != 3) {
@@ -339,30 +485,21 @@ static void exec_command(ls_gate_t *ls, kernel_pid_t writer, gc_pending_fifo_t *
 		}
         
         uint8_t joinkey[16] = {};
-        uint64_t appid64 = config_get_appid();
 
         if (!hex_to_bytes(payload, joinkey, false)) {
         	printf("[error] Invalid hex data received: %s\n", payload);
 			return;
 		}
-             
-        if (config_write_main_block(appid64, joinkey, 0)) {
-            char s[32] = {};
-            bytes_to_hex(joinkey, 16, s, false);
-            printf("[ok] JOINKEY = %s\n", s);
-        } else {
-            printf("[error] Error saving config\n");
-        }
-        
+
+        set_joinkey(joinkey);
         break;
     }
     case CMD_REBOOT: {
-        NVIC_SystemReset();
+        reboot(false);
         break;
     }
     case CMD_FW_UPDATE: {
-        rtc_save_backup(RTC_REGBACKUP_BOOTLOADER_VALUE, RTC_REGBACKUP_BOOTLOADER);
-        NVIC_SystemReset();
+        reboot(true);
         break;
     }
 
@@ -376,6 +513,138 @@ void gc_parse_command(ls_gate_t *ls, kernel_pid_t writer, gc_pending_fifo_t *fif
 	exec_command(ls, writer, fifo, cmd);
 }
 
+void gc_parse_binary_command(ls_gate_t *ls, kernel_pid_t writer, gc_pending_fifo_t *fifo, uint8_t type, uint8_t *payload, size_t len) {
+	uint64_t nodeid = 0;
+
+	/* Commands addressed to a node start with its ID */
+	switch (type) {
+	case CMD_IND:
+	case CMD_HAS_PENDING:
+	case CMD_INVITE:
+	case CMD_ADD_STATIC_DEV:
+		if (len < 8) {
+			printf("[error] Invalid binary command received: 0x%02X\n", type);
+			return;
+		}
+
+		memcpy(&nodeid, payload, 8);
+		payload += 8;
+		len -= 8;
+		break;
+
+	default:
+		break;
+	}
+
+	switch (type) {
+	case CMD_PING:
+		send_pong(writer, fifo, (len > 0) ? (payload[0] ? 1 : 0) : -1);
+		break;
+
+	case CMD_DEVLIST:
+		send_devlist(ls, writer, fifo);
+		break;
+
+	case CMD_IND:
+		if (len > UNWDS_MAX_DATA_LEN) {
+			printf("[error] Invalid binary command received: 0x%02X\n", type);
+			return;
+		}
+
+		send_to_node(ls, nodeid, payload, len);
+		break;
+
+	case CMD_FLUSH: {
+		/* Send flush message */
+		msg_t msg;
+		msg_send(&msg, writer);
+		break;
+	}
+
+	case CMD_HAS_PENDING:
+		if (len != 1) {
+			printf("[error] Invalid binary command received: 0x%02X\n", type);
+			return;
+		}
+
+		set_pending(ls, nodeid, payload[0]);
+		break;
+
+	case CMD_INVITE:
+		invite(ls, nodeid);
+		break;
+
+	case CMD_BROADCAST:
+		if (len > UNWDS_MAX_DATA_LEN) {
+			printf("[error] Invalid binary command received: 0x%02X\n", type);
+			return;
+		}
+
+		ls_gate_broadcast(ls, payload, len);
+		break;
+
+	case CMD_ADD_STATIC_DEV: {
+		/* App. ID (8), address (4), device nonce (4), channel (1) */
+		if (len != 8 + 4 + 4 + 1) {
+			printf("[error] Invalid binary command received: 0x%02X\n", type);
+			return;
+		}
+
+		uint64_t appid;
+		uint32_t addr;
+		uint32_t dev_nonce;
+		memcpy(&appid, payload, 8);
+		memcpy(&addr, payload + 8, 4);
+		memcpy(&dev_nonce, payload + 12, 4);
+
+		add_static_dev(ls, nodeid, appid, addr, dev_nonce, payload[16]);
+		break;
+	}
+
+	case CMD_KICK_ALL_STATIC:
+		kick_all_static(ls);
+		break;
+
+	case CMD_SET_REGION:
+	case CMD_SET_DATARATE:
+	case CMD_SET_CHANNEL:
+		if (len != 1) {
+			printf("[error] Invalid binary command received: 0x%02X\n", type);
+			return;
+		}
+
+		if (type == CMD_SET_REGION) {
+			unwds_set_region(payload[0]);
+		} else if (type == CMD_SET_DATARATE) {
+			unwds_set_dr(payload[0]);
+		} else {
+			unwds_set_channel(payload[0]);
+		}
+		break;
+
+	case CMD_SET_JOINKEY:
+		if (len != 16) {
+			printf("[error] Invalid key length: %u\n", (unsigned int) len);
+			return;
+		}
+
+		set_joinkey(payload);
+		break;
+
+	case CMD_REBOOT:
+		reboot(false);
+		break;
+
+	case CMD_FW_UPDATE:
+		reboot(true);
+		break;
+
+	default:
+		printf("[gate-commands] Unsupported binary command: 0x%02X\n", type);
+		break;
+	}
+}
+
 #ifdef __cplusplus
 }
 #endif
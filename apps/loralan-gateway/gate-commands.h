@@ -70,4 +70,9 @@ typedef enum {
 
 void gc_parse_command(ls_gate_t *ls, kernel_pid_t writer, gc_pending_fifo_t *fifo, char *cmd);
 
+/**
+ * @brief Executes a command record received in binary mode, see gate-binary.h
+ */
+void gc_parse_binary_command(ls_gate_t *ls, kernel_pid_t writer, gc_pending_fifo_t *fifo, uint8_t type, uint8_t *payload, size_t len);
+
 #endif /* GATE_COMMANDS_H_ */
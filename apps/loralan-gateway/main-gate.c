@@ -41,6 +41,7 @@ extern "C" {
 #include "main.h"
 
 #include "thread.h"
+#include "irq.h"
 #include "random.h"
 #include "periph/rtc.h"
 #include "periph/wdg.h"
@@ -68,6 +69,7 @@ extern "C" {
 #include "ls-gate.h"
 
 #include "gate-commands.h"
+#include "gate-binary.h"
 #include "pending-fifo.h"
 
 #define ENABLE_DEBUG    (0)
@@ -88,20 +90,21 @@ static ls_gate_channel_t channels[1] = {
         .dr = LS_DR6,
         .frequency = 0,
         .last_rssi = 0,
-        .state = LS_GATE_CHANNEL_STATE_IDLE,
+        .duty_cycle = 0,
         ._internal = {
                 .device = &netdev,
                 .gate = &ls
         }
-    },        /* DR, frequency, rssi, state, sx127x & LS instance */
+    },        /* DR, frequency, rssi, duty cycle, sx127x & LS instance */
 };
 
-/* UART interaction */
-#define UART_BUFSIZE        (255U)
+/* UART interaction, buffer holds a couple of binary frames */
+#define UART_BUFSIZE        (2 * (GC_BIN_HEADER_LEN + GC_BIN_MAX_CMD_LEN + GC_BIN_CRC_LEN))
 #define EOL '\r'
 
 static char rx_mem[UART_BUFSIZE];
 static ringbuffer_t rx_buf;
+static volatile unsigned rx_ready;	/**< Number of complete lines or frames in rx_buf */
 
 static kernel_pid_t gate_reader_pid;
 static char reader_stack[1024 + 2 * 1024];
@@ -117,9 +120,18 @@ static void rx_cb(void *arg, uint8_t data)
 {
     (void)arg;
     
-    ringbuffer_add_one(&rx_buf, data);
+    bool ready;
+
+    if (gc_bin_mode()) {
+        ready = gc_bin_rx_byte(&rx_buf, data);
+    } else {
+        ringbuffer_add_one(&rx_buf, data);
+        ready = (data == EOL);
+    }
+
+    if (ready) {
+        rx_ready++;
 
-    if (data == EOL) {
         msg_t msg;
         msg_send(&msg, gate_reader_pid);
     }
@@ -137,12 +149,8 @@ static void *writer(void *arg)
     while (1) {
         msg_receive(&msg);
 
-        char buf[GC_MAX_REPLY_LEN];
-        while (!gc_pending_fifo_empty(&fifo)) {
-            if (gc_pending_fifo_pop(&fifo, buf)) {
-                uart_write(uart, (uint8_t *) buf, strlen(buf));
-            }
-        }
+        /* Replies are written to UART straight from the queue */
+        gc_flush_pending(uart, &fifo);
     }
 
     return NULL;
@@ -160,18 +168,32 @@ static void *reader(void *arg)
     while (1) {
         msg_receive(&msg);
 
-        char c;
-        int i = 0;
-        do {
-            c = ringbuffer_get_one(&rx_buf);
-            buf[i++] = c;
-        } while (c != EOL);
+        /* Messages may be lost when reader is busy, so process everything that is ready */
+        while (rx_ready) {
+            unsigned state = irq_disable();
+            rx_ready--;
+            irq_restore(state);
+
+            if (ringbuffer_peek_one(&rx_buf) == GC_BIN_SOF) {
+                if (!gc_bin_parse_frame(&ls, writer_pid, &fifo, &rx_buf)) {
+                    puts("[error] Invalid binary frame received");
+                }
+                continue;
+            }
+
+            char c;
+            int i = 0;
+            do {
+                c = ringbuffer_get_one(&rx_buf);
+                buf[i++] = c;
+            } while (c != EOL && i < (int) sizeof(buf) - 1);
 
-        /* Strip the string just in case that there's a garbage after EOL */
-        buf[i] = '\0';
+            /* Strip the string just in case that there's a garbage after EOL */
+            buf[i] = '\0';
 
-        /* Parse received command */
-        gc_parse_command(&ls, writer_pid, &fifo, buf);
+            /* Parse received command */
+            gc_parse_command(&ls, writer_pid, &fifo, buf);
+        }
     }
 
     /* this should never be reached */
@@ -228,10 +250,25 @@ static void radio_init(void)
 
 static int ls_list_cmd(int argc, char **argv);
 
+/**
+ * @brief Queues binary reply which payload is node ID only
+ */
+static void push_binary_nodeid(gate_reply_type_t type, ls_gate_node_t *node)
+{
+    if (!gc_bin_push(&fifo, type, &node->node_id, sizeof(node->node_id))) {
+        puts("gc: pending fifo overflowed!");
+    }
+}
+
 static void node_kicked_cb(ls_gate_node_t *node)
 {
     printf("ls-gate: node 0x%08X%08X kicked for long silence\n", (unsigned int) (node->node_id >> 32), (unsigned int) (node->node_id & 0xFFFFFFFF));
 
+    if (gc_bin_mode()) {
+        push_binary_nodeid(REPLY_KICK, node);
+        return;
+    }
+
     char str[18] = {};
 
     sprintf(str, "%c%08X%08X\n", REPLY_KICK, (unsigned int) (node->node_id >> 32), (unsigned int) (node->node_id & 0xFFFFFFFF));
@@ -246,10 +283,21 @@ static uint32_t node_joined_cb(ls_gate_node_t *node)
            (unsigned int) node->addr);
 
     /* Notify the gate */
-    char str[128] = { '\0' };
-    sprintf(str, "%c%08X%08X%u\n", REPLY_JOIN, (unsigned int) (node->node_id >> 32), (unsigned int) (node->node_id & 0xFFFFFFFF), (unsigned int) node->node_class);
+    if (gc_bin_mode()) {
+        /* Node ID (8), class (1) */
+        uint8_t rec[9];
+        memcpy(rec, &node->node_id, 8);
+        rec[8] = node->node_class;
+
+        if (!gc_bin_push(&fifo, REPLY_JOIN, rec, sizeof(rec))) {
+            puts("gc: pending fifo overflowed!");
+        }
+    } else {
+        char str[128] = { '\0' };
+        sprintf(str, "%c%08X%08X%u\n", REPLY_JOIN, (unsigned int) (node->node_id >> 32), (unsigned int) (node->node_id & 0xFFFFFFFF), (unsigned int) node->node_class);
 
-    gc_pending_fifo_push(&fifo, str);
+        gc_pending_fifo_push(&fifo, str);
+    }
 
     /* Return random app nonce */
     return sx127x_random(&sx127x);
@@ -263,8 +311,40 @@ static bool accept_node_join_cb(uint64_t dev_id, uint64_t app_id)
     return true; /* Stub */
 }
 
+/**
+ * @brief Queues binary indication: node ID (8), RSSI (2), status (1), data
+ */
+static void app_data_received_binary(ls_gate_node_t *node, ls_gate_channel_t *ch, uint8_t *buf, size_t bufsize, uint8_t status)
+{
+    const size_t hdr_len = 8 + 2 + 1;
+
+    if (bufsize > GC_BIN_MAX_RECORD_LEN - hdr_len) {
+        bufsize = GC_BIN_MAX_RECORD_LEN - hdr_len;
+    }
+
+    uint8_t *rec = gc_bin_reserve(&fifo, REPLY_IND, hdr_len + bufsize);
+    if (rec == NULL) {
+        puts("gc: pending fifo overflowed!");
+        return;
+    }
+
+    int16_t rssi = ch->last_rssi;
+
+    memcpy(rec, &node->node_id, 8);
+    memcpy(rec + 8, &rssi, 2);
+    rec[10] = status;
+    memcpy(rec + hdr_len, buf, bufsize);
+
+    gc_bin_commit(&fifo, rec, hdr_len + bufsize);
+}
+
 void app_data_received_cb(ls_gate_node_t *node, ls_gate_channel_t *ch, uint8_t *buf, size_t bufsize, uint8_t status)
 {
+    if (gc_bin_mode()) {
+        app_data_received_binary(node, ch, buf, bufsize, status);
+        return;
+    }
+
     char hex[GC_MAX_REPLY_LEN - 19] = {};
     if (bufsize > sizeof(hex))
     	bufsize = sizeof(hex);
@@ -280,14 +360,20 @@ void app_data_received_cb(ls_gate_node_t *node, ls_gate_channel_t *ch, uint8_t *
     bytes_to_hex(buf, bufsize, hex, false);
     printf("Data: %u bytes, 0x%s\n", bufsize, hex);
 
-    char str[GC_MAX_REPLY_LEN] = { };
-    sprintf(str, "%c%08X%08X%s%s%s\n", REPLY_IND,
+    /* Format indication right in the queue */
+    char *str = gc_pending_fifo_reserve(&fifo, GC_MAX_REPLY_LEN);
+    if (str == NULL) {
+        puts("gc: pending fifo overflowed!");
+        return;
+    }
+
+    int len = snprintf(str, GC_MAX_REPLY_LEN, "%c%08X%08X%s%s%s\n", REPLY_IND,
     		(unsigned int) (node->node_id >> 32), (unsigned int) (node->node_id & 0xFFFFFFFF),
 			buf_rssi,
             buf_status,
 			hex);
 
-    gc_pending_fifo_push(&fifo, str);
+    gc_pending_fifo_commit(&fifo, (len < GC_MAX_REPLY_LEN) ? len : GC_MAX_REPLY_LEN - 1);
 }
 
 void app_data_ack_cb(ls_gate_node_t *node, ls_gate_channel_t *ch)
@@ -296,6 +382,11 @@ void app_data_ack_cb(ls_gate_node_t *node, ls_gate_channel_t *ch)
     
     printf("ls-gate: data acknowledged from 0x%08X%08X\n", (unsigned int) (node->node_id >> 32), (unsigned int) (node->node_id & 0xFFFFFFFF));
 
+    if (gc_bin_mode()) {
+        push_binary_nodeid(REPLY_ACK, node);
+        return;
+    }
+
     char str[18] = {};
 
     sprintf(str, "%c%08X%08X\n", REPLY_ACK, (unsigned int) (node->node_id >> 32), (unsigned int) (node->node_id & 0xFFFFFFFF));
@@ -306,6 +397,11 @@ void app_data_ack_cb(ls_gate_node_t *node, ls_gate_channel_t *ch)
 static void pending_frames_req_cb(ls_gate_node_t *node) {
 	printf("ls-gate: requesting next pending frame for 0x%08X%08X\n", (unsigned int) (node->node_id >> 32), (unsigned int) (node->node_id & 0xFFFFFFFF));
 
+    if (gc_bin_mode()) {
+        push_binary_nodeid(REPLY_PENDING_REQ, node);
+        return;
+    }
+
     char str[18] = {};
     sprintf(str, "%c%08X%08X\n", REPLY_PENDING_REQ,
     		(unsigned int) (node->node_id >> 32), (unsigned int) (node->node_id & 0xFFFFFFFF));
@@ -529,6 +625,55 @@ static int kick_cmd(int argc, char **argv) {
 	return -1;
 }
 
+static int links_cmd(int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+
+    ls_gate_devices_t *devs = &ls.devices;
+    uint32_t uplinks = 0;
+    uint32_t airtime_ms = 0;
+
+    printf("addr.\t\t|\tDR\t|\tTX power\t|\tRSSI\t|\tuplinks\t|\tairtime\t\t|\tper uplink\t|\tADR cmds\n");
+
+    for (int i = 0; i < LS_GATE_MAX_NODES; i++) {
+        if (devs->nodes_free_list[i]) {
+            continue;
+        }
+
+        ls_gate_link_t *link = &devs->nodes[i].link;
+
+        printf("0x%08X\t|\t%d\t|\t%d dBm\t\t|\t%d\t|\t%u\t|\t%u ms\t\t|\t%u ms\t\t|\t%u\n",
+               (unsigned int) devs->nodes[i].addr, (int) link->dr, (int) link->tx_power, (int) link->last_rssi,
+               (unsigned int) link->uplinks, (unsigned int) link->airtime_ms,
+               (unsigned int) (link->uplinks ? link->airtime_ms / link->uplinks : 0),
+               (unsigned int) link->adr_commands);
+
+        uplinks += link->uplinks;
+        airtime_ms += link->airtime_ms;
+    }
+
+    printf("Total: %u uplinks, %u ms on air, %u ms per uplink\n",
+           (unsigned int) uplinks, (unsigned int) airtime_ms,
+           (unsigned int) (uplinks ? airtime_ms / uplinks : 0));
+
+    return 0;
+}
+
+static int fifo_cmd(int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+
+    gc_pending_stats_t *st = &fifo.stats;
+
+    printf("Host replies buffer: %u of %u bytes used, %u max.\n",
+           gc_pending_fifo_used(&fifo), (unsigned int) GC_PENDING_BUF_SIZE, (unsigned int) st->max_used);
+    printf("Queued: %u replies, %u bytes\n", (unsigned int) st->replies, (unsigned int) st->bytes);
+    printf("Dropped: %u replies, %u bytes\n", (unsigned int) st->overflows, (unsigned int) st->dropped_bytes);
+    printf("UART writes: %u, %u ms blocked\n", (unsigned int) st->writes, (unsigned int) (st->write_time_us / 1000));
+
+    return 0;
+}
+
 static void iwdg_reset (void *arg) {
     (void)arg;
     
@@ -544,6 +689,8 @@ shell_command_t shell_commands[UNWDS_SHELL_COMMANDS_MAX] = {
     { "list", "-- prints list of connected devices", ls_list_cmd },
 	{ "add", "<nodeid> <appid> <addr> <devnonce> <channel> -- adds node to the list", add_cmd },
 	{ "kick", "<addr> -- kicks node from the list by its address", kick_cmd},
+    { "fifo", "-- prints host replies buffer statistics", fifo_cmd },
+    { "links", "-- prints link settings and airtime of connected devices", links_cmd },
     { NULL, NULL, NULL }
 };
 
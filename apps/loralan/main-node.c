@@ -55,6 +55,8 @@ extern "C" {
 
 #include "unwds-common.h"
 #include "unwds-gpio.h"
+#include "unwds-batch.h"
+#include "umdk-ids.h"
 #include "ls-settings.h"
 #include "ls-end-device.h"
 #include "ls-init-device.h"
@@ -287,6 +289,7 @@ static void ls_setup(ls_ed_t *ls)
     ls->joined_cb = joined_cb;
     
     ls->settings.confirmation = unwds_get_node_settings().confirmation;
+    ls->settings.adr = unwds_get_node_settings().adr;
 
     ls->appdata_send_failed_cb = appdata_send_failed_cb;
     ls->settings.max_retr = unwds_get_node_settings().max_retr;     /* Maximum number of confirmed data retransmissions */
@@ -313,6 +316,7 @@ int ls_set_cmd(int argc, char **argv)
         puts("\tdr <0-6> -- sets device data rate [0 - slowest, 3 - average, 6 - fastest]");
         puts("\tmaxretr <0-255> -- sets maximum number of retransmissions of confirmed app. data [5 is recommended]");
         puts("\tclass <A/B/C> -- sets device class");
+        puts("\tadr <0/1> -- follow data rate and TX power commanded by the gate");
     }
 
     char *key = argv[1];
@@ -369,6 +373,11 @@ int ls_set_cmd(int argc, char **argv)
             ls.settings.class = LS_ED_CLASS_C;
         }
     }
+    else if (strcmp(key, "adr") == 0) {
+    	char v = value[0];
+
+    	ls.settings.adr = (v == '1');
+    }
     else if (strcmp(key, "nojoin") == 0) {
     	char v = value[0];
 
@@ -399,6 +408,7 @@ int ls_set_cmd(int argc, char **argv)
     unwds_set_dr(ls.settings.dr);
     unwds_set_max_retr(ls.settings.max_retr);
     unwds_set_class(ls.settings.class);
+    unwds_set_adr(ls.settings.adr);
 
     return 0;
 }
@@ -456,6 +466,8 @@ static void print_config(void)
     
     printf("CONFIRMED = %s\n", (unwds_get_node_settings().confirmation) ? "yes" : "no");
 
+    printf("ADR = %s\n", (unwds_get_node_settings().adr) ? "yes" : "no");
+
     char nodeclass = 'A'; // unwds_get_node_settings().nodeclass == LS_ED_CLASS_A
     if (unwds_get_node_settings().nodeclass == LS_ED_CLASS_B) {
         nodeclass = 'B';
@@ -612,6 +624,22 @@ static int ls_join_cmd(int argc, char **argv) {
     return 0;
 }
 
+static int ls_queue_cmd(int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+
+    appdata_fifo_t *fifo = &ls._internal.appdata_fifo;
+    appdata_fifo_stats_t *st = &fifo->stats;
+
+    printf("Pending app. data: %d of %d\n", appdata_fifo_size(fifo), APPDATA_FIFO_SIZE);
+    printf("Queued: %u, replaced: %u, expired: %u, dropped: %u\n",
+           (unsigned int) st->pushed, (unsigned int) st->replaced,
+           (unsigned int) st->expired, (unsigned int) st->dropped);
+
+    return 0;
+}
+
 shell_command_t shell_commands[UNWDS_SHELL_COMMANDS_MAX] = {
     { "set", "<config> <value> -- set value for the configuration entry", ls_set_cmd },
     { "lscfg", "-- print out current configuration", ls_printc_cmd },
@@ -621,12 +649,25 @@ shell_command_t shell_commands[UNWDS_SHELL_COMMANDS_MAX] = {
     { "cmd", "<modid> <cmdhex> -- send command to another UNWDS device", ls_cmd_cmd },
     { "safe", " -- reboot in safe mode", ls_safe_cmd },
     { "join", " -- join now", ls_join_cmd },
+    { "queue", " -- print pending app. data statistics", ls_queue_cmd },
     { NULL, NULL, NULL },
 };
 
 static void unwds_callback(module_data_t *buf)
 {
-    int res = ls_ed_send_app_data(&ls, buf->data, buf->length, true, buf->as_ack, false);
+    /* Replies to commands go first, a newer report of the module replaces its unsent one */
+    ls_ed_appdata_opts_t opts = {
+        .priority = (buf->as_ack) ? APPDATA_PRIO_HIGH : APPDATA_PRIO_NORMAL,
+        .key = APPDATA_FIFO_NO_KEY,
+        .lifetime_ms = 0,
+    };
+
+    /* Aggregated frames hold reports of different modules */
+    if (!buf->as_ack && (buf->length > 0) && (buf->data[0] != UNWDS_BATCH_MODULE_ID)) {
+        opts.key = buf->data[0];
+    }
+
+    int res = ls_ed_send_app_data_opts(&ls, buf->data, buf->length, true, buf->as_ack, &opts);
 
     if (res < 0) {
         if (res == -LS_SEND_E_FQ_OVERFLOW) {
@@ -718,7 +759,9 @@ void init_normal(shell_command_t *commands)
             blink_led(LED_GREEN);
         }
         else {
-            unwds_init_modules(unwds_callback);
+            /* Reports of the modules share frames within the aggregation window */
+            unwds_batch_init(unwds_callback);
+            unwds_init_modules(unwds_batch_add);
             
             /* reset IWDG timer every 15 seconds */
             /* NB: unwired-module MUST NOT need more than 3 seconds to finish its job */
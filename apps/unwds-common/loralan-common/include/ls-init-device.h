@@ -41,4 +41,9 @@ void init_role(shell_command_t *shell_commands);
 
 void ls_setup_sx127x(netdev_t *dev, ls_datarate_t dr, uint32_t frequency);
 
+/**
+ * @brief Calculates time on air [us] of a frame of len bytes at the data rate
+ */
+uint32_t ls_time_on_air(ls_datarate_t dr, size_t len);
+
 #endif /* LS_INIT_DEVICE_H_ */
@@ -70,53 +70,6 @@ static uint64_t appid = 0;
 static uint8_t joinkey[16] = {};
 static uint32_t devnonce = 0;
 
-/**
- * Data rates table.
- */
-const uint8_t datarate_table[7][3] = {
-    { LORA_SF12, LORA_BW_125_KHZ, LORA_CR_4_5 },       /* DR0 */
-    { LORA_SF11, LORA_BW_125_KHZ, LORA_CR_4_5 },       /* DR1 */
-    { LORA_SF10, LORA_BW_125_KHZ, LORA_CR_4_5 },       /* DR2 */
-    { LORA_SF9, LORA_BW_125_KHZ, LORA_CR_4_5 },        /* DR3 */
-    { LORA_SF8, LORA_BW_125_KHZ, LORA_CR_4_5 },        /* DR4 */
-    { LORA_SF7, LORA_BW_125_KHZ, LORA_CR_4_5 },        /* DR5 */
-    { LORA_SF7, LORA_BW_250_KHZ, LORA_CR_4_5 },        /* DR6 */
-};
-
-void ls_setup_sx127x(netdev_t *dev, ls_datarate_t dr, uint32_t frequency) {    
-    const netopt_enable_t enable = true;
-    const netopt_enable_t disable = false;
-
-    /* Choose data rate */
-    const uint8_t *datarate = datarate_table[dr];
-    dev->driver->set(dev, NETOPT_SPREADING_FACTOR, &datarate[0], sizeof(uint8_t));
-    dev->driver->set(dev, NETOPT_BANDWIDTH, &datarate[1], sizeof(uint8_t));
-    dev->driver->set(dev, NETOPT_CODING_RATE, &datarate[2], sizeof(uint8_t));
-    
-    uint8_t hop_period = 0;
-    dev->driver->set(dev, NETOPT_CHANNEL_HOP_PERIOD, &hop_period, sizeof(uint8_t));
-    dev->driver->set(dev, NETOPT_CHANNEL_HOP, &disable, sizeof(disable));
-    dev->driver->set(dev, NETOPT_SINGLE_RECEIVE, &disable, sizeof(disable));
-    dev->driver->set(dev, NETOPT_INTEGRITY_CHECK, &enable, sizeof(enable));
-    dev->driver->set(dev, NETOPT_FIXED_HEADER, &disable, sizeof(disable));
-    dev->driver->set(dev, NETOPT_IQ_INVERT, &disable, sizeof(disable));
-    
-    uint8_t power = TX_OUTPUT_POWER;
-    dev->driver->set(dev, NETOPT_TX_POWER, &power, sizeof(uint8_t));
-    
-    uint16_t preamble_len = LORA_PREAMBLE_LENGTH;
-    dev->driver->set(dev, NETOPT_PREAMBLE_LENGTH, &preamble_len, sizeof(uint8_t));
-    
-    uint32_t tx_timeout = 30000;
-    dev->driver->set(dev, NETOPT_TX_TIMEOUT, &tx_timeout, sizeof(uint8_t));
-    
-    uint32_t rx_timeout = 0;
-    dev->driver->set(dev, NETOPT_RX_TIMEOUT, &rx_timeout, sizeof(uint8_t));
-
-    /* Setup channel */
-    dev->driver->set(dev, NETOPT_CHANNEL, &frequency, sizeof(uint32_t));
-}
-
 void init_role(shell_command_t *commands) {
     pm_init();
     /* all power modes are blocked by default */
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2016-2018 Unwired Devices LLC <info@unwds.com>
+
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+/**
+ * @defgroup
+ * @ingroup
+ * @brief
+ * @{
+ * @file        ls-init-radio.c
+ * @brief       LoRaLAN transceiver configuration, shared by gates and end devices
+ * @author      Oleg Artamonov
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "board.h"
+#include "net/lora.h"
+#include "net/netdev.h"
+
+#include "ls-init-device.h"
+
+/* Boards without LoRa transceiver (native with simulated radio) */
+#ifndef TX_OUTPUT_POWER
+#define TX_OUTPUT_POWER         (14)
+#endif
+
+#ifndef LORA_PREAMBLE_LENGTH
+#define LORA_PREAMBLE_LENGTH    (LORA_PREAMBLE_LENGTH_DEFAULT)
+#endif
+
+/**
+ * Data rates table.
+ */
+const uint8_t datarate_table[7][3] = {
+    { LORA_SF12, LORA_BW_125_KHZ, LORA_CR_4_5 },       /* DR0 */
+    { LORA_SF11, LORA_BW_125_KHZ, LORA_CR_4_5 },       /* DR1 */
+    { LORA_SF10, LORA_BW_125_KHZ, LORA_CR_4_5 },       /* DR2 */
+    { LORA_SF9, LORA_BW_125_KHZ, LORA_CR_4_5 },        /* DR3 */
+    { LORA_SF8, LORA_BW_125_KHZ, LORA_CR_4_5 },        /* DR4 */
+    { LORA_SF7, LORA_BW_125_KHZ, LORA_CR_4_5 },        /* DR5 */
+    { LORA_SF7, LORA_BW_250_KHZ, LORA_CR_4_5 },        /* DR6 */
+};
+
+void ls_setup_sx127x(netdev_t *dev, ls_datarate_t dr, uint32_t frequency) {
+    const netopt_enable_t enable = true;
+    const netopt_enable_t disable = false;
+
+    /* Choose data rate */
+    const uint8_t *datarate = datarate_table[dr];
+    dev->driver->set(dev, NETOPT_SPREADING_FACTOR, &datarate[0], sizeof(uint8_t));
+    dev->driver->set(dev, NETOPT_BANDWIDTH, &datarate[1], sizeof(uint8_t));
+    dev->driver->set(dev, NETOPT_CODING_RATE, &datarate[2], sizeof(uint8_t));
+    
+    uint8_t hop_period = 0;
+    dev->driver->set(dev, NETOPT_CHANNEL_HOP_PERIOD, &hop_period, sizeof(uint8_t));
+    dev->driver->set(dev, NETOPT_CHANNEL_HOP, &disable, sizeof(disable));
+    dev->driver->set(dev, NETOPT_SINGLE_RECEIVE, &disable, sizeof(disable));
+    dev->driver->set(dev, NETOPT_INTEGRITY_CHECK, &enable, sizeof(enable));
+    dev->driver->set(dev, NETOPT_FIXED_HEADER, &disable, sizeof(disable));
+    dev->driver->set(dev, NETOPT_IQ_INVERT, &disable, sizeof(disable));
+    
+    int16_t power = TX_OUTPUT_POWER;
+    dev->driver->set(dev, NETOPT_TX_POWER, &power, sizeof(int16_t));
+    
+    uint16_t preamble_len = LORA_PREAMBLE_LENGTH;
+    dev->driver->set(dev, NETOPT_PREAMBLE_LENGTH, &preamble_len, sizeof(uint16_t));
+    
+    uint32_t tx_timeout = 30000;
+    dev->driver->set(dev, NETOPT_TX_TIMEOUT, &tx_timeout, sizeof(uint32_t));
+    
+    uint32_t rx_timeout = 0;
+    dev->driver->set(dev, NETOPT_RX_TIMEOUT, &rx_timeout, sizeof(uint32_t));
+
+    /* Setup channel, transceiver doesn't handle NETOPT_CHANNEL */
+    dev->driver->set(dev, NETOPT_CHANNEL_FREQUENCY, &frequency, sizeof(uint32_t));
+}
+
+uint32_t ls_time_on_air(ls_datarate_t dr, size_t len) {
+    const uint8_t *datarate = datarate_table[dr];
+    uint8_t sf = datarate[0];
+
+    /* Symbol time [us] */
+    uint32_t bw_khz = 125 << datarate[1];
+    uint32_t tsym = ((uint32_t) 1000 << sf) / bw_khz;
+
+    /* Low data rate optimization is on for symbols longer than 16 ms */
+    int de = (tsym > 16000) ? 1 : 0;
+
+    /* Explicit header, payload CRC on */
+    int num = 8 * len - 4 * sf + 28 + 16;
+    int den = 4 * (sf - 2 * de);
+
+    uint32_t symbols = 8;
+    if (num > 0) {
+        symbols += ((num + den - 1) / den) * (datarate[2] + 4);
+    }
+
+    /* Preamble and synchronization take 4.25 symbols more than programmed */
+    return (LORA_PREAMBLE_LENGTH + 4 + symbols) * tsym + tsym / 4;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -25,7 +25,7 @@
  * @brief       
  * @{
  * @file		appdata-fifo.c
- * @brief       Application data FIFO implementation
+ * @brief       Application data queue implementation
  * @author      Eugene Ponomarev [ep@unwds.com]
  */
 
@@ -36,107 +36,235 @@
 
 #include "appdata-fifo.h"
 #include "mutex.h"
-#include "irq.h"
+#include "rtctimers-millis.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 
+/**
+ * @brief Returns true if entry a must be sent before entry b
+ */
+static bool is_before(const appdata_fifo_entry_t *a, const appdata_fifo_entry_t *b) {
+	if (a->priority != b->priority) {
+		return a->priority > b->priority;
+	}
+
+	/* Data that could expire goes before data that couldn't */
+	if (a->has_deadline != b->has_deadline) {
+		return a->has_deadline;
+	}
+
+	if (a->has_deadline && (a->deadline != b->deadline)) {
+		return (int32_t) (a->deadline - b->deadline) < 0;
+	}
+
+	return (int32_t) (a->seq - b->seq) < 0;
+}
+
+static void remove_entry(appdata_fifo_t *fifo, int idx) {
+	fifo->fifo[idx].used = false;
+	fifo->num--;
+
+	if (fifo->head == idx) {
+		fifo->head = APPDATA_FIFO_NO_HEAD;
+	}
+}
+
+/**
+ * @brief Drops expired entries, except the head one which may be awaiting acknowledge
+ */
+static void expire(appdata_fifo_t *fifo) {
+	uint32_t now = rtctimers_millis_now();
+
+	for (int i = 0; i < APPDATA_FIFO_SIZE; i++) {
+		appdata_fifo_entry_t *e = &fifo->fifo[i];
+
+		if (e->used && e->has_deadline && (i != fifo->head) && ((int32_t) (now - e->deadline) >= 0)) {
+			remove_entry(fifo, i);
+			fifo->stats.expired++;
+		}
+	}
+}
+
+/**
+ * @brief Finds the entry to be sent first among the ones not at the head, or the last one to be sent
+ */
+static int find(appdata_fifo_t *fifo, bool first) {
+	int found = -1;
+
+	for (int i = 0; i < APPDATA_FIFO_SIZE; i++) {
+		if (!fifo->fifo[i].used || (i == fifo->head)) {
+			continue;
+		}
+
+		if ((found < 0) || (is_before(&fifo->fifo[i], &fifo->fifo[found]) == first)) {
+			found = i;
+		}
+	}
+
+	return found;
+}
+
 void appdata_fifo_init(appdata_fifo_t *fifo) {
 	mutex_init(&fifo->mutex);
-	fifo->front = fifo->start = -1;
+	memset(fifo->fifo, 0, sizeof(fifo->fifo));
+	memset(&fifo->stats, 0, sizeof(fifo->stats));
+
+	fifo->head = APPDATA_FIFO_NO_HEAD;
+	fifo->num = 0;
+	fifo->seq = 0;
 }
 
 bool appdata_fifo_pop(appdata_fifo_t *fifo, appdata_fifo_entry_t *e) {
-	if (appdata_fifo_empty(fifo)) {
-		return false;
-	}
-
 	mutex_lock(&fifo->mutex);
 
-	if (e != NULL) {
-		*e = fifo->fifo[fifo->front];
+	int idx = fifo->head;
+	if (idx == APPDATA_FIFO_NO_HEAD) {
+		expire(fifo);
+		idx = find(fifo, true);
 	}
 
-	if (fifo->front == fifo->start) {
-		fifo->front = fifo->start = -1;
-
+	if (idx < 0) {
 		mutex_unlock(&fifo->mutex);
-		return true;
+		return false;
+	}
+
+	if (e != NULL) {
+		*e = fifo->fifo[idx];
 	}
-	fifo->front = (fifo->front + 1) % APPDATA_FIFO_SIZE;
+
+	remove_entry(fifo, idx);
 
 	mutex_unlock(&fifo->mutex);
 	return true;
 }
 
 bool appdata_fifo_peek(appdata_fifo_t *fifo, appdata_fifo_entry_t *e) {
-	if (appdata_fifo_empty(fifo)) {
+	mutex_lock(&fifo->mutex);
+
+	if (fifo->head == APPDATA_FIFO_NO_HEAD) {
+		expire(fifo);
+		fifo->head = find(fifo, true);
+	}
+
+	if (fifo->head == APPDATA_FIFO_NO_HEAD) {
+		mutex_unlock(&fifo->mutex);
 		return false;
 	}
 
-	mutex_lock(&fifo->mutex);
-	*e = fifo->fifo[fifo->front];
-	mutex_unlock(&fifo->mutex);
+	*e = fifo->fifo[fifo->head];
 
+	mutex_unlock(&fifo->mutex);
 	return true;
 }
 
-bool appdata_fifo_push(appdata_fifo_t *fifo, uint8_t *buf, size_t bufsize, uint8_t id, bool is_confirmed, bool is_with_ack) {
-	if (appdata_fifo_full(fifo)) {
+void appdata_fifo_release(appdata_fifo_t *fifo) {
+	mutex_lock(&fifo->mutex);
+	fifo->head = APPDATA_FIFO_NO_HEAD;
+	mutex_unlock(&fifo->mutex);
+}
+
+bool appdata_fifo_push(appdata_fifo_t *fifo, uint8_t *buf, size_t bufsize, uint8_t id, bool is_confirmed, bool is_with_ack,
+					   uint8_t priority, int16_t key, uint32_t lifetime_ms) {
+	if (bufsize > APPDATA_FIFO_MAX_APPDATA_SIZE) {
 		return false;
 	}
 
-	int c = irq_disable();
+	mutex_lock(&fifo->mutex);
 
-	if (appdata_fifo_empty(fifo)) {
-		fifo->front = fifo->start = 0;
-	} else {
-		fifo->start = (fifo->start + 1) % APPDATA_FIFO_SIZE;
+	expire(fifo);
+
+	appdata_fifo_entry_t n = {
+		.size = bufsize,
+		.id = id,
+		.is_confirmed = is_confirmed,
+		.is_with_ack = is_with_ack,
+		.used = true,
+		.priority = priority,
+		.key = key,
+		.deadline = rtctimers_millis_now() + lifetime_ms,
+		.has_deadline = (lifetime_ms != 0),
+		.seq = fifo->seq++,
+	};
+	memcpy(n.data, buf, bufsize);
+
+	int idx = -1;
+
+	/* Newer data replaces the unsent one with the same key */
+	if (key != APPDATA_FIFO_NO_KEY) {
+		for (int i = 0; i < APPDATA_FIFO_SIZE; i++) {
+			appdata_fifo_entry_t *e = &fifo->fifo[i];
+
+			if (e->used && (i != fifo->head) && (e->key == key)) {
+				/* Replaced data keeps its place in the queue if it was more urgent */
+				if (e->priority > n.priority) {
+					n.priority = e->priority;
+				}
+				if (e->has_deadline && (!n.has_deadline || (int32_t) (e->deadline - n.deadline) < 0)) {
+					n.deadline = e->deadline;
+					n.has_deadline = true;
+				}
+
+				idx = i;
+				fifo->stats.replaced++;
+				break;
+			}
+		}
 	}
 
-	appdata_fifo_entry_t *e = &fifo->fifo[fifo->start];
-	memset(e, 0, sizeof(appdata_fifo_entry_t));
-	memcpy(e->data, buf, bufsize);
+	if ((idx < 0) && (fifo->num == APPDATA_FIFO_SIZE)) {
+		/* Least important entry gives way, unless it's more important than the new one */
+		int last = find(fifo, false);
+
+		if ((last < 0) || is_before(&fifo->fifo[last], &n)) {
+			fifo->stats.dropped++;
+
+			mutex_unlock(&fifo->mutex);
+			return false;
+		}
 
-	e->size = bufsize;
-	e->id = id;
+		remove_entry(fifo, last);
+		fifo->stats.dropped++;
+	}
+
+	if (idx < 0) {
+		for (idx = 0; fifo->fifo[idx].used; idx++) {}
+		fifo->num++;
+	}
 
-	e->is_confirmed = is_confirmed;
-	e->is_with_ack = is_with_ack;
+	fifo->fifo[idx] = n;
+	fifo->stats.pushed++;
 
-	irq_restore(c);
+	mutex_unlock(&fifo->mutex);
 
 	return true;
 }
 
 bool appdata_fifo_full(appdata_fifo_t *fifo) {
-	return ((fifo->start + 1) % APPDATA_FIFO_SIZE) == fifo->front;
+	return fifo->num == APPDATA_FIFO_SIZE;
 }
 
 bool appdata_fifo_empty(appdata_fifo_t *fifo) {
-	return (fifo->front == -1 && fifo->start == -1);
+	return fifo->num == 0;
 }
 
 int appdata_fifo_size(appdata_fifo_t *fifo) {
-	if (appdata_fifo_empty(fifo)) {
-		return 0;
-	}
+	return fifo->num;
+}
 
-	int size = fifo->start - fifo->front;
+void appdata_fifo_clear(appdata_fifo_t *fifo) {
+	mutex_lock(&fifo->mutex);
 
-	/* Front may be behind of start */
-	if (size < 0)
-		size = -size;
+	for (int i = 0; i < APPDATA_FIFO_SIZE; i++) {
+		fifo->fifo[i].used = false;
+	}
 
-	return size;
-}
+	fifo->num = 0;
+	fifo->head = APPDATA_FIFO_NO_HEAD;
 
-void appdata_fifo_clear(appdata_fifo_t *fifo) {
-	int c = irq_disable();
-	fifo->front = fifo->start = -1;
-	irq_restore(c);
+	mutex_unlock(&fifo->mutex);
 }
 
 
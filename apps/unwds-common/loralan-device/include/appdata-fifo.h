@@ -25,24 +25,50 @@
  * @brief       
  * @{
  * @file		appdata-fifo.h
- * @brief       Application data FIFO definitions
+ * @brief       Application data queue definitions
+ *
+ * Pending application data is sent in order of priority, then of deadline,
+ * then of arrival. Entry with a lifetime is dropped once it expires unsent.
+ * New entry with a key replaces the unsent entry with the same key, so only
+ * the latest update of e.g. a module reading waits for the network. The head
+ * entry, once chosen by appdata_fifo_peek(), stays at the head until popped
+ * or released, so the frame awaiting acknowledge is the one removed by it.
  * @author      Eugene Ponomarev [ep@unwds.com]
  */
 #ifndef APPDATA_FIFO_H_
 #define APPDATA_FIFO_H_
 
 #include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
 #include "mutex.h"
 
 /**
  * @brief Maximum application data payload size in bytes.
  */
-#define APPDATA_FIFO_MAX_APPDATA_SIZE 32
+#ifndef APPDATA_FIFO_MAX_APPDATA_SIZE
+#define APPDATA_FIFO_MAX_APPDATA_SIZE 128
+#endif
 
 /**
  * @brief Maximum number of entries to store in FIFO.
  */
-#define APPDATA_FIFO_SIZE 2
+#ifndef APPDATA_FIFO_SIZE
+#define APPDATA_FIFO_SIZE 4
+#endif
+
+#define APPDATA_FIFO_NO_HEAD (-1)	/**< Head entry is not chosen */
+#define APPDATA_FIFO_NO_KEY (-1)	/**< Entry is never replaced by newer data */
+
+/**
+ * @brief Priorities of application data
+ */
+enum {
+	APPDATA_PRIO_LOW = 0,
+	APPDATA_PRIO_NORMAL,
+	APPDATA_PRIO_HIGH,
+	APPDATA_PRIO_URGENT,
+};
 
 typedef struct {
 	uint8_t data[APPDATA_FIFO_MAX_APPDATA_SIZE];	/**< Application data */
@@ -51,27 +77,68 @@ typedef struct {
 
 	bool is_confirmed;								/**< Data requires confirmation */
 	bool is_with_ack;								/**< Implicit ACK to the app. data previously received */
+
+	bool used;										/**< Entry holds data */
+	uint8_t priority;								/**< Higher priority data is sent first */
+	int16_t key;									/**< Newer data with the same key replaces this one */
+	uint32_t deadline;								/**< Data expires at this time [ms], if has_deadline */
+	bool has_deadline;								/**< Data has limited lifetime */
+	uint32_t seq;									/**< Arrival order */
 } appdata_fifo_entry_t;
 
+/**
+ * @brief Application data queue statistics
+ */
+typedef struct {
+	uint32_t pushed;	/**< Entries queued */
+	uint32_t replaced;	/**< Unsent entries replaced by newer data with the same key */
+	uint32_t expired;	/**< Entries dropped unsent after their deadline */
+	uint32_t dropped;	/**< Entries dropped because the queue was full */
+} appdata_fifo_stats_t;
+
 /**
  * @brief describes the frame queue.
  */
 typedef struct {
 	appdata_fifo_entry_t fifo[APPDATA_FIFO_SIZE];	/**< Queue data */
 
-	int front;	/**< Pointer to the queue's front */
-	int start;	/**< Pointer to the queue's start */
+	int head;		/**< Entry being sent, APPDATA_FIFO_NO_HEAD if not chosen yet */
+	int num;		/**< Number of entries */
+	uint32_t seq;	/**< Arrival counter */
+
+	appdata_fifo_stats_t stats;	/**< Queue statistics */
 
 	mutex_t mutex; /**< FIFO's mutex */
 } appdata_fifo_t;
 
 void appdata_fifo_init(appdata_fifo_t *fifo);
 
+/**
+ * @brief Removes head entry, copying it to e if not NULL
+ */
 bool appdata_fifo_pop(appdata_fifo_t *fifo, appdata_fifo_entry_t *e);
 
+/**
+ * @brief Copies head entry to e, choosing the best entry for the head if there's none
+ */
 bool appdata_fifo_peek(appdata_fifo_t *fifo, appdata_fifo_entry_t *e);
 
-bool appdata_fifo_push(appdata_fifo_t *fifo, uint8_t *buf, size_t bufsize, uint8_t id, bool is_confirmed, bool is_with_ack);
+/**
+ * @brief Lets head entry compete with the others again, e.g. after it failed to be delivered
+ */
+void appdata_fifo_release(appdata_fifo_t *fifo);
+
+/**
+ * @brief Queues data, dropping expired entries first
+ *
+ * @param	[in]	priority	APPDATA_PRIO_*
+ * @param	[in]	key			key of the data or APPDATA_FIFO_NO_KEY
+ * @param	[in]	lifetime_ms	lifetime of the data, 0 if unlimited
+ *
+ * @return	false if the data doesn't fit or everything queued is more important
+ */
+bool appdata_fifo_push(appdata_fifo_t *fifo, uint8_t *buf, size_t bufsize, uint8_t id, bool is_confirmed, bool is_with_ack,
+					   uint8_t priority, int16_t key, uint32_t lifetime_ms);
 
 bool appdata_fifo_full(appdata_fifo_t *fifo);
 
@@ -78,6 +78,23 @@
  */
 #define LS_ED_SLEEP_REQUEST_DELAY 1
 
+/**
+ * @brief Priority of the timeouts thread.
+ *
+ * Below the radio and GNRC threads, the receive window timeouts do not have to preempt them.
+ * Set it to SCHED_EDF_PRIO to schedule the thread by deadline, along with other threads there.
+ */
+#ifndef LS_ED_TIM_PRIO
+#define LS_ED_TIM_PRIO (THREAD_PRIORITY_MAIN - 2)
+#endif
+
+/**
+ * @brief Time to handle a receive window timeout in microseconds, when the timeouts thread is scheduled by deadline
+ */
+#ifndef LS_ED_TIM_DEADLINE_US
+#define LS_ED_TIM_DEADLINE_US (20000)
+#endif
+
 // TODO: optimize these values to reduce memory consumption
 #if defined (UNWDS_BUILD_MINIMAL)
     #define LS_UQ_HANDLER_STACKSIZE			(1536)
@@ -98,6 +115,15 @@ typedef enum {
 	LS_ED_APPDATA_ACK_EXPIRED,
 } ls_ed_tim_cmd_t;
 
+/**
+ * @brief Commands of the uplink queue thread, the only one which removes frames from the queue.
+ */
+typedef enum {
+	LS_ED_UQ_TX = 0,		/**< Transmit the frame at the head of the queue */
+	LS_ED_UQ_ACKED,			/**< Remove the confirmed frame at the head of the queue */
+	LS_ED_UQ_CLEAR,			/**< Remove all frames, the sender waits for the reply */
+} ls_ed_uq_cmd_t;
+
 /**
  * @brief LoRa-Star stack status.
  */
@@ -136,6 +162,15 @@ typedef enum {
 	LS_ED_NOTIFY			/**< Notify application if link check is failed */
 } ls_ed_lnkchk_action_t;
 
+/**
+ * @brief Queueing options of confirmed application data
+ */
+typedef struct {
+	uint8_t priority;		/**< APPDATA_PRIO_*, higher priority data is sent first */
+	int16_t key;			/**< Queued unsent data with the same key is replaced, APPDATA_FIFO_NO_KEY to keep it */
+	uint32_t lifetime_ms;	/**< Data not sent within this time is dropped, 0 to keep it until sent */
+} ls_ed_appdata_opts_t;
+
 /**
  * @brief LoRa-Star stack settings.
  *
@@ -153,6 +188,7 @@ typedef struct {
 	ls_node_class_t class;						/**< Device class */
 	uint8_t max_retr;							/**< Maximum number of retransmissions */
 	bool no_join;								/**< Statically personalized device, no join required */
+	bool adr;									/**< Follow data rate and TX power commanded by the gate */
     bool auto_shutdown;
     bool confirmation;
 } ls_ed_settings_t;
@@ -189,6 +225,10 @@ typedef struct {
 	/* Device is joined to the network */
 	bool is_joined;
 
+	/* Session keys with expanded AES key, filled from settings.crypto on first use */
+	ls_session_keys_t session_keys;
+	bool session_keys_valid;
+
 	/* Join request expiration timer */
 	rtctimers_millis_t join_req_expired;
 
@@ -205,11 +245,15 @@ typedef struct {
      * Blocking sending of other frames from queue until current frame is confirmed */
 	bool confirmation_required;
 
-	/* Current frame to send (to reduce stack consumption) */
-	ls_frame_t current_frame;
-	mutex_t curr_frame_mutex; /**< Mutex on current frame */
+	mutex_t curr_frame_mutex; /**< Mutex on frame assembly and sending */
 
 	int16_t last_rssi;		  /**< RSSI value of the last frame received */
+
+	/* Link settings commanded by the gate, used instead of the configured ones until the link is lost */
+	bool adr_active;
+	ls_datarate_t adr_dr;
+	ls_channel_t adr_channel;
+	int8_t adr_tx_power;
     
     bool last_cad_success;     /**< last Channel Activity Detection result */
     
@@ -250,6 +294,12 @@ void ls_ed_poweroff(ls_ed_t *ls);
 
 int ls_ed_send_app_data(ls_ed_t *ls, uint8_t *buf, size_t buflen, bool confirmed, bool with_ack, bool delayed);
 
+/**
+ * @brief Sends application data with the priority, replacement key and lifetime in the queue of pending data
+ */
+int ls_ed_send_app_data_opts(ls_ed_t *ls, uint8_t *buf, size_t buflen, bool confirmed, bool with_ack,
+                             const ls_ed_appdata_opts_t *opts);
+
 int ls_ed_join(ls_ed_t *ls);
 
 void ls_ed_unjoin(ls_ed_t *ls);
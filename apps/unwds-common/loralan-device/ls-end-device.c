@@ -48,6 +48,10 @@ extern "C" {
 #include "board.h"
 #include "rtctimers-millis.h"
 
+#ifdef MODULE_SCHED_EDF
+#include "sched_edf.h"
+#endif
+
 #define ENABLE_DEBUG    (0)
 #include "debug.h"
 
@@ -63,16 +67,84 @@ static msg_t msg_rx2;
 static msg_t msg_join_timeout;
 static msg_t msg_ack_timeout;
 
+/**
+ * @brief Returns session keys, expanding AES key only once per session
+ */
+static const ls_session_keys_t *session_keys(ls_ed_t *ls)
+{
+    if (!ls->_internal.session_keys_valid) {
+        ls_session_keys_set(&ls->_internal.session_keys, ls->settings.crypto.mic_key, ls->settings.crypto.aes_key);
+        ls->_internal.session_keys_valid = true;
+    }
+
+    return &ls->_internal.session_keys;
+}
+
 static void configure_sx127x(ls_ed_t *ls)
 {
     ls_datarate_t dr = (!ls->_internal.use_rx_window_2_settings) ? ls->settings.dr : LS_RX2_DR;
     ls_channel_t ch = (!ls->_internal.use_rx_window_2_settings) ? ls->settings.channel : LS_RX2_CH;
+    bool adr = ls->_internal.adr_active && !ls->_internal.use_rx_window_2_settings;
+
+    if (adr) {
+        dr = ls->_internal.adr_dr;
+        ch = ls->_internal.adr_channel;
+    }
     
     ls_setup_sx127x(ls->_internal.device, dr, ls->settings.channels_table[ch]);
+
+    if (adr) {
+        int16_t power = ls->_internal.adr_tx_power;
+        ls->_internal.device->driver->set(ls->_internal.device, NETOPT_TX_POWER, &power, sizeof(int16_t));
+    }
     
     DEBUG("[LoRa] SX127X configured\n");
 }
 
+/**
+ * @brief Switches to the data rate, channel and TX power commanded by the gate
+ */
+static void adr_recv(ls_ed_t *ls, ls_frame_t *frame)
+{
+    if (!ls->settings.adr) {
+        DEBUG("[LoRa] ADR disabled\n");
+        return;
+    }
+
+    if (frame->payload.len != sizeof(ls_adr_req_t)) {
+        DEBUG("[LoRa] incorrect payload length\n");
+        return;
+    }
+
+    ls_adr_req_t req;
+    memcpy(&req, frame->payload.data, sizeof(ls_adr_req_t));
+
+    if (req.dr > LS_DR6) {
+        DEBUG("[LoRa] unknown data rate\n");
+        return;
+    }
+
+    /* Gate names the channel by its frequency */
+    size_t ch;
+    for (ch = 0; ch < ls->settings.channels_table_size; ch++) {
+        if (ls->settings.channels_table[ch] == req.frequency) {
+            break;
+        }
+    }
+
+    if (ch == ls->settings.channels_table_size) {
+        DEBUG("[LoRa] unknown channel frequency\n");
+        return;
+    }
+
+    ls->_internal.adr_dr = (ls_datarate_t) req.dr;
+    ls->_internal.adr_channel = ch;
+    ls->_internal.adr_tx_power = req.tx_power;
+    ls->_internal.adr_active = true;
+
+    printf("[LoRa] ADR: DR%d, channel %d, %d dBm\n", req.dr, (int) ch, req.tx_power);
+}
+
 static void anticollision_delay(void) {
 	/* Pseudorandom delay up to 8 seconds for collision avoidance */
 	unsigned int delay = random_uint32_range(1000, 8000);
@@ -111,6 +183,7 @@ static inline void schedule_tx(ls_ed_t *ls)
     
     /* Send message to the frame queue thread to initiate frame transmission */
     DEBUG("[LoRa] sending message to uplink queue\n");
+    msg.content.value = LS_ED_UQ_TX;
     msg_try_send(&msg, ls->_internal.uq_thread_pid);
 }
 
@@ -185,23 +258,21 @@ static int send_frame(ls_ed_t *ls, ls_type_t type, uint8_t *buf, size_t buflen)
 
     mutex_lock(&ls->_internal.curr_frame_mutex);
 
-    ls_frame_t *frame = &ls->_internal.current_frame;
+    /* Assemble frame right in the uplink queue slot. The queue head may be
+     * awaiting confirmation in the other thread, so it is never evicted here */
+    ls_frame_t *frame = ls_frame_fifo_reserve(&ls->_internal.uplink_queue);
+    if (frame == NULL) {
+    	mutex_unlock(&ls->_internal.curr_frame_mutex);
+        DEBUG("[LoRa] uplink queue is full\n");
+        return -LS_SEND_E_FQ_OVERFLOW;
+    }
+
     ls_assemble_frame(ls->_internal.dev_addr, type, buf, buflen, frame);
 
     frame->header.fid = ls->_internal.last_fid;
     frame->header.status = get_node_status();
 
-    /* Enqueue frame */
-    if (ls_frame_fifo_full(&ls->_internal.uplink_queue)) {
-        DEBUG("[LoRa] remove oldest frame from queue\n");
-        ls_frame_fifo_pop(&ls->_internal.uplink_queue, NULL);
-    }
-    
-    if (!ls_frame_fifo_push(&ls->_internal.uplink_queue, frame)) {
-    	mutex_unlock(&ls->_internal.curr_frame_mutex);
-        DEBUG("[LoRa] FIFO error\n");
-        return -LS_SEND_E_FIFO_ERROR;
-    }
+    ls_frame_fifo_commit(&ls->_internal.uplink_queue);
 
     send_next(ls);
 
@@ -238,8 +309,9 @@ static bool ack_recv(ls_ed_t *ls, ls_frame_t  *frame) {
     	return false;
     }
 
-	/* Pop frame from uplink queue */
-	ls_frame_fifo_pop(&ls->_internal.uplink_queue, NULL);
+	/* Pop frame from uplink queue, it's done by the queue thread before it transmits the next one */
+	msg_t msg = { .content.value = LS_ED_UQ_ACKED };
+	msg_send(&msg, ls->_internal.uq_thread_pid);
 
 	/* Advance frame ID */
 	ls->_internal.last_fid++;
@@ -255,7 +327,7 @@ static bool ack_recv(ls_ed_t *ls, ls_frame_t  *frame) {
 	rtctimers_millis_remove(&ls->_internal.conf_ack_expired);
 
 	/* Close RX window only if we haven't pending frames (regular app. data acknowledge received) */
-	bool close_rx_window = frame->header.type == LS_DL_ACK;
+	bool close_rx_window = (frame->header.type == LS_DL_ACK) || (frame->header.type == LS_DL_ADR_REQ);
 	return close_rx_window;
 }
 
@@ -306,6 +378,9 @@ static bool frame_recv(ls_ed_t *ls, ls_frame_t *frame)
         case LS_DL_TIME_ACK:
             snprintf(debug_frame_type, 20, "LS_DL_TIME_ACK");
             break;
+        case LS_DL_ADR_REQ:
+            snprintf(debug_frame_type, 20, "LS_DL_ADR_REQ");
+            break;
         default:
             snprintf(debug_frame_type, 20, "UNKNOWN");
             break;
@@ -316,7 +391,8 @@ static bool frame_recv(ls_ed_t *ls, ls_frame_t *frame)
     if ((frame->header.type == LS_DL_ACK_W_DATA) ||
         (frame->header.type == LS_DL_ACK) ||
         (frame->header.type == LS_DL) || 
-        (frame->header.type == LS_DL_TIME_ACK)) {
+        (frame->header.type == LS_DL_TIME_ACK) ||
+        (frame->header.type == LS_DL_ADR_REQ)) {
         if (!ls->settings.no_join && !ls->_internal.is_joined) {
             DEBUG("[LoRa] not joined\n");
             return false;
@@ -365,7 +441,7 @@ static bool frame_recv(ls_ed_t *ls, ls_frame_t *frame)
             }
 
             DEBUG("[LoRa] decrypting payload\n");
-            ls_decrypt_frame_payload(ls->settings.crypto.aes_key, frame);
+            ls_session_crypt_payload(session_keys(ls), frame);
 
             bool close_rx_window = ack_recv(ls, frame);
             data_recv(ls, frame);
@@ -385,10 +461,25 @@ static bool frame_recv(ls_ed_t *ls, ls_frame_t *frame)
 
             return ack_recv(ls, frame);
 
+        case LS_DL_ADR_REQ:                         /* Acknowledge with new link settings */
+            DEBUG("[LoRa] ack with ADR request received\n");
+
+            if (!appdata_fifo_empty(&ls->_internal.appdata_fifo)) {
+                DEBUG("[LoRa] remove FIFO entry\n");
+                appdata_fifo_pop(&ls->_internal.appdata_fifo, NULL);
+            }
+
+            DEBUG("[LoRa] decrypting payload\n");
+            ls_session_crypt_payload(session_keys(ls), frame);
+
+            adr_recv(ls, frame);
+
+            return ack_recv(ls, frame);
+
         case LS_DL:         /* Downlink frame */
             DEBUG("[LoRa] donwlink frame received\n");
             DEBUG("[LoRa] decrypting payload\n");
-            ls_decrypt_frame_payload(ls->settings.crypto.aes_key, frame);
+            ls_session_crypt_payload(session_keys(ls), frame);
 
             data_recv(ls, frame);
             return true;
@@ -423,6 +514,7 @@ static bool frame_recv(ls_ed_t *ls, ls_frame_t *frame)
 
             /* This join ack for us, derive encryption keys and save */
             ls_derive_keys(ls->_internal.last_nonce, ack.app_nonce, ack.addr, ls->settings.crypto.mic_key, ls->settings.crypto.aes_key);
+            ls->_internal.session_keys_valid = false;
 
             /* Remove timeout timer */
             DEBUG("[LoRa] remove join timeout timer\n");
@@ -502,7 +594,7 @@ static bool frame_recv(ls_ed_t *ls, ls_frame_t *frame)
         }
         
         case LS_DL_TIME_ACK: {
-            ls_decrypt_frame_payload(ls->settings.crypto.aes_key, frame);
+            ls_session_crypt_payload(session_keys(ls), frame);
 
             ls_time_req_ack_t ack;
             memcpy(&ack, frame->payload.data, sizeof(ls_time_req_ack_t));
@@ -716,22 +808,33 @@ static void *uq_handler(void *arg)
     while (1) {
         msg_receive(&msg);
         DEBUG("[LoRa] message received\n");
+
+        /* Frames are removed from the queue by this thread only */
+        switch ((ls_ed_uq_cmd_t) msg.content.value) {
+            case LS_ED_UQ_ACKED:
+                ls_frame_fifo_pop(&ls->_internal.uplink_queue, NULL);
+                continue;
+
+            case LS_ED_UQ_CLEAR:
+                ls_frame_fifo_clear(&ls->_internal.uplink_queue);
+                msg_reply(&msg, &msg);
+                continue;
+
+            default:
+                break;
+        }
         
-        if (ls_frame_fifo_empty(&ls->_internal.uplink_queue)) {
+        /* Get frame from queue top */
+        ls_frame_t *head = ls_frame_fifo_peek(&ls->_internal.uplink_queue);
+        if (head == NULL) {
             ls->state = LS_ED_IDLE;
             DEBUG("[LoRa] FIFO is empty\n");
             continue;
         }
 
-        /* Get frame from queue top */
-        ls_frame_t *f;
-        ls_frame_t frame;
-        if (!ls_frame_fifo_peek(&ls->_internal.uplink_queue, &frame)) {
-            DEBUG("[LoRa] error getting frame from FIFO\n");
-            continue;
-        }
-
-        f = &frame;
+        /* Frame is encrypted in a copy, the plain one stays queued for retransmission */
+        ls_frame_t frame = *head;
+        ls_frame_t *f = &frame;
 
         ls->_internal.confirmation_required = (f->header.type == LS_UL_CONF);
 
@@ -766,7 +869,7 @@ static void *uq_handler(void *arg)
         /* Apply cryptography procedures */
         if (f->header.type != LS_UL_JOIN_REQ) {
             DEBUG("[LoRa] encrypt regular frame\n");
-            ls_encrypt_frame(ls->settings.crypto.mic_key, ls->settings.crypto.aes_key, f, &payload_size);
+            ls_session_encrypt_frame(session_keys(ls), f, &payload_size);
         }
         else {
             DEBUG("[LoRa] encrypt join request\n");
@@ -875,6 +978,11 @@ static void *tim_handler(void *arg)
     msg_init_queue(ls->_internal.tim_msg_queue, sizeof(ls->_internal.tim_msg_queue));
     msg_t msg;
 
+#ifdef MODULE_SCHED_EDF
+    /* Takes effect when LS_ED_TIM_PRIO is SCHED_EDF_PRIO: runs before threads there with later or no deadlines */
+    sched_edf_set_deadline(thread_getpid(), LS_ED_TIM_DEADLINE_US);
+#endif
+
     while (1) {
         msg_receive(&msg);
 
@@ -962,6 +1070,15 @@ static void *tim_handler(void *arg)
                     DEBUG("[LoRa] stop retransmitting\n");
                     ls->_internal.num_retr = 0;
 
+                    /* Gate may not hear us with the commanded settings, get back to the configured ones */
+                    if (ls->_internal.adr_active) {
+                        puts("[LoRa] ADR: link lost, back to the default settings");
+                        ls->_internal.adr_active = false;
+                    }
+
+                    /* Undelivered data competes with newer data again */
+                    appdata_fifo_release(&ls->_internal.appdata_fifo);
+
                     if (ls->appdata_send_failed_cb != NULL) {
                         ls->appdata_send_failed_cb();
                     }
@@ -987,7 +1104,7 @@ static bool create_tim_handler_thread(ls_ed_t *ls)
 {
     DEBUG("[LoRa] creating LS timeouts thread\n");
 
-    kernel_pid_t pid_tim = thread_create(ls->_internal.tim_thread_stack, sizeof(ls->_internal.tim_thread_stack), THREAD_PRIORITY_MAIN - 2,
+    kernel_pid_t pid_tim = thread_create(ls->_internal.tim_thread_stack, sizeof(ls->_internal.tim_thread_stack), LS_ED_TIM_PRIO,
                                          THREAD_CREATE_STACKTEST, tim_handler, ls,
                                          "LS timeouts thread");
 
@@ -1011,6 +1128,8 @@ int ls_ed_init(ls_ed_t *ls)
     ls->_internal.last_fid = 0;
     ls->_internal.num_retr = 0;
     ls->_internal.is_joined = false;
+    ls->_internal.session_keys_valid = false;
+    ls->_internal.adr_active = false;
 
     if (!ls->settings.no_join) {
     	ls->_internal.dev_addr = LS_ADDR_UNDEFINED;
@@ -1064,11 +1183,14 @@ void ls_ed_poweroff(ls_ed_t *ls) {
     ls->_internal.device->driver->set(ls->_internal.device, NETOPT_STATE, &state, sizeof(uint8_t));
 }
 
-int ls_ed_send_app_data(ls_ed_t *ls, uint8_t *buf, size_t buflen, bool confirmed, bool with_ack, bool delayed)
+static int send_app_data(ls_ed_t *ls, uint8_t *buf, size_t buflen, bool confirmed, bool with_ack, bool delayed,
+                         const ls_ed_appdata_opts_t *opts)
 {
     assert(ls != NULL);
     assert(buf != NULL);
 
+    appdata_fifo_entry_t e;
+    bool queued = true;
     
     /* Store current app. data in FIFO buffer
      * Data will be removed on receiving ACK from gate */
@@ -1076,12 +1198,12 @@ int ls_ed_send_app_data(ls_ed_t *ls, uint8_t *buf, size_t buflen, bool confirmed
         DEBUG("[LoRa] pushing data to FIFO\n");
         appdata_fifo_t *fifo = &ls->_internal.appdata_fifo;
 
-        /* Last data has priority, so we can pop oldest item from the queue if it's full */
-        if (appdata_fifo_full(fifo)) {
-            appdata_fifo_pop(fifo, NULL);
+        /* Less important data gives way if the queue is full */
+        queued = appdata_fifo_push(fifo, buf, buflen, ls->_internal.last_fid, confirmed, with_ack,
+                                   opts->priority, opts->key, opts->lifetime_ms);
+        if (!queued) {
+            DEBUG("[LoRa] data dropped, queue is full of more important data\n");
         }
-
-        appdata_fifo_push(fifo, buf, buflen, ls->_internal.last_fid, confirmed, with_ack);
         
         /* Not joined to the network, delay appdata frame until device is joined */
         if (!ls->settings.no_join && !ls->_internal.is_joined) {
@@ -1089,17 +1211,16 @@ int ls_ed_send_app_data(ls_ed_t *ls, uint8_t *buf, size_t buflen, bool confirmed
             return -LS_SEND_E_NOT_JOINED;
         }
         
-        if (appdata_fifo_size(fifo) > 1) {
-            DEBUG("[LoRa] FIFO is not empty, postpone new data\n");
-            
-            appdata_fifo_entry_t e;
-            appdata_fifo_peek(fifo, &e);
-            DEBUG("[LoRa] send oldest data instead [fid: %d, size: %d]\n", e.id, e.size);
-            buf = e.data;
-            buflen = e.size;
-            confirmed = e.is_confirmed;
-            with_ack = e.is_with_ack;
+        /* Data awaiting acknowledge or more important data goes first */
+        if (!appdata_fifo_peek(fifo, &e)) {
+            return -LS_SEND_E_FIFO_ERROR;
         }
+
+        DEBUG("[LoRa] sending queued data [fid: %d, size: %d]\n", e.id, e.size);
+        buf = e.data;
+        buflen = e.size;
+        confirmed = e.is_confirmed;
+        with_ack = e.is_with_ack;
     }
 
     ls->_internal.confirmation_required = false;
@@ -1119,7 +1240,26 @@ int ls_ed_send_app_data(ls_ed_t *ls, uint8_t *buf, size_t buflen, bool confirmed
         return res;
     }
 
-    return LS_OK;
+    return (queued) ? LS_OK : -LS_SEND_E_FIFO_ERROR;
+}
+
+int ls_ed_send_app_data(ls_ed_t *ls, uint8_t *buf, size_t buflen, bool confirmed, bool with_ack, bool delayed)
+{
+    const ls_ed_appdata_opts_t opts = {
+        .priority = APPDATA_PRIO_NORMAL,
+        .key = APPDATA_FIFO_NO_KEY,
+        .lifetime_ms = 0,
+    };
+
+    return send_app_data(ls, buf, buflen, confirmed, with_ack, delayed, &opts);
+}
+
+int ls_ed_send_app_data_opts(ls_ed_t *ls, uint8_t *buf, size_t buflen, bool confirmed, bool with_ack,
+                             const ls_ed_appdata_opts_t *opts)
+{
+    assert(opts != NULL);
+
+    return send_app_data(ls, buf, buflen, confirmed, with_ack, false, opts);
 }
 
 void ls_ed_unjoin(ls_ed_t *ls)
@@ -1131,8 +1271,15 @@ void ls_ed_unjoin(ls_ed_t *ls)
 		return;
     }
 
-    /* Clear uplink queue */
-    ls_frame_fifo_clear(&ls->_internal.uplink_queue);
+    /* Clear uplink queue in the queue thread, as it may be taking the head frame right now */
+    if ((ls->_internal.uq_thread_pid == KERNEL_PID_UNDEF) ||
+        (ls->_internal.uq_thread_pid == thread_getpid())) {
+        ls_frame_fifo_clear(&ls->_internal.uplink_queue);
+    }
+    else {
+        msg_t msg = { .content.value = LS_ED_UQ_CLEAR };
+        msg_send_receive(&msg, &msg, ls->_internal.uq_thread_pid);
+    }
     ls->_internal.confirmation_required = false;
 
 	/* Stop timers */
@@ -1147,9 +1294,13 @@ void ls_ed_unjoin(ls_ed_t *ls)
     /* Forget session cryptographic keys */
     memset(ls->settings.crypto.aes_key, 0, AES_KEY_SIZE);
     memset(ls->settings.crypto.mic_key, 0, AES_KEY_SIZE);
+    ls->_internal.session_keys_valid = false;
 
     /* Mark as not joined */
     ls->_internal.is_joined = false;
+
+    /* New session starts with the configured link settings */
+    ls->_internal.adr_active = false;
     
     DEBUG("[LoRa] node unjoined\n");
 }
@@ -1166,25 +1317,31 @@ int ls_ed_join(ls_ed_t *ls)
     ls_ed_unjoin(ls);
 
     /* Compose a join request */
-    ls_join_req_t req;
-    req.app_id = ls->settings.app_id;
-    req.dev_id = ls->settings.node_id;
+    ls_join_req_caps_t req;
+    memset(&req, 0, sizeof(ls_join_req_caps_t));
+    req.req.app_id = ls->settings.app_id;
+    req.req.dev_id = ls->settings.node_id;
 
-    req.node_class = ls->settings.class;
+    req.req.node_class = ls->settings.class;
+
+    /* Gate sends new link settings only to the nodes which follow them */
+    if (ls->settings.adr) {
+        req.caps |= LS_JOIN_CAP_ADR;
+    }
     
     /* nonce must not be 0 */
     do {
-        req.dev_nonce = sx127x_random((sx127x_t *)ls->_internal.device);
-    } while (req.dev_nonce == 0);
+        req.req.dev_nonce = sx127x_random((sx127x_t *)ls->_internal.device);
+    } while (req.req.dev_nonce == 0);
 
-    ls->_internal.last_nonce = req.dev_nonce;
+    ls->_internal.last_nonce = req.req.dev_nonce;
 
     /* Reset frame ID */
     ls->_internal.last_fid = 0;
 
     /* Send request */
     DEBUG("[LoRa] send join request\n");
-    send_frame(ls, LS_UL_JOIN_REQ, (uint8_t *) &req, sizeof(ls_join_req_t));
+    send_frame(ls, LS_UL_JOIN_REQ, (uint8_t *) &req, sizeof(ls_join_req_caps_t));
 
     /* Launch timeout timer */
     DEBUG("[LoRa] set join timeout timer\n");
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2016-2018 Unwired Devices LLC <info@unwds.com>
+
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @defgroup    
+ * @ingroup     
+ * @brief       
+ * @{
+ * @file		ls-gate-adr.h
+ * @brief       Adaptive data rate engine of the gate
+ *
+ * Gate keeps SNR of the last uplinks of every node and the time they took on
+ * air. Once the history is full, the link margin over the demodulation floor
+ * of the node's data rate is converted into steps: each spare step moves the
+ * node to a faster data rate served by the gate or lowers its TX power,
+ * each missing step does the opposite. New settings are sent to the node
+ * in place of the acknowledge of a confirmed uplink.
+ */
+#ifndef LS_GATE_ADR_H_
+#define LS_GATE_ADR_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "ls-mac-types.h"
+
+/**
+ * @brief Number of uplinks the decision is based upon
+ */
+#ifndef LS_GATE_ADR_HISTORY
+#define LS_GATE_ADR_HISTORY		(8)
+#endif
+
+/**
+ * @brief Installation margin kept above the demodulation floor [dB]
+ */
+#ifndef LS_GATE_ADR_MARGIN_DB
+#define LS_GATE_ADR_MARGIN_DB	(10)
+#endif
+
+/**
+ * @brief Link budget of one step, also the TX power step [dB]
+ */
+#define LS_GATE_ADR_STEP_DB		(3)
+
+/**
+ * @brief Range of the TX power commanded to the nodes [dBm]
+ */
+#ifndef LS_GATE_ADR_MAX_POWER
+#define LS_GATE_ADR_MAX_POWER	(14)
+#endif
+#ifndef LS_GATE_ADR_MIN_POWER
+#define LS_GATE_ADR_MIN_POWER	(2)
+#endif
+
+/**
+ * @brief Link state of a node as seen by the gate
+ */
+typedef struct __attribute__((__packed__)) {
+	int8_t snr[LS_GATE_ADR_HISTORY];	/**< SNR of the last uplinks [dB] */
+	uint8_t num_snr;					/**< Number of valid entries in the history */
+	uint8_t snr_pos;					/**< Next history entry to write */
+	int16_t last_rssi;					/**< RSSI of the last uplink [dBm] */
+	ls_datarate_t dr;					/**< Data rate of the last uplink */
+	int8_t tx_power;					/**< TX power the node is believed to use [dBm] */
+	uint32_t uplinks;					/**< Uplinks received in the session */
+	uint32_t airtime_ms;				/**< Time on air of these uplinks [ms] */
+	uint32_t adr_commands;				/**< Number of settings changes sent */
+} ls_gate_link_t;
+
+/**
+ * @brief Clears history, node is expected to use its default settings
+ */
+void ls_gate_adr_reset(ls_gate_link_t *link, ls_datarate_t dr);
+
+/**
+ * @brief Accounts uplink of len bytes received at the data rate with given SNR and RSSI
+ */
+void ls_gate_adr_update(ls_gate_link_t *link, ls_datarate_t dr, int8_t snr, int16_t rssi, size_t len);
+
+/**
+ * @brief Returns number of LS_GATE_ADR_STEP_DB steps the link could be tightened by (negative to loosen),
+ *        0 until the history is full
+ */
+int ls_gate_adr_steps(const ls_gate_link_t *link);
+
+/**
+ * @brief Applies commanded settings, history is restarted as the link changes
+ */
+void ls_gate_adr_commanded(ls_gate_link_t *link, ls_datarate_t dr, int8_t tx_power);
+
+#endif /* LS_GATE_ADR_H_ */
@@ -35,11 +35,15 @@
 #include <stdbool.h>
 
 #include "mutex.h"
+#ifdef MODULE_CORE_PI_MUTEX
+#include "pi_mutex.h"
+#endif
 
 #include "ls-crypto.h"
 #include "ls-mac-types.h"
 
 #include "ls-frame-fifo.h"
+#include "ls-gate-adr.h"
 
 /**
  * Max device number that gate can hold simultaneously and nonce counts per device to remember
@@ -47,13 +51,42 @@
  */
 
 #if defined(CPU_FAM_STM32L4)
+    #ifndef LS_GATE_MAX_NODES
     #define LS_GATE_MAX_NODES 1000
+    #endif
+    #ifndef LS_GATE_NONCES_PER_DEVICE
     #define LS_GATE_NONCES_PER_DEVICE 20
+    #endif
+    #ifndef LS_GATE_HASH_BITS
+    #define LS_GATE_HASH_BITS 11
+    #endif
 #else
+    #ifndef LS_GATE_MAX_NODES
     #define LS_GATE_MAX_NODES 100
+    #endif
+    #ifndef LS_GATE_NONCES_PER_DEVICE
     #define LS_GATE_NONCES_PER_DEVICE 8
+    #endif
+    #ifndef LS_GATE_HASH_BITS
+    #define LS_GATE_HASH_BITS 8
+    #endif
+#endif
+
+/**
+ * Size of the node ID hash index, must be larger than LS_GATE_MAX_NODES.
+ * Keeping it at least twice as large keeps probe sequences short.
+ */
+#define LS_GATE_HASH_SIZE (1UL << LS_GATE_HASH_BITS)
+
+#if (LS_GATE_HASH_SIZE <= LS_GATE_MAX_NODES) || (LS_GATE_MAX_NODES >= 0xFFFF)
+#error "ls-gate-device-list: LS_GATE_HASH_BITS too small or LS_GATE_MAX_NODES too large"
 #endif
 
+/**
+ * Empty cell of the node ID hash index
+ */
+#define LS_GATE_HASH_EMPTY 0
+
 typedef struct __attribute__((__packed__)){
     uint64_t node_id;			/**< Node unique ID */
 	uint64_t app_id;			/**< Application unique ID */    
@@ -65,16 +98,28 @@ typedef struct __attribute__((__packed__)){
 	ls_node_class_t node_class;	/**< Node's class */
     ls_device_status_t status;	/**< Last received device status */
 	ls_frame_id_t last_fid;		/**< Last received frame ID */
+	uint64_t nonce_bloom;		/**< Bloom filter over remembered nonces */
 	uint8_t num_nonces;			/**< Number of remembered nonces  */
 	uint8_t num_pending;		/**< Number of frames pending */
 	bool is_static;				/**< Statically personalized device, won't be kicked for idle */
+	bool adr;					/**< Node advertised ADR support when joined */
+	ls_gate_link_t link;		/**< Link quality history and airtime statistics */
 } ls_gate_node_t;
 
 typedef struct {
 	ls_gate_node_t nodes[LS_GATE_MAX_NODES];
 	bool nodes_free_list[LS_GATE_MAX_NODES];
+	uint16_t free_next[LS_GATE_MAX_NODES];	/**< Free cells queue links, hold cell address + 1 */
+	uint16_t free_prev[LS_GATE_MAX_NODES];
+	uint16_t free_head;		/**< Free cell to be taken next + 1, 0 if none */
+	uint16_t free_tail;		/**< Last freed cell + 1 */
+	uint16_t index[LS_GATE_HASH_SIZE];	/**< Node ID hash index, holds node address + 1 */
     size_t num_nodes;
+#ifdef MODULE_CORE_PI_MUTEX
+    pi_mutex_t mutex;	/**< Radio and UART threads contend for it, holder inherits the priority */
+#else
     mutex_t mutex;
+#endif
 } ls_gate_devices_t;
 
 void ls_devlist_init(ls_gate_devices_t *devlist);
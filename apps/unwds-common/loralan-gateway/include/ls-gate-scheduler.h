@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2016-2018 Unwired Devices LLC <info@unwds.com>
+
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @defgroup    
+ * @ingroup     
+ * @brief       
+ * @{
+ * @file		ls-gate-scheduler.h
+ * @brief       Per-channel radio scheduler of the gate
+ *
+ * Every channel is driven by its own thread which handles transceiver events,
+ * plans transmissions of queued frames and keeps receive windows and
+ * duty-cycle off-time of the channel, so transceivers work independently
+ * of each other. Frames contents are handled by the gate through callbacks.
+ */
+#ifndef LS_GATE_SCHEDULER_H_
+#define LS_GATE_SCHEDULER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "thread.h"
+#include "xtimer.h"
+#include "net/netdev.h"
+#include "sx127x_netdev.h"
+
+#include "ls-frame-fifo.h"
+
+#ifndef LS_SCHED_STACKSIZE
+#define LS_SCHED_STACKSIZE		(2 * THREAD_STACKSIZE_DEFAULT)
+#endif
+
+#define LS_SCHED_MSG_QUEUE_SIZE	(8)
+
+#ifndef LS_SCHED_TX_ATTEMPTS
+#define LS_SCHED_TX_ATTEMPTS	(3)			/**< Attempts to hand a frame to a busy transceiver */
+#endif
+
+#ifndef LS_SCHED_TX_RETRY_DELAY
+#define LS_SCHED_TX_RETRY_DELAY	(10000U)	/**< Delay before the next attempt [us] */
+#endif
+
+typedef enum {
+	LS_GATE_CHANNEL_STATE_IDLE = 0,		/**< Listening, free to transmit */
+	LS_GATE_CHANNEL_STATE_RX,			/**< Receiving a frame or receive window is open */
+	LS_GATE_CHANNEL_STATE_TX,			/**< Transmitting */
+} ls_channel_state_t;
+
+/**
+ * @brief Channel callbacks, called from the channel thread
+ */
+typedef struct {
+	/** Configures transceiver for the channel, called before every TX and RX */
+	void (*setup)(void *arg);
+
+	/** Encrypts frame for sending in place, returns frame length or negative value to drop it */
+	int (*prepare)(void *arg, ls_frame_t *frame);
+
+	/** Handles received packet */
+	void (*recv)(void *arg, uint8_t *buf, size_t len, netdev_sx127x_lora_packet_info_t *info);
+} ls_sched_cb_t;
+
+/**
+ * @brief Channel scheduler parameters
+ */
+typedef struct {
+	netdev_t *device;			/**< Transceiver of the channel */
+	ls_frame_fifo_t *fifo;		/**< Queue of frames to send */
+
+	const ls_sched_cb_t *cb;	/**< Callbacks */
+	void *arg;					/**< Callbacks argument */
+
+	uint32_t rx1_length;		/**< Length of the receive window after TX, no TX is done in it [us] */
+	uint8_t duty_cycle;			/**< Max. share of time on air [%], 0 if not limited */
+} ls_sched_params_t;
+
+/**
+ * @brief Channel scheduler statistics
+ */
+typedef struct {
+	uint32_t tx_frames;			/**< Frames sent */
+	uint32_t tx_errors;			/**< Frames transceiver failed to send */
+	uint32_t tx_deferred;		/**< Transmissions postponed by the duty-cycle limit */
+	uint32_t rx_frames;			/**< Packets received */
+	uint32_t rx_errors;			/**< Packets with CRC errors */
+	uint32_t airtime_ms;		/**< Total time on air */
+} ls_sched_stats_t;
+
+/**
+ * @brief Channel scheduler state
+ */
+typedef struct {
+	ls_sched_params_t p;					/**< Parameters */
+
+	volatile ls_channel_state_t state;		/**< State of the channel */
+
+	uint32_t tx_start;						/**< Start of the current transmission [us] */
+	uint64_t tx_allowed;					/**< End of the duty-cycle off-time [us], 64-bit so it
+												 can't wrap while the channel sits idle */
+
+	int tx_len;								/**< Length of the frame at the head of the queue if it is
+												 encrypted already, 0 otherwise */
+	uint8_t tx_attempts;					/**< Failed attempts to send that frame */
+
+	xtimer_t tx_timer;						/**< Duty-cycle off-time timer */
+	xtimer_t rx_window1;					/**< Receive window timer */
+	msg_t msg_tx;
+	msg_t msg_rx1_expired;
+
+	ls_sched_stats_t stats;					/**< Statistics */
+
+	kernel_pid_t pid;						/**< Channel thread */
+	char stack[LS_SCHED_STACKSIZE];
+} ls_sched_t;
+
+/**
+ * @brief Starts channel thread and puts transceiver into receive mode.
+ *
+ * Transceiver must be initialized, its event callback is taken by the scheduler.
+ *
+ * @param	*sched		pointer to the scheduler structure
+ * @param	*params		scheduler parameters, copied
+ *
+ * @return	false if thread could not be created
+ */
+bool ls_sched_init(ls_sched_t *sched, const ls_sched_params_t *params);
+
+/**
+ * @brief Notifies channel thread about a new frame in the queue. May be called from any thread.
+ */
+void ls_sched_kick(ls_sched_t *sched);
+
+/**
+ * @brief Returns time in microseconds until the channel is allowed to transmit by the duty-cycle limit
+ */
+uint32_t ls_sched_time_to_tx(ls_sched_t *sched);
+
+#endif /* LS_GATE_SCHEDULER_H_ */
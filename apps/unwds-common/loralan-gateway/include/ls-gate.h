@@ -38,6 +38,7 @@
 #include "ls-crypto.h"
 #include "ls-gate-device-list.h"
 #include "ls-frame-fifo.h"
+#include "ls-gate-scheduler.h"
 
 #include "xtimer.h"
 #include "net/netdev.h"
@@ -96,8 +97,6 @@ typedef enum {
 
 typedef enum {
 	LS_GATE_PING = 0,
-
-	LS_GATE_RX1_EXPIRED,
 } ls_gate_tim_cmd_t;
 
 /**
@@ -109,7 +108,7 @@ typedef enum {
 	LS_INIT_E_TIM_THREAD = 2,			/**< Unable to start timeout handler thread */
 	LS_GATE_E_NODEV = 3,				/**< Unable to send frame - device with address specified is not joined */
 	LS_E_PQ_OVERFLOW = 4,				/**< Unable to queue frame for sending - queue is overflowed */
-	LS_INIT_E_UQ_THREAD = 5,			/**< Unable to create uplink queue handler thread */
+	LS_INIT_E_CH_THREAD = 5,			/**< Unable to create channel handler thread */
 
 	LS_GATE_OK,							/**< Initialized successfully */
 } ls_gate_init_status_t;
@@ -133,20 +132,11 @@ typedef struct {
 	netdev_t *device;			/**< Transceiver instance for this channel */
 	void *gate;					/**< Gate instance pointer */
 
-	ls_frame_t current_frame;	/**< Memory for current frame */
-	mutex_t channel_mutex;		/**< Mutex on the channel */
-
 	ls_frame_fifo_t ul_fifo;	/**< Uplink frame queue */
 
-	xtimer_t	rx_window1;		/**< First receive window timer */
+	ls_sched_t sched;			/**< Channel scheduler and its thread */
 } ls_channel_internal_t;
 
-typedef enum {
-	LS_GATE_CHANNEL_STATE_IDLE = 0,
-	LS_GATE_CHANNEL_STATE_RX,
-	LS_GATE_CHANNEL_STATE_TX,
-} ls_channel_state_t;
-
 /**
  * @brief Holds channel-related information.
  *
@@ -158,13 +148,37 @@ typedef struct {
 
 	int16_t	last_rssi;					/**< RSSI of last received packet on this channel */
 
-	ls_channel_state_t state;			/**< State of the channel */
+	uint8_t duty_cycle;					/**< Max. share of time on air [%], 0 if not limited */
 
 	ls_channel_internal_t _internal;	/**< Internal channel-specific data */
 } ls_gate_channel_t;
 
-#define LS_UQ_HANDLER_STACKSIZE			(2048)
-#define LS_UQ_MSG_QUEUE_SIZE 8
+/**
+ * @brief Number of nodes whose session keys are kept derived and expanded.
+ *
+ * Cache is indexed by node address, nodes evict each other on collision.
+ */
+#ifndef LS_GATE_KEY_CACHE_SIZE
+#if defined(CPU_FAM_STM32L4)
+#define LS_GATE_KEY_CACHE_SIZE 32
+#else
+#define LS_GATE_KEY_CACHE_SIZE 8
+#endif
+#endif
+
+/**
+ * @brief Cached session keys of a node.
+ *
+ * Keys depend only on the last device nonce, app nonce and address, so entry
+ * is valid as long as these three match the node record.
+ */
+typedef struct {
+	ls_addr_t addr;					/**< Node address */
+	uint32_t dev_nonce;				/**< Device nonce keys were derived from */
+	uint32_t app_nonce;				/**< Application nonce keys were derived from */
+	bool valid;						/**< Entry holds keys */
+	ls_session_keys_t keys;			/**< Derived keys */
+} ls_gate_key_cache_entry_t;
 
 #define LS_TIM_HANDLER_STACKSIZE		(2048)
 #define LS_TIM_MSG_QUEUE_SIZE 8
@@ -181,10 +195,12 @@ typedef struct {
     kernel_pid_t tim_thread_pid;
     char tim_thread_stack[LS_TIM_HANDLER_STACKSIZE];
 
-    /* Uplink queue handler data */
-    kernel_pid_t uq_thread_pid;
-    char uq_thread_stack[LS_TIM_HANDLER_STACKSIZE];
+    /* Frames received on different channels are handled one at a time */
+    mutex_t rx_mutex;
 
+    /* Session keys cache */
+    ls_gate_key_cache_entry_t key_cache[LS_GATE_KEY_CACHE_SIZE];
+    mutex_t key_cache_mutex;
 } ls_gate_internal_t;
 
 /**
@@ -32,24 +32,66 @@
 #define PENDING_FIFO_H_
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 #include "mutex.h"
 
-#define GC_MAX_PENDING 16
-#define GC_MAX_REPLY_LEN 256
+/**
+ * @brief Size of the reply buffer in bytes, must be a power of two
+ */
+#ifndef GC_PENDING_BUF_SIZE
+#define GC_PENDING_BUF_SIZE 2048
+#endif
+
+#define GC_MAX_REPLY_LEN 256	/**< Max. length of one reply */
+
+#if (GC_PENDING_BUF_SIZE & (GC_PENDING_BUF_SIZE - 1))
+#error "GC_PENDING_BUF_SIZE must be a power of two"
+#endif
 
 /**
- * @brief describes the frame queue.
+ * @brief Backpressure statistics of the reply queue
+ */
+typedef struct {
+	uint32_t replies;		/**< Replies queued */
+	uint32_t bytes;			/**< Bytes queued */
+	uint32_t overflows;		/**< Replies dropped because the buffer was full */
+	uint32_t dropped_bytes;	/**< Bytes of dropped replies */
+	uint32_t max_used;		/**< High watermark of buffer usage in bytes */
+	uint32_t writes;		/**< Number of UART writes */
+	uint32_t write_time_us;	/**< Time spent in UART writes */
+} gc_pending_stats_t;
+
+/**
+ * @brief describes the reply queue.
+ *
+ * Replies of variable length are stored back to back, each prefixed by its 16-bit length,
+ * and never wrap around the end of the buffer, so every reply is written out in one piece.
+ * Single consumer (UART writer), producers are serialized by the mutex which is never taken by the consumer.
  */
 typedef struct {
-	char fifo[GC_MAX_PENDING][GC_MAX_REPLY_LEN];	/**< Queue data */
+	char buf[GC_PENDING_BUF_SIZE];	/**< Queue data */
 
-	int front;	/**< Pointer to the queue's front */
-	int rear;	/**< Pointer to the queue's start */
+	/* Free running positions, masked on access. tsrb can't be used: replies are
+	 * formatted in place and the consumer reads them in place, so the positions
+	 * are moved by whole replies rather than by bytes copied in and out. */
+	volatile unsigned writes;	/**< Position past the last committed reply */
+	volatile unsigned reads;	/**< Position of the oldest reply */
+	unsigned reserved;	/**< Position of the reserved reply */
 
-	mutex_t mutex; /**< FIFO's mutex */
+	mutex_t mutex;		/**< Producers' mutex */
+
+	gc_pending_stats_t stats;	/**< Backpressure statistics */
 } gc_pending_fifo_t;
 
+/**
+ * @brief Iterator over the queued replies, used by the consumer
+ */
+typedef struct {
+	unsigned pos;	/**< Position of the next reply */
+} gc_pending_iter_t;
+
 /**
  * @brief initialies the queue.
  *
@@ -58,24 +100,56 @@ typedef struct {
 void gc_pending_fifo_init(gc_pending_fifo_t *fifo);
 
 /**
- * @brief evicts element from the end of a queue.
+ * @brief reserves contiguous space at the end of the queue to format a reply in place.
  *
- * @param	[IN]	*fifo	pointer to the FIFO structure
- * @param	[OUT]	*reply	pointer to the buf to write
+ * On success, producers' mutex is held until gc_pending_fifo_commit() is called.
+ * On failure, overflow is counted in the statistics.
+ *
+ * @param	*fifo		pointer to the FIFO structure
+ * @param	max_len		max. length of the reply, up to GC_MAX_REPLY_LEN
+ *
+ * @return	pointer to the buffer, NULL if queue is full
+ */
+char *gc_pending_fifo_reserve(gc_pending_fifo_t *fifo, size_t max_len);
+
+/**
+ * @brief publishes the reply formatted in a buffer obtained by gc_pending_fifo_reserve().
  *
- * @return false if queue is empty
+ * @param	*fifo	pointer to the FIFO structure
+ * @param	len		actual length of the reply, not more than reserved
  */
-bool gc_pending_fifo_pop(gc_pending_fifo_t *fifo, char *buf);
+void gc_pending_fifo_commit(gc_pending_fifo_t *fifo, size_t len);
 
 /**
- * @brief inserts element into the queue.
+ * @brief inserts a copy of the null-terminated reply into the queue.
  *
  * @param	*fifo	pointer to the FIFO structure
- * @param	*buf	pointer to the reply buffer to insert
+ * @param	*buf	reply, truncated to GC_MAX_REPLY_LEN characters
+ *
+ * @return 	false if queue is full
+ */
+bool gc_pending_fifo_push(gc_pending_fifo_t *fifo, const char *buf);
+
+/**
+ * @brief starts iteration from the oldest reply.
+ */
+void gc_pending_fifo_iter_init(gc_pending_fifo_t *fifo, gc_pending_iter_t *it);
+
+/**
+ * @brief gets the next reply without evicting it.
+ *
+ * @param	[IN]	*fifo	pointer to the FIFO structure
+ * @param	[IN]	*it		iterator
+ * @param	[OUT]	*len	length of the reply
  *
- * @return 	false if frame is full
+ * @return	pointer to the reply, NULL if there are no more replies
  */
-bool gc_pending_fifo_push(gc_pending_fifo_t *fifo, char buf[GC_MAX_REPLY_LEN]);
+char *gc_pending_fifo_iter_next(gc_pending_fifo_t *fifo, gc_pending_iter_t *it, size_t *len);
+
+/**
+ * @brief evicts all replies returned by the iterator so far.
+ */
+void gc_pending_fifo_release_to(gc_pending_fifo_t *fifo, const gc_pending_iter_t *it);
 
 /**
  * @biref checks that queue is empty or not.
@@ -87,12 +161,8 @@ bool gc_pending_fifo_push(gc_pending_fifo_t *fifo, char buf[GC_MAX_REPLY_LEN]);
 bool gc_pending_fifo_empty(gc_pending_fifo_t *fifo);
 
 /**
- * @brief checks that queue is full.
- *
- * @param	*fifo	pointer to the FIFO structure
- *
- * @return	true if queue is full
+ * @brief Gets number of bytes currently used by the queue
  */
-bool gc_pending_fifo_full(gc_pending_fifo_t *fifo);
+unsigned gc_pending_fifo_used(gc_pending_fifo_t *fifo);
 
 #endif /* PENDING_FIFO_H_ */
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2016-2018 Unwired Devices LLC <info@unwds.com>
+
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @defgroup
+ * @ingroup
+ * @brief
+ * @{
+ * @file		ls-gate-adr.c
+ * @brief       Adaptive data rate engine of the gate
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <string.h>
+
+#include "ls-gate-adr.h"
+#include "ls-init-device.h"
+
+#define ENABLE_DEBUG (0)
+#include "debug.h"
+
+/**
+ * Min. SNR to demodulate DR0..DR6 [dB], rounded up
+ */
+static const int8_t snr_floor[] = { -20, -17, -15, -12, -10, -7, -7 };
+
+void ls_gate_adr_reset(ls_gate_link_t *link, ls_datarate_t dr)
+{
+	memset(link, 0, sizeof(ls_gate_link_t));
+
+	link->dr = dr;
+	link->tx_power = LS_GATE_ADR_MAX_POWER;
+}
+
+void ls_gate_adr_update(ls_gate_link_t *link, ls_datarate_t dr, int8_t snr, int16_t rssi, size_t len)
+{
+	/* First uplink or node is not where we've put it, e.g. it fell back to the defaults after losing the link */
+	if ((link->uplinks == 0) || (dr != link->dr)) {
+		DEBUG("ls-gate-adr: node moved from DR%d to DR%d\n", link->dr, dr);
+
+		link->dr = dr;
+		link->tx_power = LS_GATE_ADR_MAX_POWER;
+		link->num_snr = 0;
+	}
+
+	link->snr[link->snr_pos] = snr;
+	link->snr_pos = (link->snr_pos + 1) % LS_GATE_ADR_HISTORY;
+	if (link->num_snr < LS_GATE_ADR_HISTORY) {
+		link->num_snr++;
+	}
+
+	link->last_rssi = rssi;
+	link->uplinks++;
+	link->airtime_ms += (ls_time_on_air(dr, len) + 500) / 1000;
+}
+
+int ls_gate_adr_steps(const ls_gate_link_t *link)
+{
+	if (link->num_snr < LS_GATE_ADR_HISTORY) {
+		return 0;
+	}
+
+	/* Best of the recent uplinks, fading only makes the others worse */
+	int max_snr = link->snr[0];
+	for (unsigned i = 1; i < LS_GATE_ADR_HISTORY; i++) {
+		if (link->snr[i] > max_snr) {
+			max_snr = link->snr[i];
+		}
+	}
+
+	int margin = max_snr - snr_floor[link->dr] - LS_GATE_ADR_MARGIN_DB;
+
+	DEBUG("ls-gate-adr: max. SNR %d dB, margin %d dB\n", max_snr, margin);
+
+	return margin / LS_GATE_ADR_STEP_DB;
+}
+
+void ls_gate_adr_commanded(ls_gate_link_t *link, ls_datarate_t dr, int8_t tx_power)
+{
+	link->dr = dr;
+	link->tx_power = tx_power;
+	link->num_snr = 0;
+	link->adr_commands++;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -35,6 +35,7 @@ extern "C" {
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 
 #include "xtimer.h"
 #include "mutex.h"
@@ -45,6 +46,59 @@ extern "C" {
 #define ENABLE_DEBUG (0)
 #include "debug.h"
 
+#ifdef MODULE_CORE_PI_MUTEX
+#define devlist_mutex_init(d)	pi_mutex_init(&(d)->mutex)
+#define devlist_lock(d)			pi_mutex_lock(&(d)->mutex)
+#define devlist_unlock(d)		pi_mutex_unlock(&(d)->mutex)
+#else
+#define devlist_mutex_init(d)	mutex_init(&(d)->mutex)
+#define devlist_lock(d)			mutex_lock(&(d)->mutex)
+#define devlist_unlock(d)		mutex_unlock(&(d)->mutex)
+#endif
+
+/**
+ * @brief Appends the cell to the queue of free cells
+ *
+ * Freed addresses are reused last, so frames still in flight for a removed
+ * node are unlikely to reach a new one.
+ */
+static void free_cell_put(ls_gate_devices_t *devlist, ls_addr_t addr) {
+	devlist->nodes_free_list[addr] = true;
+
+	devlist->free_next[addr] = 0;
+	devlist->free_prev[addr] = devlist->free_tail;
+	if (devlist->free_tail) {
+		devlist->free_next[devlist->free_tail - 1] = addr + 1;
+	}
+	else {
+		devlist->free_head = addr + 1;
+	}
+	devlist->free_tail = addr + 1;
+}
+
+/**
+ * @brief Takes the cell out of the queue of free cells
+ */
+static void free_cell_take(ls_gate_devices_t *devlist, ls_addr_t addr) {
+	uint16_t prev = devlist->free_prev[addr];
+	uint16_t next = devlist->free_next[addr];
+
+	devlist->nodes_free_list[addr] = false;
+
+	if (prev) {
+		devlist->free_next[prev - 1] = next;
+	}
+	else {
+		devlist->free_head = next;
+	}
+	if (next) {
+		devlist->free_prev[next - 1] = prev;
+	}
+	else {
+		devlist->free_tail = prev;
+	}
+}
+
 /**
  * @brief Initialize list of connected nodes
  */
@@ -52,12 +106,93 @@ void ls_devlist_init(ls_gate_devices_t *devlist) {
 	memset(devlist, 0, sizeof(ls_gate_devices_t));
 
 	for(int i = 0; i < LS_GATE_MAX_NODES; i++) {
-		devlist->nodes_free_list[i] = true;
+		free_cell_put(devlist, i);
     }
-	mutex_init(&devlist->mutex);    
+	devlist_mutex_init(devlist);    
     DEBUG("ls-gate-device-list: device list initialized\n");
 }
 
+/**
+ * @brief Returns home cell of the node ID in the hash index
+ */
+static inline uint32_t index_slot(uint64_t node_id) {
+    /* Fold EUI-64 and apply Fibonacci hashing */
+    uint32_t h = (uint32_t) (node_id ^ (node_id >> 32));
+    return (uint32_t) (h * 2654435761U) >> (32 - LS_GATE_HASH_BITS);
+}
+
+/**
+ * @brief Looks up the node with specified node ID via the hash index
+ *
+ * The caller must hold the list lock, removal moves index entries around.
+ */
+static ls_gate_node_t *index_find(ls_gate_devices_t *devlist, uint64_t node_id) {
+    uint32_t slot = index_slot(node_id);
+
+    while (devlist->index[slot] != LS_GATE_HASH_EMPTY) {
+        ls_gate_node_t *node = &devlist->nodes[devlist->index[slot] - 1];
+
+        if (node->node_id == node_id) {
+            return node;
+        }
+
+        slot = (slot + 1) & (LS_GATE_HASH_SIZE - 1);
+    }
+
+    return NULL;
+}
+
+static void index_insert(ls_gate_devices_t *devlist, uint64_t node_id, ls_addr_t addr) {
+    uint32_t slot = index_slot(node_id);
+
+    /* Table is always larger than the list, so there's a free cell */
+    while (devlist->index[slot] != LS_GATE_HASH_EMPTY) {
+        slot = (slot + 1) & (LS_GATE_HASH_SIZE - 1);
+    }
+
+    devlist->index[slot] = addr + 1;
+}
+
+static void index_remove(ls_gate_devices_t *devlist, ls_addr_t addr) {
+    uint32_t slot = index_slot(devlist->nodes[addr].node_id);
+
+    while (devlist->index[slot] != addr + 1) {
+        if (devlist->index[slot] == LS_GATE_HASH_EMPTY) {
+            DEBUG("ls-gate-device-list: node is not indexed\n");
+            return;
+        }
+        slot = (slot + 1) & (LS_GATE_HASH_SIZE - 1);
+    }
+
+    /* Shift following entries back to keep probe sequences unbroken */
+    uint32_t next = slot;
+    while (1) {
+        next = (next + 1) & (LS_GATE_HASH_SIZE - 1);
+
+        if (devlist->index[next] == LS_GATE_HASH_EMPTY) {
+            break;
+        }
+
+        uint32_t home = index_slot(devlist->nodes[devlist->index[next] - 1].node_id);
+
+        /* Entry may be moved only if its home cell isn't within (slot, next] */
+        if (((next - home) & (LS_GATE_HASH_SIZE - 1)) >= ((next - slot) & (LS_GATE_HASH_SIZE - 1))) {
+            devlist->index[slot] = devlist->index[next];
+            slot = next;
+        }
+    }
+
+    devlist->index[slot] = LS_GATE_HASH_EMPTY;
+}
+
+/**
+ * @brief Returns bloom filter bits for the nonce value
+ */
+static inline uint64_t nonce_bloom_bits(uint32_t nonce) {
+    uint32_t h = nonce * 2654435761U;
+    return (1ULL << (h >> 26)) | (1ULL << ((h >> 20) & 0x3F));
+}
+
 /**
  * @brief Clears tracked nonces list
  */
@@ -72,38 +207,49 @@ static void clear_nonce_list(ls_gate_devices_t *devlist, ls_addr_t addr) {
     
     memset((void *)node->nonce, 0, sizeof(ls_nonce_t) * LS_GATE_NONCES_PER_DEVICE);
 	node->num_nonces = 0;
+	node->nonce_bloom = 0;
     
     DEBUG("ls-gate-device-list: nonce list cleared\n");
 }
 
+/**
+ * @brief Appends nonce to the node's nonce list
+ */
+static void append_nonce(ls_gate_node_t *node, uint32_t nonce) {
+    for (uint32_t j = 0; j < LS_GATE_NONCES_PER_DEVICE; j++) {
+        if (node->nonce[j] == 0) {
+            node->nonce[j] = nonce;
+            node->num_nonces++;
+            node->nonce_bloom |= nonce_bloom_bits(nonce);
+            DEBUG("ls-gate-device-list: nonce successfully added\n");
+            break;
+        }
+    }
+}
+
 ls_gate_node_t *add_nonce(ls_gate_devices_t *devlist, uint64_t node_id, uint32_t nonce) {
     DEBUG("ls-gate-device-list: adding nonce\n");
-	/* Look for a free cell (and address) to insert */
-	for (uint32_t i = 0; i < LS_GATE_MAX_NODES; i++) {
-		if (!devlist->nodes_free_list[i]) {
-			ls_gate_node_t *node = &devlist->nodes[i];
-
-			if (node->node_id == node_id) {
-				/* Clear nonces list if it's full */
-				if (node->num_nonces == LS_GATE_NONCES_PER_DEVICE) {
-					clear_nonce_list(devlist, i);
-				}
-
-				/* Add current nonce to nonce list */
-                for (uint32_t j = 0; j < LS_GATE_NONCES_PER_DEVICE; j++) {
-                    if (node->nonce[j] == 0) {
-                        node->nonce[j] = nonce;
-                        node->num_nonces++;
-                        DEBUG("ls-gate-device-list: nonce successfully added\n");
-                        break;
-                    }
-                }
-                return node;
-			}
-		}
+	devlist_lock(devlist);
+
+	ls_gate_node_t *node = index_find(devlist, node_id);
+
+	if (node == NULL) {
+		devlist_unlock(devlist);
+        DEBUG("ls-gate-device-list: error adding nonce\n");
+		return NULL;
 	}
-    DEBUG("ls-gate-device-list: error adding nonce\n");
-	return NULL;
+
+	/* Clear nonces list if it's full */
+	if (node->num_nonces == LS_GATE_NONCES_PER_DEVICE) {
+		clear_nonce_list(devlist, node->addr);
+	}
+
+	/* Add current nonce to nonce list */
+	append_nonce(node, nonce);
+
+	devlist_unlock(devlist);
+
+	return node;
 }
 
 static void init_node(ls_gate_devices_t *devlist, ls_gate_node_t *node, ls_addr_t addr, uint64_t node_id, uint64_t app_id, uint32_t nonce, void *ch) {
@@ -115,6 +261,10 @@ static void init_node(ls_gate_devices_t *devlist, ls_gate_node_t *node, ls_addr_
 	node->addr = addr;
 	node->is_static = false;
 
+	/* Statically personalized devices start with a clean link history too */
+	memset(&node->link, 0, sizeof(node->link));
+	node->adr = false;
+
 	/* Clear nonces list if it's full */
 	if (node->num_nonces >= LS_GATE_NONCES_PER_DEVICE) {
 		DEBUG("ls-gate-device-list: clear nonce list");
@@ -122,14 +272,10 @@ static void init_node(ls_gate_devices_t *devlist, ls_gate_node_t *node, ls_addr_
 	}
 
 	/* Append nonce to the nonce list */
-    for (uint32_t j = 0; j < LS_GATE_NONCES_PER_DEVICE; j++) {
-        if (node->nonce[j] == 0) {
-            node->nonce[j] = nonce;
-            node->num_nonces++;
-            DEBUG("ls-gate-device-list: nonce successfully added\n");
-            break;
-        }
-    }
+	append_nonce(node, nonce);
+
+	/* Make node reachable by its ID */
+	index_insert(devlist, node_id, addr);
     
     DEBUG("ls-gate-device-list: node initialized\n");
 }
@@ -142,27 +288,29 @@ ls_gate_node_t *ls_devlist_add_by_addr(ls_gate_devices_t *devlist, ls_addr_t add
 		return NULL;
     }
 
-	/* Device is already added? */
-	if (ls_devlist_is_added(devlist, node_id)) {
-        DEBUG("ls-gate-device-list: device already added to the list\n");
+	if (addr >= LS_GATE_MAX_NODES) {
+        DEBUG("ls-gate-device-list: maximum node count has been reached\n");
 		return NULL;
     }
 
-	if (addr >= LS_GATE_MAX_NODES) {
-        DEBUG("ls-gate-device-list: maximum node count has been reached\n");
+	devlist_lock(devlist);
+
+	/* Device is already added? */
+	if (index_find(devlist, node_id) != NULL) {
+		devlist_unlock(devlist);
+        DEBUG("ls-gate-device-list: device already added to the list\n");
 		return NULL;
     }
 
 	/* This network address is occupied */
 	if (!devlist->nodes_free_list[addr]) {
+		devlist_unlock(devlist);
         DEBUG("ls-gate-device-list: network address already occupied\n");
 		return NULL;
     }
 
-	mutex_lock(&devlist->mutex);
-
 	/* Occupy node record */
-	devlist->nodes_free_list[addr] = false;
+	free_cell_take(devlist, addr);
 
 	/* Fill node record */
 	ls_gate_node_t *node = &devlist->nodes[addr];
@@ -174,11 +322,12 @@ ls_gate_node_t *ls_devlist_add_by_addr(ls_gate_devices_t *devlist, ls_addr_t add
 
 	node->num_nonces = 1;
 	node->nonce[0] = nonce;
+	node->nonce_bloom = nonce_bloom_bits(nonce);
 
 	/* Increase number of connected devices */
 	devlist->num_nodes++;
 
-	mutex_unlock(&devlist->mutex);
+	devlist_unlock(devlist);
     DEBUG("ls-gate-device-list: device successfully added\n");
 	return node;
 }
@@ -191,85 +340,82 @@ ls_gate_node_t *ls_devlist_add(ls_gate_devices_t *devlist, uint64_t node_id, uin
 		return NULL;
     }
 
+	devlist_lock(devlist);
+
 	/* Device is already added? */
-	if (ls_devlist_is_added(devlist, node_id)) {
+	if (index_find(devlist, node_id) != NULL) {
+		devlist_unlock(devlist);
         DEBUG("ls-gate-device-list: device already added to the list\n");
 		return NULL;
     }
 
-	mutex_lock(&devlist->mutex);
+	/* Take the first free cell (and address) to insert */
+	if (!devlist->free_head) {
+		devlist_unlock(devlist);
+		DEBUG("ls-gate-device-list: error adding device\n");
+		return NULL;
+	}
 
-	/* Look for a free cell (and address) to insert */
-	for (uint32_t i = 0; i < LS_GATE_MAX_NODES; i++) {
-		if (devlist->nodes_free_list[i]) {
-			/* Occupy node record */
-			devlist->nodes_free_list[i] = false;
+	ls_addr_t addr = devlist->free_head - 1;
 
-			/* Fill node record */
-			ls_gate_node_t *node = &devlist->nodes[i];
-			init_node(devlist, node, i, node_id, app_id, nonce, ch);
+	/* Occupy node record */
+	free_cell_take(devlist, addr);
 
-			/* Increase number of connected devices */
-			devlist->num_nodes++;
+	/* Fill node record */
+	ls_gate_node_t *node = &devlist->nodes[addr];
+	init_node(devlist, node, addr, node_id, app_id, nonce, ch);
 
-			/* Free lock */
-			mutex_unlock(&devlist->mutex);
+	/* Increase number of connected devices */
+	devlist->num_nodes++;
 
-			/* Return pointer to the node in the list */
-            DEBUG("ls-gate-device-list: device successfully added\n");
-			return node;
-		}
-	}
+	/* Free lock */
+	devlist_unlock(devlist);
 
-	mutex_unlock(&devlist->mutex);
-    DEBUG("ls-gate-device-list: error adding device\n");
-	return NULL;
+	/* Return pointer to the node in the list */
+	DEBUG("ls-gate-device-list: device successfully added\n");
+	return node;
 }
 
 bool ls_devlist_check_nonce(ls_gate_devices_t *devlist, uint64_t node_id, uint32_t nonce) {
     DEBUG("ls-gate-device-list: checking nonce for the device\n");
-	for (uint32_t i = 0; i < LS_GATE_MAX_NODES; i++) {
-		if (devlist->nodes_free_list[i])
-			continue;
-
-		ls_gate_node_t *node = &devlist->nodes[i];
-
-		if (node->node_id == node_id) {
-			/* Iterate through remembered nonce list */
-            for (uint32_t k = 0; k < LS_GATE_NONCES_PER_DEVICE; k++) {
-                if (node->nonce[k] == 0) {
-                    DEBUG("ls-gate-device-list: end of nonce list\n");
-                    break;
-                }
-                
-                if (node->nonce[k] == nonce) {
-                    DEBUG("ls-gate-device-list: nonce value was used before\n");
-					return false;
-                }
-            }
-            break;
+	devlist_lock(devlist);
+
+	ls_gate_node_t *node = index_find(devlist, node_id);
+
+	/* Nonce was never seen if the filter says so, no need to walk the list */
+	if (node != NULL && (node->nonce_bloom & nonce_bloom_bits(nonce)) == nonce_bloom_bits(nonce)) {
+		/* Iterate through remembered nonce list */
+		for (uint32_t k = 0; k < LS_GATE_NONCES_PER_DEVICE; k++) {
+			if (node->nonce[k] == 0) {
+				DEBUG("ls-gate-device-list: end of nonce list\n");
+				break;
+			}
+
+			if (node->nonce[k] == nonce) {
+				devlist_unlock(devlist);
+				DEBUG("ls-gate-device-list: nonce value was used before\n");
+				return false;
+			}
 		}
 	}
+	devlist_unlock(devlist);
     DEBUG("ls-gate-device-list: nonce checked, is ok\n");
 	return true;
 }
 
 bool ls_devlist_is_added(ls_gate_devices_t *devlist, uint64_t node_id) {
     DEBUG("ls-gate-device-list: check if device is in the list\n");
-	for (uint32_t i = 0; i < LS_GATE_MAX_NODES; i++) {
-		/* Skip free cells */
-		if (devlist->nodes_free_list[i])
-			continue;
-
-		ls_gate_node_t *node = &devlist->nodes[i];
+	bool found = (ls_devlist_get_by_nodeid(devlist, node_id) != NULL);
 
-		if (node->node_id == node_id) {
-            DEBUG("ls-gate-device-list: device found\n");
-			return true;
-        }
+#if ENABLE_DEBUG
+	if (found) {
+        DEBUG("ls-gate-device-list: device found\n");
+	} else {
+        DEBUG("ls-gate-device-list: device not found\n");
 	}
-    DEBUG("ls-gate-device-list: device not found\n");
-	return false;
+#endif
+
+	return found;
 }
 
 bool ls_devlist_is_in_network(ls_gate_devices_t *devlist, ls_addr_t addr) {
@@ -302,18 +448,21 @@ bool ls_devlist_remove_device(ls_gate_devices_t *devlist, ls_addr_t addr) {
 		return false;
     }
 
-	mutex_lock(&devlist->mutex);
+	devlist_lock(devlist);
+
+	/* Remove node from the ID index */
+	index_remove(devlist, addr);
 
 	/* Remove all tracked nonces from memory */
 	clear_nonce_list(devlist, addr);
 
 	/* Mark cell as free */
-	devlist->nodes_free_list[addr] = true;
+	free_cell_put(devlist, addr);
 
 	/* Decrease counter */
 	devlist->num_nodes--;
 
-	mutex_unlock(&devlist->mutex);
+	devlist_unlock(devlist);
     
     DEBUG("ls-gate-device-list: device removed\n");
 
@@ -325,18 +474,11 @@ bool ls_devlist_is_full(ls_gate_devices_t *devlist) {
 }
 
 ls_gate_node_t *ls_devlist_get_by_nodeid(ls_gate_devices_t *devlist, uint64_t nodeid) {
-	for (uint32_t i = 0; i < LS_GATE_MAX_NODES; i++) {
-		/* Skip free cells */
-		if (devlist->nodes_free_list[i])
-			continue;
+	devlist_lock(devlist);
+	ls_gate_node_t *node = index_find(devlist, nodeid);
+	devlist_unlock(devlist);
 
-		ls_gate_node_t *node = &devlist->nodes[i];
-
-		if (node->node_id == nodeid)
-			return &devlist->nodes[i];
-	}
-
-	return NULL;
+	return node;
 }
 
 ls_gate_node_t *ls_devlist_get(ls_gate_devices_t *devlist, ls_addr_t addr) {
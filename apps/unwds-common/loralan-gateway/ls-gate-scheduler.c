@@ -0,0 +1,373 @@
+/*
+ * Copyright (C) 2016-2018 Unwired Devices LLC <info@unwds.com>
+
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @defgroup    
+ * @ingroup     
+ * @brief       
+ * @{
+ * @file		ls-gate-scheduler.c
+ * @brief       Per-channel radio scheduler of the gate
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "assert.h"
+#include "thread.h"
+#include "xtimer.h"
+
+#include "ls-gate-scheduler.h"
+
+#define ENABLE_DEBUG (0)
+#include "debug.h"
+
+enum {
+	LS_SCHED_MSG_ISR = 0x3456,		/**< Transceiver interrupt */
+	LS_SCHED_MSG_TX,				/**< Frame queued or off-time is over */
+	LS_SCHED_MSG_RX1_EXPIRED,		/**< Receive window closed */
+};
+
+static void listen(ls_sched_t *s)
+{
+	netdev_t *dev = s->p.device;
+
+	if (s->p.cb->setup) {
+		s->p.cb->setup(s->p.arg);
+	}
+
+	uint8_t state = NETOPT_STATE_RX;
+	dev->driver->set(dev, NETOPT_STATE, &state, sizeof(uint8_t));
+}
+
+static void transmit(ls_sched_t *s)
+{
+	netdev_t *dev = s->p.device;
+	ls_frame_t *frame;
+	int len = s->tx_len;
+
+	if (len > 0) {
+		/* Frame was encrypted in place for an attempt that failed */
+		frame = ls_frame_fifo_peek(s->p.fifo);
+	}
+	else {
+		/* Frames of the nodes left the network are dropped */
+		while ((frame = ls_frame_fifo_peek(s->p.fifo)) != NULL) {
+			len = s->p.cb->prepare(s->p.arg, frame);
+			if (len >= 0) {
+				break;
+			}
+
+			ls_frame_fifo_pop(s->p.fifo, NULL);
+		}
+
+		if (frame == NULL) {
+			return;
+		}
+	}
+
+	DEBUG("ls-sched: state = TX, %d frames left\n", ls_frame_fifo_size(s->p.fifo) - 1);
+
+	if (s->p.cb->setup) {
+		s->p.cb->setup(s->p.arg);
+	}
+
+	s->state = LS_GATE_CHANNEL_STATE_TX;
+	s->tx_start = xtimer_now_usec();
+
+	iolist_t data = {
+		.iol_base = frame,
+		.iol_len = len,
+	};
+
+	if (dev->driver->send(dev, &data) < 0) {
+		puts("ls-sched: cannot send, device busy");
+		s->stats.tx_errors++;
+
+		s->state = LS_GATE_CHANNEL_STATE_IDLE;
+		listen(s);
+
+		if (++s->tx_attempts < LS_SCHED_TX_ATTEMPTS) {
+			/* Frame stays at the head of the queue, already encrypted */
+			s->tx_len = len;
+			xtimer_set_msg(&s->tx_timer, LS_SCHED_TX_RETRY_DELAY, &s->msg_tx, s->pid);
+			return;
+		}
+
+		puts("ls-sched: frame dropped");
+	}
+
+	/* Transceiver has its own copy of the frame now, or gave up on it */
+	s->tx_len = 0;
+	s->tx_attempts = 0;
+	ls_frame_fifo_pop(s->p.fifo, NULL);
+}
+
+/**
+ * @brief Sends the next frame if channel is free, waiting for the end of off-time if needed
+ */
+static void plan_tx(ls_sched_t *s)
+{
+	if (s->state != LS_GATE_CHANNEL_STATE_IDLE) {
+		/* Planned again when the channel becomes idle */
+		DEBUG("ls-sched: channel is busy, frame stays in queue\n");
+		return;
+	}
+
+	if (ls_frame_fifo_empty(s->p.fifo)) {
+		return;
+	}
+
+	uint32_t wait = ls_sched_time_to_tx(s);
+	if (wait > 0) {
+		DEBUG("ls-sched: duty-cycle off-time, TX in %u us\n", (unsigned) wait);
+		s->stats.tx_deferred++;
+
+		xtimer_set_msg(&s->tx_timer, wait, &s->msg_tx, s->pid);
+		return;
+	}
+
+	transmit(s);
+}
+
+static void rx_done(ls_sched_t *s)
+{
+	xtimer_remove(&s->rx_window1);
+	s->state = LS_GATE_CHANNEL_STATE_IDLE;
+
+	plan_tx(s);
+}
+
+static void tx_done(ls_sched_t *s)
+{
+	uint32_t now = xtimer_now_usec();
+	uint32_t airtime = now - s->tx_start;
+
+	s->stats.tx_frames++;
+	s->stats.airtime_ms += airtime / 1000;
+
+	if (s->p.duty_cycle) {
+		/* Off-time keeps the share of time on air within the limit */
+		s->tx_allowed = xtimer_now_usec64() +
+						(uint64_t) airtime * (100 - s->p.duty_cycle) / s->p.duty_cycle;
+	}
+
+	/* Give the node a chance to answer before sending anything else */
+	listen(s);
+
+	if (s->p.rx1_length) {
+		DEBUG("ls-sched: state = RX, rx1 window opened\n");
+		s->state = LS_GATE_CHANNEL_STATE_RX;
+		xtimer_set_msg(&s->rx_window1, s->p.rx1_length, &s->msg_rx1_expired, s->pid);
+	}
+	else {
+		s->state = LS_GATE_CHANNEL_STATE_IDLE;
+		plan_tx(s);
+	}
+}
+
+static void recv(ls_sched_t *s)
+{
+	netdev_t *dev = s->p.device;
+	netdev_sx127x_lora_packet_info_t packet_info;
+	uint8_t message[LS_FRAME_SIZE];
+
+	int len = dev->driver->recv(dev, NULL, 0, 0);
+	if (len < 0 || len > LS_FRAME_SIZE) {
+		puts("ls-sched: bad message, aborting");
+		rx_done(s);
+		return;
+	}
+
+	dev->driver->recv(dev, message, len, &packet_info);
+	s->stats.rx_frames++;
+
+	/* Channel is free before the frame is handled, so the reply is sent right away */
+	xtimer_remove(&s->rx_window1);
+	s->state = LS_GATE_CHANNEL_STATE_IDLE;
+
+	s->p.cb->recv(s->p.arg, message, len, &packet_info);
+
+	plan_tx(s);
+}
+
+static void event_cb(netdev_t *dev, netdev_event_t event, void *arg)
+{
+	ls_sched_t *s = (ls_sched_t *) arg;
+
+	if (event == NETDEV_EVENT_ISR) {
+		msg_t msg;
+		msg.type = LS_SCHED_MSG_ISR;
+
+		if (msg_send(&msg, s->pid) <= 0) {
+			puts("ls-sched: possibly lost interrupt");
+		}
+		return;
+	}
+
+	switch (event) {
+		case NETDEV_EVENT_RX_COMPLETE:
+			recv(s);
+			break;
+
+		case NETDEV_EVENT_CRC_ERROR:
+			DEBUG("ls-sched: CRC error\n");
+			s->stats.rx_errors++;
+			rx_done(s);
+			break;
+
+		case NETDEV_EVENT_RX_TIMEOUT:
+			DEBUG("ls-sched: RX timeout\n");
+			rx_done(s);
+			break;
+
+		case NETDEV_EVENT_TX_COMPLETE:
+			DEBUG("ls-sched: TX done\n");
+			tx_done(s);
+			break;
+
+		case NETDEV_EVENT_TX_TIMEOUT:
+			DEBUG("ls-sched: TX timeout\n");
+			s->stats.tx_errors++;
+
+			dev->driver->init(dev);
+			s->state = LS_GATE_CHANNEL_STATE_IDLE;
+			listen(s);
+			plan_tx(s);
+			break;
+
+		case NETDEV_EVENT_VALID_HEADER:
+			/* Reception decides the end of the window now */
+			DEBUG("ls-sched: header received, state = RX\n");
+			xtimer_remove(&s->rx_window1);
+			s->state = LS_GATE_CHANNEL_STATE_RX;
+			break;
+
+		default:
+			DEBUG("ls-sched: received event #%d\n", (int) event);
+			break;
+	}
+}
+
+static void *sched_thread(void *arg)
+{
+	ls_sched_t *s = (ls_sched_t *) arg;
+
+	msg_t queue[LS_SCHED_MSG_QUEUE_SIZE];
+	msg_init_queue(queue, LS_SCHED_MSG_QUEUE_SIZE);
+
+	while (1) {
+		msg_t msg;
+		msg_receive(&msg);
+
+		switch (msg.type) {
+			case LS_SCHED_MSG_ISR:
+				s->p.device->driver->isr(s->p.device);
+				break;
+
+			case LS_SCHED_MSG_TX:
+				plan_tx(s);
+				break;
+
+			case LS_SCHED_MSG_RX1_EXPIRED:
+				/* Window may have been closed by a reception already */
+				if (s->state == LS_GATE_CHANNEL_STATE_RX) {
+					DEBUG("ls-sched: rx1 window expired, state = IDLE\n");
+					s->state = LS_GATE_CHANNEL_STATE_IDLE;
+					plan_tx(s);
+				}
+				break;
+
+			default:
+				puts("ls-sched: unexpected msg type");
+				break;
+		}
+	}
+
+	return NULL;
+}
+
+bool ls_sched_init(ls_sched_t *sched, const ls_sched_params_t *params)
+{
+	assert(params->device != NULL);
+	assert(params->fifo != NULL);
+	assert(params->cb != NULL && params->cb->prepare != NULL && params->cb->recv != NULL);
+
+	memcpy(&sched->p, params, sizeof(ls_sched_params_t));
+	memset(&sched->stats, 0, sizeof(ls_sched_stats_t));
+
+	sched->state = LS_GATE_CHANNEL_STATE_IDLE;
+	sched->tx_allowed = 0;
+	sched->tx_len = 0;
+	sched->tx_attempts = 0;
+
+	sched->msg_tx.type = LS_SCHED_MSG_TX;
+	sched->msg_rx1_expired.type = LS_SCHED_MSG_RX1_EXPIRED;
+
+	sched->pid = thread_create(sched->stack, sizeof(sched->stack), THREAD_PRIORITY_MAIN - 2,
+							   THREAD_CREATE_STACKTEST, sched_thread, sched,
+							   "ls-gate channel");
+
+	if (sched->pid <= KERNEL_PID_UNDEF) {
+		puts("ls-sched: creation of channel thread failed");
+		return false;
+	}
+
+	params->device->event_callback = event_cb;
+	params->device->event_callback_arg = sched;
+
+	listen(sched);
+
+	return true;
+}
+
+void ls_sched_kick(ls_sched_t *sched)
+{
+	msg_t msg;
+	msg.type = LS_SCHED_MSG_TX;
+
+	msg_try_send(&msg, sched->pid);
+}
+
+uint32_t ls_sched_time_to_tx(ls_sched_t *sched)
+{
+	uint64_t now;
+
+	if (!sched->p.duty_cycle) {
+		return 0;
+	}
+
+	now = xtimer_now_usec64();
+	if (sched->tx_allowed <= now) {
+		return 0;
+	}
+
+	return (uint32_t) (sched->tx_allowed - now);
+}
+
+#ifdef __cplusplus
+}
+#endif
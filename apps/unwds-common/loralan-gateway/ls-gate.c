@@ -42,34 +42,59 @@ extern "C" {
 #include "ls-mac-types.h"
 #include "ls-mac.h"
 #include "ls-gate.h"
+#include "ls-gate-adr.h"
 
 #include "rtctimers-millis.h"
 
 #include <stdint.h>
 
-#define SX127X_LORA_MSG_QUEUE   (16U)
-#define SX127X_STACKSIZE        (2*THREAD_STACKSIZE_DEFAULT)
-#define MSG_TYPE_ISR            (0x3456)
-static char isr_stack[SX127X_STACKSIZE];
-static kernel_pid_t isr_pid;
-
 #define ENABLE_DEBUG (0)
 #include "debug.h"
 
 static msg_t msg_ping;
-static msg_t msg_rx1_expired;
 
-static void schedule_tx(ls_gate_channel_t *ch) {
-	/* Can send next frame only if channel is doing nothing */
-	if (ch->state != LS_GATE_CHANNEL_STATE_IDLE) {
-		puts("ls-gate: frame enqueued until channel is free");
-		return;
-	}
+/**
+ * @brief Gets session keys of the node, deriving them only if node's session changed
+ */
+static void get_node_keys(ls_gate_t *ls, ls_gate_node_t *node, ls_session_keys_t *keys)
+{
+    ls_gate_key_cache_entry_t *e = &ls->_internal.key_cache[node->addr % LS_GATE_KEY_CACHE_SIZE];
+    uint32_t dev_nonce = node->nonce[node->num_nonces - 1];
+
+    mutex_lock(&ls->_internal.key_cache_mutex);
+
+    if (!e->valid || e->addr != node->addr ||
+        e->dev_nonce != dev_nonce || e->app_nonce != node->app_nonce) {
+        DEBUG("ls-gate: deriving session keys for 0x%08X\n", (unsigned) node->addr);
 
-	msg_t msg;
-	msg.content.ptr = (void *) ch;
+        ls_session_keys_derive(&e->keys, dev_nonce, node->app_nonce, node->addr);
 
-	msg_try_send(&msg, ((ls_gate_t *)ch->_internal.gate)->_internal.uq_thread_pid);
+        e->addr = node->addr;
+        e->dev_nonce = dev_nonce;
+        e->app_nonce = node->app_nonce;
+        e->valid = true;
+    }
+
+    /* Copy keys out, entry may be evicted by another thread */
+    memcpy(keys, &e->keys, sizeof(ls_session_keys_t));
+
+    mutex_unlock(&ls->_internal.key_cache_mutex);
+}
+
+/**
+ * @brief Drops cached session keys of the node
+ */
+static void invalidate_node_keys(ls_gate_t *ls, ls_gate_node_t *node)
+{
+    ls_gate_key_cache_entry_t *e = &ls->_internal.key_cache[node->addr % LS_GATE_KEY_CACHE_SIZE];
+
+    mutex_lock(&ls->_internal.key_cache_mutex);
+
+    if (e->addr == node->addr) {
+        e->valid = false;
+    }
+
+    mutex_unlock(&ls->_internal.key_cache_mutex);
 }
 
 static void prepare_sx127x(ls_gate_channel_t *ch)
@@ -79,21 +104,37 @@ static void prepare_sx127x(ls_gate_channel_t *ch)
     DEBUG("ls-gate: SX127x configured\n");
 }
 
-static int send_frame_f(ls_gate_channel_t *ch, ls_frame_t *frame)
+static void setup_channel(void *arg)
 {
+    prepare_sx127x((ls_gate_channel_t *) arg);
+}
+
+/**
+ * @brief Encrypts frame from the queue in place, called by the channel scheduler right before sending
+ */
+static int prepare_frame(void *arg, ls_frame_t *frame)
+{
+    ls_gate_channel_t *ch = (ls_gate_channel_t *) arg;
     assert(ch != NULL);
 
     ls_gate_t *ls = (ls_gate_t *) ch->_internal.gate;
 
-    /* Send frame */
+    /* Update frame's FID to the last one and advance it */
+    frame->header.fid = 0;
+
+    DEBUG("ls-gate: >mhdr=0x%02X, mic=0x%04X, addr=0x%02X, type=0x%02X, fid=0x%02X\n",
+            (unsigned int) frame->header.mhdr,
+            (unsigned int) frame->header.mic, (unsigned int) frame->header.dev_addr,
+            (unsigned int) frame->header.type,
+            (unsigned int) frame->header.fid);
+
     size_t header_size = sizeof(ls_header_t) + sizeof(ls_payload_len_t);
     size_t payload_size = 0;
 
     /* The JOIN_ACK frame must be encrypted with the special join key */
     ls_gate_node_t *node;
 
-    uint8_t mic_key[AES_BLOCK_SIZE];
-    uint8_t aes_key[AES_BLOCK_SIZE];
+    ls_session_keys_t keys;
 
     switch (frame->header.type) {
         case LS_DL_JOIN_ACK:
@@ -102,123 +143,168 @@ static int send_frame_f(ls_gate_channel_t *ch, ls_frame_t *frame)
             ls_encrypt_frame(ls->settings.join_key, ls->settings.join_key, frame, &payload_size);
             break;
 
-        case LS_DL_ACK:
+        default:
+            mutex_lock(&ls->_internal.rx_mutex);
+
             node = ls_devlist_get(&ls->devices, frame->header.dev_addr);
+            if (node != NULL) {
+                get_node_keys(ls, node, &keys);
+            }
 
-            ls_derive_keys(node->nonce[node->num_nonces - 1], node->app_nonce, node->addr, mic_key, NULL);
-            ls_encrypt_frame(mic_key, mic_key, frame, &payload_size);
-            break;
+            mutex_unlock(&ls->_internal.rx_mutex);
 
-        default:
-            node = ls_devlist_get(&ls->devices, frame->header.dev_addr);
+            if (node == NULL) {
+                DEBUG("ls-gate: node left the network, frame dropped\n");
+                return -LS_GATE_E_NODEV;
+            }
 
-            ls_derive_keys(node->nonce[node->num_nonces - 1], node->app_nonce, node->addr, mic_key, aes_key);
-            ls_encrypt_frame(mic_key, aes_key, frame, &payload_size);
+            ls_session_encrypt_frame(&keys, frame, &payload_size);
     }
     
-    /* REG_LR_MODEMSTAT doesn't seems to work properly
-    int delay_ms = 5 + ((100 + 10*ch->dr) >> ch->dr);
-    int total_time = 0;
-    while (sx1276_get_modem_status(ch->_internal.sx1276) != SX1276_MODEM_CLEAR) {
-        DEBUG("ls-gate: modem is in RX, postpone transmission\n");
-        rtctimers_millis_sleep(delay_ms);
-        total_time += delay_ms;
-        if (total_time > 1000) {
-            DEBUG("ls-gate: force switching from RX to TX\n");
-            break;
-        }
+    return header_size + payload_size;
+}
+
+static bool enqueue_frame(ls_gate_channel_t *ch, ls_addr_t to, ls_type_t type, uint8_t *buf, size_t buflen) {
+    /* Assemble frame right in the queue slot */
+    ls_frame_t *frame = ls_frame_fifo_reserve(&ch->_internal.ul_fifo);
+    if (frame == NULL) {
+        DEBUG("ls-gate: uplink queue is full\n");
+        return true;
     }
-    */
 
-    /* Capture channel */
-    mutex_lock(&ch->_internal.channel_mutex);
+    ls_assemble_frame(to, type, buf, buflen, frame);
+    ls_frame_fifo_commit(&ch->_internal.ul_fifo);
 
-    puts("ls-gate: state = TX");
-    ch->state = LS_GATE_CHANNEL_STATE_TX;
+    ls_sched_kick(&ch->_internal.sched);
 
-    /* Prepare transceiver */
-    prepare_sx127x(ch);
+    DEBUG("ls-gate: frame scheduled\n");
 
-    /* Send frame into LoRa PHY */
-    iolist_t data = {
-        .iol_base = (uint8_t *)frame,
-        .iol_len = header_size + payload_size,
-    };
+	return false;
+}
+
+static inline void send_join_ack(ls_gate_t *ls, ls_gate_channel_t *ch, uint64_t dev_id, ls_addr_t addr, uint32_t app_nonce)
+{
+    (void)ls;
     
-    if (ch->_internal.device->driver->send(ch->_internal.device, &data) < 0) {
-        puts("[LoRa] uq_handler: cannot send, device busy");
+    ls_join_ack_t ack = { .addr = addr, .dev_id = dev_id, .app_nonce = app_nonce };
+
+    enqueue_frame(ch, addr, LS_DL_JOIN_ACK, (uint8_t *) &ack, sizeof(ls_join_ack_t));
+}
+
+/**
+ * @brief Finds channel of the data rate for the node, nodes are spread over channels of the same data rate
+ */
+static ls_gate_channel_t *find_channel(ls_gate_t *ls, ls_datarate_t dr, ls_addr_t addr)
+{
+    size_t num = 0;
+    for (size_t i = 0; i < ls->num_channels; i++) {
+        if (ls->channels[i].dr == dr) {
+            num++;
+        }
     }
-    
-    DEBUG("ls-gate: frame sent\n");
 
-    mutex_unlock(&ch->_internal.channel_mutex);
+    if (num == 0) {
+        return NULL;
+    }
 
-    return LS_GATE_OK;
+    size_t n = addr % num;
+    for (size_t i = 0; i < ls->num_channels; i++) {
+        if (ls->channels[i].dr == dr) {
+            if (n-- == 0) {
+                return &ls->channels[i];
+            }
+        }
+    }
+
+    return NULL;
 }
 
-static bool enqueue_frame_f(ls_gate_channel_t *ch, ls_frame_t *frame) {
-	bool res = !ls_frame_fifo_push(&ch->_internal.ul_fifo, frame);
+/**
+ * @brief Chooses new data rate and TX power for the node, returns false if they shouldn't change
+ */
+static bool adr_request(ls_gate_t *ls, ls_gate_channel_t *ch, ls_gate_node_t *node, ls_adr_req_t *req)
+{
+    ls_gate_link_t *link = &node->link;
 
-	schedule_tx(ch);
-    
-    DEBUG("ls-gate: frame scheduled\n");
+    /* Node which hasn't advertised ADR support keeps its settings */
+    if (!node->adr) {
+        return false;
+    }
 
-	return res;
-}
+    int steps = ls_gate_adr_steps(link);
+    if (steps == 0) {
+        return false;
+    }
 
-static bool enqueue_frame(ls_gate_channel_t *ch, ls_addr_t to, ls_type_t type, uint8_t *buf, size_t buflen) {
-    ls_frame_t *frame = &ch->_internal.current_frame;
-    ls_assemble_frame(to, type, buf, buflen, frame);
+    ls_gate_channel_t *target = ch;
+    int power = link->tx_power;
 
-    return enqueue_frame_f(ch, frame);
-}
+    /* Spare margin goes to the data rate first as it saves airtime, then to TX power */
+    while ((steps > 0) && (target->dr < LS_DR6)) {
+        ls_gate_channel_t *next = find_channel(ls, target->dr + 1, node->addr);
+        if (next == NULL) {
+            break;
+        }
 
-static inline void close_rx_windows(ls_gate_channel_t *ch) {
-	xtimer_remove(&ch->_internal.rx_window1);
-    DEBUG("ls-gate: state = IDLE");
-	ch->state = LS_GATE_CHANNEL_STATE_IDLE;
-    
-    DEBUG("ls-gate: RX window closed\n");
+        target = next;
+        steps--;
+    }
 
-	/* Free channel for TX */
-	//mutex_unlock(&ch->_internal.channel_mutex);
-}
+    while ((steps > 0) && (power - LS_GATE_ADR_STEP_DB >= LS_GATE_ADR_MIN_POWER)) {
+        power -= LS_GATE_ADR_STEP_DB;
+        steps--;
+    }
 
-static inline void open_rx_windows(ls_gate_channel_t *ch) {
-	/* Launch RX window timeout timer */
-	msg_rx1_expired.content.ptr = (void *) ch;
-	xtimer_set_msg(&ch->_internal.rx_window1, LS_GATE_RX1_LENGTH, &msg_rx1_expired, ((ls_gate_t *)ch->_internal.gate)->_internal.tim_thread_pid);
+    /* Lost margin is restored with TX power first, slower data rate costs airtime */
+    while ((steps < 0) && (power < LS_GATE_ADR_MAX_POWER)) {
+        power += LS_GATE_ADR_STEP_DB;
+        if (power > LS_GATE_ADR_MAX_POWER) {
+            power = LS_GATE_ADR_MAX_POWER;
+        }
+        steps++;
+    }
 
-	/* Switch transceiver to RX mode */
-	prepare_sx127x(ch);
-    uint8_t state = NETOPT_STATE_RX;
-    ch->_internal.device->driver->set(ch->_internal.device, NETOPT_STATE, &state, sizeof(uint8_t));
+    while ((steps < 0) && (target->dr > LS_DR0)) {
+        ls_gate_channel_t *next = find_channel(ls, target->dr - 1, node->addr);
+        if (next == NULL) {
+            break;
+        }
 
-    /* Capture channel on RX */
-    //mutex_lock(&ch->_internal.channel_mutex);
-    DEBUG("ls-gate: state = RX");
-    ch->state = LS_GATE_CHANNEL_STATE_RX;
+        target = next;
+        steps++;
+    }
 
-	DEBUG("ls-gate: rx1 window opened\n");
-}
+    if ((target == ch) && (power == link->tx_power)) {
+        return false;
+    }
 
-static inline void send_join_ack(ls_gate_t *ls, ls_gate_channel_t *ch, uint64_t dev_id, ls_addr_t addr, uint32_t app_nonce)
-{
-    (void)ls;
-    
-    ls_join_ack_t ack = { .addr = addr, .dev_id = dev_id, .app_nonce = app_nonce };
+    DEBUG("ls-gate: ADR for 0x%08X: DR%d -> DR%d, %d -> %d dBm\n", (unsigned int) node->addr,
+          ch->dr, target->dr, link->tx_power, power);
 
-    enqueue_frame(ch, addr, LS_DL_JOIN_ACK, (uint8_t *) &ack, sizeof(ls_join_ack_t));
+    req->frequency = target->frequency;
+    req->dr = target->dr;
+    req->tx_power = power;
+
+    ls_gate_adr_commanded(link, target->dr, power);
+
+    return true;
 }
 
-static inline void send_ack(ls_gate_t *ls, ls_gate_channel_t *ch, ls_addr_t addr)
+static inline void send_ack(ls_gate_t *ls, ls_gate_channel_t *ch, ls_gate_node_t *node)
 {
-    (void)ls;
-    
-	enqueue_frame(ch, addr, LS_DL_ACK, NULL, 0);
+    ls_adr_req_t req;
+    memset(&req, 0, sizeof(ls_adr_req_t));
+
+    /* New link settings go in place of the plain acknowledge */
+    if (adr_request(ls, ch, node, &req)) {
+        enqueue_frame(ch, node->addr, LS_DL_ADR_REQ, (uint8_t *) &req, sizeof(ls_adr_req_t));
+        return;
+    }
+
+	enqueue_frame(ch, node->addr, LS_DL_ACK, NULL, 0);
 }
 
-static void device_join_req(ls_gate_t *ls, ls_gate_channel_t *ch, uint64_t dev_id, uint64_t app_id, uint32_t dev_nonce, ls_node_class_t node_class)
+static void device_join_req(ls_gate_t *ls, ls_gate_channel_t *ch, uint64_t dev_id, uint64_t app_id, uint32_t dev_nonce, ls_node_class_t node_class, uint8_t caps)
 {
     DEBUG("ls-gate: join request from %08x%08x\n", (unsigned int) (dev_id >> 32), (unsigned int) (dev_id & 0xFFFFFFFF));
     
@@ -263,31 +349,38 @@ static void device_join_req(ls_gate_t *ls, ls_gate_channel_t *ch, uint64_t dev_i
     /* Update node's last seen time */
     node->last_seen = ls->_internal.ping_count;
 
+    /* Session is renewed, previous keys are no longer valid */
+    invalidate_node_keys(ls, node);
+
     /* Call join handler which returns an app nonce from the application side */
     node->app_nonce = ls->node_joined_cb(node);
 
     /* Reset last frame ID counter */
     node->last_fid = 0;
 
+    /* Joining node uses its default settings */
+    ls_gate_adr_reset(&node->link, ch->dr);
+    node->adr = (caps & LS_JOIN_CAP_ADR) != 0;
+
     /* Send join ACK */
     DEBUG("ls-gate: send join ack\n");
     send_join_ack(ls, ch, dev_id, node->addr, node->app_nonce);
 }
 
-static void app_data_recv(ls_gate_t *ls, ls_gate_channel_t *ch, ls_gate_node_t *node, ls_frame_t *frame, uint8_t *aes_key)
+static void app_data_recv(ls_gate_t *ls, ls_gate_channel_t *ch, ls_gate_node_t *node, ls_frame_t *frame, const ls_session_keys_t *keys)
 {
     DEBUG("ls-gate: app data frame received\n");
 
     /* Decrypt frame payload */
     DEBUG("ls-gate: decrypt frame payload\n");
-    ls_decrypt_frame_payload(aes_key, frame);
+    ls_session_crypt_payload(keys, frame);
 
     /* Call handler callback */
     DEBUG("ls-gate: call handler callback\n");
     ls->app_data_received_cb(node, ch, frame->payload.data, frame->payload.len, frame->header.status);
 }
 
-static bool frame_recv(ls_gate_t *ls, ls_gate_channel_t *ch, ls_frame_t *frame)
+static bool frame_recv(ls_gate_t *ls, ls_gate_channel_t *ch, ls_frame_t *frame, size_t len, netdev_sx127x_lora_packet_info_t *packet_info)
 {
     DEBUG("ls-gate: frame received\n");
     
@@ -302,21 +395,25 @@ static bool frame_recv(ls_gate_t *ls, ls_gate_channel_t *ch, ls_frame_t *frame)
     	}
     }
 
-    /* Derive cryptographic keys */
-    uint8_t mic_key[AES_BLOCK_SIZE];
-    uint8_t aes_key[AES_BLOCK_SIZE];
+    /* Session cryptographic keys */
+    ls_session_keys_t keys;
 
     if (node) {
         /* Update node's last seen time */
         node->last_seen = ls->_internal.ping_count;
         
-        ls_derive_keys(node->nonce[node->num_nonces - 1], node->app_nonce, node->addr, mic_key, aes_key);
+        get_node_keys(ls, node, &keys);
 
         /* Validate frame MIC */
-        if (!ls_validate_frame_mic(mic_key, frame)) {
+        if (!ls_validate_frame_mic(keys.mic_key, frame)) {
             DEBUG("ls-gate: MIC validation failed\n");
             return false;
         }
+
+        /* Node could be moved to another channel, replies follow it */
+        node->node_ch = ch;
+
+        ls_gate_adr_update(&node->link, ch->dr, packet_info->snr, packet_info->rssi, len);
     }
 
     switch (frame->header.type) {
@@ -352,7 +449,7 @@ static bool frame_recv(ls_gate_t *ls, ls_gate_channel_t *ch, ls_frame_t *frame)
                 /*
                  * Process as app. data frame
                  */
-    			app_data_recv(ls, ch, node, frame, aes_key);
+    			app_data_recv(ls, ch, node, frame, &keys);
                 DEBUG("ls-gate: data processed\n");
             } else {
             	DEBUG("ls-gate: frame dropped: %d != %d\n", frame->header.fid, (uint8_t) (node->last_fid + 1));
@@ -412,7 +509,7 @@ static bool frame_recv(ls_gate_t *ls, ls_gate_channel_t *ch, ls_frame_t *frame)
              * Confirmation of data reception will be sent in any case
              */
             if ((uint8_t) frame->header.fid >= (uint8_t) (node->last_fid + 1)) {
-            	app_data_recv(ls, ch, node, frame, aes_key);
+            	app_data_recv(ls, ch, node, frame, &keys);
 
             	/* Update frame ID */
             	node->last_fid = frame->header.fid;
@@ -428,7 +525,7 @@ static bool frame_recv(ls_gate_t *ls, ls_gate_channel_t *ch, ls_frame_t *frame)
              */
             if (node->num_pending == 0) {
                 DEBUG("ls-gate: ack sent to node\n");
-            	send_ack(ls, ch, frame->header.dev_addr);
+            	send_ack(ls, ch, node);
             } else {
                 DEBUG("ls-gate: pending data requested\n");
             	if (ls->pending_frames_req)
@@ -445,7 +542,7 @@ static bool frame_recv(ls_gate_t *ls, ls_gate_channel_t *ch, ls_frame_t *frame)
 
             DEBUG("ls-gate: uplink data unconfirmed\n");
 
-            app_data_recv(ls, ch, node, frame, aes_key);
+            app_data_recv(ls, ch, node, frame, &keys);
 
             return true;
 
@@ -457,8 +554,11 @@ static bool frame_recv(ls_gate_t *ls, ls_gate_channel_t *ch, ls_frame_t *frame)
                 return false;
             }
 
-            /* Check packet size */
-            if (frame->payload.len != sizeof(ls_join_req_t)) {
+            /* Check packet size, older nodes don't send capabilities */
+            BUILD_BUG_ON(LS_JOIN_REQ_LEGACY_LEN != 24);
+            BUILD_BUG_ON(sizeof(ls_join_req_caps_t) != LS_JOIN_REQ_LEGACY_LEN + 1);
+            if ((frame->payload.len != sizeof(ls_join_req_caps_t)) &&
+                (frame->payload.len != LS_JOIN_REQ_LEGACY_LEN)) {
                 DEBUG("ls-gate: wrong payload length\n");
                 return false;
             }
@@ -472,15 +572,16 @@ static bool frame_recv(ls_gate_t *ls, ls_gate_channel_t *ch, ls_frame_t *frame)
             
             DEBUG("ls-gate: frame payload decrypted\n");
 
-            ls_join_req_t req;
-            memcpy(&req, &frame->payload.data, sizeof(ls_join_req_t));
+            ls_join_req_caps_t req;
+            memset(&req, 0, sizeof(ls_join_req_caps_t));
+            memcpy(&req, &frame->payload.data, frame->payload.len);
 
-            uint64_t dev_id = req.dev_id;
-            uint64_t app_id = req.app_id;
-            uint32_t dev_nonce = req.dev_nonce;
-            ls_node_class_t node_class = req.node_class;
+            uint64_t dev_id = req.req.dev_id;
+            uint64_t app_id = req.req.app_id;
+            uint32_t dev_nonce = req.req.dev_nonce;
+            ls_node_class_t node_class = req.req.node_class;
 
-            device_join_req(ls, ch, dev_id, app_id, dev_nonce, node_class);
+            device_join_req(ls, ch, dev_id, app_id, dev_nonce, node_class, req.caps);
             
             DEBUG("ls-gate: join request processed\n");
 
@@ -508,175 +609,52 @@ static bool frame_recv(ls_gate_t *ls, ls_gate_channel_t *ch, ls_frame_t *frame)
     }
 }
 
-static void sx127x_handler(netdev_t *dev, netdev_event_t event, void *arg)
-{
-    if (event == NETDEV_EVENT_ISR) {
-        msg_t msg;
-        msg.type = MSG_TYPE_ISR;
-        msg.content.ptr = dev;
-        if (msg_send(&msg, isr_pid) <= 0) {
-            puts("gnrc_netdev: possibly lost interrupt.");
-        }
-        return;
-    }
-    
-    assert(arg != NULL);
-    ls_gate_channel_t *ch = (ls_gate_channel_t *)arg;
-    
-    switch (event) {
-        case NETDEV_EVENT_RX_COMPLETE: {
-            int len;
-            netdev_sx127x_lora_packet_info_t packet_info;
-            ls_gate_t *ls = (ls_gate_t *) ch->_internal.gate;
-            uint8_t message[LS_FRAME_SIZE];
-            
-            len = dev->driver->recv(dev, NULL, 0, 0);
-            if (len < 0) {
-                printf("RX: bad message, aborting\n");
-                break;
-            }
-            
-            dev->driver->recv(dev, message, len, &packet_info);
-            
-            printf("RX: %d bytes, | RSSI: %d dBm | SNR: %d dBm\n", (int)len,
-                    packet_info.rssi, (int)packet_info.snr);
-                    
-#if ENABLE_DEBUG
-            printf("RX:");
-            for (int k=0; k<len; k++) {
-                printf(" %02x", message[k]);
-            }
-            printf("\n");
-#endif
-
-            DEBUG("ls-gate: state = IDLE\n");
-            ch->state = LS_GATE_CHANNEL_STATE_IDLE;
-            
-            ch->last_rssi = packet_info.rssi;
-
-            /* Copy packet's data as a frame to our stack */
-            ls_frame_t *frame = (ls_frame_t *) message;
-
-            /* Check frame format */
-            if (ls_validate_frame(message, len)) {
-                if (!frame_recv(ls, ch, frame)) {
-                    DEBUG("ls-gate: ls-gate: well-formed frame discarded\n");
-                }
-            }
-            else {
-                DEBUG("ls-gate: ls-gate: malformed data discarded\n");
-            }
-        }
-        break;
-
-        case NETDEV_EVENT_CRC_ERROR:
-            DEBUG("ls-gate: CRC error\n");
-            DEBUG("ls-gate: state = IDLE\n");
-            ch->state = LS_GATE_CHANNEL_STATE_IDLE;
-            break;
-
-        case NETDEV_EVENT_TX_COMPLETE:
-            DEBUG("ls-gate: TX done\n");
-            open_rx_windows(ch);
-
-            break;
-
-        case NETDEV_EVENT_RX_TIMEOUT:
-            DEBUG("ls-gate: RX timeout\n");
-            DEBUG("ls-gate: state = IDLE\n");
-            ch->state = LS_GATE_CHANNEL_STATE_IDLE;
-            break;
-
-        case NETDEV_EVENT_TX_TIMEOUT:
-        	DEBUG("ls-gate: TX timeout");
-            ch->_internal.device->driver->init(ch->_internal.device);
-            prepare_sx127x(ch);
-            uint8_t state = NETOPT_STATE_RX;
-            ch->_internal.device->driver->set(ch->_internal.device, NETOPT_STATE, &state, sizeof(uint8_t));
-            break;
-            
-        case NETDEV_EVENT_VALID_HEADER:
-            DEBUG("ls-gate: header received, switch to RX state");
-            ch->state = LS_GATE_CHANNEL_STATE_RX;
-            break;
-
-        default:
-            DEBUG("ls-gate: received event #%d\n", (int) event);
-            break;
-    }
-}
-
-void *isr_thread(void *arg)
-{
-    (void)arg;
-    
-    static msg_t _msg_q[SX127X_LORA_MSG_QUEUE];
-    msg_init_queue(_msg_q, SX127X_LORA_MSG_QUEUE);
-
-    while (1) {
-        msg_t msg;
-        msg_receive(&msg);
-        if (msg.type == MSG_TYPE_ISR) {
-            netdev_t *dev = msg.content.ptr;
-            dev->driver->isr(dev);
-        }
-        else {
-            puts("[LoRa] isr_thread: unexpected msg type");
-        }
-    }
-}
-
 /**
- * Uplink frame queue handler thread body.
+ * @brief Handles packet received on the channel, called by the channel scheduler
  */
-static void *uq_handler(void *arg)
+static void frame_received(void *arg, uint8_t *message, size_t len, netdev_sx127x_lora_packet_info_t *packet_info)
 {
-    assert(arg != NULL);
-
-    //ls_gate_t *ls = (ls_gate_t *) arg;
-    msg_t msg_queue[LS_UQ_MSG_QUEUE_SIZE] = {};
-    msg_init_queue(msg_queue, LS_UQ_MSG_QUEUE_SIZE);
+    ls_gate_channel_t *ch = (ls_gate_channel_t *) arg;
+    ls_gate_t *ls = (ls_gate_t *) ch->_internal.gate;
 
-    msg_t msg;
+    printf("RX: %d bytes, | RSSI: %d dBm | SNR: %d dBm\n", (int)len,
+            packet_info->rssi, (int)packet_info->snr);
 
-    puts("ls-gate: uplink frame queue handler thread started"); // XXX: debug
+#if ENABLE_DEBUG
+    printf("RX:");
+    for (unsigned k = 0; k < len; k++) {
+        printf(" %02x", message[k]);
+    }
+    printf("\n");
+#endif
 
-    while (1) {
-        msg_receive(&msg);
+    ch->last_rssi = packet_info->rssi;
 
-        ls_gate_channel_t *ch = (ls_gate_channel_t *) msg.content.ptr;
-        ls_frame_fifo_t *fifo = &ch->_internal.ul_fifo;
+    /* Copy packet's data as a frame to our stack */
+    ls_frame_t *frame = (ls_frame_t *) message;
 
-        if (ls_frame_fifo_empty(fifo)) {
-            continue;
-        }
+    /* Device list and node sessions are shared by all channels */
+    mutex_lock(&ls->_internal.rx_mutex);
 
-        /* Get frame from queue top */
-        ls_frame_t *f;
-        ls_frame_t frame;
-        if (!ls_frame_fifo_pop(fifo, &frame)) {
-            continue;
+    /* Check frame format */
+    if (ls_validate_frame(message, len)) {
+        if (!frame_recv(ls, ch, frame, len, packet_info)) {
+            DEBUG("ls-gate: ls-gate: well-formed frame discarded\n");
         }
-
-        f = &frame;
-
-		/* Update frame's FID to the last one and advance it */
-		f->header.fid = 0;
-
-        DEBUG("ls-gate: >mhdr=0x%02X, mic=0x%04X, addr=0x%02X, type=0x%02X, fid=0x%02X [%d left]\n",
-                (unsigned int) f->header.mhdr,
-                (unsigned int) f->header.mic, (unsigned int) f->header.dev_addr,
-                (unsigned int) f->header.type,
-                (unsigned int) f->header.fid,
-                ls_frame_fifo_size(fifo));
-
-        /* Send frame into LoRa PHY */
-        send_frame_f(ch, f);
+    }
+    else {
+        DEBUG("ls-gate: ls-gate: malformed data discarded\n");
     }
 
-    return NULL;
+    mutex_unlock(&ls->_internal.rx_mutex);
 }
 
+static const ls_sched_cb_t sched_cb = {
+    .setup = setup_channel,
+    .prepare = prepare_frame,
+    .recv = frame_received,
+};
+
 static void *tim_handler(void *arg)
 {
     assert(arg != NULL);
@@ -713,6 +691,7 @@ static void *tim_handler(void *arg)
 						if (diff >= LS_MAX_PING_DIFFERENCE) {
 							/* Kick node */
                             DEBUG("ls-gate: remove node from devlist");
+							invalidate_node_keys(ls, node);
 							ls_devlist_remove_device(&ls->devices, i);
 
 							/* Notify application code about kicked node */
@@ -726,26 +705,6 @@ static void *tim_handler(void *arg)
                 /* Restart timer */
                 xtimer_set_msg(&ls->_internal.ping_timer, LS_PING_TIMEOUT, &msg_ping, ls->_internal.tim_thread_pid);
                 break;
-
-            case LS_GATE_RX1_EXPIRED: {
-            	ls_gate_channel_t *ch = (ls_gate_channel_t *) msg.content.ptr;
-            	if (!ch)
-            		break;
-
-
-            	/* RX window expired, if there are frames awaiting in queue, schedule TX operation */
-            	if (!ls_frame_fifo_empty(&ch->_internal.ul_fifo)) {
-            		puts("ls-gate: rx1 window expired, sending next frame from queue");
-
-            		close_rx_windows(ch);
-            		schedule_tx(ch);
-            	} else {
-            		ch->state = LS_GATE_CHANNEL_STATE_IDLE;
-            		puts("ls-gate: rx1 window expired, staying in RX, but IDLE");
-            	}
-            }
-            break;
-
         }
     }
 
@@ -767,43 +726,12 @@ static bool create_tim_handler_thread(ls_gate_t *ls)
         puts("ls-gate: creation of timer handler thread failed");
         return false;
     }
-    
-    isr_pid = thread_create(isr_stack, sizeof(isr_stack), THREAD_PRIORITY_MAIN - 1,
-                              THREAD_CREATE_STACKTEST, isr_thread, NULL,
-                              "SX127x handler thread");
-
-    if (isr_pid <= KERNEL_PID_UNDEF) {
-        puts("ls_init: creation of SX127X ISR thread failed");
-        return false;
-    }
 
     ls->_internal.tim_thread_pid = pid_tim;
 
     return true;
 }
 
-/**
- * @brief Creates uplink queue handler thread
- */
-static bool create_uq_handler_thread(ls_gate_t *ls)
-{
-    puts("ls-gate: creating uplink queue handler thread...");
-
-    kernel_pid_t pid_uq = thread_create(ls->_internal.uq_thread_stack, sizeof(ls->_internal.uq_thread_stack),
-                                        THREAD_PRIORITY_MAIN - 2,
-                                        THREAD_CREATE_STACKTEST, uq_handler, ls,
-                                        "uplink queue thread");
-    
-    if (pid_uq <= KERNEL_PID_UNDEF) {
-        puts("ls-gate: creation of uplink queue handler thread failed");
-        return false;
-    }
-
-    ls->_internal.uq_thread_pid = pid_uq;
-
-    return true;
-}
-
 static bool open_channel(ls_gate_channel_t *ch)
 {
     assert(ch != NULL);
@@ -816,22 +744,23 @@ static bool open_channel(ls_gate_channel_t *ch)
     /* Initialize the transceiver */
     ch->_internal.device->driver->init(ch->_internal.device);
 
-    /* Setup callbacks */
-    ch->_internal.device->event_callback = sx127x_handler;
-    ch->_internal.device->event_callback_arg = ch;
-    
+#ifdef MODULE_SX127X
     DEBUG("[LoRa] ls_ed_init: init RNG\n");
-    /* Initialize random number generator */
+    /* Initialize random number generator, simulated transceivers have no entropy source */
     random_init(sx127x_random((sx127x_t *)ch->_internal.device));
-    
-    /* Initialize and configure the transceiver for this channel */
-    prepare_sx127x(ch);
+#endif
 
-    /* Set channel to receive */
-    uint8_t state = NETOPT_STATE_RX;
-    ch->_internal.device->driver->set(ch->_internal.device, NETOPT_STATE, &state, sizeof(uint8_t));
-    
-    return true;
+    /* Start channel thread, it configures the transceiver and sets it to receive */
+    ls_sched_params_t params = {
+        .device = ch->_internal.device,
+        .fifo = &ch->_internal.ul_fifo,
+        .cb = &sched_cb,
+        .arg = ch,
+        .rx1_length = LS_GATE_RX1_LENGTH,
+        .duty_cycle = ch->duty_cycle,
+    };
+
+    return ls_sched_init(&ch->_internal.sched, &params);
 }
 
 static bool initialize_channels(ls_gate_t *ls)
@@ -841,7 +770,6 @@ static bool initialize_channels(ls_gate_t *ls)
         assert(ch->_internal.device != NULL);
 
         ch->_internal.gate = ls;
-        mutex_init(&ch->_internal.channel_mutex);
 
         if (!open_channel(ch)) {
             return false;
@@ -860,22 +788,25 @@ int ls_gate_init(ls_gate_t *ls)
     assert(ls->channels != NULL);
     assert(ls->num_channels > 0);
 
+    mutex_init(&ls->_internal.key_cache_mutex);
+    memset(ls->_internal.key_cache, 0, sizeof(ls->_internal.key_cache));
+
+    mutex_init(&ls->_internal.rx_mutex);
+
     msg_ping.type = LS_GATE_PING;
-    msg_rx1_expired.type = LS_GATE_RX1_EXPIRED;
     
     if (!create_tim_handler_thread(ls)) {
         return -LS_INIT_E_TIM_THREAD;
     }
-    
-    if (!create_uq_handler_thread(ls)) {
-    	return -LS_INIT_E_UQ_THREAD;
-    }
 
     /* Start ping timer */
     xtimer_set_msg(&ls->_internal.ping_timer, LS_PING_TIMEOUT, &msg_ping, ls->_internal.tim_thread_pid);
     
     ls_devlist_init(&ls->devices);
-    initialize_channels(ls);
+
+    if (!initialize_channels(ls)) {
+        return -LS_INIT_E_CH_THREAD;
+    }
 
     return LS_GATE_OK;
 }
@@ -910,6 +841,7 @@ int ls_gate_invite(ls_gate_t *ls, uint64_t nodeid) {
     ls_gate_node_t *node = ls_devlist_get_by_nodeid(devs, nodeid);
     if (node != NULL) {
         DEBUG("ls-gate: remove node from the list\n");
+        invalidate_node_keys(ls, node);
         ls_devlist_remove_device(devs, node->addr);
 	}
 
@@ -33,10 +33,19 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <string.h>
+#include <assert.h>
+
+#include <stdatomic.h>
 
 #include "pending-fifo.h"
 #include "mutex.h"
-#include "irq.h"
+
+#define HDR_LEN	(2)			/**< Reply length prefix */
+#define HDR_PAD	(0xFFFF)	/**< Length prefix of the padding up to the end of the buffer */
+
+static inline unsigned used_bytes(const gc_pending_fifo_t *fifo) {
+	return fifo->writes - fifo->reads;
+}
 
 #ifdef __cplusplus
 extern "C" {
@@ -44,57 +53,129 @@ extern "C" {
 
 void gc_pending_fifo_init(gc_pending_fifo_t *fifo) {
 	mutex_init(&fifo->mutex);
-	fifo->front = fifo->rear = -1;
+	fifo->writes = 0;
+	fifo->reads = 0;
+	memset(&fifo->stats, 0, sizeof(fifo->stats));
 }
 
-bool gc_pending_fifo_pop(gc_pending_fifo_t *fifo, char *buf) {
-	if (gc_pending_fifo_empty(fifo)) {
-		return false;
-	}
+char *gc_pending_fifo_reserve(gc_pending_fifo_t *fifo, size_t max_len) {
+	assert(max_len <= GC_MAX_REPLY_LEN);
 
 	mutex_lock(&fifo->mutex);
 
-	memcpy(buf, fifo->fifo[fifo->front], GC_MAX_REPLY_LEN);
+	unsigned pos = fifo->writes;
+	unsigned idx = pos & (GC_PENDING_BUF_SIZE - 1);
+	unsigned to_end = GC_PENDING_BUF_SIZE - idx;
+
+	/* Reply must be contiguous, so the rest of the buffer is skipped if it is too short */
+	unsigned skip = (to_end < HDR_LEN + max_len) ? to_end : 0;
 
-	if (fifo->front == fifo->rear) {
-		fifo->front = fifo->rear = -1;
+	if (skip + HDR_LEN + max_len > GC_PENDING_BUF_SIZE - used_bytes(fifo)) {
+		fifo->stats.overflows++;
+		fifo->stats.dropped_bytes += max_len;
 
 		mutex_unlock(&fifo->mutex);
-		return true;
+		return NULL;
 	}
 
-	fifo->front = (fifo->front + 1) % GC_MAX_PENDING;
+	if (skip) {
+		/* Less than a length prefix at the end is skipped by the consumer implicitly */
+		if (skip >= HDR_LEN) {
+			fifo->buf[idx] = (char) (HDR_PAD & 0xFF);
+			fifo->buf[idx + 1] = (char) (HDR_PAD >> 8);
+		}
+
+		pos += skip;
+		idx = 0;
+
+		atomic_thread_fence(memory_order_release);
+		fifo->writes = pos;
+	}
+
+	fifo->reserved = pos;
+
+	return fifo->buf + idx + HDR_LEN;
+}
+
+void gc_pending_fifo_commit(gc_pending_fifo_t *fifo, size_t len) {
+	unsigned idx = fifo->reserved & (GC_PENDING_BUF_SIZE - 1);
+
+	fifo->buf[idx] = len & 0xFF;
+	fifo->buf[idx + 1] = len >> 8;
+
+	/* Reply must be visible before the new write position */
+	atomic_thread_fence(memory_order_release);
+	fifo->writes = fifo->reserved + HDR_LEN + len;
+
+	fifo->stats.replies++;
+	fifo->stats.bytes += len;
+
+	unsigned used = used_bytes(fifo);
+	if (used > fifo->stats.max_used) {
+		fifo->stats.max_used = used;
+	}
 
 	mutex_unlock(&fifo->mutex);
-	return true;
 }
 
-bool gc_pending_fifo_push(gc_pending_fifo_t *fifo, char buf[GC_MAX_REPLY_LEN]) {
-	if (gc_pending_fifo_full(fifo)) {
+bool gc_pending_fifo_push(gc_pending_fifo_t *fifo, const char *buf) {
+	size_t len = strnlen(buf, GC_MAX_REPLY_LEN);
+
+	/* Copy only the reply itself */
+	char *slot = gc_pending_fifo_reserve(fifo, len);
+	if (slot == NULL) {
 		return false;
 	}
 
-	int c = irq_disable();
+	memcpy(slot, buf, len);
+	gc_pending_fifo_commit(fifo, len);
 
-	if (gc_pending_fifo_empty(fifo)) {
-		fifo->front = fifo->rear = 0;
-	} else {
-		fifo->rear = (fifo->rear + 1) % GC_MAX_PENDING;
-	}
+	return true;
+}
 
-	memcpy(fifo->fifo[fifo->rear], buf, GC_MAX_REPLY_LEN);
+void gc_pending_fifo_iter_init(gc_pending_fifo_t *fifo, gc_pending_iter_t *it) {
+	it->pos = fifo->reads;
+}
 
-	irq_restore(c);
+char *gc_pending_fifo_iter_next(gc_pending_fifo_t *fifo, gc_pending_iter_t *it, size_t *len) {
+	while (it->pos != fifo->writes) {
+		atomic_thread_fence(memory_order_acquire);
 
-	return true;
+		unsigned idx = it->pos & (GC_PENDING_BUF_SIZE - 1);
+		unsigned to_end = GC_PENDING_BUF_SIZE - idx;
+
+		if (to_end < HDR_LEN) {
+			it->pos += to_end;
+			continue;
+		}
+
+		unsigned hdr = (uint8_t) fifo->buf[idx] | ((uint8_t) fifo->buf[idx + 1] << 8);
+		if (hdr == HDR_PAD) {
+			it->pos += to_end;
+			continue;
+		}
+
+		*len = hdr;
+		it->pos += HDR_LEN + hdr;
+
+		return fifo->buf + idx + HDR_LEN;
+	}
+
+	return NULL;
 }
 
-bool gc_pending_fifo_full(gc_pending_fifo_t *fifo) {
-	return ((fifo->rear + 1) % GC_MAX_PENDING) == fifo->front;
+void gc_pending_fifo_release_to(gc_pending_fifo_t *fifo, const gc_pending_iter_t *it) {
+	/* Reads of the replies must complete before the space is given back to producers */
+	atomic_thread_fence(memory_order_release);
+	fifo->reads = it->pos;
 }
 
 bool gc_pending_fifo_empty(gc_pending_fifo_t *fifo) {
-	return (fifo->front == -1 && fifo->rear == -1);
+	return fifo->writes == fifo->reads;
+}
+
+unsigned gc_pending_fifo_used(gc_pending_fifo_t *fifo) {
+	return used_bytes(fifo);
 }
 
 #ifdef __cplusplus
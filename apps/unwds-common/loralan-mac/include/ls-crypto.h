@@ -45,6 +45,17 @@ typedef struct {
 	uint8_t join_key[AES_KEY_SIZE];
 } ls_crypto_t;
 
+/**
+ * @brief Session keys derived on join, with the AES key schedule already expanded.
+ *
+ * Deriving keys costs a SHA-256 and expanding the AES key costs a full key setup
+ * per block, so both are done once per session and kept here.
+ */
+typedef struct {
+	uint8_t mic_key[LS_MIC_KEY_LEN];	/**< Key for the MIC calculation */
+	AES_KEY aes_key;					/**< Expanded AES encryption key */
+} ls_session_keys_t;
+
 /**
  * @brief Calculates Message Integrity Code for the specified frame
  *
@@ -103,4 +114,40 @@ void ls_encrypt_frame(uint8_t *key_mic, uint8_t *key_aes, ls_frame_t *frame, siz
  */
 void ls_derive_keys(uint32_t dev_nonce, uint32_t app_nonce, ls_addr_t addr, uint8_t *key_mic, uint8_t *key_aes);
 
+/**
+ * @brief Derives session keys from the nonce numbers and expands AES key
+ *
+ * @param	[OUT]	*keys		session keys to fill
+ * @param	[IN]	dev_nonce	the device nonce number
+ * @param	[IN]	app_nonce	the application nonce number
+ * @param	[IN]	addr		device address
+ */
+void ls_session_keys_derive(ls_session_keys_t *keys, uint32_t dev_nonce, uint32_t app_nonce, ls_addr_t addr);
+
+/**
+ * @brief Fills session keys from already known MIC and AES keys
+ *
+ * @param	[OUT]	*keys		session keys to fill
+ * @param	[IN]	*key_mic	key for the MIC calculation
+ * @param	[IN]	*key_aes	key for the AES encryption
+ */
+void ls_session_keys_set(ls_session_keys_t *keys, const uint8_t *key_mic, const uint8_t *key_aes);
+
+/**
+ * @brief Encrypts (or decrypts) payload of the specified frame with session keys.
+ *
+ * @param	[IN]	*keys		session keys
+ * @param	[IN]	*frame		pointer to the frame to work with
+ */
+void ls_session_crypt_payload(const ls_session_keys_t *keys, ls_frame_t *frame);
+
+/**
+ * @brief Encrypts frame payload and calculates frame's MIC with session keys
+ *
+ * @param	[IN]	*keys		session keys
+ * @param	[IN]	*frame		the frame to work with
+ * @param	[OUT]	*newsize	new size of payload (resizes after encryption)
+ */
+void ls_session_encrypt_frame(const ls_session_keys_t *keys, ls_frame_t *frame, size_t *newsize);
+
 #endif /* LS_CRYPTO_H_ */
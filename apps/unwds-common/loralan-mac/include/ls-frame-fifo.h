@@ -35,22 +35,29 @@
 
 #include "mutex.h"
 #include "ls-mac-types.h"
+#include "ls-spsc-ring.h"
 
 /**
- * @brief The biggest possible queue size.
+ * @brief The biggest possible queue size, must be a power of two.
  */
 #define LS_MAX_FRAME_FIFO_SIZE 8
 
+#if (LS_MAX_FRAME_FIFO_SIZE & (LS_MAX_FRAME_FIFO_SIZE - 1))
+#error "LS_MAX_FRAME_FIFO_SIZE must be a power of two"
+#endif
+
 /**
  * @brief describes the frame queue.
+ *
+ * Single consumer, producers are serialized by the mutex which is never taken by the consumer.
+ * Peek, pop and clear are consumer side operations and must all be done by one thread.
  */
 typedef struct {
 	ls_frame_t fifo[LS_MAX_FRAME_FIFO_SIZE];	/**< Queue data */
 
-	int front;	/**< Pointer to the queue's front */
-	int rear;	/**< Pointer to the queue's start */
+	ls_spsc_ring_t ring;	/**< Ring over the queue data */
 
-	mutex_t mutex; /**< FIFO's mutex */
+	mutex_t mutex; /**< Producers' mutex */
 } ls_frame_fifo_t;
 
 /**
@@ -61,34 +68,53 @@ typedef struct {
 void ls_frame_fifo_init(ls_frame_fifo_t *fifo);
 
 /**
- * @brief evicts element from the end of a queue.
+ * @brief reserves a slot at the end of the queue to assemble a frame in place.
+ *
+ * On success, producers' mutex is held until ls_frame_fifo_commit() is called.
+ *
+ * @param	*fifo	pointer to the FIFO structure
+ *
+ * @return	pointer to the slot, NULL if queue is full
+ */
+ls_frame_t *ls_frame_fifo_reserve(ls_frame_fifo_t *fifo);
+
+/**
+ * @brief publishes the frame assembled in a slot obtained by ls_frame_fifo_reserve().
+ *
+ * @param	*fifo	pointer to the FIFO structure
+ */
+void ls_frame_fifo_commit(ls_frame_fifo_t *fifo);
+
+/**
+ * @brief evicts element from the front of a queue.
  *
  * @param	*fifo	pointer to the FIFO structure
- * @param	*frame	pointer to the frame to write the output
+ * @param	*frame	pointer to the frame to write the output, may be NULL
  *
  * @return false if queue is empty
  */
 bool ls_frame_fifo_pop(ls_frame_fifo_t *fifo, ls_frame_t *frame);
 
 /**
- * @brief polls element from the end of a queue but doesn't evicts it.
+ * @brief gets element from the front of a queue but doesn't evict it.
+ *
+ * The frame stays in place and must not be used after it has been popped.
  *
  * @param	*fifo	pointer to the FIFO structure
- * @param	*frame	pointer to the frame to write the output
  *
- * @return false if queue is empty
+ * @return	pointer to the frame, NULL if queue is empty
  */
-bool ls_frame_fifo_peek(ls_frame_fifo_t *fifo, ls_frame_t *frame);
+ls_frame_t *ls_frame_fifo_peek(ls_frame_fifo_t *fifo);
 
 /**
- * @brief inserts element into the queue.
+ * @brief inserts a copy of the element into the queue.
  *
  * @param	*fifo	pointer to the FIFO structure
  * @param	*frame	pointer to the frame to insert
  *
  * @return 	false if frame is full
  */
-bool ls_frame_fifo_push(ls_frame_fifo_t *fifo, ls_frame_t *frame);
+bool ls_frame_fifo_push(ls_frame_fifo_t *fifo, const ls_frame_t *frame);
 
 /**
  * @biref checks that queue is empty or not.
@@ -118,7 +144,7 @@ bool ls_frame_fifo_full(ls_frame_fifo_t *fifo);
 int ls_frame_fifo_size(ls_frame_fifo_t *fifo);
 
 /**
- * @brief clears the queue.
+ * @brief clears the queue. Consumer side operation.
  *
  * @param	*fifo	pointer to the FIFO structure
  */
@@ -103,6 +103,8 @@ typedef enum {
     LS_UL_TIME_REQ,     /**< Time synchronization request */
     LS_DL_TIME_ACK,     /**< Time synchronization reply */
 
+    LS_DL_ADR_REQ,      /**< Downlink acknowledge with new data rate and TX power for the node */
+
 	/* Reserved for future use */
 	LS_RFU5,
 } ls_type_t;
@@ -170,6 +172,11 @@ typedef struct {
     ls_payload_t payload;          /**< LS frame payload */
 } ls_frame_r1_t;
 
+/**
+ * @brief Node follows data rate and TX power commanded with LS_DL_ADR_REQ
+ */
+#define LS_JOIN_CAP_ADR	(1 << 0)
+
 /**
  * LS join request.
  */
@@ -181,6 +188,19 @@ typedef struct {
 	ls_node_class_t node_class;	/**< Node's device class */
 } ls_join_req_t;
 
+/**
+ * @brief Length of the join request sent by nodes without the capabilities field
+ */
+#define LS_JOIN_REQ_LEGACY_LEN (sizeof(ls_join_req_t))
+
+/**
+ * LS join request followed by the node capabilities, one byte longer than the legacy one.
+ */
+typedef struct __attribute__((__packed__)) {
+	ls_join_req_t req;			/**< Join request in the legacy layout */
+	uint8_t caps;				/**< Node capabilities, LS_JOIN_CAP_* flags */
+} ls_join_req_caps_t;
+
 /**
  * LS join acknowledge.
  */
@@ -209,4 +229,13 @@ typedef struct {
 	uint64_t rfu1;      /**< Reserved */
 } ls_time_req_ack_t;
 
+/**
+ * @brief Link settings the node must switch to, confirmed uplink acknowledge
+ */
+typedef struct __attribute__((__packed__)) {
+	uint32_t frequency;	/**< Channel frequency [Hz] */
+	uint8_t dr;			/**< Data rate, ls_datarate_t */
+	int8_t tx_power;	/**< TX power [dBm] */
+} ls_adr_req_t;
+
 #endif /* UNWIRED_MODULES_LORALAN_MAC_TYPES_H_ */
@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2016-2018 Unwired Devices LLC <info@unwds.com>
+
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @defgroup
+ * @ingroup
+ * @brief
+ * @{
+ * @file		ls-spsc-ring.h
+ * @brief       Single-producer/single-consumer ring of fixed-size slots
+ *
+ * Producer and consumer may run in different threads without locking and
+ * without masking interrupts: the producer only writes @p head, the consumer
+ * only writes @p tail. Slots are filled and read in place, so no element is
+ * copied by the ring itself.
+ *
+ * Producer side:  ls_spsc_ring_reserve() -> fill slot -> ls_spsc_ring_commit()
+ * Consumer side:  ls_spsc_ring_peek() -> use slot -> ls_spsc_ring_release()
+ */
+#ifndef LS_SPSC_RING_H_
+#define LS_SPSC_RING_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Ring descriptor, slot storage is provided by the user.
+ */
+typedef struct {
+	uint8_t *slots;			/**< Slot storage */
+	size_t slot_size;		/**< Size of one slot in bytes */
+	unsigned mask;			/**< Number of slots - 1, number of slots is a power of two */
+	volatile unsigned head;	/**< Slots committed so far, written by producer only */
+	volatile unsigned tail;	/**< Slots released so far, written by consumer only */
+} ls_spsc_ring_t;
+
+/**
+ * @brief Initializes the ring.
+ *
+ * @param	*ring		pointer to the ring structure
+ * @param	*slots		slot storage, @p num_slots * @p slot_size bytes
+ * @param	slot_size	size of one slot
+ * @param	num_slots	number of slots, must be a power of two
+ */
+static inline void ls_spsc_ring_init(ls_spsc_ring_t *ring, void *slots, size_t slot_size, unsigned num_slots)
+{
+	ring->slots = slots;
+	ring->slot_size = slot_size;
+	ring->mask = num_slots - 1;
+	ring->head = ring->tail = 0;
+}
+
+/**
+ * @brief Gets number of committed and not yet released slots.
+ *
+ * Counters are free-running, so the result is correct after any number of wraps.
+ */
+static inline unsigned ls_spsc_ring_size(const ls_spsc_ring_t *ring)
+{
+	return ring->head - ring->tail;
+}
+
+/**
+ * @brief checks that ring is empty.
+ */
+static inline bool ls_spsc_ring_empty(const ls_spsc_ring_t *ring)
+{
+	return ring->head == ring->tail;
+}
+
+/**
+ * @brief checks that ring is full.
+ */
+static inline bool ls_spsc_ring_full(const ls_spsc_ring_t *ring)
+{
+	return ls_spsc_ring_size(ring) > ring->mask;
+}
+
+/**
+ * @brief Returns the next free slot without publishing it. Producer only.
+ *
+ * @return	NULL if ring is full
+ */
+static inline void *ls_spsc_ring_reserve(ls_spsc_ring_t *ring)
+{
+	if (ls_spsc_ring_full(ring)) {
+		return NULL;
+	}
+
+	/* Slot must not be written before the consumer is done with it */
+	atomic_thread_fence(memory_order_acquire);
+
+	return ring->slots + (ring->head & ring->mask) * ring->slot_size;
+}
+
+/**
+ * @brief Publishes the slot returned by ls_spsc_ring_reserve(). Producer only.
+ */
+static inline void ls_spsc_ring_commit(ls_spsc_ring_t *ring)
+{
+	/* Slot contents must be visible before the new head */
+	atomic_thread_fence(memory_order_release);
+	ring->head = ring->head + 1;
+}
+
+/**
+ * @brief Returns the oldest committed slot without removing it. Consumer only.
+ *
+ * @return	NULL if ring is empty
+ */
+static inline void *ls_spsc_ring_peek(ls_spsc_ring_t *ring)
+{
+	if (ls_spsc_ring_empty(ring)) {
+		return NULL;
+	}
+
+	atomic_thread_fence(memory_order_acquire);
+
+	return ring->slots + (ring->tail & ring->mask) * ring->slot_size;
+}
+
+/**
+ * @brief Removes the oldest committed slot. Consumer only.
+ */
+static inline void ls_spsc_ring_release(ls_spsc_ring_t *ring)
+{
+	/* Reads of the slot must complete before it is given back to the producer */
+	atomic_thread_fence(memory_order_release);
+	ring->tail = ring->tail + 1;
+}
+
+/**
+ * @brief Drops all committed slots. Consumer only.
+ */
+static inline void ls_spsc_ring_clear(ls_spsc_ring_t *ring)
+{
+	atomic_thread_fence(memory_order_release);
+	ring->tail = ring->head;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LS_SPSC_RING_H_ */
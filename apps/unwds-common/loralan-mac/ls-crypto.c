@@ -104,7 +104,10 @@ void ls_encrypt_frame(uint8_t *key_mic, uint8_t *key_aes, ls_frame_t *frame, siz
     frame->header.mic = ls_calculate_mic(key_mic, frame, *newsize);
 }
 
-void ls_encrypt_frame_payload(uint8_t *key, ls_frame_t *frame)
+/**
+ * @brief AES-CTR over the frame payload with the expanded key
+ */
+static void crypt_payload(const AES_KEY *key, ls_frame_t *frame)
 {
 	uint16_t size = frame->payload.len;
 
@@ -119,10 +122,6 @@ void ls_encrypt_frame_payload(uint8_t *key, ls_frame_t *frame)
     uint8_t buf_idx = 0;
     uint16_t ctr = 1;
 
-    cipher_t context;
-
-    cipher_init(&context, CIPHER_AES_128, key, AES_KEY_SIZE);
-
     a_block.fb = 0x1;
     a_block.u8_pad = 0;
     a_block.dir = frame->header.type;
@@ -135,7 +134,7 @@ void ls_encrypt_frame_payload(uint8_t *key, ls_frame_t *frame)
         a_block.len = ((ctr) & 0xFF);
         ctr++;
 
-        cipher_encrypt(&context, (uint8_t *) &a_block, s_block);
+        aes_encrypt_expanded(key, (uint8_t *) &a_block, s_block);
         for (i = 0; i < AES_BLOCK_SIZE; i++) {
             buffer[buf_idx + i] = buffer[buf_idx + i] ^ s_block[i];
         }
@@ -146,13 +145,25 @@ void ls_encrypt_frame_payload(uint8_t *key, ls_frame_t *frame)
 
     if (size > 0) {
         a_block.len = ((ctr) & 0xFF);
-        cipher_encrypt(&context, (uint8_t *) &a_block, s_block);
+        aes_encrypt_expanded(key, (uint8_t *) &a_block, s_block);
         for (i = 0; i < size; i++) {
             buffer[buf_idx + i] = buffer[buf_idx + i] ^ s_block[i];
         }
     }
 }
 
+void ls_encrypt_frame_payload(uint8_t *key, ls_frame_t *frame)
+{
+    if (frame->payload.len == 0) {
+        return; /* Nothing to do with empty payload */
+    }
+
+    AES_KEY schedule;
+    aes_expand_encrypt_key(key, &schedule);
+
+    crypt_payload(&schedule, frame);
+}
+
 inline void ls_decrypt_frame_payload(uint8_t *key, ls_frame_t *frame)
 {
     ls_encrypt_frame_payload(key, frame);
@@ -181,6 +192,38 @@ void ls_derive_keys(ls_nonce_t dev_nonce, uint32_t app_nonce, ls_addr_t addr, ui
     }
 }
 
+void ls_session_keys_derive(ls_session_keys_t *keys, uint32_t dev_nonce, uint32_t app_nonce, ls_addr_t addr)
+{
+    assert(keys != NULL);
+
+    uint8_t key_aes[AES_KEY_SIZE];
+    ls_derive_keys(dev_nonce, app_nonce, addr, keys->mic_key, key_aes);
+
+    aes_expand_encrypt_key(key_aes, &keys->aes_key);
+}
+
+void ls_session_keys_set(ls_session_keys_t *keys, const uint8_t *key_mic, const uint8_t *key_aes)
+{
+    assert(keys != NULL);
+
+    memcpy(keys->mic_key, key_mic, LS_MIC_KEY_LEN);
+    aes_expand_encrypt_key(key_aes, &keys->aes_key);
+}
+
+void ls_session_crypt_payload(const ls_session_keys_t *keys, ls_frame_t *frame)
+{
+    crypt_payload(&keys->aes_key, frame);
+}
+
+void ls_session_encrypt_frame(const ls_session_keys_t *keys, ls_frame_t *frame, size_t *newsize)
+{
+    *newsize = frame->payload.len;
+
+    crypt_payload(&keys->aes_key, frame);
+
+    frame->header.mic = ls_calculate_mic((uint8_t *) keys->mic_key, frame, *newsize);
+}
+
 #ifdef __cplusplus
 }
 #endif
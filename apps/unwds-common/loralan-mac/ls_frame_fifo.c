@@ -35,7 +35,6 @@
 
 #include "include/ls-frame-fifo.h"
 #include "mutex.h"
-#include "irq.h"
 
 #include "ls-mac-types.h"
 
@@ -45,90 +44,70 @@ extern "C" {
 
 void ls_frame_fifo_init(ls_frame_fifo_t *fifo) {
 	mutex_init(&fifo->mutex);
-	fifo->front = fifo->rear = -1;
+	ls_spsc_ring_init(&fifo->ring, fifo->fifo, sizeof(ls_frame_t), LS_MAX_FRAME_FIFO_SIZE);
 }
 
-bool ls_frame_fifo_pop(ls_frame_fifo_t *fifo, ls_frame_t *frame) {
-	if (ls_frame_fifo_empty(fifo)) {
-		return false;
-	}
-
+ls_frame_t *ls_frame_fifo_reserve(ls_frame_fifo_t *fifo) {
 	mutex_lock(&fifo->mutex);
 
-	if (frame != NULL) {
-		*frame = fifo->fifo[fifo->front];
-	}
-
-	if (fifo->front == fifo->rear) {
-		fifo->front = fifo->rear = -1;
-
+	ls_frame_t *frame = ls_spsc_ring_reserve(&fifo->ring);
+	if (frame == NULL) {
 		mutex_unlock(&fifo->mutex);
-		return true;
 	}
-	fifo->front = (fifo->front + 1) % LS_MAX_FRAME_FIFO_SIZE;
 
+	return frame;
+}
+
+void ls_frame_fifo_commit(ls_frame_fifo_t *fifo) {
+	ls_spsc_ring_commit(&fifo->ring);
 	mutex_unlock(&fifo->mutex);
-	return true;
 }
 
-bool ls_frame_fifo_peek(ls_frame_fifo_t *fifo, ls_frame_t *frame) {
-	if (ls_frame_fifo_empty(fifo)) {
+bool ls_frame_fifo_pop(ls_frame_fifo_t *fifo, ls_frame_t *frame) {
+	ls_frame_t *front = ls_spsc_ring_peek(&fifo->ring);
+	if (front == NULL) {
 		return false;
 	}
 
-	mutex_lock(&fifo->mutex);
-	*frame = fifo->fifo[fifo->front];
-	mutex_unlock(&fifo->mutex);
+	if (frame != NULL) {
+		*frame = *front;
+	}
+
+	ls_spsc_ring_release(&fifo->ring);
 
 	return true;
 }
 
-bool ls_frame_fifo_push(ls_frame_fifo_t *fifo, ls_frame_t *frame) {
-	if (ls_frame_fifo_full(fifo)) {
-		return false;
-	}
-
-	int c = irq_disable();
+ls_frame_t *ls_frame_fifo_peek(ls_frame_fifo_t *fifo) {
+	return ls_spsc_ring_peek(&fifo->ring);
+}
 
-	if (ls_frame_fifo_empty(fifo)) {
-		fifo->front = fifo->rear = 0;
-	} else {
-		fifo->rear = (fifo->rear + 1) % LS_MAX_FRAME_FIFO_SIZE;
+bool ls_frame_fifo_push(ls_frame_fifo_t *fifo, const ls_frame_t *frame) {
+	ls_frame_t *slot = ls_frame_fifo_reserve(fifo);
+	if (slot == NULL) {
+		return false;
 	}
 
-	fifo->fifo[fifo->rear] = *frame;
-
-	irq_restore(c);
+	*slot = *frame;
+	ls_frame_fifo_commit(fifo);
 
 	return true;
 }
 
 bool ls_frame_fifo_full(ls_frame_fifo_t *fifo) {
-	return ((fifo->rear + 1) % LS_MAX_FRAME_FIFO_SIZE) == fifo->front;
+	return ls_spsc_ring_full(&fifo->ring);
 }
 
 bool ls_frame_fifo_empty(ls_frame_fifo_t *fifo) {
-	return (fifo->front == -1 && fifo->rear == -1);
+	return ls_spsc_ring_empty(&fifo->ring);
 }
 
 int ls_frame_fifo_size(ls_frame_fifo_t *fifo) {
-	if (ls_frame_fifo_empty(fifo)) {
-		return 0;
-	}
-
-	int size = fifo->rear - fifo->front;
-
-	/* Front may be ahead of rear */
-	if (size < 0)
-		size = -size;
-
-	return size;
+	return ls_spsc_ring_size(&fifo->ring);
 }
 
 void ls_frame_fifo_clear(ls_frame_fifo_t *fifo) {
-	int c = irq_disable();
-	fifo->front = fifo->rear = -1;
-	irq_restore(c);
+	ls_spsc_ring_clear(&fifo->ring);
 }
 
 #ifdef __cplusplus
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2016-2018 Unwired Devices LLC <info@unwds.com>
+
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @defgroup
+ * @ingroup
+ * @brief
+ * @{
+ * @file		unwds-batch.h
+ * @brief       Aggregation of module reports into shared uplink frames
+ *
+ * Reports of the modules arriving within the aggregation window are sent
+ * in one frame instead of a frame per report. Aggregated frame starts with
+ * UNWDS_BATCH_MODULE_ID followed by a record per report:
+ *
+ *     | module ID (1) | length (1) | report without module ID (length) |
+ *
+ * Frame is sent when the window since its first report expires or when
+ * no more records fit. Frame with the single report is sent as the report
+ * itself. Replies to commands (as_ack reports) are never delayed, they are
+ * sent right after the reports collected before them.
+ *
+ * @author      Oleg Artamonov
+ */
+#ifndef UNWDS_BATCH_H_
+#define UNWDS_BATCH_H_
+
+#include <stdint.h>
+
+#include "unwds-common.h"
+
+/**
+ * @brief Default aggregation window [ms], 0 sends every report at once
+ */
+#ifndef UNWDS_BATCH_WINDOW_MS
+#define UNWDS_BATCH_WINDOW_MS		(0)
+#endif
+
+/**
+ * @brief Per-frame overhead of the network saved by every aggregated report [bytes]
+ *
+ * LoRaLAN header, payload length, AES block padding and PHY header with CRC.
+ */
+#ifndef UNWDS_BATCH_FRAME_OVERHEAD
+#define UNWDS_BATCH_FRAME_OVERHEAD	(24)
+#endif
+
+#define UNWDS_BATCH_RECORD_HDR_LEN	(2)		/**< Module ID and length of the record */
+#define UNWDS_BATCH_MIN_RECORD_LEN	(4)		/**< Frame is sent when less space is left */
+
+#define UNWDS_BATCH_STACK_SIZE		(1024)
+
+/**
+ * @brief Aggregation statistics
+ */
+typedef struct {
+	uint32_t reports;			/**< Reports received from the modules */
+	uint32_t frames;			/**< Frames sent, aggregated or not */
+	uint32_t aggregated;		/**< Reports sent in aggregated frames */
+	uint32_t flush_size;		/**< Frames sent because they were full */
+	uint32_t flush_deadline;	/**< Frames sent because the window expired */
+	uint32_t bytes_saved;		/**< Bytes not sent on air thanks to aggregation */
+} unwds_batch_stats_t;
+
+/**
+ * @brief Starts aggregation thread, frames are passed to send_cb
+ */
+void unwds_batch_init(uwnds_cb_t *send_cb);
+
+/**
+ * @brief Queues module report, to be passed to unwds_init_modules() as the modules callback
+ */
+void unwds_batch_add(module_data_t *report);
+
+/**
+ * @brief Sends collected reports now
+ */
+void unwds_batch_flush(void);
+
+/**
+ * @brief Sets aggregation window [ms], 0 disables aggregation
+ */
+void unwds_batch_set_window(uint32_t window_ms);
+
+/**
+ * @brief Returns aggregation statistics
+ */
+const unwds_batch_stats_t *unwds_batch_get_stats(void);
+
+#endif /* UNWDS_BATCH_H_ */
@@ -91,6 +91,13 @@ uint8_t *allocate_stack_name(uint32_t stack_size, const char* caller_name);
 #define UNWDS_MODULE_HAS_DATA   1
 #define UNWDS_MODULE_NOT_FOUND  255
 
+/**
+ * @brief Delay allowed to periodic reports of the modules [ms], lets the reports share wakeups
+ */
+#ifndef UNWDS_PUBLISH_SLACK_MS
+#define UNWDS_PUBLISH_SLACK_MS (1000)
+#endif
+
 #if defined(UNWDS_BUILD_MINIMAL)
     #define UNWDS_SHELL_COMMANDS_MAX (12)
 #else
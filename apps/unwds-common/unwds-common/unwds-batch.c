@@ -0,0 +1,251 @@
+/*
+ * Copyright (C) 2016-2018 Unwired Devices LLC <info@unwds.com>
+
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the Software
+ * is furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @defgroup
+ * @ingroup
+ * @brief
+ * @{
+ * @file		unwds-batch.c
+ * @brief       Aggregation of module reports into shared uplink frames
+ * @author      Oleg Artamonov
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "thread.h"
+#include "mutex.h"
+#include "msg.h"
+#include "rtctimers-millis.h"
+
+#include "unwds-common.h"
+#include "unwds-batch.h"
+#include "umdk-ids.h"
+
+#define ENABLE_DEBUG (0)
+#include "debug.h"
+
+static uwnds_cb_t *send_cb;
+
+static module_data_t batch;
+static unsigned num_records;
+
+static uint32_t window_ms = UNWDS_BATCH_WINDOW_MS;
+static unwds_batch_stats_t stats;
+
+static mutex_t batch_mutex = MUTEX_INIT;
+
+static kernel_pid_t timer_pid = KERNEL_PID_UNDEF;
+static rtctimers_millis_t timer;
+static msg_t timer_msg;
+
+/* Distinguishes window timer of the current frame from the stale ones */
+static uint32_t window_seq;
+
+static void send_frame(module_data_t *frame)
+{
+	stats.frames++;
+	send_cb(frame);
+}
+
+/**
+ * @brief Sends collected reports, batch mutex must be held
+ */
+static void flush_locked(void)
+{
+	if (num_records == 0) {
+		return;
+	}
+
+	rtctimers_millis_remove(&timer);
+	window_seq++;
+
+	if (num_records == 1) {
+		/* Single report goes as is: module ID, then the report */
+		module_data_t report = { .as_ack = false };
+		uint8_t len = batch.data[2];
+
+		report.data[0] = batch.data[1];
+		memcpy(&report.data[1], &batch.data[1 + UNWDS_BATCH_RECORD_HDR_LEN], len);
+		report.length = 1 + len;
+
+		send_frame(&report);
+	}
+	else {
+		/* Every record but the first saves a frame and costs a length byte, frame ID costs one more */
+		int saved = (num_records - 1) * UNWDS_BATCH_FRAME_OVERHEAD - num_records - 1;
+		if (saved > 0) {
+			stats.bytes_saved += saved;
+		}
+		stats.aggregated += num_records;
+
+		DEBUG("unwds-batch: %u reports in %u bytes\n", num_records, batch.length);
+
+		send_frame(&batch);
+	}
+
+	num_records = 0;
+	batch.length = 0;
+}
+
+static void *timer_thread(void *arg)
+{
+	(void)arg;
+
+	msg_t msg;
+
+	while (1) {
+		msg_receive(&msg);
+
+		mutex_lock(&batch_mutex);
+
+		if ((msg.content.value == window_seq) && (num_records > 0)) {
+			stats.flush_deadline++;
+			flush_locked();
+		}
+
+		mutex_unlock(&batch_mutex);
+	}
+
+	return NULL;
+}
+
+void unwds_batch_add(module_data_t *report)
+{
+	mutex_lock(&batch_mutex);
+
+	stats.reports++;
+
+	size_t record_len = UNWDS_BATCH_RECORD_HDR_LEN + report->length - 1;
+
+	/* Replies to commands, reports too large to share a frame and reports without aggregation */
+	if ((window_ms == 0) || (timer_pid <= KERNEL_PID_UNDEF) || report->as_ack ||
+		(report->length < 1) || (1 + record_len > UNWDS_MAX_DATA_LEN)) {
+		/* Keep the order of the reports */
+		flush_locked();
+		send_frame(report);
+
+		mutex_unlock(&batch_mutex);
+		return;
+	}
+
+	if (batch.length + record_len > UNWDS_MAX_DATA_LEN) {
+		stats.flush_size++;
+		flush_locked();
+	}
+
+	if (num_records == 0) {
+		batch.data[0] = UNWDS_BATCH_MODULE_ID;
+		batch.length = 1;
+		batch.as_ack = false;
+
+		/* Window starts with the first report of the frame */
+		timer_msg.content.value = window_seq;
+		rtctimers_millis_set_msg(&timer, window_ms, &timer_msg, timer_pid);
+	}
+
+	uint8_t *rec = &batch.data[batch.length];
+	rec[0] = report->data[0];
+	rec[1] = report->length - 1;
+	memcpy(&rec[UNWDS_BATCH_RECORD_HDR_LEN], &report->data[1], report->length - 1);
+
+	batch.length += record_len;
+	num_records++;
+
+	if (UNWDS_MAX_DATA_LEN - batch.length < UNWDS_BATCH_MIN_RECORD_LEN) {
+		stats.flush_size++;
+		flush_locked();
+	}
+
+	mutex_unlock(&batch_mutex);
+}
+
+void unwds_batch_flush(void)
+{
+	mutex_lock(&batch_mutex);
+	flush_locked();
+	mutex_unlock(&batch_mutex);
+}
+
+void unwds_batch_set_window(uint32_t window)
+{
+	mutex_lock(&batch_mutex);
+
+	window_ms = window;
+
+	/* New window applies to the next frame */
+	flush_locked();
+
+	mutex_unlock(&batch_mutex);
+}
+
+const unwds_batch_stats_t *unwds_batch_get_stats(void)
+{
+	return &stats;
+}
+
+static int batch_cmd(int argc, char **argv)
+{
+	if (argc == 2) {
+		unwds_batch_set_window(strtoul(argv[1], NULL, 10));
+	}
+	else if (argc > 2) {
+		puts("usage: batch [<window ms>]");
+		return 1;
+	}
+
+	printf("Aggregation window: %u ms\n", (unsigned int) window_ms);
+	printf("Reports: %u, frames: %u, aggregated reports: %u\n",
+		   (unsigned int) stats.reports, (unsigned int) stats.frames, (unsigned int) stats.aggregated);
+	printf("Sent when full: %u, on deadline: %u\n",
+		   (unsigned int) stats.flush_size, (unsigned int) stats.flush_deadline);
+	printf("Bytes saved: %u\n", (unsigned int) stats.bytes_saved);
+
+	return 0;
+}
+
+void unwds_batch_init(uwnds_cb_t *cb)
+{
+	send_cb = cb;
+
+	char *stack = (char *) allocate_stack(UNWDS_BATCH_STACK_SIZE);
+	if (!stack) {
+		puts("unwds-batch: unable to allocate memory, aggregation disabled");
+		return;
+	}
+
+	timer_pid = thread_create(stack, UNWDS_BATCH_STACK_SIZE, THREAD_PRIORITY_MAIN - 1, THREAD_CREATE_STACKTEST,
+							  timer_thread, NULL, "batch thread");
+
+	unwds_add_shell_command("batch", "[<window ms>] -- set reports aggregation window, print statistics", batch_cmd);
+}
+
+#ifdef __cplusplus
+}
+#endif
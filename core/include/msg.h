@@ -272,6 +272,28 @@ int msg_send_to_self(msg_t *m);
  */
 int msg_send_int(msg_t *m, kernel_pid_t target_pid);
 
+/**
+ * @brief Send several messages to one thread (non-blocking).
+ *
+ * All messages are delivered in a single critical section: if the target is
+ * waiting for a message it gets the first one directly, the rest is put
+ * into its message queue. At most one context switch happens, after all
+ * messages are delivered. Sending stops at the first message the target
+ * cannot take, so this is meant for targets with a message queue.
+ *
+ * May be called from an interrupt, ``sender_pid`` of the messages is then
+ * set to @ref KERNEL_PID_ISR.
+ *
+ * @param[in] m             Array of @p num preallocated ``msg_t``
+ *                          structures, must not be NULL.
+ * @param[in] num           Number of messages in @p m
+ * @param[in] target_pid    PID of target thread
+ *
+ * @return number of messages sent, from the start of @p m
+ * @return -1, on error (invalid PID)
+ */
+int msg_try_send_many(msg_t *m, unsigned num, kernel_pid_t target_pid);
+
 /**
  * @brief Test if the message was sent inside an ISR.
  * @see msg_send_int()
@@ -309,6 +331,35 @@ int msg_receive(msg_t *m);
  */
 int msg_try_receive(msg_t *m);
 
+/**
+ * @brief Receive up to @p num messages.
+ *
+ * Takes all messages available in the message queue and from blocked
+ * senders, up to @p num, in a single critical section. Blocks until at
+ * least one message was received.
+ *
+ * @param[out] m    Array of @p num preallocated ``msg_t`` structures, must
+ *                  not be NULL.
+ * @param[in] num   Size of @p m, must be greater than 0
+ *
+ * @return  number of messages received, at least 1
+ */
+int msg_receive_many(msg_t *m, unsigned num);
+
+/**
+ * @brief Try to receive up to @p num messages.
+ *
+ * Like msg_receive_many(), but does not block if no message can be
+ * received.
+ *
+ * @param[out] m    Array of @p num preallocated ``msg_t`` structures, must
+ *                  not be NULL.
+ * @param[in] num   Size of @p m, must be greater than 0
+ *
+ * @return  number of messages received, 0 if there were none
+ */
+int msg_try_receive_many(msg_t *m, unsigned num);
+
 /**
  * @brief Send a message, block until reply received.
  *
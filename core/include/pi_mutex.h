@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    core_pi_mutex Priority inheritance mutex
+ * @brief       Mutex lending the priority of its waiters to its owner
+ * @ingroup     core_sync
+ *
+ * A thread holding a @ref pi_mutex_t runs with the priority of the most
+ * urgent thread waiting for it. A low priority owner therefore can not be
+ * kept from releasing the mutex by medium priority threads, and the wait of
+ * a high priority thread is bounded by the critical sections of the threads
+ * it waits for. The inherited priority is passed along a chain of owners
+ * blocked on other priority inheritance mutexes and dropped on unlock.
+ *
+ * Unlike @ref mutex_t, a priority inheritance mutex must be unlocked by the
+ * thread holding it, and never from an interrupt.
+ *
+ * Enable with `USEMODULE += core_pi_mutex`.
+ *
+ * @{
+ *
+ * @file
+ * @brief       Priority inheritance mutex API
+ */
+
+#ifndef PI_MUTEX_H
+#define PI_MUTEX_H
+
+#include "mutex.h"
+#include "sched.h"
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/**
+ * @brief Priority inheritance mutex structure. Must never be modified by the
+ *        user.
+ */
+typedef struct pi_mutex {
+    mutex_t mutex;              /**< lock state and waiters in priority order */
+    thread_t *owner;            /**< thread holding the mutex */
+    struct pi_mutex *next_held; /**< next mutex held by the owner */
+} pi_mutex_t;
+
+/**
+ * @brief Static initializer for pi_mutex_t.
+ */
+#define PI_MUTEX_INIT { MUTEX_INIT, NULL, NULL }
+
+/**
+ * @brief Initializes a priority inheritance mutex object.
+ *
+ * @param[out] mutex    pre-allocated mutex structure, must not be NULL.
+ */
+static inline void pi_mutex_init(pi_mutex_t *mutex)
+{
+    mutex_init(&mutex->mutex);
+    mutex->owner = NULL;
+    mutex->next_held = NULL;
+}
+
+/**
+ * @brief Lock a priority inheritance mutex, blocking or non-blocking.
+ *
+ * @details For commit purposes you should probably use pi_mutex_trylock()
+ *          and pi_mutex_lock() instead.
+ *
+ * @param[in] mutex     Mutex object to lock. Has to be initialized first.
+ *                      Must not be NULL.
+ * @param[in] blocking  if true, block until mutex is available.
+ *
+ * @return 1 if mutex was unlocked, now it is locked.
+ * @return 0 if the mutex was locked.
+ */
+int _pi_mutex_lock(pi_mutex_t *mutex, int blocking);
+
+/**
+ * @brief Tries to get a priority inheritance mutex, non-blocking.
+ *
+ * @param[in] mutex Mutex object to lock. Has to be initialized first.
+ *                  Must not be NULL.
+ *
+ * @return 1 if mutex was unlocked, now it is locked.
+ * @return 0 if the mutex was locked.
+ */
+static inline int pi_mutex_trylock(pi_mutex_t *mutex)
+{
+    return _pi_mutex_lock(mutex, 0);
+}
+
+/**
+ * @brief Locks a priority inheritance mutex, blocking.
+ *
+ * While blocked, the owner of the mutex (and the owners of the mutexes it
+ * waits for in turn) run at least at the priority of the calling thread.
+ *
+ * @param[in] mutex Mutex object to lock. Has to be initialized first.
+ *                  Must not be NULL.
+ */
+static inline void pi_mutex_lock(pi_mutex_t *mutex)
+{
+    _pi_mutex_lock(mutex, 1);
+}
+
+/**
+ * @brief Unlocks a priority inheritance mutex.
+ *
+ * The mutex is handed over to the most urgent waiter, the calling thread
+ * drops the priority inherited through this mutex.
+ *
+ * @pre The calling thread holds @p mutex.
+ *
+ * @param[in] mutex Mutex object to unlock, must not be NULL.
+ */
+void pi_mutex_unlock(pi_mutex_t *mutex);
+
+/**
+ * @brief Unlocks a priority inheritance mutex and sends the current thread
+ *        to sleep
+ *
+ * @pre The calling thread holds @p mutex.
+ *
+ * @param[in] mutex Mutex object to unlock, must not be NULL.
+ */
+void pi_mutex_unlock_and_sleep(pi_mutex_t *mutex);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PI_MUTEX_H */
+/** @} */
@@ -133,6 +133,19 @@ void sched_set_status(thread_t *process, unsigned int status);
  */
 void sched_switch(uint16_t other_prio);
 
+/**
+ * @brief       Change the priority of a thread
+ *
+ * @details     A thread on the run queue is moved to the run queue of its new
+ *              priority, the active thread stays first in it. No context
+ *              switch is done, call sched_switch() or thread_yield_higher()
+ *              afterwards if needed.
+ *
+ * @param[in]   thread      Thread to change the priority of
+ * @param[in]   priority    New priority, less than @ref SCHED_PRIO_LEVELS
+ */
+void sched_change_priority(thread_t *thread, uint8_t priority);
+
 /**
  * @brief   Call context switching at thread exit
  */
@@ -201,6 +201,13 @@ struct _thread {
     msg_t *msg_array;               /**< memory holding messages sent
                                          to this thread's message queue */
 #endif
+#if defined(MODULE_CORE_PI_MUTEX) || defined(DOXYGEN)
+    uint8_t base_priority;          /**< priority without inheritance   */
+    struct pi_mutex *pi_held;       /**< priority inheritance mutexes
+                                         held by this thread            */
+    struct pi_mutex *pi_wait;       /**< priority inheritance mutex this
+                                         thread is blocked on           */
+#endif
 #if defined(DEVELHELP) || defined(SCHED_TEST_STACK) \
     || defined(MODULE_MPU_STACK_GUARD) || defined(DOXYGEN)
     char *stack_start;              /**< thread's stack start address   */
@@ -32,11 +32,21 @@
 #endif
 #include "irq.h"
 #include "cib.h"
+#ifdef MODULE_SCHED_PROF
+#include "sched_prof.h"
+#endif
+#ifdef MODULE_SCHED_TRACE
+#include "sched_trace.h"
+#define TRACE(event, arg8, arg16)   sched_trace_record(event, arg8, arg16)
+#else
+#define TRACE(event, arg8, arg16)
+#endif
 
 #define ENABLE_DEBUG    (0)
 #include "debug.h"
 
 static int _msg_receive(msg_t *m, int block);
+static int _msg_receive_many(msg_t *m, unsigned num, int block);
 static int _msg_send(msg_t *m, kernel_pid_t target_pid, bool block, unsigned state);
 
 static int queue_msg(thread_t *target, const msg_t *m)
@@ -50,6 +60,9 @@ static int queue_msg(thread_t *target, const msg_t *m)
     DEBUG("queue_msg(): queuing message\n");
     msg_t *dest = &target->msg_array[n];
     *dest = *m;
+#ifdef MODULE_SCHED_PROF
+    sched_prof_msg_queued(target->pid, cib_avail(&(target->msg_queue)));
+#endif
 #if MODULE_CORE_THREAD_FLAGS
     target->flags |= THREAD_FLAG_MSG_WAITING;
     thread_flags_wake(target);
@@ -97,6 +110,8 @@ static int _msg_send(msg_t *m, kernel_pid_t target_pid, bool block, unsigned sta
         return -1;
     }
 
+    TRACE(SCHED_TRACE_MSG_SEND, target_pid, m->type);
+
     thread_t *me = (thread_t *) sched_active_thread;
 
     DEBUG("msg_send() %s:%i: Sending from %" PRIkernel_pid " to %" PRIkernel_pid
@@ -176,6 +191,7 @@ int msg_send_to_self(msg_t *m)
     unsigned state = irq_disable();
 
     m->sender_pid = sched_active_pid;
+    TRACE(SCHED_TRACE_MSG_SEND, sched_active_pid, m->type);
     int res = queue_msg((thread_t *) sched_active_thread, m);
 
     irq_restore(state);
@@ -198,6 +214,7 @@ int msg_send_int(msg_t *m, kernel_pid_t target_pid)
     }
 
     m->sender_pid = KERNEL_PID_ISR;
+    TRACE(SCHED_TRACE_MSG_SEND, target_pid, m->type);
     if (target->status == STATUS_RECEIVE_BLOCKED) {
         DEBUG("msg_send_int: Direct msg copy from %" PRIkernel_pid " to %"
               PRIkernel_pid ".\n", thread_getpid(), target_pid);
@@ -217,6 +234,68 @@ int msg_send_int(msg_t *m, kernel_pid_t target_pid)
     }
 }
 
+int msg_try_send_many(msg_t *m, unsigned num, kernel_pid_t target_pid)
+{
+#ifdef DEVELHELP
+    if (!pid_is_valid(target_pid)) {
+        DEBUG("msg_try_send_many(): target_pid is invalid, continuing anyways\n");
+    }
+#endif /* DEVELHELP */
+
+    int in_isr = irq_is_in();
+    unsigned state = irq_disable();
+
+    thread_t *target = (thread_t *) sched_threads[target_pid];
+
+    if (target == NULL) {
+        DEBUG("msg_try_send_many(): target thread does not exist\n");
+        irq_restore(state);
+        return -1;
+    }
+
+    if (num > 0) {
+        TRACE(SCHED_TRACE_MSG_SEND, target_pid, m[0].type);
+    }
+
+    kernel_pid_t sender_pid = in_isr ? KERNEL_PID_ISR : sched_active_pid;
+    unsigned n = 0;
+    int woken = 0;
+
+    if ((num > 0) && (target->status == STATUS_RECEIVE_BLOCKED)) {
+        DEBUG("msg_try_send_many: Direct msg copy to %" PRIkernel_pid ".\n",
+              target_pid);
+        m[0].sender_pid = sender_pid;
+        *((msg_t *) target->wait_data) = m[0];
+        sched_set_status(target, STATUS_PENDING);
+        woken = 1;
+        n++;
+    }
+
+    /* the rest goes to the queue, all in the same critical section */
+    for (; n < num; n++) {
+        m[n].sender_pid = sender_pid;
+        if (!queue_msg(target, &m[n])) {
+            break;
+        }
+    }
+
+    DEBUG("msg_try_send_many: %u of %u messages sent to %" PRIkernel_pid ".\n",
+          n, num, target_pid);
+
+    irq_restore(state);
+
+    if (woken) {
+        if (in_isr) {
+            sched_context_switch_request = 1;
+        }
+        else {
+            thread_yield_higher();
+        }
+    }
+
+    return n;
+}
+
 int msg_send_receive(msg_t *m, msg_t *reply, kernel_pid_t target_pid)
 {
     assert(sched_active_pid != target_pid);
@@ -278,12 +357,18 @@ int msg_reply_int(msg_t *m, msg_t *reply)
 
 int msg_try_receive(msg_t *m)
 {
-    return _msg_receive(m, 0);
+    int res = _msg_receive(m, 0);
+    if (res > 0) {
+        TRACE(SCHED_TRACE_MSG_RECV, m->sender_pid, m->type);
+    }
+    return res;
 }
 
 int msg_receive(msg_t *m)
 {
-    return _msg_receive(m, 1);
+    int res = _msg_receive(m, 1);
+    TRACE(SCHED_TRACE_MSG_RECV, m->sender_pid, m->type);
+    return res;
 }
 
 static int _msg_receive(msg_t *m, int block)
@@ -324,6 +409,7 @@ static int _msg_receive(msg_t *m, int block)
         if (queue_index < 0) {
             DEBUG("_msg_receive(): %" PRIkernel_pid ": No msg in queue. Going blocked.\n",
                   sched_active_thread->pid);
+            TRACE(SCHED_TRACE_MSG_WAIT, 0, 0);
             sched_set_status(me, STATUS_RECEIVE_BLOCKED);
 
             irq_restore(state);
@@ -372,6 +458,103 @@ static int _msg_receive(msg_t *m, int block)
     DEBUG("This should have never been reached!\n");
 }
 
+int msg_receive_many(msg_t *m, unsigned num)
+{
+    int res = _msg_receive_many(m, num, 1);
+    for (int i = 0; i < res; i++) {
+        TRACE(SCHED_TRACE_MSG_RECV, m[i].sender_pid, m[i].type);
+    }
+    return res;
+}
+
+int msg_try_receive_many(msg_t *m, unsigned num)
+{
+    int res = _msg_receive_many(m, num, 0);
+    for (int i = 0; i < res; i++) {
+        TRACE(SCHED_TRACE_MSG_RECV, m[i].sender_pid, m[i].type);
+    }
+    return res;
+}
+
+static int _msg_receive_many(msg_t *m, unsigned num, int block)
+{
+    assert(num > 0);
+
+    unsigned state = irq_disable();
+    DEBUG("_msg_receive_many: %" PRIkernel_pid ": up to %u messages.\n",
+          sched_active_thread->pid, num);
+
+    thread_t *me = (thread_t*) sched_threads[sched_active_pid];
+
+    unsigned n = 0;
+
+    if (me->msg_array) {
+        int queue_index;
+        while ((n < num) && ((queue_index = cib_get(&(me->msg_queue))) >= 0)) {
+            m[n++] = me->msg_array[queue_index];
+        }
+    }
+
+    /* Waiting senders come after the queued messages: they are taken
+     * directly while there is room in @p m, then into the freed queue space.
+     */
+    uint16_t sender_prio = THREAD_PRIORITY_IDLE;
+    while (me->msg_waiters.next) {
+        msg_t *dest;
+
+        if (n < num) {
+            dest = &m[n++];
+        }
+        else if (me->msg_array && !cib_full(&(me->msg_queue))) {
+            dest = &(me->msg_array[cib_put(&(me->msg_queue))]);
+        }
+        else {
+            break;
+        }
+
+        list_node_t *next = list_remove_head(&me->msg_waiters);
+        thread_t *sender = container_of((clist_node_t*)next, thread_t, rq_entry);
+
+        /* copy msg */
+        *dest = *((msg_t*) sender->wait_data);
+
+        /* remove sender from queue */
+        if (sender->status != STATUS_REPLY_BLOCKED) {
+            sender->wait_data = NULL;
+            sched_set_status(sender, STATUS_PENDING);
+            if (sender->priority < sender_prio) {
+                sender_prio = sender->priority;
+            }
+        }
+    }
+
+    if (n == 0) {
+        if (!block) {
+            irq_restore(state);
+            return 0;
+        }
+
+        DEBUG("_msg_receive_many(): %" PRIkernel_pid ": No msg in queue. Going blocked.\n",
+              sched_active_thread->pid);
+        TRACE(SCHED_TRACE_MSG_WAIT, 0, 0);
+        me->wait_data = (void *) m;
+        sched_set_status(me, STATUS_RECEIVE_BLOCKED);
+
+        irq_restore(state);
+        thread_yield_higher();
+
+        /* sender copied message */
+        return 1;
+    }
+
+    irq_restore(state);
+    if (sender_prio < THREAD_PRIORITY_IDLE) {
+        sched_switch(sender_prio);
+    }
+
+    return n;
+}
+
 int msg_avail(void)
 {
     DEBUG("msg_available: %" PRIkernel_pid ": msg_available.\n",
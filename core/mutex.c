@@ -29,6 +29,10 @@
 #include "irq.h"
 #include "list.h"
 
+#ifdef MODULE_SCHED_TRACE
+#include "sched_trace.h"
+#endif
+
 #define ENABLE_DEBUG    (0)
 #include "debug.h"
 
@@ -50,6 +54,9 @@ int _mutex_lock(mutex_t *mutex, int blocking)
         thread_t *me = (thread_t*)sched_active_thread;
         DEBUG("PID[%" PRIkernel_pid "]: Adding node to mutex queue: prio: %"
               PRIu32 "\n", sched_active_pid, (uint32_t)me->priority);
+#ifdef MODULE_SCHED_TRACE
+        sched_trace_record(SCHED_TRACE_MUTEX_WAIT, 0, (uintptr_t)mutex);
+#endif
         sched_set_status(me, STATUS_MUTEX_BLOCKED);
         if (mutex->queue.next == MUTEX_LOCKED) {
             mutex->queue.next = (list_node_t*)&me->rq_entry;
@@ -96,6 +103,9 @@ void mutex_unlock(mutex_t *mutex)
 
     DEBUG("mutex_unlock: waking up waiting thread %" PRIkernel_pid "\n",
           process->pid);
+#ifdef MODULE_SCHED_TRACE
+    sched_trace_record(SCHED_TRACE_MUTEX_WAKE, process->pid, (uintptr_t)mutex);
+#endif
     sched_set_status(process, STATUS_PENDING);
 
     if (!mutex->queue.next) {
@@ -122,6 +132,10 @@ void mutex_unlock_and_sleep(mutex_t *mutex)
             thread_t *process = container_of((clist_node_t*)next, thread_t,
                                              rq_entry);
             DEBUG("PID[%" PRIkernel_pid "]: waking up waiter.\n", process->pid);
+#ifdef MODULE_SCHED_TRACE
+            sched_trace_record(SCHED_TRACE_MUTEX_WAKE, process->pid,
+                               (uintptr_t)mutex);
+#endif
             sched_set_status(process, STATUS_PENDING);
             if (!mutex->queue.next) {
                 mutex->queue.next = MUTEX_LOCKED;
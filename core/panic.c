@@ -36,6 +36,10 @@
 #include "ps.h"
 #endif
 
+#ifdef MODULE_SCHED_TRACE
+#include "sched_trace.h"
+#endif
+
 const char assert_crash_message[] = "FAILED ASSERTION.";
 
 /* flag preventing "recursive crash printing loop" */
@@ -59,6 +63,10 @@ NORETURN void core_panic(core_panic_t crash_code, const char *message)
         }
 #endif
         LOG_ERROR("*** RIOT kernel panic:\n%s\n\n", message);
+#ifdef MODULE_SCHED_TRACE
+        /* what the threads did right before the crash */
+        sched_trace_dump();
+#endif
 #ifdef DEVELHELP
 #ifdef MODULE_PS
         ps();
@@ -0,0 +1,257 @@
+/*
+ * Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     core_pi_mutex
+ * @{
+ *
+ * @file
+ * @brief       Priority inheritance mutex implementation
+ *
+ * @}
+ */
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdbool.h>
+
+#include "pi_mutex.h"
+#include "thread.h"
+#include "sched.h"
+#include "irq.h"
+#include "list.h"
+
+#ifdef MODULE_SCHED_TRACE
+#include "sched_trace.h"
+#endif
+
+#define ENABLE_DEBUG    (0)
+#include "debug.h"
+
+static void _held_push(thread_t *thread, pi_mutex_t *mutex)
+{
+    mutex->owner = thread;
+    mutex->next_held = thread->pi_held;
+    thread->pi_held = mutex;
+}
+
+static void _held_remove(thread_t *thread, pi_mutex_t *mutex)
+{
+    pi_mutex_t **pp = &thread->pi_held;
+
+    while (*pp != mutex) {
+        assert(*pp != NULL);
+        pp = &(*pp)->next_held;
+    }
+
+    *pp = mutex->next_held;
+    mutex->next_held = NULL;
+    mutex->owner = NULL;
+}
+
+static thread_t *_first_waiter(pi_mutex_t *mutex)
+{
+    list_node_t *next = mutex->mutex.queue.next;
+
+    if ((next == NULL) || (next == MUTEX_LOCKED)) {
+        return NULL;
+    }
+
+    return container_of((clist_node_t*)next, thread_t, rq_entry);
+}
+
+static void _waiter_add(pi_mutex_t *mutex, thread_t *thread)
+{
+    if (mutex->mutex.queue.next == MUTEX_LOCKED) {
+        mutex->mutex.queue.next = (list_node_t*)&thread->rq_entry;
+        mutex->mutex.queue.next->next = NULL;
+    }
+    else {
+        thread_add_to_list(&mutex->mutex.queue, thread);
+    }
+}
+
+static void _waiter_remove(pi_mutex_t *mutex, thread_t *thread)
+{
+    list_remove(&mutex->mutex.queue, (list_node_t*)&thread->rq_entry);
+
+    if (!mutex->mutex.queue.next) {
+        mutex->mutex.queue.next = MUTEX_LOCKED;
+    }
+}
+
+/**
+ * @brief   Priority @p thread is entitled to: its own one or the one of the
+ *          most urgent waiter of the mutexes it holds
+ */
+static uint8_t _effective_priority(thread_t *thread)
+{
+    uint8_t priority = thread->base_priority;
+
+    for (pi_mutex_t *held = thread->pi_held; held; held = held->next_held) {
+        thread_t *waiter = _first_waiter(held);
+        if (waiter && (waiter->priority < priority)) {
+            priority = waiter->priority;
+        }
+    }
+
+    return priority;
+}
+
+/**
+ * @brief   Lends @p priority to the owner of @p mutex and down the chain of
+ *          owners it is blocked on
+ *
+ * Stops at the first owner already running at this priority or higher, so a
+ * deadlock cycle is walked at most once.
+ */
+static void _inherit(pi_mutex_t *mutex, uint8_t priority)
+{
+    thread_t *owner = mutex->owner;
+
+    while (owner && (priority < owner->priority)) {
+        DEBUG("pi_mutex: thread %" PRIkernel_pid " inherits priority %" PRIu8
+              "\n", owner->pid, priority);
+        sched_change_priority(owner, priority);
+
+        mutex = owner->pi_wait;
+        if (mutex == NULL) {
+            break;
+        }
+
+        /* keep the priority order of the queue the owner waits in */
+        _waiter_remove(mutex, owner);
+        _waiter_add(mutex, owner);
+
+        owner = mutex->owner;
+    }
+}
+
+/**
+ * @brief   Hands @p mutex over to its first waiter, if any, and drops the
+ *          priority the current thread inherited through it
+ *
+ * @return  true if a thread more urgent than the current one became runnable
+ */
+static bool _release(pi_mutex_t *mutex)
+{
+    thread_t *me = (thread_t*)sched_active_thread;
+    assert(mutex->owner == me);
+
+    _held_remove(me, mutex);
+
+    thread_t *next = NULL;
+
+    if (mutex->mutex.queue.next == MUTEX_LOCKED) {
+        mutex->mutex.queue.next = NULL;
+    }
+    else {
+        list_node_t *node = list_remove_head(&mutex->mutex.queue);
+        next = container_of((clist_node_t*)node, thread_t, rq_entry);
+
+        if (!mutex->mutex.queue.next) {
+            mutex->mutex.queue.next = MUTEX_LOCKED;
+        }
+
+        DEBUG("pi_mutex_unlock: handing over to thread %" PRIkernel_pid "\n",
+              next->pid);
+
+        /* the remaining waiters are not more urgent than the new owner */
+        next->pi_wait = NULL;
+        _held_push(next, mutex);
+#ifdef MODULE_SCHED_TRACE
+        sched_trace_record(SCHED_TRACE_MUTEX_WAKE, next->pid, (uintptr_t)mutex);
+#endif
+        sched_set_status(next, STATUS_PENDING);
+    }
+
+    uint8_t priority = _effective_priority(me);
+    bool yield = (priority > me->priority);
+
+    if (priority != me->priority) {
+        DEBUG("pi_mutex_unlock: thread %" PRIkernel_pid " back to priority %"
+              PRIu8 "\n", me->pid, priority);
+        sched_change_priority(me, priority);
+    }
+
+    return yield || (next && (next->priority < me->priority));
+}
+
+int _pi_mutex_lock(pi_mutex_t *mutex, int blocking)
+{
+    unsigned irqstate = irq_disable();
+    thread_t *me = (thread_t*)sched_active_thread;
+
+    if (mutex->mutex.queue.next == NULL) {
+        /* mutex is unlocked. */
+        mutex->mutex.queue.next = MUTEX_LOCKED;
+        _held_push(me, mutex);
+        irq_restore(irqstate);
+        return 1;
+    }
+    else if (blocking) {
+        assert(mutex->owner != me);
+
+        DEBUG("PID[%" PRIkernel_pid "]: waiting for pi_mutex held by %"
+              PRIkernel_pid "\n", me->pid, mutex->owner->pid);
+
+#ifdef MODULE_SCHED_TRACE
+        sched_trace_record(SCHED_TRACE_MUTEX_WAIT, 0, (uintptr_t)mutex);
+#endif
+        sched_set_status(me, STATUS_MUTEX_BLOCKED);
+        _waiter_add(mutex, me);
+        me->pi_wait = mutex;
+
+        _inherit(mutex, me->priority);
+
+        irq_restore(irqstate);
+        thread_yield_higher();
+        /* The owner handed the mutex over to us on unlock. */
+        return 1;
+    }
+    else {
+        irq_restore(irqstate);
+        return 0;
+    }
+}
+
+void pi_mutex_unlock(pi_mutex_t *mutex)
+{
+    assert(!irq_is_in());
+
+    unsigned irqstate = irq_disable();
+
+    if (mutex->mutex.queue.next == NULL) {
+        /* the mutex was not locked */
+        irq_restore(irqstate);
+        return;
+    }
+
+    bool yield = _release(mutex);
+
+    irq_restore(irqstate);
+
+    if (yield) {
+        thread_yield_higher();
+    }
+}
+
+void pi_mutex_unlock_and_sleep(pi_mutex_t *mutex)
+{
+    assert(!irq_is_in());
+
+    unsigned irqstate = irq_disable();
+
+    if (mutex->mutex.queue.next) {
+        _release(mutex);
+    }
+
+    sched_set_status((thread_t*)sched_active_thread, STATUS_SLEEPING);
+    irq_restore(irqstate);
+    thread_yield_higher();
+}
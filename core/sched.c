@@ -19,6 +19,7 @@
  * @}
  */
 
+#include <assert.h>
 #include <stdint.h>
 
 #include "sched.h"
@@ -37,6 +38,18 @@
 #include "xtimer.h"
 #endif
 
+#ifdef MODULE_SCHED_PROF
+#include "sched_prof.h"
+#endif
+
+#ifdef MODULE_SCHED_TRACE
+#include "sched_trace.h"
+#endif
+
+#ifdef MODULE_SCHED_EDF
+#include "sched_edf.h"
+#endif
+
 #define ENABLE_DEBUG (0)
 #include "debug.h"
 
@@ -79,6 +92,32 @@ static void (*sched_cb) (uint32_t timestamp, uint32_t value) = NULL;
 schedstat sched_pidlist[KERNEL_PID_LAST + 1];
 #endif
 
+static inline void _runqueue_add(thread_t *thread)
+{
+#ifdef MODULE_SCHED_EDF
+    if (thread->priority == SCHED_EDF_PRIO) {
+        /* ordered by deadline instead of FIFO */
+        sched_edf_release(thread);
+        return;
+    }
+#endif
+    clist_rpush(&sched_runqueues[thread->priority], &(thread->rq_entry));
+}
+
+static inline void _runqueue_remove(thread_t *thread)
+{
+#ifdef MODULE_SCHED_EDF
+    if (thread->priority == SCHED_EDF_PRIO) {
+        /* a thread with an earlier deadline may have been queued in front of
+         * the active one */
+        sched_edf_complete(thread);
+        clist_remove(&sched_runqueues[thread->priority], &(thread->rq_entry));
+        return;
+    }
+#endif
+    clist_lpop(&sched_runqueues[thread->priority]);
+}
+
 int __attribute__((used)) sched_run(void)
 {
     sched_context_switch_request = 0;
@@ -132,6 +171,19 @@ int __attribute__((used)) sched_run(void)
     }
 #endif
 
+#ifdef MODULE_SCHED_PROF
+    sched_prof_switch(active_thread ? active_thread->pid : KERNEL_PID_UNDEF,
+                      next_thread->pid);
+#endif
+
+#ifdef MODULE_SCHED_TRACE
+    /* previous status tells whether it was preempted or blocked */
+    sched_trace_record(SCHED_TRACE_SWITCH, next_thread->pid,
+                       active_thread ? (uint8_t)active_thread->pid |
+                                       (active_thread->status << 8)
+                                     : (uint8_t)KERNEL_PID_UNDEF);
+#endif
+
     next_thread->status = STATUS_RUNNING;
     sched_active_pid = next_thread->pid;
     sched_active_thread = (volatile thread_t *) next_thread;
@@ -164,15 +216,18 @@ void sched_set_status(thread_t *process, unsigned int status)
         if (!(process->status >= STATUS_ON_RUNQUEUE)) {
             DEBUG("sched_set_status: adding thread %" PRIkernel_pid " to runqueue %" PRIu8 ".\n",
                   process->pid, process->priority);
-            clist_rpush(&sched_runqueues[process->priority], &(process->rq_entry));
+            _runqueue_add(process);
             runqueue_bitcache |= 1 << process->priority;
+#ifdef MODULE_SCHED_PROF
+            sched_prof_wakeup(process->pid);
+#endif
         }
     }
     else {
         if (process->status >= STATUS_ON_RUNQUEUE) {
             DEBUG("sched_set_status: removing thread %" PRIkernel_pid " to runqueue %" PRIu8 ".\n",
                   process->pid, process->priority);
-            clist_lpop(&sched_runqueues[process->priority]);
+            _runqueue_remove(process);
 
             if (!sched_runqueues[process->priority].next) {
                 runqueue_bitcache &= ~(1 << process->priority);
@@ -193,7 +248,15 @@ void sched_switch(uint16_t other_prio)
           ", other_prio=%" PRIu16 "\n",
           active_thread->pid, current_prio, on_runqueue, other_prio);
 
-    if (!on_runqueue || (current_prio > other_prio)) {
+    int preempt = (current_prio > other_prio);
+
+#ifdef MODULE_SCHED_EDF
+    if ((current_prio == SCHED_EDF_PRIO) && (other_prio == SCHED_EDF_PRIO)) {
+        preempt = sched_edf_preempt();
+    }
+#endif
+
+    if (!on_runqueue || preempt) {
         if (irq_is_in()) {
             DEBUG("sched_switch: setting sched_context_switch_request.\n");
             sched_context_switch_request = 1;
@@ -208,6 +271,49 @@ void sched_switch(uint16_t other_prio)
     }
 }
 
+void sched_change_priority(thread_t *thread, uint8_t priority)
+{
+    assert(priority < SCHED_PRIO_LEVELS);
+
+    unsigned irqstate = irq_disable();
+
+    if (thread->priority == priority) {
+        irq_restore(irqstate);
+        return;
+    }
+
+    DEBUG("sched_change_priority: thread %" PRIkernel_pid " from %" PRIu8
+          " to %" PRIu8 ".\n", thread->pid, thread->priority, priority);
+
+    if (thread->status >= STATUS_ON_RUNQUEUE) {
+        clist_remove(&sched_runqueues[thread->priority], &(thread->rq_entry));
+        if (!sched_runqueues[thread->priority].next) {
+            runqueue_bitcache &= ~(1 << thread->priority);
+        }
+
+        if (thread == sched_active_thread) {
+            clist_lpush(&sched_runqueues[priority], &(thread->rq_entry));
+        }
+        else {
+#ifdef MODULE_SCHED_EDF
+            if (priority == SCHED_EDF_PRIO) {
+                sched_edf_requeue(thread);
+            }
+            else {
+                clist_rpush(&sched_runqueues[priority], &(thread->rq_entry));
+            }
+#else
+            clist_rpush(&sched_runqueues[priority], &(thread->rq_entry));
+#endif
+        }
+        runqueue_bitcache |= 1 << priority;
+    }
+
+    thread->priority = priority;
+
+    irq_restore(irqstate);
+}
+
 NORETURN void sched_task_exit(void)
 {
     DEBUG("sched_task_exit: ending thread %" PRIkernel_pid "...\n", sched_active_thread->pid);
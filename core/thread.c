@@ -30,6 +30,14 @@
 #include "bitarithm.h"
 #include "sched.h"
 
+#ifdef MODULE_SCHED_PROF
+#include "sched_prof.h"
+#endif
+
+#ifdef MODULE_SCHED_EDF
+#include "sched_edf.h"
+#endif
+
 volatile thread_t *thread_get(kernel_pid_t pid)
 {
     if (pid_is_valid(pid)) {
@@ -101,7 +109,17 @@ void thread_yield(void)
     unsigned old_state = irq_disable();
     thread_t *me = (thread_t *)sched_active_thread;
     if (me->status >= STATUS_ON_RUNQUEUE) {
+#ifdef MODULE_SCHED_EDF
+        if (me->priority == SCHED_EDF_PRIO) {
+            /* behind the threads due at the same time or earlier */
+            sched_edf_requeue(me);
+        }
+        else {
+            clist_lpoprpush(&sched_runqueues[me->priority]);
+        }
+#else
         clist_lpoprpush(&sched_runqueues[me->priority]);
+#endif
     }
     irq_restore(old_state);
 
@@ -226,6 +244,20 @@ kernel_pid_t thread_create(char *stack, int stacksize, char priority, int flags,
     cb->priority = priority;
     cb->status = 0;
 
+#ifdef MODULE_SCHED_PROF
+    sched_prof_thread_init(pid);
+#endif
+
+#ifdef MODULE_SCHED_EDF
+    sched_edf_thread_init(pid);
+#endif
+
+#ifdef MODULE_CORE_PI_MUTEX
+    cb->base_priority = priority;
+    cb->pi_held = NULL;
+    cb->pi_wait = NULL;
+#endif
+
     cb->rq_entry.next = NULL;
 
 #ifdef MODULE_CORE_MSG
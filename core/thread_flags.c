@@ -23,6 +23,10 @@
 #include "irq.h"
 #include "thread.h"
 
+#ifdef MODULE_SCHED_TRACE
+#include "sched_trace.h"
+#endif
+
 #define ENABLE_DEBUG (0)
 #include "debug.h"
 
@@ -40,6 +44,9 @@ static void _thread_flags_wait(thread_flags_t mask, thread_t *thread, unsigned t
     DEBUG("_thread_flags_wait: me->flags=0x%08x me->mask=0x%08x. going blocked.\n",
             (unsigned)thread->flags, (unsigned)mask);
 
+#ifdef MODULE_SCHED_TRACE
+    sched_trace_record(SCHED_TRACE_FLAGS_WAIT, 0, mask);
+#endif
     thread->wait_data = (void *)(unsigned)mask;
     sched_set_status(thread, threadstate);
     irq_restore(irqstate);
@@ -124,6 +131,9 @@ void thread_flags_set(thread_t *thread, thread_flags_t mask)
 {
     DEBUG("thread_flags_set(): setting 0x%08x for pid %"PRIkernel_pid"\n", mask, thread->pid);
     unsigned state = irq_disable();
+#ifdef MODULE_SCHED_TRACE
+    sched_trace_record(SCHED_TRACE_FLAGS_SET, thread->pid, mask);
+#endif
     thread->flags |= mask;
     if (thread_flags_wake(thread)) {
         irq_restore(state);
@@ -37,6 +37,10 @@
 #include "thread.h"
 #include "cpu_conf.h"
 
+#ifdef MODULE_SCHED_TRACE
+#include "sched_trace.h"
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -179,6 +183,9 @@ static inline void cortexm_sleep(int deep)
  * This function is supposed to be called in the end of each ISR.
  */
 static inline void cortexm_isr_end(void) {
+#ifdef MODULE_SCHED_TRACE
+    sched_trace_record(SCHED_TRACE_ISR, __get_IPSR(), 0);
+#endif
     if (sched_context_switch_request) {
         thread_yield_higher();
     }
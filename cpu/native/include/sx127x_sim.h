@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    drivers_sx127x_sim Simulated SX127x
+ * @ingroup     native_cpu
+ * @brief       Simulated SX127x LoRa transceivers sharing one radio medium
+ *
+ * Devices implement the netdev interface of the sx127x driver (including
+ * @ref netdev_sx127x_lora_packet_info_t and the CRC error reporting from
+ * recv()), so LoRa stacks run on the native board unchanged. Packets are
+ * exchanged through a simulated air shared by all devices of the process:
+ *
+ * - time on air is calculated from spreading factor, bandwidth, coding rate,
+ *   preamble and payload length as in the SX1276 datasheet;
+ * - a packet is detected by every device listening on the same frequency,
+ *   spreading factor, bandwidth and IQ polarity early enough to catch the
+ *   last 4 symbols of the preamble and not busy with another packet,
+ *   @ref NETDEV_EVENT_VALID_HEADER is reported after the header and
+ *   @ref NETDEV_EVENT_RX_COMPLETE at the end;
+ * - path loss of every device is given relative to a common point (e.g.
+ *   the gateway antenna), so RSSI is the TX power less path losses of the
+ *   sender and the receiver, packets with SNR below the demodulation floor
+ *   of the spreading factor are not detected;
+ * - packets overlapping on the same frequency and spreading factor collide
+ *   unless one is stronger by @ref SX127X_SIM_CAPTURE_DB, collided packets
+ *   are received with CRC error;
+ * - configurable share of packets is lost randomly.
+ *
+ * Frequency hopping is not simulated, TX timeout is accepted and ignored.
+ *
+ * @{
+ *
+ * @file
+ * @brief       Simulated SX127x LoRa transceiver
+ *
+ * @author      Oleg Artamonov
+ */
+#ifndef SX127X_SIM_H
+#define SX127X_SIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "xtimer.h"
+#include "net/netdev.h"
+#include "sx127x_netdev.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Max. number of packets on air at once, packets sent above it are dropped
+ */
+#ifndef SX127X_SIM_MAX_PACKETS
+#define SX127X_SIM_MAX_PACKETS      (64)
+#endif
+
+/**
+ * @brief   Min. power difference for the stronger of two colliding packets to be received [dB]
+ */
+#ifndef SX127X_SIM_CAPTURE_DB
+#define SX127X_SIM_CAPTURE_DB       (6)
+#endif
+
+/**
+ * @brief   Receiver noise figure [dB]
+ */
+#ifndef SX127X_SIM_NOISE_FIGURE
+#define SX127X_SIM_NOISE_FIGURE     (6)
+#endif
+
+#define SX127X_SIM_MAX_PACKET_LEN   (255)   /**< Max. packet length */
+
+/**
+ * @brief   Simulated device parameters
+ */
+typedef struct {
+    int16_t path_loss;          /**< Path loss to the common point [dB] */
+} sx127x_sim_params_t;
+
+/**
+ * @brief   Simulated device statistics
+ */
+typedef struct {
+    uint32_t tx_packets;        /**< Packets sent */
+    uint32_t tx_dropped;        /**< Packets not sent because the air was full */
+    uint32_t airtime_ms;        /**< Total time on air of sent packets [ms] */
+    uint32_t rx_packets;        /**< Packets received without errors */
+    uint32_t rx_collisions;     /**< Packets received with CRC error due to collision */
+    uint32_t rx_lost;           /**< Packets lost randomly */
+} sx127x_sim_stats_t;
+
+/**
+ * @brief   Simulated device descriptor
+ */
+typedef struct sx127x_sim {
+    netdev_t netdev;                    /**< Netdev parent struct */
+    struct sx127x_sim *next;            /**< Next device sharing the air */
+    sx127x_sim_params_t params;         /**< Device parameters */
+
+    uint32_t frequency;                 /**< Channel frequency [Hz] */
+    uint32_t rx_timeout;                /**< RX timeout in single receive mode [ms], 0 to wait forever */
+    uint32_t tx_timeout;                /**< TX timeout [ms], not used */
+    uint16_t preamble_len;              /**< Preamble length [symbols] */
+    int16_t tx_power;                   /**< TX power [dBm] */
+    uint8_t sf;                         /**< Spreading factor */
+    uint8_t bw;                         /**< Bandwidth, LORA_BW_* */
+    uint8_t cr;                         /**< Coding rate, LORA_CR_* */
+    uint8_t max_payload_len;            /**< Max. payload length */
+    bool crc;                           /**< Payload CRC enabled */
+    bool iq_invert;                     /**< IQ polarity inverted */
+    bool fixed_header;                  /**< Implicit header mode */
+    bool rx_single;                     /**< Single receive mode */
+
+    volatile netopt_state_t state;      /**< Current state */
+    uint32_t rx_start;                  /**< Time the receiver was started [us] */
+    const void *rx_packet;              /**< Packet being received */
+    volatile unsigned events;           /**< Events reported by the next isr() call */
+    xtimer_t timer;                     /**< CAD and RX timeout timer */
+
+    uint8_t rx_len;                     /**< Length of the received packet */
+    bool rx_crc_error;                  /**< Received packet is damaged */
+    netdev_sx127x_lora_packet_info_t rx_info;       /**< Received packet info */
+    uint8_t rx_buf[SX127X_SIM_MAX_PACKET_LEN];      /**< Received packet */
+
+    sx127x_sim_stats_t stats;           /**< Device statistics */
+} sx127x_sim_t;
+
+/**
+ * @brief   Sets up a simulated device and puts it on air
+ *
+ * @param[out] dev      device descriptor
+ * @param[in]  params   device parameters
+ */
+void sx127x_sim_setup(sx127x_sim_t *dev, const sx127x_sim_params_t *params);
+
+/**
+ * @brief   Sets share of the packets lost randomly by all receivers
+ *
+ * @param[in] percent   packet loss [%]
+ */
+void sx127x_sim_set_loss(uint8_t percent);
+
+/**
+ * @brief   Calculates time on air of a packet with current device settings
+ *
+ * @param[in] dev       device descriptor
+ * @param[in] len       payload length
+ *
+ * @return  time on air [us]
+ */
+uint32_t sx127x_sim_time_on_air(const sx127x_sim_t *dev, uint8_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SX127X_SIM_H */
+/** @} */
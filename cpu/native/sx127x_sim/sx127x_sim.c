@@ -0,0 +1,753 @@
+/*
+ * Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     drivers_sx127x_sim
+ * @{
+ *
+ * @file
+ * @brief       Simulated SX127x LoRa transceiver and radio medium
+ *
+ * @author      Oleg Artamonov
+ * @}
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <string.h>
+
+#include "irq.h"
+#include "iolist.h"
+#include "random.h"
+#include "xtimer.h"
+#include "net/lora.h"
+
+#include "sx127x_sim.h"
+
+#define ENABLE_DEBUG    (0)
+#include "debug.h"
+
+#define CHANNEL_DEFAULT     (868300000UL)   /**< Same as of the sx127x driver */
+#define TX_POWER_DEFAULT    (14)
+
+#define CAD_SYMBOLS         (2)             /**< CAD takes about two symbols */
+#define SYNC_SYMBOLS        (4)             /**< Preamble symbols receiver needs to synchronize */
+
+/* Events reported by isr() */
+#define EVENT_TX_DONE       (1U << 0)
+#define EVENT_RX_DONE       (1U << 1)
+#define EVENT_RX_TIMEOUT    (1U << 2)
+#define EVENT_VALID_HEADER  (1U << 3)
+#define EVENT_CAD_DONE      (1U << 4)
+#define EVENT_CAD_DETECTED  (1U << 5)
+
+/**
+ * @brief   Packet on air
+ */
+typedef struct {
+    bool used;
+    sx127x_sim_t *src;          /**< Sender, NULL if it aborted the transmission */
+    uint32_t start;             /**< Start of the preamble [us] */
+    uint32_t sync_end;          /**< Receivers started later miss the packet [us] */
+    uint32_t frequency;
+    uint8_t sf;
+    uint8_t bw;
+    bool iq_invert;
+    int16_t level;              /**< TX power less path loss of the sender [dBm] */
+    int16_t interference;       /**< Level of the strongest overlapping packet [dBm] */
+    uint8_t len;
+    uint8_t data[SX127X_SIM_MAX_PACKET_LEN];
+    xtimer_t header_timer;
+    xtimer_t end_timer;
+} packet_t;
+
+static const uint32_t bw_hz[] = { 125000, 250000, 500000 };
+
+/* Thermal noise in the channel bandwidth [dBm] */
+static const int16_t thermal_noise[] = { -123, -120, -117 };
+
+/* Min. SNR to demodulate SF6..SF12 [0.1 dB] */
+static const int16_t snr_floor[] = { -50, -75, -100, -125, -150, -175, -200 };
+
+static packet_t air[SX127X_SIM_MAX_PACKETS];
+static sx127x_sim_t *devices;
+static uint8_t loss_percent;
+
+static inline uint32_t symbol_time(uint8_t sf, uint8_t bw)
+{
+    return ((uint32_t) 1 << sf) * US_PER_SEC / bw_hz[bw];
+}
+
+/* Preamble and synchronization take 4.25 symbols more than programmed */
+static inline uint32_t preamble_time(const sx127x_sim_t *dev)
+{
+    uint32_t tsym = symbol_time(dev->sf, dev->bw);
+    return (dev->preamble_len + 4) * tsym + tsym / 4;
+}
+
+uint32_t sx127x_sim_time_on_air(const sx127x_sim_t *dev, uint8_t len)
+{
+    uint32_t tsym = symbol_time(dev->sf, dev->bw);
+
+    /* Low data rate optimization is on for symbols longer than 16 ms */
+    int de = (tsym > 16 * US_PER_MS) ? 1 : 0;
+
+    int num = 8 * len - 4 * dev->sf + 28 + (dev->crc ? 16 : 0) - (dev->fixed_header ? 20 : 0);
+    int den = 4 * (dev->sf - 2 * de);
+
+    uint32_t payload_symbols = 8;
+    if (num > 0) {
+        payload_symbols += ((num + den - 1) / den) * (dev->cr + 4);
+    }
+
+    return preamble_time(dev) + payload_symbols * tsym;
+}
+
+static void _raise(sx127x_sim_t *dev, unsigned event)
+{
+    dev->events |= event;
+
+    if (dev->netdev.event_callback) {
+        dev->netdev.event_callback(&dev->netdev, NETDEV_EVENT_ISR, dev->netdev.event_callback_arg);
+    }
+}
+
+static inline bool _same_channel(const sx127x_sim_t *dev, const packet_t *p)
+{
+    return (dev->frequency == p->frequency) && (dev->sf == p->sf) && (dev->bw == p->bw);
+}
+
+/**
+ * @brief   Calculates signal of the packet at the device, returns true if it can be demodulated
+ */
+static bool _detect(const sx127x_sim_t *dev, const packet_t *p, int16_t *rssi, int16_t *snr)
+{
+    *rssi = p->level - dev->params.path_loss;
+    *snr = *rssi - (thermal_noise[p->bw] + SX127X_SIM_NOISE_FIGURE);
+
+    return (*snr * 10) >= snr_floor[p->sf - LORA_SF6];
+}
+
+static inline bool _collided(const packet_t *p)
+{
+    return p->interference + SX127X_SIM_CAPTURE_DB > p->level;
+}
+
+static void _header_cb(void *arg)
+{
+    packet_t *p = arg;
+
+    for (sx127x_sim_t *d = devices; d != NULL; d = d->next) {
+        if (d == p->src || d->state != NETOPT_STATE_RX || d->rx_packet != NULL) {
+            continue;
+        }
+
+        if (!_same_channel(d, p) || d->iq_invert != p->iq_invert) {
+            continue;
+        }
+
+        /* Receiver must hear enough of the preamble */
+        if ((int32_t) (p->sync_end - d->rx_start) < 0) {
+            continue;
+        }
+
+        int16_t rssi, snr;
+        if (!_detect(d, p, &rssi, &snr)) {
+            continue;
+        }
+
+        if (loss_percent && random_uint32_range(0, 100) < loss_percent) {
+            d->stats.rx_lost++;
+            continue;
+        }
+
+        /* Receiver is busy with this packet until its end */
+        d->rx_packet = p;
+        d->rx_info.lqi = 0;
+        d->rx_info.rssi = rssi;
+        d->rx_info.snr = (snr < INT8_MIN) ? INT8_MIN : (snr > INT8_MAX) ? INT8_MAX : snr;
+
+        xtimer_remove(&d->timer);
+
+        if (!d->fixed_header) {
+            _raise(d, EVENT_VALID_HEADER);
+        }
+    }
+}
+
+static void _end_cb(void *arg)
+{
+    packet_t *p = arg;
+    bool collided = _collided(p);
+
+    for (sx127x_sim_t *d = devices; d != NULL; d = d->next) {
+        if (d->rx_packet != p) {
+            continue;
+        }
+
+        d->rx_packet = NULL;
+        d->rx_len = p->len;
+        d->rx_crc_error = collided;
+        memcpy(d->rx_buf, p->data, p->len);
+
+        if (collided) {
+            d->stats.rx_collisions++;
+        }
+        else {
+            d->stats.rx_packets++;
+        }
+
+        if (d->rx_single) {
+            d->state = NETOPT_STATE_STANDBY;
+        }
+
+        _raise(d, EVENT_RX_DONE);
+    }
+
+    p->used = false;
+
+    if (p->src != NULL) {
+        p->src->state = NETOPT_STATE_STANDBY;
+        _raise(p->src, EVENT_TX_DONE);
+    }
+}
+
+/**
+ * @brief   Checks for a detectable packet on the device's channel
+ */
+static bool _channel_active(const sx127x_sim_t *dev)
+{
+    for (unsigned i = 0; i < SX127X_SIM_MAX_PACKETS; i++) {
+        const packet_t *p = &air[i];
+        int16_t rssi, snr;
+
+        if (p->used && p->src != dev && _same_channel(dev, p) && _detect(dev, p, &rssi, &snr)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief   Ends CAD, RX timeout or transmission of the packet dropped from the air
+ */
+static void _timer_cb(void *arg)
+{
+    sx127x_sim_t *dev = arg;
+
+    switch (dev->state) {
+        case NETOPT_STATE_TX:
+            dev->state = NETOPT_STATE_STANDBY;
+            _raise(dev, EVENT_TX_DONE);
+            break;
+
+        case NETOPT_STATE_CAD:
+            dev->state = NETOPT_STATE_STANDBY;
+            _raise(dev, _channel_active(dev) ? EVENT_CAD_DETECTED : EVENT_CAD_DONE);
+            break;
+
+        case NETOPT_STATE_RX:
+            if (dev->rx_packet == NULL) {
+                dev->state = NETOPT_STATE_STANDBY;
+                _raise(dev, EVENT_RX_TIMEOUT);
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief   Stops any operation in progress, must be called with interrupts disabled
+ */
+static void _abort(sx127x_sim_t *dev)
+{
+    xtimer_remove(&dev->timer);
+    dev->rx_packet = NULL;
+
+    if (dev->state != NETOPT_STATE_TX) {
+        return;
+    }
+
+    /* Truncated packet stays on air till its planned end, but is never received intact */
+    for (unsigned i = 0; i < SX127X_SIM_MAX_PACKETS; i++) {
+        if (air[i].used && air[i].src == dev) {
+            air[i].src = NULL;
+            air[i].interference = INT16_MAX - SX127X_SIM_CAPTURE_DB;
+        }
+    }
+}
+
+static packet_t *_alloc_packet(void)
+{
+    for (unsigned i = 0; i < SX127X_SIM_MAX_PACKETS; i++) {
+        if (!air[i].used) {
+            air[i].used = true;
+            return &air[i];
+        }
+    }
+
+    return NULL;
+}
+
+static int _send(netdev_t *netdev, const iolist_t *iolist)
+{
+    sx127x_sim_t *dev = (sx127x_sim_t *) netdev;
+
+    if (dev->state == NETOPT_STATE_TX) {
+        DEBUG("[sx127x_sim] Cannot send packet: radio already in transmitting state.\n");
+        return -ENOTSUP;
+    }
+
+    size_t size = iolist_size(iolist);
+    if (size > SX127X_SIM_MAX_PACKET_LEN) {
+        return -EOVERFLOW;
+    }
+
+    uint32_t toa = sx127x_sim_time_on_air(dev, size);
+
+    unsigned state = irq_disable();
+
+    _abort(dev);
+    dev->state = NETOPT_STATE_TX;
+    dev->stats.airtime_ms += toa / US_PER_MS;
+
+    packet_t *p = _alloc_packet();
+    if (p == NULL) {
+        /* Nobody hears the packet, but the transmission takes its time */
+        DEBUG("[sx127x_sim] air is full, packet dropped\n");
+        dev->stats.tx_dropped++;
+        xtimer_set(&dev->timer, toa);
+
+        irq_restore(state);
+        return 0;
+    }
+
+    p->src = dev;
+    p->start = xtimer_now_usec();
+    p->sync_end = p->start;
+    if (dev->preamble_len > SYNC_SYMBOLS) {
+        p->sync_end += (dev->preamble_len - SYNC_SYMBOLS) * symbol_time(dev->sf, dev->bw);
+    }
+    p->frequency = dev->frequency;
+    p->sf = dev->sf;
+    p->bw = dev->bw;
+    p->iq_invert = dev->iq_invert;
+    p->level = dev->tx_power - dev->params.path_loss;
+    p->interference = INT16_MIN + SX127X_SIM_CAPTURE_DB;
+    p->len = size;
+
+    uint8_t *pos = p->data;
+    for (const iolist_t *iol = iolist; iol != NULL; iol = iol->iol_next) {
+        memcpy(pos, iol->iol_base, iol->iol_len);
+        pos += iol->iol_len;
+    }
+
+    /* Overlapping packets on the same channel interfere with each other */
+    for (unsigned i = 0; i < SX127X_SIM_MAX_PACKETS; i++) {
+        packet_t *q = &air[i];
+
+        if (q == p || !q->used || q->frequency != p->frequency || q->sf != p->sf || q->bw != p->bw) {
+            continue;
+        }
+
+        if (p->level > q->interference) {
+            q->interference = p->level;
+        }
+
+        if (q->level > p->interference) {
+            p->interference = q->level;
+        }
+    }
+
+    /* Header is sent within the first 8 symbols after the preamble */
+    p->header_timer.callback = _header_cb;
+    p->header_timer.arg = p;
+    xtimer_set(&p->header_timer, preamble_time(dev) + 8 * symbol_time(dev->sf, dev->bw));
+
+    p->end_timer.callback = _end_cb;
+    p->end_timer.arg = p;
+    xtimer_set(&p->end_timer, toa);
+
+    dev->stats.tx_packets++;
+
+    irq_restore(state);
+
+    return 0;
+}
+
+static int _recv(netdev_t *netdev, void *buf, size_t len, void *info)
+{
+    sx127x_sim_t *dev = (sx127x_sim_t *) netdev;
+
+    /* Damaged packet is reported like the sx127x driver does */
+    if (dev->rx_crc_error) {
+        dev->rx_crc_error = false;
+        netdev->event_callback(netdev, NETDEV_EVENT_CRC_ERROR, netdev->event_callback_arg);
+        return -EBADMSG;
+    }
+
+    if (info != NULL) {
+        *((netdev_sx127x_lora_packet_info_t *) info) = dev->rx_info;
+    }
+
+    if (buf == NULL) {
+        return dev->rx_len;
+    }
+
+    if (dev->rx_len > len) {
+        return -ENOBUFS;
+    }
+
+    memcpy(buf, dev->rx_buf, dev->rx_len);
+
+    return dev->rx_len;
+}
+
+static void _reset(sx127x_sim_t *dev)
+{
+    dev->frequency = CHANNEL_DEFAULT;
+    dev->rx_timeout = 0;
+    dev->tx_timeout = 0;
+    dev->preamble_len = LORA_PREAMBLE_LENGTH_DEFAULT;
+    dev->tx_power = TX_POWER_DEFAULT;
+    dev->sf = LORA_SF_DEFAULT;
+    dev->bw = LORA_BW_DEFAULT;
+    dev->cr = LORA_CR_DEFAULT;
+    dev->max_payload_len = SX127X_SIM_MAX_PACKET_LEN;
+    dev->crc = LORA_PAYLOAD_CRC_ON_DEFAULT;
+    dev->iq_invert = LORA_IQ_INVERTED_DEFAULT;
+    dev->fixed_header = LORA_FIXED_HEADER_LEN_MODE_DEFAULT;
+    dev->rx_single = false;
+    dev->state = NETOPT_STATE_SLEEP;
+}
+
+static int _init(netdev_t *netdev)
+{
+    sx127x_sim_t *dev = (sx127x_sim_t *) netdev;
+
+    unsigned state = irq_disable();
+    _abort(dev);
+    _reset(dev);
+    dev->events = 0;
+    irq_restore(state);
+
+    return 0;
+}
+
+static void _isr(netdev_t *netdev)
+{
+    sx127x_sim_t *dev = (sx127x_sim_t *) netdev;
+
+    unsigned state = irq_disable();
+    unsigned events = dev->events;
+    dev->events = 0;
+    irq_restore(state);
+
+    if (events & EVENT_VALID_HEADER) {
+        netdev->event_callback(netdev, NETDEV_EVENT_VALID_HEADER, netdev->event_callback_arg);
+    }
+
+    if (events & EVENT_RX_DONE) {
+        netdev->event_callback(netdev, NETDEV_EVENT_RX_COMPLETE, netdev->event_callback_arg);
+    }
+
+    if (events & EVENT_RX_TIMEOUT) {
+        netdev->event_callback(netdev, NETDEV_EVENT_RX_TIMEOUT, netdev->event_callback_arg);
+    }
+
+    if (events & EVENT_CAD_DONE) {
+        netdev->event_callback(netdev, NETDEV_EVENT_CAD_DONE, netdev->event_callback_arg);
+    }
+
+    if (events & EVENT_CAD_DETECTED) {
+        netdev->event_callback(netdev, NETDEV_EVENT_CAD_DETECTED, netdev->event_callback_arg);
+    }
+
+    if (events & EVENT_TX_DONE) {
+        netdev->event_callback(netdev, NETDEV_EVENT_TX_COMPLETE, netdev->event_callback_arg);
+    }
+}
+
+static int _set_state(sx127x_sim_t *dev, netopt_state_t state)
+{
+    unsigned irq = irq_disable();
+
+    switch (state) {
+        case NETOPT_STATE_SLEEP:
+        case NETOPT_STATE_STANDBY:
+            _abort(dev);
+            dev->state = state;
+            break;
+
+        case NETOPT_STATE_IDLE:
+            /* set permanent listening */
+            dev->rx_timeout = 0;
+            /* fall through */
+        case NETOPT_STATE_RX:
+            _abort(dev);
+            dev->state = NETOPT_STATE_RX;
+            dev->rx_start = xtimer_now_usec();
+
+            if (dev->rx_single && dev->rx_timeout) {
+                xtimer_set(&dev->timer, dev->rx_timeout * US_PER_MS);
+            }
+            break;
+
+        case NETOPT_STATE_RESET:
+            _abort(dev);
+            _reset(dev);
+            break;
+
+        case NETOPT_STATE_CAD:
+            _abort(dev);
+            dev->state = NETOPT_STATE_CAD;
+            xtimer_set(&dev->timer, CAD_SYMBOLS * symbol_time(dev->sf, dev->bw));
+            break;
+
+        default:
+            irq_restore(irq);
+            return -ENOTSUP;
+    }
+
+    irq_restore(irq);
+
+    return sizeof(netopt_state_t);
+}
+
+static int _get(netdev_t *netdev, netopt_t opt, void *val, size_t max_len)
+{
+    (void) max_len;  /* unused when compiled without debug, assert empty */
+    sx127x_sim_t *dev = (sx127x_sim_t *) netdev;
+
+    switch (opt) {
+        case NETOPT_STATE:
+            assert(max_len >= sizeof(netopt_state_t));
+            *((netopt_state_t *) val) = dev->state;
+            return sizeof(netopt_state_t);
+
+        case NETOPT_DEVICE_TYPE:
+            assert(max_len >= sizeof(uint16_t));
+            *((uint16_t *) val) = NETDEV_TYPE_LORA;
+            return sizeof(uint16_t);
+
+        case NETOPT_CHANNEL_FREQUENCY:
+            assert(max_len >= sizeof(uint32_t));
+            *((uint32_t *) val) = dev->frequency;
+            return sizeof(uint32_t);
+
+        case NETOPT_BANDWIDTH:
+            assert(max_len >= sizeof(uint8_t));
+            *((uint8_t *) val) = dev->bw;
+            return sizeof(uint8_t);
+
+        case NETOPT_SPREADING_FACTOR:
+            assert(max_len >= sizeof(uint8_t));
+            *((uint8_t *) val) = dev->sf;
+            return sizeof(uint8_t);
+
+        case NETOPT_CODING_RATE:
+            assert(max_len >= sizeof(uint8_t));
+            *((uint8_t *) val) = dev->cr;
+            return sizeof(uint8_t);
+
+        case NETOPT_MAX_PACKET_SIZE:
+            assert(max_len >= sizeof(uint8_t));
+            *((uint8_t *) val) = dev->max_payload_len;
+            return sizeof(uint8_t);
+
+        case NETOPT_INTEGRITY_CHECK:
+            assert(max_len >= sizeof(netopt_enable_t));
+            *((netopt_enable_t *) val) = dev->crc ? NETOPT_ENABLE : NETOPT_DISABLE;
+            return sizeof(netopt_enable_t);
+
+        case NETOPT_SINGLE_RECEIVE:
+            assert(max_len >= sizeof(netopt_enable_t));
+            *((netopt_enable_t *) val) = dev->rx_single ? NETOPT_ENABLE : NETOPT_DISABLE;
+            return sizeof(netopt_enable_t);
+
+        case NETOPT_RX_TIMEOUT:
+            assert(max_len >= sizeof(uint32_t));
+            *((uint32_t *) val) = dev->rx_timeout;
+            return sizeof(uint32_t);
+
+        case NETOPT_TX_TIMEOUT:
+            assert(max_len >= sizeof(uint32_t));
+            *((uint32_t *) val) = dev->tx_timeout;
+            return sizeof(uint32_t);
+
+        case NETOPT_TX_POWER:
+            assert(max_len >= sizeof(int16_t));
+            *((int16_t *) val) = dev->tx_power;
+            return sizeof(int16_t);
+
+        case NETOPT_FIXED_HEADER:
+            assert(max_len >= sizeof(netopt_enable_t));
+            *((netopt_enable_t *) val) = dev->fixed_header ? NETOPT_ENABLE : NETOPT_DISABLE;
+            return sizeof(netopt_enable_t);
+
+        case NETOPT_PREAMBLE_LENGTH:
+            assert(max_len >= sizeof(uint16_t));
+            *((uint16_t *) val) = dev->preamble_len;
+            return sizeof(uint16_t);
+
+        case NETOPT_IQ_INVERT:
+            assert(max_len >= sizeof(netopt_enable_t));
+            *((netopt_enable_t *) val) = dev->iq_invert ? NETOPT_ENABLE : NETOPT_DISABLE;
+            return sizeof(netopt_enable_t);
+
+        default:
+            return -ENOTSUP;
+    }
+}
+
+static int _set(netdev_t *netdev, netopt_t opt, const void *val, size_t len)
+{
+    (void) len;  /* unused when compiled without debug, assert empty */
+    sx127x_sim_t *dev = (sx127x_sim_t *) netdev;
+
+    switch (opt) {
+        case NETOPT_STATE:
+            assert(len <= sizeof(netopt_state_t));
+            return _set_state(dev, *((const netopt_state_t *) val));
+
+        case NETOPT_DEVICE_TYPE:
+            assert(len <= sizeof(uint16_t));
+            /* Only LoRa modem is simulated */
+            if (*((const uint16_t *) val) != NETDEV_TYPE_LORA) {
+                return -EINVAL;
+            }
+            return sizeof(uint16_t);
+
+        case NETOPT_CHANNEL_FREQUENCY:
+            assert(len <= sizeof(uint32_t));
+            dev->frequency = *((const uint32_t *) val);
+            return sizeof(uint32_t);
+
+        case NETOPT_BANDWIDTH: {
+            assert(len <= sizeof(uint8_t));
+            uint8_t bw = *((const uint8_t *) val);
+            if (bw > LORA_BW_500_KHZ) {
+                return -EINVAL;
+            }
+            dev->bw = bw;
+            return sizeof(uint8_t);
+        }
+
+        case NETOPT_SPREADING_FACTOR: {
+            assert(len <= sizeof(uint8_t));
+            uint8_t sf = *((const uint8_t *) val);
+            if ((sf < LORA_SF6) || (sf > LORA_SF12)) {
+                return -EINVAL;
+            }
+            dev->sf = sf;
+            return sizeof(uint8_t);
+        }
+
+        case NETOPT_CODING_RATE: {
+            assert(len <= sizeof(uint8_t));
+            uint8_t cr = *((const uint8_t *) val);
+            if ((cr < LORA_CR_4_5) || (cr > LORA_CR_4_8)) {
+                return -EINVAL;
+            }
+            dev->cr = cr;
+            return sizeof(uint8_t);
+        }
+
+        case NETOPT_MAX_PACKET_SIZE:
+            assert(len <= sizeof(uint8_t));
+            dev->max_payload_len = *((const uint8_t *) val);
+            return sizeof(uint8_t);
+
+        case NETOPT_INTEGRITY_CHECK:
+            assert(len <= sizeof(netopt_enable_t));
+            dev->crc = *((const netopt_enable_t *) val) ? true : false;
+            return sizeof(netopt_enable_t);
+
+        case NETOPT_CHANNEL_HOP:
+            /* Frequency hopping is not simulated */
+            assert(len <= sizeof(netopt_enable_t));
+            return sizeof(netopt_enable_t);
+
+        case NETOPT_CHANNEL_HOP_PERIOD:
+            assert(len <= sizeof(uint8_t));
+            return sizeof(uint8_t);
+
+        case NETOPT_SINGLE_RECEIVE:
+            assert(len <= sizeof(netopt_enable_t));
+            dev->rx_single = *((const netopt_enable_t *) val) ? true : false;
+            return sizeof(netopt_enable_t);
+
+        case NETOPT_RX_TIMEOUT:
+            assert(len <= sizeof(uint32_t));
+            dev->rx_timeout = *((const uint32_t *) val);
+            return sizeof(uint32_t);
+
+        case NETOPT_TX_TIMEOUT:
+            assert(len <= sizeof(uint32_t));
+            dev->tx_timeout = *((const uint32_t *) val);
+            return sizeof(uint32_t);
+
+        case NETOPT_TX_POWER:
+            assert(len <= sizeof(int16_t));
+            dev->tx_power = *((const int16_t *) val);
+            return sizeof(int16_t);
+
+        case NETOPT_FIXED_HEADER:
+            assert(len <= sizeof(netopt_enable_t));
+            dev->fixed_header = *((const netopt_enable_t *) val) ? true : false;
+            return sizeof(netopt_enable_t);
+
+        case NETOPT_PREAMBLE_LENGTH:
+            assert(len <= sizeof(uint16_t));
+            dev->preamble_len = *((const uint16_t *) val);
+            return sizeof(uint16_t);
+
+        case NETOPT_IQ_INVERT:
+            assert(len <= sizeof(netopt_enable_t));
+            dev->iq_invert = *((const netopt_enable_t *) val) ? true : false;
+            return sizeof(netopt_enable_t);
+
+        default:
+            return -ENOTSUP;
+    }
+}
+
+static const netdev_driver_t sx127x_sim_driver = {
+    .send = _send,
+    .recv = _recv,
+    .init = _init,
+    .isr = _isr,
+    .get = _get,
+    .set = _set,
+};
+
+void sx127x_sim_setup(sx127x_sim_t *dev, const sx127x_sim_params_t *params)
+{
+    memset(dev, 0, sizeof(sx127x_sim_t));
+
+    dev->netdev.driver = &sx127x_sim_driver;
+    dev->params = *params;
+    dev->timer.callback = _timer_cb;
+    dev->timer.arg = dev;
+
+    _reset(dev);
+
+    unsigned state = irq_disable();
+    dev->next = devices;
+    devices = dev;
+    irq_restore(state);
+}
+
+void sx127x_sim_set_loss(uint8_t percent)
+{
+    assert(percent <= 100);
+    loss_percent = percent;
+}
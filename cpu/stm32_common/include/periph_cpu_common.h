@@ -81,6 +81,17 @@ extern "C" {
 #define PM_NUM_MODES    (4U)
 /** @} */
 
+/**
+ * @brief   Wakeup latency of the power modes [us], see pm_layered
+ *
+ * Standby ends in a reset, so it is only entered when no timer is due within
+ * UINT32_MAX us (71 minutes). Leaving stop mode includes restarting the
+ * system clock.
+ */
+#ifndef PM_WAKEUP_LATENCY_US
+#define PM_WAKEUP_LATENCY_US    { UINT32_MAX, UINT32_MAX, 1000, 0 }
+#endif
+
 /**
  * @brief   Available peripheral buses
  */
@@ -0,0 +1,213 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+#
+# This file is subject to the terms and conditions of the GNU Lesser
+# General Public License v2.1. See the file LICENSE in the top level
+# directory for more details.
+
+"""Convert a sched_trace dump into a Chrome trace.
+
+Reads a terminal log containing the output of the `trace` shell command or
+of a kernel panic and writes the last complete dump as Chrome trace event
+JSON, to be opened in https://ui.perfetto.dev or chrome://tracing.
+"""
+
+import argparse
+import json
+import re
+import struct
+import sys
+
+RECORD = struct.Struct("<IBBH")
+
+EV_SWITCH = 0x01
+EV_MSG_SEND = 0x02
+EV_MSG_RECV = 0x03
+EV_MSG_WAIT = 0x04
+EV_MUTEX_WAIT = 0x05
+EV_MUTEX_WAKE = 0x06
+EV_FLAGS_SET = 0x07
+EV_FLAGS_WAIT = 0x08
+EV_ISR = 0x09
+EV_USER = 0x40
+IN_ISR = 0x80
+
+KERNEL_PID_UNDEF = 0
+KERNEL_PID_ISR = 0xFF
+
+STATUS = ["stopped", "sleeping", "mutex blocked", "receive blocked",
+          "send blocked", "reply blocked", "flag blocked any",
+          "flag blocked all", "mbox blocked", "running", "pending"]
+
+# trace tracks not belonging to a thread
+TID_ISR = 1000
+TID_UNKNOWN = 1001
+PID = 1
+
+LINE = re.compile(r"trace: (.*)$")
+HEADER = re.compile(r"hz=(\d+) count=(\d+) records=(\d+)")
+THREAD = re.compile(r"thread (\d+) (.*)$")
+
+
+def parse_log(lines):
+    """Return (hz, count, thread names, raw records) of the last dump."""
+    dump = None
+    last = None
+
+    for line in lines:
+        match = LINE.search(line.rstrip())
+        if not match:
+            continue
+        text = match.group(1).strip()
+
+        header = HEADER.match(text)
+        if header:
+            dump = {"hz": int(header.group(1)), "count": int(header.group(2)),
+                    "names": {}, "data": bytearray()}
+            continue
+        if dump is None:
+            continue
+
+        thread = THREAD.match(text)
+        if thread:
+            dump["names"][int(thread.group(1))] = thread.group(2)
+        elif text == "end":
+            last = dump
+            dump = None
+        else:
+            try:
+                dump["data"] += bytes.fromhex(text)
+            except ValueError:
+                # garbled line, e.g. interleaved with other output
+                dump = None
+
+    if last is None:
+        raise ValueError("no complete trace dump found")
+
+    records = [RECORD.unpack_from(last["data"], pos)
+               for pos in range(0, len(last["data"]) - RECORD.size + 1, RECORD.size)]
+    return last["hz"], last["count"], last["names"], records
+
+
+def unwrap(records, hz):
+    """Yield records with the time in microseconds since the first one."""
+    elapsed = 0
+    prev = None
+    for time, event, arg8, arg16 in records:
+        if prev is not None:
+            elapsed += (time - prev) & 0xFFFFFFFF
+        prev = time
+        yield elapsed * 1e6 / hz, event, arg8, arg16
+
+
+def pid_name(names, pid):
+    if pid == KERNEL_PID_ISR:
+        return "ISR"
+    return names.get(pid, "pid {}".format(pid))
+
+
+def describe(event, arg8, arg16, names):
+    """Return name and arguments of an instant event."""
+    if event == EV_MSG_SEND:
+        return "msg send", {"to": pid_name(names, arg8), "type": hex(arg16)}
+    if event == EV_MSG_RECV:
+        return "msg recv", {"from": pid_name(names, arg8), "type": hex(arg16)}
+    if event == EV_MSG_WAIT:
+        return "msg wait", {}
+    if event == EV_MUTEX_WAIT:
+        return "mutex wait", {"mutex": hex(arg16)}
+    if event == EV_MUTEX_WAKE:
+        return "mutex wake", {"to": pid_name(names, arg8), "mutex": hex(arg16)}
+    if event == EV_FLAGS_SET:
+        return "flags set", {"to": pid_name(names, arg8), "flags": hex(arg16)}
+    if event == EV_FLAGS_WAIT:
+        return "flags wait", {"flags": hex(arg16)}
+    if event == EV_ISR:
+        if arg8 >= 16:
+            return "irq {}".format(arg8 - 16), {}
+        return "exception {}".format(arg8), {}
+    if event >= EV_USER:
+        return "user {}".format(hex(event)), {"arg8": arg8, "arg16": arg16}
+    return "unknown {}".format(hex(event)), {"arg8": arg8, "arg16": arg16}
+
+
+def convert(hz, count, names, records):
+    """Return the Chrome trace as a dict."""
+    events = []
+    tids = set()
+    running = None
+    start = 0.0
+    now = 0.0
+
+    for now, event, arg8, arg16 in unwrap(records, hz):
+        in_isr = bool(event & IN_ISR)
+        event &= ~IN_ISR
+
+        if event == EV_SWITCH:
+            prev, status = arg16 & 0xFF, arg16 >> 8
+            if running is not None:
+                events.append({"ph": "X", "pid": PID, "tid": running, "ts": start,
+                               "dur": now - start, "name": pid_name(names, running),
+                               "cat": "sched",
+                               "args": {"left": STATUS[status] if status < len(STATUS)
+                                        else str(status)}})
+            elif prev != KERNEL_PID_UNDEF:
+                tids.add(prev)
+            running = arg8
+            start = now
+            tids.add(running)
+            continue
+
+        name, args = describe(event, arg8, arg16, names)
+        if in_isr or event == EV_ISR:
+            tid = TID_ISR
+        elif running is None:
+            tid = TID_UNKNOWN
+        else:
+            tid = running
+        tids.add(tid)
+        events.append({"ph": "i", "s": "t", "pid": PID, "tid": tid, "ts": now,
+                       "name": name, "cat": "isr" if tid == TID_ISR else "ipc",
+                       "args": args})
+
+    if running is not None:
+        events.append({"ph": "X", "pid": PID, "tid": running, "ts": start,
+                       "dur": now - start, "name": pid_name(names, running),
+                       "cat": "sched", "args": {}})
+
+    meta = [{"ph": "M", "pid": PID, "name": "process_name", "args": {"name": "RIOT"}}]
+    for tid in sorted(tids):
+        if tid == TID_ISR:
+            name = "ISR"
+        elif tid == TID_UNKNOWN:
+            name = "unknown"
+        else:
+            name = "{} {}".format(tid, pid_name(names, tid))
+        meta.append({"ph": "M", "pid": PID, "tid": tid, "name": "thread_name",
+                     "args": {"name": name}})
+
+    return {"traceEvents": meta + events, "displayTimeUnit": "ms",
+            "otherData": {"hz": hz, "records": len(records),
+                          "lost": count - len(records)}}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("log", nargs="?", type=argparse.FileType("r"),
+                        default=sys.stdin, help="terminal log, stdin by default")
+    parser.add_argument("-o", "--output", type=argparse.FileType("w"),
+                        default=sys.stdout, help="JSON output, stdout by default")
+    args = parser.parse_args()
+
+    try:
+        hz, count, names, records = parse_log(args.log)
+    except ValueError as err:
+        sys.exit("sched_trace: {}".format(err))
+
+    json.dump(convert(hz, count, names, records), args.output, indent=1)
+    args.output.write("\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -1014,6 +1014,11 @@ static int aes_set_decrypt_key(const unsigned char *userKey, const int bits,
 #endif /* AES_NO_DECRYPTION */
 
 #ifndef AES_ASM
+int aes_expand_encrypt_key(const uint8_t *key, AES_KEY *schedule)
+{
+    return aes_set_encrypt_key(key, AES_KEY_SIZE * 8, schedule);
+}
+
 /*
  * Encrypt a single block
  * in and out can overlap
@@ -1024,13 +1029,22 @@ int aes_encrypt(const cipher_context_t *context, const uint8_t *plainBlock,
     /* setup AES_KEY */
     int res;
     AES_KEY aeskey;
-    const AES_KEY *key = &aeskey;
     res = aes_set_encrypt_key((unsigned char *)context->context,
                                    AES_KEY_SIZE * 8, &aeskey);
     if (res < 0) {
         return res;
     }
 
+    return aes_encrypt_expanded(&aeskey, plainBlock, cipherBlock);
+}
+
+/*
+ * Encrypt a single block with an already expanded key schedule
+ * in and out can overlap
+ */
+int aes_encrypt_expanded(const AES_KEY *key, const uint8_t *plainBlock,
+                         uint8_t *cipherBlock)
+{
     const u32 *rk;
     u32 s0, s1, s2, s3, t0, t1, t2, t3;
 #ifndef FULL_UNROLL
@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include <assert.h>
+
+#include <string.h>
+
+#include "bitarithm.h"
+#include "event/prio.h"
+#include "thread.h"
+
+#if EVENT_PRIO_LEVELS > 32
+#error "EVENT_PRIO_LEVELS must be 32 or less"
+#endif
+
+/**
+ * @brief   Idle worker, lives on the stack of the waiting thread
+ */
+typedef struct {
+    list_node_t node;           /**< entry in the idle list of the queue */
+    thread_t *thread;           /**< waiting thread, NULL once woken */
+    unsigned max_prio;          /**< least urgent priority it takes */
+} _worker_t;
+
+void event_prio_queue_init(event_prio_queue_t *queue)
+{
+    assert(queue);
+    memset(queue, '\0', sizeof(*queue));
+}
+
+static event_t *_pop(event_prio_queue_t *queue, unsigned max_prio)
+{
+    uint32_t pending = queue->pending & ((2UL << max_prio) - 1);
+
+    if (!pending) {
+        return NULL;
+    }
+
+    unsigned prio = bitarithm_lsb(pending);
+    event_t *event = (event_t *) clist_lpop(&queue->lists[prio]);
+
+    if (!queue->lists[prio].next) {
+        queue->pending &= ~(1UL << prio);
+    }
+
+    event->list_node.next = NULL;
+    return event;
+}
+
+/**
+ * @brief   Takes the most recently idle worker that may handle @p prio off
+ *          the idle list
+ */
+static thread_t *_pick_worker(event_prio_queue_t *queue, unsigned prio)
+{
+    for (list_node_t *prev = &queue->idle; prev->next; prev = prev->next) {
+        _worker_t *worker = container_of(prev->next, _worker_t, node);
+
+        if (worker->max_prio >= prio) {
+            thread_t *thread = worker->thread;
+            prev->next = worker->node.next;
+            worker->thread = NULL;
+            return thread;
+        }
+    }
+
+    return NULL;
+}
+
+void event_prio_post(event_prio_queue_t *queue, event_t *event, unsigned prio)
+{
+    assert(queue && event && (prio < EVENT_PRIO_LEVELS));
+
+    thread_t *worker = NULL;
+
+    unsigned state = irq_disable();
+    if (!event->list_node.next) {
+        clist_rpush(&queue->lists[prio], &event->list_node);
+        queue->pending |= (1UL << prio);
+        worker = _pick_worker(queue, prio);
+    }
+    irq_restore(state);
+
+    /* busy workers find the event when they are done */
+    if (worker) {
+        thread_flags_set(worker, THREAD_FLAG_EVENT);
+    }
+}
+
+void event_prio_cancel(event_prio_queue_t *queue, event_t *event)
+{
+    assert(queue);
+    assert(event);
+
+    unsigned state = irq_disable();
+    for (unsigned prio = 0; prio < EVENT_PRIO_LEVELS; prio++) {
+        if (clist_remove(&queue->lists[prio], &event->list_node)) {
+            if (!queue->lists[prio].next) {
+                queue->pending &= ~(1UL << prio);
+            }
+            break;
+        }
+    }
+    event->list_node.next = NULL;
+    irq_restore(state);
+}
+
+event_t *event_prio_get(event_prio_queue_t *queue, unsigned max_prio)
+{
+    assert(max_prio < EVENT_PRIO_LEVELS);
+
+    unsigned state = irq_disable();
+    event_t *result = _pop(queue, max_prio);
+    irq_restore(state);
+
+    return result;
+}
+
+event_t *event_prio_wait(event_prio_queue_t *queue, unsigned max_prio)
+{
+    assert(max_prio < EVENT_PRIO_LEVELS);
+
+    _worker_t worker = { .max_prio = max_prio };
+
+    while (1) {
+        unsigned state = irq_disable();
+        event_t *result = _pop(queue, max_prio);
+        if (result) {
+            irq_restore(state);
+            return result;
+        }
+
+        /* only a post from now on wakes us up */
+        thread_flags_clear(THREAD_FLAG_EVENT);
+        worker.thread = (thread_t *)sched_active_thread;
+        list_add(&queue->idle, &worker.node);
+        irq_restore(state);
+
+        thread_flags_wait_any(THREAD_FLAG_EVENT);
+
+        state = irq_disable();
+        if (worker.thread) {
+            /* woken up by someone else, still on the idle list */
+            list_remove(&queue->idle, &worker.node);
+        }
+        irq_restore(state);
+    }
+}
+
+void event_prio_loop_max(event_prio_queue_t *queue, unsigned max_prio)
+{
+    event_t *event;
+
+    while ((event = event_prio_wait(queue, max_prio))) {
+        event->handler(event);
+    }
+}
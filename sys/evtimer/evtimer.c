@@ -207,6 +207,30 @@ void evtimer_init(evtimer_t *evtimer, evtimer_callback_t handler)
     evtimer->events = NULL;
 }
 
+evtimer_event_t *evtimer_next(const evtimer_t *evtimer,
+                              const evtimer_event_t *event)
+{
+    return (event) ? event->next : evtimer->events;
+}
+
+uint32_t evtimer_remaining(const evtimer_t *evtimer,
+                           const evtimer_event_t *event)
+{
+    unsigned state = irq_disable();
+    evtimer_event_t *list = evtimer->events;
+    /* the head offset is only updated on changes, ask the timer instead */
+    uint32_t offset = _get_offset((xtimer_t *)&evtimer->timer);
+
+    while (list && (list != event)) {
+        list = list->next;
+        if (list) {
+            offset += list->offset;
+        }
+    }
+    irq_restore(state);
+    return offset;
+}
+
 void evtimer_print(const evtimer_t *evtimer)
 {
     evtimer_event_t *list = evtimer->events;
@@ -0,0 +1,256 @@
+/*
+ * Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     sys_evtimer
+ * @{
+ *
+ * @file
+ * @brief       event timer implementation on a pairing heap
+ *
+ * Each event keeps its due time in milliseconds in `offset`. The heap is a
+ * tree of events, each no later than its children, linked by first child,
+ * next sibling and previous sibling (parent for a first child). Adding melds
+ * the event with the root in constant time, removing merges the children of
+ * the event in two passes, which takes logarithmic amortized time.
+ *
+ * @}
+ */
+
+#include "irq.h"
+#include "xtimer.h"
+
+#include "evtimer.h"
+
+#define ENABLE_DEBUG (0)
+#include "debug.h"
+
+static uint32_t _now_ms(void)
+{
+    return (uint32_t)(xtimer_now_usec64() / US_PER_MS);
+}
+
+static inline int _before(const evtimer_t *evtimer, const evtimer_event_t *a,
+                          const evtimer_event_t *b)
+{
+    return (a->offset - evtimer->base) < (b->offset - evtimer->base);
+}
+
+/* both are roots, the later one becomes the first child of the other */
+static evtimer_event_t *_meld(const evtimer_t *evtimer, evtimer_event_t *a,
+                              evtimer_event_t *b)
+{
+    if (!a) {
+        return b;
+    }
+    if (!b) {
+        return a;
+    }
+    if (_before(evtimer, b, a)) {
+        evtimer_event_t *tmp = a;
+        a = b;
+        b = tmp;
+    }
+    b->prev = a;
+    b->next = a->child;
+    if (a->child) {
+        a->child->prev = b;
+    }
+    a->child = b;
+    return a;
+}
+
+/* melds a list of siblings into one heap: pairs left to right, then the
+ * pairs right to left */
+static evtimer_event_t *_merge_pairs(const evtimer_t *evtimer,
+                                     evtimer_event_t *first)
+{
+    evtimer_event_t *pairs = NULL;
+
+    while (first) {
+        evtimer_event_t *a = first;
+        evtimer_event_t *b = a->next;
+
+        first = (b) ? b->next : NULL;
+        a->next = a->prev = NULL;
+        if (b) {
+            b->next = b->prev = NULL;
+        }
+        a = _meld(evtimer, a, b);
+        /* chain the pairs backwards through prev */
+        a->prev = pairs;
+        pairs = a;
+    }
+
+    evtimer_event_t *root = NULL;
+    while (pairs) {
+        evtimer_event_t *next = pairs->prev;
+        pairs->prev = NULL;
+        root = _meld(evtimer, root, pairs);
+        pairs = next;
+    }
+    return root;
+}
+
+static void _remove(evtimer_t *evtimer, evtimer_event_t *event)
+{
+    evtimer_event_t *children = event->child;
+
+    if (event == evtimer->events) {
+        evtimer->events = _merge_pairs(evtimer, children);
+    }
+    else {
+        if (event->prev->child == event) {
+            event->prev->child = event->next;
+        }
+        else {
+            event->prev->next = event->next;
+        }
+        if (event->next) {
+            event->next->prev = event->prev;
+        }
+        evtimer->events = _meld(evtimer, evtimer->events,
+                                _merge_pairs(evtimer, children));
+    }
+    event->next = event->child = event->prev = NULL;
+}
+
+static int _is_pending(const evtimer_t *evtimer, const evtimer_event_t *event)
+{
+    if (event == evtimer->events) {
+        return 1;
+    }
+    return event->prev &&
+           ((event->prev->child == event) || (event->prev->next == event));
+}
+
+static void _set_timer(xtimer_t *timer, uint32_t offset_ms)
+{
+    uint64_t offset_us = (uint64_t)offset_ms * US_PER_MS;
+
+    DEBUG("evtimer: setting xtimer to %" PRIu32 " ms\n", offset_ms);
+    xtimer_set64(timer, offset_us);
+}
+
+static void _update_timer(evtimer_t *evtimer, uint32_t now)
+{
+    evtimer_event_t *event = evtimer->events;
+
+    if (event) {
+        uint32_t due = event->offset - evtimer->base;
+        uint32_t elapsed = now - evtimer->base;
+        _set_timer(&evtimer->timer, (due > elapsed) ? (due - elapsed) : 0);
+    }
+    else {
+        xtimer_remove(&evtimer->timer);
+    }
+}
+
+void evtimer_add(evtimer_t *evtimer, evtimer_event_t *event)
+{
+    unsigned state = irq_disable();
+    uint32_t now = _now_ms();
+
+    DEBUG("evtimer_add(): adding event with offset %" PRIu32 "\n", event->offset);
+
+    if (!evtimer->events) {
+        evtimer->base = now;
+    }
+    event->offset += now;
+    event->next = event->child = event->prev = NULL;
+    evtimer->events = _meld(evtimer, evtimer->events, event);
+    if (evtimer->events == event) {
+        _update_timer(evtimer, now);
+    }
+    irq_restore(state);
+    if (sched_context_switch_request) {
+        thread_yield_higher();
+    }
+}
+
+void evtimer_del(evtimer_t *evtimer, evtimer_event_t *event)
+{
+    unsigned state = irq_disable();
+
+    if (_is_pending(evtimer, event)) {
+        int was_root = (event == evtimer->events);
+
+        DEBUG("evtimer_del(): removing event due at %" PRIu32 "\n", event->offset);
+        _remove(evtimer, event);
+        if (was_root) {
+            _update_timer(evtimer, _now_ms());
+        }
+    }
+    irq_restore(state);
+}
+
+static void _evtimer_handler(void *arg)
+{
+    DEBUG("_evtimer_handler()\n");
+
+    evtimer_t *evtimer = (evtimer_t *)arg;
+    uint32_t now = _now_ms();
+    evtimer_event_t *event;
+
+    while ((event = evtimer->events) &&
+           ((event->offset - evtimer->base) <= (now - evtimer->base))) {
+        _remove(evtimer, event);
+        evtimer->base = event->offset;
+        evtimer->callback(event);
+    }
+
+    _update_timer(evtimer, now);
+}
+
+void evtimer_init(evtimer_t *evtimer, evtimer_callback_t handler)
+{
+    evtimer->callback = handler;
+    evtimer->timer.callback = _evtimer_handler;
+    evtimer->timer.arg = (void *)evtimer;
+    evtimer->events = NULL;
+    evtimer->base = 0;
+}
+
+evtimer_event_t *evtimer_next(const evtimer_t *evtimer,
+                              const evtimer_event_t *event)
+{
+    if (!event) {
+        return evtimer->events;
+    }
+    if (event->child) {
+        return event->child;
+    }
+    while (event) {
+        if (event->next) {
+            return event->next;
+        }
+        /* back to the first sibling, whose prev is the parent */
+        while (event->prev && (event->prev->child != event)) {
+            event = event->prev;
+        }
+        event = event->prev;
+    }
+    return NULL;
+}
+
+uint32_t evtimer_remaining(const evtimer_t *evtimer,
+                           const evtimer_event_t *event)
+{
+    uint32_t due = event->offset - evtimer->base;
+    uint32_t elapsed = _now_ms() - evtimer->base;
+
+    return (due > elapsed) ? (due - elapsed) : 0;
+}
+
+void evtimer_print(const evtimer_t *evtimer)
+{
+    for (evtimer_event_t *event = evtimer_next(evtimer, NULL); event;
+         event = evtimer_next(evtimer, event)) {
+        printf("ev offset=%u\n", (unsigned)evtimer_remaining(evtimer, event));
+    }
+}
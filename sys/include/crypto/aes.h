@@ -109,6 +109,33 @@ int aes_init(cipher_context_t *context, const uint8_t *key, uint8_t keySize);
 int aes_encrypt(const cipher_context_t *context, const uint8_t *plain_block,
                 uint8_t *cipher_block);
 
+/**
+ * @brief   expands the key into the AES encryption key schedule.
+ *
+ *          The schedule can be kept and passed to aes_encrypt_expanded() to
+ *          avoid expanding the same key again for every block.
+ *
+ * @param       key       a pointer to the AES_KEY_SIZE bytes long key
+ * @param       schedule  the key schedule to fill
+ *
+ * @return  0 on success, negative value on error
+ */
+int aes_expand_encrypt_key(const uint8_t *key, AES_KEY *schedule);
+
+/**
+ * @brief   encrypts one plain block with an already expanded key schedule.
+ *
+ * @param       key           key schedule filled by aes_expand_encrypt_key()
+ * @param       plain_block   a pointer to the plaintext-block (of size
+ *                            blocksize)
+ * @param       cipher_block  a pointer to the place where the ciphertext will
+ *                            be stored
+ *
+ * @return  1
+ */
+int aes_encrypt_expanded(const AES_KEY *key, const uint8_t *plain_block,
+                         uint8_t *cipher_block);
+
 /**
  * @brief   decrypts one cipher-block and saves the plain-block in plainBlock.
  *          decrypts one blocksize long block of ciphertext pointed to by
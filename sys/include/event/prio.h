@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     sys_event
+ * @brief       Prioritized event queue drained by several worker threads
+ *
+ * Unlike @ref event_queue_t, which belongs to one thread, an
+ * event_prio_queue_t is served by any number of worker threads, each running
+ * event_prio_loop(). Events are posted with a priority, 0 being the most
+ * urgent, and are handled most urgent first, in FIFO order within a priority.
+ *
+ * Posting an event wakes up exactly one idle worker, if there is one. Busy
+ * workers take the next event as soon as their handler returns, so a long
+ * handler (crypto, encoding) only delays other events when all the workers
+ * are busy. A worker can be restricted to urgent events with
+ * event_prio_loop_max(), keeping it free for them. On a single core, a woken
+ * worker still has to wait for busy workers of higher or the same thread
+ * priority, so the worker for urgent events should also have the higher
+ * thread priority.
+ *
+ * Example:
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~ {.c}
+ * static event_prio_queue_t queue = EVENT_PRIO_QUEUE_INIT;
+ *
+ * void *worker(void *arg)
+ * {
+ *     event_prio_loop(&queue);
+ *     return NULL;
+ * }
+ *
+ * [...]
+ * event_prio_post(&queue, &radio_event, 0);
+ * event_prio_post(&queue, &encode_event, 2);
+ * ~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * @{
+ *
+ * @file
+ * @brief       Prioritized event queue API
+ */
+
+#ifndef EVENT_PRIO_H
+#define EVENT_PRIO_H
+
+#include <stdint.h>
+
+#include "event.h"
+#include "list.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Number of event priorities, at most 32
+ */
+#ifndef EVENT_PRIO_LEVELS
+#define EVENT_PRIO_LEVELS   (4U)
+#endif
+
+/**
+ * @brief   Prioritized event queue static initializer
+ */
+#define EVENT_PRIO_QUEUE_INIT   { .pending = 0 }
+
+/**
+ * @brief   Prioritized event queue structure
+ */
+typedef struct {
+    clist_node_t lists[EVENT_PRIO_LEVELS];  /**< queued events by priority */
+    uint32_t pending;                       /**< bit n set if lists[n] is not
+                                                 empty */
+    list_node_t idle;                       /**< workers waiting for events */
+} event_prio_queue_t;
+
+/**
+ * @brief   Initialize a prioritized event queue
+ *
+ * @param[out]  queue   event queue object to initialize
+ */
+void event_prio_queue_init(event_prio_queue_t *queue);
+
+/**
+ * @brief   Queue an event
+ *
+ * Wakes up one idle worker allowed to handle @p prio. Can be called from
+ * interrupt context. An event already queued is left where it is.
+ *
+ * @param[in]   queue   event queue to queue event in
+ * @param[in]   event   event to queue
+ * @param[in]   prio    priority, 0 is the most urgent
+ */
+void event_prio_post(event_prio_queue_t *queue, event_t *event, unsigned prio);
+
+/**
+ * @brief   Cancel a queued event
+ *
+ * Does nothing if the event is not queued or already being handled.
+ *
+ * @param[in]   queue   event queue to remove event from
+ * @param[in]   event   event to remove from queue
+ */
+void event_prio_cancel(event_prio_queue_t *queue, event_t *event);
+
+/**
+ * @brief   Get the most urgent event without blocking
+ *
+ * @param[in]   queue       event queue to get event from
+ * @param[in]   max_prio    least urgent priority to take
+ *
+ * @returns     the most urgent event of priority @p max_prio or lower
+ * @returns     NULL if there is none
+ */
+event_t *event_prio_get(event_prio_queue_t *queue, unsigned max_prio);
+
+/**
+ * @brief   Get the most urgent event, blocking
+ *
+ * The calling thread waits as an idle worker of @p queue until an event of
+ * priority @p max_prio or lower is posted.
+ *
+ * @param[in]   queue       event queue to get event from
+ * @param[in]   max_prio    least urgent priority to take
+ *
+ * @returns     the most urgent event of priority @p max_prio or lower
+ */
+event_t *event_prio_wait(event_prio_queue_t *queue, unsigned max_prio);
+
+/**
+ * @brief   Handle events of @p queue up to @p max_prio forever
+ *
+ * @param[in]   queue       event queue to process
+ * @param[in]   max_prio    least urgent priority to handle
+ */
+void event_prio_loop_max(event_prio_queue_t *queue, unsigned max_prio);
+
+/**
+ * @brief   Handle all events of @p queue forever
+ *
+ * @param[in]   queue   event queue to process
+ */
+static inline void event_prio_loop(event_prio_queue_t *queue)
+{
+    event_prio_loop_max(queue, EVENT_PRIO_LEVELS - 1);
+}
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* EVENT_PRIO_H */
+/** @} */
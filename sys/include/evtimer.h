@@ -31,6 +31,16 @@
  *   example.
  * - uses @ref sys_xtimer "xtimer" as backend
  *
+ * By default the events are kept in a list sorted by time, so adding and
+ * removing an event takes time linear in the number of pending events. With
+ * `USEMODULE += evtimer_heap` they are kept in a pairing heap instead, which
+ * adds and removes in logarithmic (amortized) time at the cost of two more
+ * pointers per event. Use it for timers with many pending events, such as
+ * the one of the GNRC NIB. With the heap, events due in the same millisecond
+ * fire in no particular order, and the offset of a new event plus the time
+ * since the earliest pending event was added must stay below @$2^{32}@$
+ * milliseconds.
+ *
  * @{
  *
  * @file
@@ -55,8 +65,15 @@ extern "C" {
  * @brief   Generic event
  */
 typedef struct evtimer_event {
-    struct evtimer_event *next; /**< the next event in the queue */
-    uint32_t offset;            /**< offset in milliseconds from previous event */
+    struct evtimer_event *next; /**< the next event in the queue, the next
+                                     sibling with evtimer_heap */
+    uint32_t offset;            /**< offset in milliseconds from previous event,
+                                     the due time with evtimer_heap */
+#if defined(MODULE_EVTIMER_HEAP) || DOXYGEN
+    struct evtimer_event *child;    /**< first child in the heap */
+    struct evtimer_event *prev;     /**< previous sibling, or the parent of
+                                         a first child */
+#endif
 } evtimer_event_t;
 
 /**
@@ -71,7 +88,13 @@ typedef struct {
     xtimer_t timer;                 /**< Timer */
     evtimer_callback_t callback;    /**< Handler function for this evtimer's
                                          event type */
-    evtimer_event_t *events;        /**< Event queue */
+    evtimer_event_t *events;        /**< Event queue, the root of the heap
+                                         with evtimer_heap */
+#if defined(MODULE_EVTIMER_HEAP) || DOXYGEN
+    uint32_t base;                  /**< time no pending event is due before
+                                         [ms], due times are compared
+                                         relative to it */
+#endif
 } evtimer_t;
 
 /**
@@ -98,6 +121,34 @@ void evtimer_add(evtimer_t *evtimer, evtimer_event_t *event);
  */
 void evtimer_del(evtimer_t *evtimer, evtimer_event_t *event);
 
+/**
+ * @brief   Iterates over the pending events of an event timer
+ *
+ * The events are not visited in the order they are due. Events must not be
+ * added or removed while iterating.
+ *
+ * @param[in] evtimer       An event timer
+ * @param[in] event         The current event, NULL to get the first one
+ *
+ * @return  The event after @p event
+ * @return  NULL, if @p event was the last one
+ */
+evtimer_event_t *evtimer_next(const evtimer_t *evtimer,
+                              const evtimer_event_t *event);
+
+/**
+ * @brief   Returns the time until a pending event is due
+ *
+ * Takes time linear in the number of pending events without evtimer_heap.
+ *
+ * @param[in] evtimer       An event timer
+ * @param[in] event         A pending event of @p evtimer
+ *
+ * @return  Milliseconds until @p event is due
+ */
+uint32_t evtimer_remaining(const evtimer_t *evtimer,
+                           const evtimer_event_t *event);
+
 /**
  * @brief   Print overview of current state of an event timer
  *
@@ -271,6 +271,22 @@ extern "C" {
 #endif
 #endif
 
+/**
+ * @brief   Index on-link and off-link entries with hash tables
+ *
+ * Looking up a neighbor or the route to a destination then takes a few hash
+ * table lookups instead of going through all entries, at the cost of 6 bytes
+ * per on-link and 4 bytes per off-link entry, plus 275 bytes. Enabled by
+ * default for large NIBs, e.g. on border routers.
+ */
+#ifndef GNRC_IPV6_NIB_CONF_INDEX
+#if (GNRC_IPV6_NIB_NUMOF >= 32) || (GNRC_IPV6_NIB_OFFL_NUMOF >= 32)
+#define GNRC_IPV6_NIB_CONF_INDEX            (1)
+#else
+#define GNRC_IPV6_NIB_CONF_INDEX            (0)
+#endif
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -18,6 +18,14 @@
  *          this *will* lead to alignment problems and can potentially result
  *          in segmentation/hard faults and other unexpected behaviour.
  *
+ * The default implementation, `gnrc_pktbuf_static`, allocates from one
+ * static array of @ref GNRC_PKTBUF_SIZE bytes with a first-fit free list.
+ * `gnrc_pktbuf_malloc` uses the heap instead. `gnrc_pktbuf_slab` splits the
+ * memory into pools of fixed size blocks, one for the packet snips and one
+ * per size class of data (see @ref GNRC_PKTBUF_SLAB_SNIP_NUMOF and the
+ * following), so allocating and releasing take constant time and long-lived
+ * buffers do not fragment the memory of short-lived ones.
+ *
  * @{
  *
  * @file
@@ -58,6 +66,41 @@ extern "C" {
 #define GNRC_PKTBUF_SIZE    (6144)
 #endif  /* GNRC_PKTBUF_SIZE */
 
+/**
+ * @name    Pools of `gnrc_pktbuf_slab`
+ *
+ * Data goes into the smallest free block it fits in, data larger than
+ * @ref GNRC_PKTBUF_SLAB_LARGE_SIZE can not be allocated. The defaults take
+ * about as much memory as the default @ref GNRC_PKTBUF_SIZE.
+ * @{
+ */
+#ifndef GNRC_PKTBUF_SLAB_SNIP_NUMOF
+#define GNRC_PKTBUF_SLAB_SNIP_NUMOF     (40U)   /**< number of packet snips */
+#endif
+#ifndef GNRC_PKTBUF_SLAB_SMALL_SIZE
+#define GNRC_PKTBUF_SLAB_SMALL_SIZE     (64U)   /**< size of small blocks, for
+                                                     headers */
+#endif
+#ifndef GNRC_PKTBUF_SLAB_SMALL_NUMOF
+#define GNRC_PKTBUF_SLAB_SMALL_NUMOF    (24U)   /**< number of small blocks */
+#endif
+#ifndef GNRC_PKTBUF_SLAB_MEDIUM_SIZE
+#define GNRC_PKTBUF_SLAB_MEDIUM_SIZE    (128U)  /**< size of medium blocks, for
+                                                     link layer frames */
+#endif
+#ifndef GNRC_PKTBUF_SLAB_MEDIUM_NUMOF
+#define GNRC_PKTBUF_SLAB_MEDIUM_NUMOF   (8U)    /**< number of medium blocks */
+#endif
+#ifndef GNRC_PKTBUF_SLAB_LARGE_SIZE
+#define GNRC_PKTBUF_SLAB_LARGE_SIZE     (1280U) /**< size of large blocks, for
+                                                     IPv6 packets up to the
+                                                     minimum MTU */
+#endif
+#ifndef GNRC_PKTBUF_SLAB_LARGE_NUMOF
+#define GNRC_PKTBUF_SLAB_LARGE_NUMOF    (2U)    /**< number of large blocks */
+#endif
+/** @} */
+
 /**
  * @brief   Initializes packet buffer module.
  */
@@ -107,6 +150,10 @@ gnrc_pktsnip_t *gnrc_pktbuf_add(gnrc_pktsnip_t *next, const void *data, size_t s
  * If `size == pkt->size` then the resulting snip will point to NULL in its
  * gnrc_pktsnip_t::data field and its gnrc_pktsnip_t::size field will be 0.
  *
+ * `gnrc_pktbuf_static` and `gnrc_pktbuf_slab` leave the remaining data in
+ * place, as shown above. `gnrc_pktbuf_static` may copy the marked section
+ * itself if @p size is not a multiple of the buffer's alignment.
+ *
  * @pre @p pkt != NULL && @p size != 0
  *
  * @param[in] pkt   A received packet.
@@ -87,7 +87,9 @@ typedef struct {
  * @brief   Definition of 6LoWPAN fragmentation type.
  */
 typedef struct {
-    gnrc_pktsnip_t *pkt;    /**< Pointer to the IPv6 packet to be fragmented */
+    gnrc_pktsnip_t *pkt;    /**< Pointer to the IPv6 packet to be fragmented.
+                             *   The fragments sent so far have taken their
+                             *   payload out of it, without copying. */
     size_t datagram_size;   /**< Length of just the (uncompressed) IPv6 packet to be fragmented */
     uint16_t offset;        /**< Offset of the Nth fragment from the beginning of the
                              *   payload datagram */
@@ -73,6 +73,57 @@ static inline uint16_t inet_csum(uint16_t sum, const uint8_t *buf, uint16_t len)
     return inet_csum_slice(sum, buf, len, 0);
 }
 
+/**
+ * @brief   Updates an Internet Checksum for a changed 16-bit field
+ *
+ * @see <a href="https://tools.ietf.org/html/rfc1624">
+ *          RFC 1624
+ *      </a>
+ *
+ * @details Unlike inet_csum(), this function works on the checksum as it is
+ *          stored in a header, i.e. with its 1's complement taken, so header
+ *          fields can be rewritten without checksumming the packet again.
+ *          The field must start at an even offset in the checksum domain.
+ *
+ * @param[in] csum      The checksum stored in the header, in host byte order.
+ * @param[in] old_val   The old value of the field, in host byte order.
+ * @param[in] new_val   The new value of the field, in host byte order.
+ *
+ * @return  The new checksum to store in the header, in host byte order.
+ */
+static inline uint16_t inet_csum_update16(uint16_t csum, uint16_t old_val,
+                                          uint16_t new_val)
+{
+    /* RFC 1624, eqn. 3: HC' = ~(~HC + ~m + m') */
+    uint32_t sum = (uint16_t)~csum + (uint16_t)~old_val + new_val;
+
+    sum = (sum & 0xffff) + (sum >> 16);
+    sum = (sum & 0xffff) + (sum >> 16);
+    return ~sum;
+}
+
+/**
+ * @brief   Updates an Internet Checksum for a changed field of any length,
+ *          e.g. an address
+ *
+ * @see <a href="https://tools.ietf.org/html/rfc1624">
+ *          RFC 1624
+ *      </a>
+ *
+ * @details Works on the checksum as stored in a header, like
+ *          inet_csum_update16(). The field must start at an even offset in
+ *          the checksum domain.
+ *
+ * @param[in] csum      The checksum stored in the header, in host byte order.
+ * @param[in] old_data  The old content of the field.
+ * @param[in] new_data  The new content of the field.
+ * @param[in] len       Length of the field in byte.
+ *
+ * @return  The new checksum to store in the header, in host byte order.
+ */
+uint16_t inet_csum_update(uint16_t csum, const uint8_t *old_data,
+                          const uint8_t *new_data, uint16_t len);
+
 #ifdef __cplusplus
 }
 #endif
@@ -23,6 +23,11 @@
  * - if a mode is blocked, so are implicitly all lower modes
  * - the idle thread automatically selects and sets the lowest unblocked mode
  *
+ * With `USEMODULE += pm_layered_tickless` the idle thread also looks at the
+ * next xtimer and rtctimers-millis deadline and only enters a mode whose
+ * wakeup latency (@ref PM_WAKEUP_LATENCY_US) fits before it. Entries and time
+ * spent in each mode are recorded for tuning the latencies.
+ *
  * In order to use this module, you'll need to implement pm_set().
  *
  * @file
@@ -34,6 +39,8 @@
 #ifndef PM_LAYERED_H
 #define PM_LAYERED_H
 
+#include <stdint.h>
+
 #include "assert.h"
 #include "periph_cpu.h"
 
@@ -79,6 +86,58 @@ void _pm_unblock(unsigned mode, const char *caller);
  */
 enum pm_mode pm_set(enum pm_mode target);
 
+#if defined(MODULE_PM_LAYERED_TICKLESS) || DOXYGEN
+/**
+ * @brief   Wakeup latency of each mode [us], as an array initializer
+ *
+ * A mode is only entered if the next timer deadline is at least this far
+ * away. Defaults to 0 for all modes, i.e. no restriction.
+ */
+#ifndef PM_WAKEUP_LATENCY_US
+#define PM_WAKEUP_LATENCY_US    { 0 }
+#endif
+
+/**
+ * @brief   Time stamp source for the residency [us]
+ *
+ * Has to keep counting in the low power modes to give the right times.
+ * xtimer stops in the STOP mode of STM32, so with rtctimers-millis the time
+ * is taken from the RTC by default, with 1 ms resolution. Without it, xtimer
+ * is used and the time spent in modes that stop it is not counted. 64-bit,
+ * so a single long stay in a mode doesn't wrap.
+ */
+#if !defined(PM_RESIDENCY_NOW_US) && !defined(MODULE_RTCTIMERS_MILLIS)
+#define PM_RESIDENCY_NOW_US()   (xtimer_now_usec64())
+#endif
+
+/**
+ * @brief   Residency of a power mode
+ */
+typedef struct {
+    uint32_t entries;       /**< times the mode was entered */
+    uint32_t denied;        /**< times it was skipped for a close deadline */
+    uint64_t time_us;       /**< time spent in the mode */
+} pm_residency_t;
+
+/**
+ * @brief   Returns the residency of the modes
+ *
+ * @return  array of PM_NUM_MODES + 1 entries, the last one for staying awake
+ *          because all modes are blocked or too slow
+ */
+const pm_residency_t *pm_get_residency(void);
+
+/**
+ * @brief   Clears the residency of all modes
+ */
+void pm_reset_residency(void);
+
+/**
+ * @brief   Prints the residency of all modes to stdout
+ */
+void pm_print_residency(void);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -52,6 +52,33 @@ void rtctimers_millis_sleep(uint32_t sleep_millis);
 void rtctimers_millis_set_msg(rtctimers_millis_t *timer, uint32_t offset, msg_t *msg, kernel_pid_t target_pid);
 uint32_t rtctimers_millis_now(void);
 
+/**
+ * @brief Sets timer to fire from offset to offset + slack milliseconds from now
+ *
+ * Timer is moved to the target of a timer already set within the window or to
+ * a round time within it, so timers with overlapping windows share one wakeup.
+ */
+void rtctimers_millis_set_slack(rtctimers_millis_t *timer, uint32_t offset, uint32_t slack);
+void rtctimers_millis_set_msg_slack(rtctimers_millis_t *timer, uint32_t offset, uint32_t slack,
+                                    msg_t *msg, kernel_pid_t target_pid);
+
+typedef struct {
+    uint32_t wakeups;           /**< Alarms that fired timers */
+    uint32_t wakeups_saved;     /**< Timers fired by the alarm of another timer */
+    uint32_t coalesced;         /**< Timers moved onto the target of another timer within their slack */
+} rtctimers_millis_wakeup_stats_t;
+
+/**
+ * @brief Returns wakeup statistics
+ */
+const rtctimers_millis_wakeup_stats_t *rtctimers_millis_get_wakeup_stats(void);
+
+/**
+ * @brief Returns milliseconds until the next RTC alarm, the weekly overflow
+ *        alarm at the latest
+ */
+uint32_t rtctimers_millis_time_until_next(void);
+
 /**
  * @brief Returns time in milliseconds since 00:00:00 Sunday
  */
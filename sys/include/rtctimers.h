@@ -46,5 +46,26 @@ void rtctimers_remove(rtctimers_t *timer);
 void rtctimers_sleep(uint32_t sleep_sec);
 void rtctimers_set_msg(rtctimers_t *timer, uint32_t offset, msg_t *msg, kernel_pid_t target_pid);
 
+/**
+ * @brief Sets timer to fire from offset to offset + slack seconds from now
+ *
+ * Timer is moved to the target of a timer already set within the window or to
+ * a round time within it, so timers with overlapping windows share one wakeup.
+ */
+void rtctimers_set_slack(rtctimers_t *timer, uint32_t offset, uint32_t slack);
+void rtctimers_set_msg_slack(rtctimers_t *timer, uint32_t offset, uint32_t slack,
+                             msg_t *msg, kernel_pid_t target_pid);
+
+typedef struct {
+    uint32_t wakeups;           /**< Alarms that fired timers */
+    uint32_t wakeups_saved;     /**< Timers fired by the alarm of another timer */
+    uint32_t coalesced;         /**< Timers moved onto the target of another timer within their slack */
+} rtctimers_wakeup_stats_t;
+
+/**
+ * @brief Returns wakeup statistics
+ */
+const rtctimers_wakeup_stats_t *rtctimers_get_wakeup_stats(void);
+
 
 #endif /* RTC_TIMERS_H_ */
@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    sys_sched_edf Earliest deadline first scheduling
+ * @ingroup     sys
+ * @brief       Deadline ordered scheduling within one priority level
+ *
+ * With `USEMODULE += sched_edf` the priority level @ref SCHED_EDF_PRIO is
+ * reserved for threads with deadlines. Fixed priorities keep working as
+ * before: the level is preempted by more urgent ones and preempts less urgent
+ * ones. Within the level, instead of first come, first served, the thread
+ * with the earliest deadline runs, preempting the others.
+ *
+ * A thread declares a relative deadline with sched_edf_set_deadline(). Every
+ * time it leaves a blocked state (message, mutex, flags, wakeup...) it gets
+ * the absolute deadline "now + relative deadline" and is expected to block
+ * again before it. Each time it blocks too late, its miss counter is
+ * increased. Threads at the level without a deadline run after all the
+ * threads with one, in FIFO order.
+ *
+ * Deadlines are kept in xtimer ticks and compared wrap-around safe, so they
+ * must be shorter than half the xtimer period.
+ *
+ * @{
+ *
+ * @file
+ * @brief       Earliest deadline first scheduling interface
+ */
+
+#ifndef SCHED_EDF_H
+#define SCHED_EDF_H
+
+#include <stdint.h>
+
+#include "thread.h"
+#include "xtimer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Priority level scheduled by deadline
+ *
+ * No thread of the tree is created at this level by default, so it is shared
+ * only by the threads which are put there to get deadlines. Levels from
+ * THREAD_PRIORITY_MAIN - 1 to THREAD_PRIORITY_MAIN - 5 are taken by the
+ * LoRaLAN and GNRC threads.
+ */
+#ifndef SCHED_EDF_PRIO
+#define SCHED_EDF_PRIO          (THREAD_PRIORITY_MAIN - 6)
+#endif
+
+/**
+ * @brief   Deadline state of a thread
+ */
+typedef struct {
+    uint32_t relative;      /**< relative deadline [ticks], 0 if none */
+    uint32_t deadline;      /**< absolute deadline of the current job [ticks] */
+    uint32_t misses;        /**< jobs finished after their deadline */
+    uint8_t pending;        /**< job released, not finished yet */
+} sched_edf_t;
+
+/**
+ * @brief   Deadline state, indexed by PID
+ */
+extern sched_edf_t sched_edf[KERNEL_PID_LAST + 1];
+
+/**
+ * @brief   Clears the deadline of a new thread, called by the kernel
+ */
+void sched_edf_thread_init(kernel_pid_t pid);
+
+/**
+ * @brief   Puts a thread leaving a blocked state into the run queue of
+ *          @ref SCHED_EDF_PRIO, called by the kernel
+ *
+ * Starts a new job of the thread if it has a deadline.
+ */
+void sched_edf_release(thread_t *thread);
+
+/**
+ * @brief   Records a thread at @ref SCHED_EDF_PRIO blocking, called by the
+ *          kernel
+ */
+void sched_edf_complete(thread_t *thread);
+
+/**
+ * @brief   Puts a thread into the run queue of @ref SCHED_EDF_PRIO by its
+ *          current deadline, called by the kernel
+ *
+ * @param[in] thread    thread to insert, removed from the run queue first if
+ *                      it is in it
+ */
+void sched_edf_requeue(thread_t *thread);
+
+/**
+ * @brief   Checks whether the active thread has to give way to another one
+ *          at @ref SCHED_EDF_PRIO, called by the kernel
+ *
+ * @return  1 if another thread at the level has an earlier deadline
+ */
+int sched_edf_preempt(void);
+
+/**
+ * @brief   Sets the relative deadline of a thread
+ *
+ * Takes effect the next time the thread is woken up. The thread is only
+ * scheduled by deadline while its priority is @ref SCHED_EDF_PRIO.
+ *
+ * @param[in] pid       thread
+ * @param[in] us        relative deadline [us], 0 to remove it
+ */
+void sched_edf_set_deadline(kernel_pid_t pid, uint32_t us);
+
+/**
+ * @brief   Returns the number of deadline misses of a thread
+ */
+static inline uint32_t sched_edf_misses(kernel_pid_t pid)
+{
+    return sched_edf[pid].misses;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SCHED_EDF_H */
+/** @} */
@@ -0,0 +1,191 @@
+/*
+ * Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    sys_sched_prof Thread profiler
+ * @ingroup     sys
+ * @brief       Per-thread CPU time, wakeup latency and queue usage counters
+ *
+ * With `USEMODULE += sched_prof` the scheduler keeps for every thread:
+ *
+ * - CPU time and number of times it was scheduled
+ * - histogram and maximum of the latency between its wakeup (leaving a
+ *   blocked state) and the moment it actually runs
+ * - high-water mark of its message queue
+ *
+ * The minimum free stack is measured when the counters are read, if the
+ * stack start is known (DEVELHELP or SCHED_TEST_STACK).
+ *
+ * All counters have a fixed size and saturate or wrap instead of growing.
+ * The cost is one clock read per context switch and per wakeup and a few
+ * additions, so the profiler may stay enabled in production firmware. The
+ * clock is xtimer by default, a cheaper free-running counter (e.g. the cycle
+ * counter of the CPU) can be plugged in through @ref SCHED_PROF_NOW.
+ *
+ * Counters are printed by the `prof` shell command and exported as binary
+ * records by sched_prof_export().
+ *
+ * @{
+ *
+ * @file
+ * @brief       Thread profiler interface
+ */
+
+#ifndef SCHED_PROF_H
+#define SCHED_PROF_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "kernel_types.h"
+#include "xtimer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Time stamp source, 32 bit free-running ticks
+ */
+#ifndef SCHED_PROF_NOW
+#define SCHED_PROF_NOW()        (xtimer_now().ticks32)
+#endif
+
+/**
+ * @brief   Frequency of @ref SCHED_PROF_NOW, reported in the binary export
+ */
+#ifndef SCHED_PROF_HZ
+#define SCHED_PROF_HZ           (XTIMER_HZ)
+#endif
+
+/**
+ * @brief   Number of wakeup latency histogram buckets
+ *
+ * Bucket n counts latencies below 4^(n + 1) ticks, the last one all the
+ * longer ones.
+ */
+#define SCHED_PROF_LAT_BUCKETS  (8)
+
+/**
+ * @brief   Size of the binary export header
+ *
+ * Magic "SP", format version, record length, @ref SCHED_PROF_HZ. Records
+ * follow up to the end of the data.
+ */
+#define SCHED_PROF_HDR_LEN      (8)
+
+/**
+ * @brief   Size of a binary export record
+ *
+ * PID, priority, free stack (0xFFFF if unknown), CPU time, switches,
+ * max. latency, latency histogram, message queue high-water mark. Integers
+ * are little endian.
+ */
+#define SCHED_PROF_RECORD_LEN   (1 + 1 + 2 + 8 + 4 + 4 + 2 * SCHED_PROF_LAT_BUCKETS + 2)
+
+/**
+ * @brief   Profiling counters of a thread
+ */
+typedef struct {
+    uint64_t runtime;                           /**< CPU time [ticks] */
+    uint32_t last;                              /**< time stamp of the last switch
+                                                     to the thread */
+    uint32_t woken_at;                          /**< time stamp of the last wakeup */
+    uint32_t switches;                          /**< times scheduled to run */
+    uint32_t lat_max;                           /**< longest wakeup latency [ticks] */
+    uint16_t lat_hist[SCHED_PROF_LAT_BUCKETS];  /**< wakeup latency histogram,
+                                                     saturating */
+    uint16_t msg_hwm;                           /**< most messages queued at once */
+    uint8_t woken;                              /**< woken up, not run yet */
+} sched_prof_t;
+
+/**
+ * @brief   Profiling counters, indexed by PID
+ */
+extern sched_prof_t sched_prof[KERNEL_PID_LAST + 1];
+
+/**
+ * @brief   Resets the counters of a new thread, called by the kernel
+ */
+void sched_prof_thread_init(kernel_pid_t pid);
+
+/**
+ * @brief   Records a thread leaving a blocked state, called by the kernel
+ */
+static inline void sched_prof_wakeup(kernel_pid_t pid)
+{
+    sched_prof[pid].woken_at = SCHED_PROF_NOW();
+    sched_prof[pid].woken = 1;
+}
+
+/**
+ * @brief   Records a context switch, called by the kernel
+ *
+ * @param[in] prev  PID of the thread switched from, KERNEL_PID_UNDEF if none
+ * @param[in] next  PID of the thread switched to
+ */
+void sched_prof_switch(kernel_pid_t prev, kernel_pid_t next);
+
+/**
+ * @brief   Records the depth of the message queue of a thread, called by the
+ *          kernel
+ */
+static inline void sched_prof_msg_queued(kernel_pid_t pid, unsigned depth)
+{
+    if (depth > sched_prof[pid].msg_hwm) {
+        sched_prof[pid].msg_hwm = depth;
+    }
+}
+
+/**
+ * @brief   Clears the counters of all threads
+ */
+void sched_prof_reset(void);
+
+/**
+ * @brief   Prints the counters of all threads to stdout
+ */
+void sched_prof_print(void);
+
+/**
+ * @brief   Writes the binary export header
+ *
+ * @param[out] buf  buffer of at least @ref SCHED_PROF_HDR_LEN bytes
+ *
+ * @return  @ref SCHED_PROF_HDR_LEN
+ */
+size_t sched_prof_export_header(uint8_t *buf);
+
+/**
+ * @brief   Writes the counters of a thread as a binary record
+ *
+ * @param[in]  pid  thread to export
+ * @param[out] buf  buffer of at least @ref SCHED_PROF_RECORD_LEN bytes
+ *
+ * @return  @ref SCHED_PROF_RECORD_LEN
+ * @return  0 if there is no thread @p pid
+ */
+size_t sched_prof_export_thread(kernel_pid_t pid, uint8_t *buf);
+
+/**
+ * @brief   Writes the header and the records of all threads
+ *
+ * @param[out] buf  buffer to write to
+ * @param[in]  len  size of @p buf
+ *
+ * @return  number of bytes written, records not fitting into @p buf are
+ *          left out
+ */
+size_t sched_prof_export(uint8_t *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SCHED_PROF_H */
+/** @} */
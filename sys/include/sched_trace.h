@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    sys_sched_trace Scheduler trace
+ * @ingroup     sys
+ * @brief       Binary ring buffer of scheduler and IPC events
+ *
+ * With `USEMODULE += sched_trace` the kernel records context switches,
+ * message sends and receives, mutex waits and wakeups, thread flags and,
+ * on Cortex-M, interrupt exits into a ring of 8 byte records. The oldest
+ * records are overwritten, so the ring always holds the latest timeline.
+ *
+ * The ring is dumped as hex by the `trace` shell command and on kernel
+ * panic. `dist/tools/sched_trace/sched_trace.py` converts a dump found in a
+ * terminal log into a Chrome trace (JSON) to be opened in Perfetto or
+ * chrome://tracing.
+ *
+ * @{
+ *
+ * @file
+ * @brief       Scheduler trace interface
+ */
+
+#ifndef SCHED_TRACE_H
+#define SCHED_TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Number of records in the ring, must be a power of two
+ */
+#ifndef SCHED_TRACE_SIZE
+#define SCHED_TRACE_SIZE        (128)
+#endif
+
+/**
+ * @brief   Time stamp source, 32 bit free-running ticks
+ *
+ * Only expanded in the implementation, so this header does not pull in
+ * xtimer and can be included from CPU headers.
+ */
+#ifndef SCHED_TRACE_NOW
+#define SCHED_TRACE_NOW()       (xtimer_now().ticks32)
+#endif
+
+/**
+ * @brief   Frequency of @ref SCHED_TRACE_NOW
+ */
+#ifndef SCHED_TRACE_HZ
+#define SCHED_TRACE_HZ          (XTIMER_HZ)
+#endif
+
+/**
+ * @name    Trace events
+ * @{
+ */
+#define SCHED_TRACE_SWITCH      (0x01)  /**< arg8: next PID, arg16: previous PID,
+                                             previous status << 8 */
+#define SCHED_TRACE_MSG_SEND    (0x02)  /**< arg8: target PID, arg16: msg type */
+#define SCHED_TRACE_MSG_RECV    (0x03)  /**< arg8: sender PID, arg16: msg type */
+#define SCHED_TRACE_MSG_WAIT    (0x04)  /**< waiting for a message */
+#define SCHED_TRACE_MUTEX_WAIT  (0x05)  /**< arg16: mutex address, lower bits */
+#define SCHED_TRACE_MUTEX_WAKE  (0x06)  /**< arg8: PID of the new holder,
+                                             arg16: mutex address, lower bits */
+#define SCHED_TRACE_FLAGS_SET   (0x07)  /**< arg8: target PID, arg16: flags */
+#define SCHED_TRACE_FLAGS_WAIT  (0x08)  /**< arg16: flags waited for */
+#define SCHED_TRACE_ISR         (0x09)  /**< arg8: exception number, at ISR exit */
+#define SCHED_TRACE_USER        (0x40)  /**< first event ID free for applications */
+#define SCHED_TRACE_IN_ISR      (0x80)  /**< flag: recorded in interrupt context */
+/** @} */
+
+/**
+ * @brief   Trace record
+ */
+typedef struct {
+    uint32_t time;      /**< time stamp [SCHED_TRACE_HZ ticks] */
+    uint8_t event;      /**< event ID, SCHED_TRACE_IN_ISR flag */
+    uint8_t arg8;       /**< event argument, usually a PID */
+    uint16_t arg16;     /**< event argument */
+} sched_trace_rec_t;
+
+/**
+ * @brief   Records an event
+ *
+ * Cheap enough to be called from the scheduler and from interrupts.
+ *
+ * @param[in] event     event ID, SCHED_TRACE_IN_ISR is added when needed
+ * @param[in] arg8      first argument
+ * @param[in] arg16     second argument
+ */
+void sched_trace_record(uint8_t event, uint8_t arg8, uint16_t arg16);
+
+/**
+ * @brief   Starts or stops recording, recording is on after boot
+ */
+void sched_trace_enable(bool enable);
+
+/**
+ * @brief   Drops all records
+ */
+void sched_trace_clear(void);
+
+/**
+ * @brief   Prints the records to stdout in the format read by
+ *          `dist/tools/sched_trace/sched_trace.py`, oldest first
+ *
+ * Recording is stopped while dumping.
+ */
+void sched_trace_dump(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SCHED_TRACE_H */
+/** @} */
@@ -20,6 +20,15 @@
  * number of active timers.  The reason for this is that multiplexing is
  * realized by next-first singly linked lists.
  *
+ * With the `xtimer_wheel` pseudomodule the lists are replaced by a
+ * hierarchical timing wheel: timers are hashed into slots of growing width by
+ * their target time, so insertion and removal take constant time regardless
+ * of the number of active timers. Timers are sorted only when their slot comes
+ * due, i.e., among those expiring within the same XTIMER_WHEEL_SLOT_SHIFT
+ * ticks. This costs an extra pointer per timer, the slot array
+ * (XTIMER_WHEEL_LEVELS * 2^XTIMER_WHEEL_BITS pointers) and an occasional
+ * interrupt to move timers from a wider slot into the narrower ones.
+ *
  * @{
  * @file
  * @brief   xtimer interface definitions
@@ -69,6 +78,10 @@ typedef void (*xtimer_callback_t)(void*);
  */
 typedef struct xtimer {
     struct xtimer *next;         /**< reference to next timer in timer lists */
+#if defined(MODULE_XTIMER_WHEEL) || DOXYGEN
+    struct xtimer **pprev;       /**< reference to the link pointing to this
+                                     timer, for removal in constant time */
+#endif
     uint32_t target;             /**< lower 32bit absolute target time */
     uint32_t long_target;        /**< upper 32bit absolute target time */
     xtimer_callback_t callback;  /**< callback function to call when timer
@@ -312,6 +325,69 @@ static inline void xtimer_set(xtimer_t *timer, uint32_t offset);
  */
 static inline void xtimer_set64(xtimer_t *timer, uint64_t offset_us);
 
+/**
+ * @brief Set a timer to execute a callback within a window in the future
+ *
+ * Like xtimer_set(), but the callback may be executed up to @p slack
+ * microseconds later than @p offset. The timer is moved to the target of a
+ * timer already set within the window, or to a round time within it, so
+ * that timers set with overlapping windows expire in one wakeup.
+ *
+ * @param[in] timer     the timer structure to use.
+ *                      Its xtimer_t::target and xtimer_t::long_target
+ *                      fields need to be initialized with 0 on first use
+ * @param[in] offset    earliest time in microseconds from now to execute
+ *                      the timer's callback
+ * @param[in] slack     allowed delay in microseconds after @p offset
+ */
+static inline void xtimer_set_slack(xtimer_t *timer, uint32_t offset, uint32_t slack);
+
+/**
+ * @brief Set a timer that sends a message within a window in the future
+ *
+ * Like xtimer_set_msg(), but the message may be sent up to @p slack
+ * microseconds later, see xtimer_set_slack().
+ *
+ * @param[in] timer         timer struct to work with.
+ *                          Its xtimer_t::target and xtimer_t::long_target
+ *                          fields need to be initialized with 0 on first use.
+ * @param[in] offset        microseconds from now
+ * @param[in] slack         allowed delay in microseconds after @p offset
+ * @param[in] msg           ptr to msg that will be sent
+ * @param[in] target_pid    pid the message will be sent to
+ */
+static inline void xtimer_set_msg_slack(xtimer_t *timer, uint32_t offset, uint32_t slack,
+                                        msg_t *msg, kernel_pid_t target_pid);
+
+/**
+ * @brief xtimer wakeup statistics
+ */
+typedef struct {
+    uint32_t wakeups;           /**< timer interrupts that executed timers */
+    uint32_t wakeups_saved;     /**< timers executed in the interrupt of
+                                     another timer */
+    uint32_t coalesced;         /**< timers moved onto the target of another
+                                     timer within their slack */
+} xtimer_wakeup_stats_t;
+
+/**
+ * @brief Get wakeup statistics
+ *
+ * @return pointer to the statistics, updated as timers expire
+ */
+const xtimer_wakeup_stats_t *xtimer_get_wakeup_stats(void);
+
+/**
+ * @brief Get the time until the next timer interrupt
+ *
+ * Includes the internal overflow interrupts of narrow low-level timers. Meant
+ * for the idle thread to choose a low power mode.
+ *
+ * @return ticks until the earliest pending timer, UINT32_MAX if there is none
+ *         or it is further away
+ */
+uint32_t xtimer_time_until_next(void);
+
 /**
  * @brief remove a timer
  *
@@ -587,6 +663,39 @@ void xtimer_set_timeout_flag(xtimer_t *t, uint32_t timeout);
 #define XTIMER_MASK (0)
 #endif
 
+#if defined(MODULE_XTIMER_WHEEL) || DOXYGEN
+#ifndef XTIMER_WHEEL_SLOT_SHIFT
+/**
+ * @brief   Width of the timing wheel's finest slots, log2 of hardware ticks
+ *
+ * Timers expiring within the same finest slot are kept sorted, so insertion
+ * costs grow with the number of timers sharing it. Must be less than
+ * XTIMER_WIDTH.
+ */
+#define XTIMER_WHEEL_SLOT_SHIFT (10)
+#endif
+
+#ifndef XTIMER_WHEEL_BITS
+/**
+ * @brief   Number of slots per timing wheel level, log2 (at most 5)
+ */
+#define XTIMER_WHEEL_BITS (5)
+#endif
+
+#ifndef XTIMER_WHEEL_LEVELS
+/**
+ * @brief   Number of timing wheel levels
+ *
+ * Each level is 2^XTIMER_WHEEL_BITS times coarser than the previous one.
+ * Timers beyond the last level are kept in an unsorted list which is
+ * redistributed as they come into its range, by default after
+ * 2^(XTIMER_WHEEL_SLOT_SHIFT + XTIMER_WHEEL_LEVELS * XTIMER_WHEEL_BITS) ticks,
+ * about 18 minutes at 1 MHz.
+ */
+#define XTIMER_WHEEL_LEVELS (4)
+#endif
+#endif
+
 /**
  * @brief  Base frequency of xtimer is 1 MHz
  */
@@ -68,9 +68,11 @@ static inline uint32_t _xtimer_lltimer_mask(uint32_t val)
 uint64_t _xtimer_now64(void);
 int _xtimer_set_absolute(xtimer_t *timer, uint32_t target);
 void _xtimer_set(xtimer_t *timer, uint32_t offset);
+void _xtimer_set_slack(xtimer_t *timer, uint32_t offset, uint32_t slack);
 void _xtimer_set64(xtimer_t *timer, uint32_t offset, uint32_t long_offset);
 void _xtimer_periodic_wakeup(uint32_t *last_wakeup, uint32_t period);
 void _xtimer_set_msg(xtimer_t *timer, uint32_t offset, msg_t *msg, kernel_pid_t target_pid);
+void _xtimer_set_msg_slack(xtimer_t *timer, uint32_t offset, uint32_t slack, msg_t *msg, kernel_pid_t target_pid);
 void _xtimer_set_msg64(xtimer_t *timer, uint64_t offset, msg_t *msg, kernel_pid_t target_pid);
 void _xtimer_set_wakeup(xtimer_t *timer, uint32_t offset, kernel_pid_t pid);
 void _xtimer_set_wakeup64(xtimer_t *timer, uint64_t offset, kernel_pid_t pid);
@@ -201,6 +203,13 @@ static inline void xtimer_set_msg(xtimer_t *timer, uint32_t offset, msg_t *msg,
     _xtimer_set_msg(timer, _xtimer_ticks_from_usec(offset), msg, target_pid);
 }
 
+static inline void xtimer_set_msg_slack(xtimer_t *timer, uint32_t offset, uint32_t slack,
+                                        msg_t *msg, kernel_pid_t target_pid)
+{
+    _xtimer_set_msg_slack(timer, _xtimer_ticks_from_usec(offset), _xtimer_ticks_from_usec(slack),
+                          msg, target_pid);
+}
+
 static inline void xtimer_set_msg64(xtimer_t *timer, uint64_t offset, msg_t *msg, kernel_pid_t target_pid)
 {
     _xtimer_set_msg64(timer, _xtimer_ticks_from_usec64(offset), msg, target_pid);
@@ -221,6 +230,11 @@ static inline void xtimer_set(xtimer_t *timer, uint32_t offset)
     _xtimer_set(timer, _xtimer_ticks_from_usec(offset));
 }
 
+static inline void xtimer_set_slack(xtimer_t *timer, uint32_t offset, uint32_t slack)
+{
+    _xtimer_set_slack(timer, _xtimer_ticks_from_usec(offset), _xtimer_ticks_from_usec(slack));
+}
+
 static inline void xtimer_set64(xtimer_t *timer, uint64_t period_us)
 {
     uint64_t ticks = _xtimer_ticks_from_usec64(period_us);
@@ -14,15 +14,70 @@
 
 #include <inttypes.h>
 #include <stdio.h>
+#include "byteorder.h"
 #include "od.h"
 #include "net/inet_csum.h"
 
 #define ENABLE_DEBUG    (0)
 #include "debug.h"
 
+/* In native byte order, a byte at an odd address is the upper half of a
+ * 16-bit word on little endian platforms and the lower half on big endian
+ * ones. The checksum domain always has the upper half first. */
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define NATIVE_LE   (1U)
+#else
+#define NATIVE_LE   (0U)
+#endif
+
+static inline unsigned _odd(const uint8_t *ptr)
+{
+    return (uintptr_t)ptr & 1;
+}
+
+static inline uint16_t _fold(uint64_t sum)
+{
+    while (sum >> 16) {
+        sum = (sum & 0xffff) + (sum >> 16);
+    }
+    return sum;
+}
+
+/* Sums up buf as 16-bit words in native byte order, with the words aligned to
+ * even addresses. As 2^16 = 1 (mod 0xffff), whole 32-bit words can be added
+ * as they are, the 64-bit sum takes the carries to be folded in at the end. */
+static uint64_t _sum(const uint8_t *buf, size_t len)
+{
+    uint64_t sum = 0;
+    const uint32_t *word;
+
+    while ((len > 0) && ((uintptr_t)buf & (sizeof(uint32_t) - 1))) {
+        sum += (uint32_t)*buf << ((_odd(buf) ^ NATIVE_LE ^ 1) << 3);
+        buf++;
+        len--;
+    }
+
+    word = (const uint32_t *)buf;
+    for (; len >= (4 * sizeof(uint32_t)); len -= (4 * sizeof(uint32_t))) {
+        sum += (uint64_t)word[0] + word[1] + word[2] + word[3];
+        word += 4;
+    }
+    for (; len >= sizeof(uint32_t); len -= sizeof(uint32_t)) {
+        sum += *(word++);
+    }
+
+    buf = (const uint8_t *)word;
+    while (len > 0) {
+        sum += (uint32_t)*buf << ((_odd(buf) ^ NATIVE_LE ^ 1) << 3);
+        buf++;
+        len--;
+    }
+    return sum;
+}
+
 uint16_t inet_csum_slice(uint16_t sum, const uint8_t *buf, uint16_t len, size_t accum_len)
 {
-    uint32_t csum = sum;
+    uint16_t csum;
 
     DEBUG("inet_sum: sum = 0x%04" PRIx16 ", len = %" PRIu16, sum, len);
 #if ENABLE_DEBUG
@@ -35,31 +90,32 @@ uint16_t inet_csum_slice(uint16_t sum, const uint8_t *buf, uint16_t len, size_t
 #endif
 
     if (len == 0)
-        return csum;
+        return sum;
 
-    if (accum_len & 1) {      /* if accumulated length is odd */
-        csum += *buf;         /* add first byte as bottom half of 16-byte word */
-        buf++;
-        len--;
-        accum_len++;
+    csum = _fold(_sum(buf, len));
+    /* the byte order of the one's complement sum can be swapped after
+     * summing up: swap if the first byte is not the upper half of a word in
+     * native byte order while it is in the checksum domain, or vice versa */
+    if (_odd(buf) ^ NATIVE_LE ^ (accum_len & 1)) {
+        csum = byteorder_swaps(csum);
     }
+    csum = _fold((uint32_t)sum + csum);
 
-    for (unsigned i = 0; i < (len >> 1); buf += 2, i++) {
-        csum += (uint16_t)(*buf << 8) + *(buf + 1); /* group bytes by 16-byte words */
-                                                    /* and add them */
-    }
+    DEBUG("inet_sum: new sum = 0x%04" PRIx16 "\n", csum);
 
-    if ((accum_len + len) & 1)          /* if accumulated length is odd */
-        csum += (uint16_t)(*buf << 8);  /* add last byte as top half of 16-byte word */
+    return csum;
+}
 
-    while (csum >> 16) {
-        uint16_t carry = csum >> 16;
-        csum = (csum & 0xffff) + carry;
-    }
+uint16_t inet_csum_update(uint16_t csum, const uint8_t *old_data,
+                          const uint8_t *new_data, uint16_t len)
+{
+    /* RFC 1624, eqn. 3: HC' = ~(~HC + ~m + m') */
+    uint32_t sum = (uint16_t)~csum;
 
-    DEBUG("inet_sum: new sum = 0x%04" PRIx32 "\n", csum);
+    sum += (uint16_t)~inet_csum(0, old_data, len);
+    sum += inet_csum(0, new_data, len);
 
-    return csum;
+    return ~_fold(sum);
 }
 
 /** @} */
@@ -42,6 +42,27 @@ static _nib_dr_entry_t _def_routers[GNRC_IPV6_NIB_DEFAULT_ROUTER_NUMOF];
 static _nib_abr_entry_t _abrs[GNRC_IPV6_NIB_ABR_NUMOF];
 #endif  /* GNRC_IPV6_NIB_CONF_MULTIHOP_P6C */
 
+#if GNRC_IPV6_NIB_CONF_INDEX
+/* Hash chains over _nodes and _dsts. Bucket heads and links hold the index of
+ * an entry plus one, 0 ends a chain. They are kept apart from the entries, as
+ * those are cleared with memset() all over the NIB.
+ *
+ * A node is in the chain of the address it was given last, i.e. a cleared node
+ * may stay in the chain of its old address. This is harmless as lookups
+ * check the entries in a chain and a cleared node is never a match. */
+static uint16_t _onl_buckets[GNRC_IPV6_NIB_NUMOF];
+static uint16_t _onl_next[GNRC_IPV6_NIB_NUMOF];
+static uint16_t _onl_bucket_of[GNRC_IPV6_NIB_NUMOF];
+
+/* An off-link entry is in the chain of its prefix from its allocation until
+ * _nib_offl_clear(). Only the prefix lengths in use are looked up for the
+ * longest prefix match. */
+static uint16_t _offl_buckets[GNRC_IPV6_NIB_OFFL_NUMOF];
+static uint16_t _offl_next[GNRC_IPV6_NIB_OFFL_NUMOF];
+static uint16_t _offl_len_count[IPV6_ADDR_BIT_LEN + 1];
+static BITFIELD(_offl_lens, IPV6_ADDR_BIT_LEN + 1);
+#endif  /* GNRC_IPV6_NIB_CONF_INDEX */
+
 static char addr_str[IPV6_ADDR_MAX_STR_LEN];
 
 mutex_t _nib_mutex = MUTEX_INIT;
@@ -62,6 +83,13 @@ void _nib_init(void)
 #if GNRC_IPV6_NIB_CONF_MULTIHOP_P6C
     memset(_abrs, 0, sizeof(_abrs));
 #endif  /* GNRC_IPV6_NIB_CONF_MULTIHOP_P6C */
+#if GNRC_IPV6_NIB_CONF_INDEX
+    memset(_onl_buckets, 0, sizeof(_onl_buckets));
+    memset(_onl_bucket_of, 0, sizeof(_onl_bucket_of));
+    memset(_offl_buckets, 0, sizeof(_offl_buckets));
+    memset(_offl_len_count, 0, sizeof(_offl_len_count));
+    memset(_offl_lens, 0, sizeof(_offl_lens));
+#endif  /* GNRC_IPV6_NIB_CONF_INDEX */
 #endif  /* TEST_SUITES */
     evtimer_init_msg(&_nib_evtimer);
     /* TODO: load ABR information from persistent memory */
@@ -74,6 +102,70 @@ static inline bool _addr_equals(const ipv6_addr_t *addr,
            (ipv6_addr_equal(addr, &node->ipv6));
 }
 
+#if GNRC_IPV6_NIB_CONF_INDEX
+/* FNV-1a, bytewise as addresses in packets may be unaligned */
+static uint32_t _hash(const ipv6_addr_t *addr, unsigned len)
+{
+    uint32_t hash = 2166136261U ^ len;
+
+    for (unsigned i = 0; i < sizeof(addr->u8); i++) {
+        hash = (hash ^ addr->u8[i]) * 16777619U;
+    }
+    return hash;
+}
+
+static inline unsigned _onl_bucket(const ipv6_addr_t *addr)
+{
+    return _hash(addr, 0) % GNRC_IPV6_NIB_NUMOF;
+}
+
+/* to be called whenever the address of a node changed */
+static void _onl_index(const _nib_onl_entry_t *node)
+{
+    unsigned idx = node - _nodes;
+    unsigned bucket = _onl_bucket(&node->ipv6) + 1;
+
+    if (_onl_bucket_of[idx] == bucket) {
+        return;
+    }
+    if (_onl_bucket_of[idx] != 0) {
+        uint16_t *ptr = &_onl_buckets[_onl_bucket_of[idx] - 1];
+
+        while (*ptr != (idx + 1)) {
+            ptr = &_onl_next[*ptr - 1];
+        }
+        *ptr = _onl_next[idx];
+    }
+    _onl_next[idx] = _onl_buckets[bucket - 1];
+    _onl_buckets[bucket - 1] = idx + 1;
+    _onl_bucket_of[idx] = bucket;
+}
+
+/* first node in the chain of bucket on iface with address addr or an
+ * unspecified one, res if that comes first in _nodes */
+static _nib_onl_entry_t *_onl_index_get_exact(unsigned bucket,
+                                              const ipv6_addr_t *addr,
+                                              unsigned iface,
+                                              _nib_onl_entry_t *res)
+{
+    for (unsigned idx = _onl_buckets[bucket]; idx != 0;
+         idx = _onl_next[idx - 1]) {
+        _nib_onl_entry_t *tmp = &_nodes[idx - 1];
+
+        if (((res == NULL) || (tmp < res)) &&
+            (_nib_onl_get_if(tmp) == iface) && _addr_equals(addr, tmp)) {
+            res = tmp;
+        }
+    }
+    return res;
+}
+#else   /* GNRC_IPV6_NIB_CONF_INDEX */
+static inline void _onl_index(const _nib_onl_entry_t *node)
+{
+    (void)node;
+}
+#endif  /* GNRC_IPV6_NIB_CONF_INDEX */
+
 _nib_onl_entry_t *_nib_onl_alloc(const ipv6_addr_t *addr, unsigned iface)
 {
     _nib_onl_entry_t *node = NULL;
@@ -81,6 +173,22 @@ _nib_onl_entry_t *_nib_onl_alloc(const ipv6_addr_t *addr, unsigned iface)
     DEBUG("nib: Allocating on-link node entry (addr = %s, iface = %u)\n",
           (addr == NULL) ? "NULL" : ipv6_addr_to_str(addr_str, addr,
                                                      sizeof(addr_str)), iface);
+#if GNRC_IPV6_NIB_CONF_INDEX
+    /* nodes on an interface are all in the chain of their address, so
+     * without an exact match in there only an empty node is left to find */
+    if ((addr != NULL) && (iface != 0)) {
+        node = _onl_index_get_exact(_onl_bucket(addr), addr, iface, NULL);
+        node = _onl_index_get_exact(_onl_bucket(&ipv6_addr_unspecified),
+                                    addr, iface, node);
+        for (unsigned i = 0; (node == NULL) && (i < GNRC_IPV6_NIB_NUMOF); i++) {
+            if (_nodes[i].mode == _EMPTY) {
+                node = &_nodes[i];
+            }
+        }
+        DEBUG("  using %p\n", (void *)node);
+    }
+    else
+#endif  /* GNRC_IPV6_NIB_CONF_INDEX */
     for (unsigned i = 0; i < GNRC_IPV6_NIB_NUMOF; i++) {
         _nib_onl_entry_t *tmp = &_nodes[i];
 
@@ -198,24 +306,47 @@ _nib_onl_entry_t *_nib_onl_iter(const _nib_onl_entry_t *last)
     return NULL;
 }
 
+static inline bool _onl_matches(const _nib_onl_entry_t *node,
+                                const ipv6_addr_t *addr, unsigned iface)
+{
+    return (node->mode != _EMPTY) &&
+           /* either requested or current interface undefined or
+            * interfaces equal */
+           ((_nib_onl_get_if(node) == 0) || (iface == 0) ||
+            (_nib_onl_get_if(node) == iface)) &&
+           ipv6_addr_equal(&node->ipv6, addr);
+}
+
 _nib_onl_entry_t *_nib_onl_get(const ipv6_addr_t *addr, unsigned iface)
 {
     assert(addr != NULL);
     DEBUG("nib: Getting on-link node entry (addr = %s, iface = %u)\n",
           ipv6_addr_to_str(addr_str, addr, sizeof(addr_str)), iface);
+#if GNRC_IPV6_NIB_CONF_INDEX
+    _nib_onl_entry_t *res = NULL;
+
+    for (unsigned idx = _onl_buckets[_onl_bucket(addr)]; idx != 0;
+         idx = _onl_next[idx - 1]) {
+        _nib_onl_entry_t *node = &_nodes[idx - 1];
+
+        if (((res == NULL) || (node < res)) && _onl_matches(node, addr, iface)) {
+            res = node;
+        }
+    }
+    if (res != NULL) {
+        DEBUG("  Found %p\n", (void *)res);
+        return res;
+    }
+#else   /* GNRC_IPV6_NIB_CONF_INDEX */
     for (unsigned i = 0; i < GNRC_IPV6_NIB_NUMOF; i++) {
         _nib_onl_entry_t *node = &_nodes[i];
 
-        if ((node->mode != _EMPTY) &&
-            /* either requested or current interface undefined or
-             * interfaces equal */
-            ((_nib_onl_get_if(node) == 0) || (iface == 0) ||
-             (_nib_onl_get_if(node) == iface)) &&
-            ipv6_addr_equal(&node->ipv6, addr)) {
+        if (_onl_matches(node, addr, iface)) {
             DEBUG("  Found %p\n", (void *)node);
             return node;
         }
     }
+#endif  /* GNRC_IPV6_NIB_CONF_INDEX */
     DEBUG("  No suitable entry found\n");
     return NULL;
 }
@@ -437,10 +568,59 @@ void _nib_drl_ft_get(const _nib_dr_entry_t *drl, gnrc_ipv6_nib_ft_t *fte)
     fte->iface = _nib_onl_get_if(drl->next_hop);
 }
 
+#if GNRC_IPV6_NIB_CONF_INDEX
+static inline unsigned _offl_bucket(const ipv6_addr_t *pfx, unsigned pfx_len)
+{
+    ipv6_addr_t masked = IPV6_ADDR_UNSPECIFIED;
+
+    ipv6_addr_init_prefix(&masked, pfx, pfx_len);
+    return _hash(&masked, pfx_len) % GNRC_IPV6_NIB_OFFL_NUMOF;
+}
+
+static void _offl_index(const _nib_offl_entry_t *dst)
+{
+    unsigned idx = dst - _dsts;
+    unsigned bucket = _offl_bucket(&dst->pfx, dst->pfx_len);
+
+    _offl_next[idx] = _offl_buckets[bucket];
+    _offl_buckets[bucket] = idx + 1;
+    if (_offl_len_count[dst->pfx_len]++ == 0) {
+        bf_set(_offl_lens, dst->pfx_len);
+    }
+}
+
+static void _offl_unindex(const _nib_offl_entry_t *dst)
+{
+    unsigned idx = dst - _dsts;
+    uint16_t *ptr = &_offl_buckets[_offl_bucket(&dst->pfx, dst->pfx_len)];
+
+    while (*ptr != (idx + 1)) {
+        ptr = &_offl_next[*ptr - 1];
+    }
+    *ptr = _offl_next[idx];
+    if (--_offl_len_count[dst->pfx_len] == 0) {
+        bf_unset(_offl_lens, dst->pfx_len);
+    }
+}
+#endif  /* GNRC_IPV6_NIB_CONF_INDEX */
+
+static inline bool _offl_is_exact(const _nib_offl_entry_t *dst,
+                                  const ipv6_addr_t *next_hop, unsigned iface,
+                                  const ipv6_addr_t *pfx, unsigned pfx_len)
+{
+    _nib_onl_entry_t *node = dst->next_hop;
+
+    return (dst->pfx_len == pfx_len) &&                 /* prefix length matches and */
+           (node != NULL) &&                            /* there is a next hop that */
+           (_nib_onl_get_if(node) == iface) &&          /* has a matching interface and */
+           _addr_equals(next_hop, node) &&              /* equal address to next_hop, also */
+           (ipv6_addr_match_prefix(&dst->pfx, pfx) >= pfx_len); /* the prefix matches */
+}
+
 _nib_offl_entry_t *_nib_offl_alloc(const ipv6_addr_t *next_hop, unsigned iface,
                                    const ipv6_addr_t *pfx, unsigned pfx_len)
 {
-    _nib_offl_entry_t *dst = NULL;
+    _nib_offl_entry_t *dst = NULL, *exact = NULL;
 
     assert((pfx != NULL) && (!ipv6_addr_is_unspecified(pfx)) &&
            (pfx_len > 0) && (pfx_len <= 128));
@@ -451,27 +631,47 @@ _nib_offl_entry_t *_nib_offl_alloc(const ipv6_addr_t *next_hop, unsigned iface,
           iface);
     DEBUG("pfx = %s/%u)\n", ipv6_addr_to_str(addr_str, pfx,
                                              sizeof(addr_str)), pfx_len);
+#if GNRC_IPV6_NIB_CONF_INDEX
+    /* entries in use are all in the chain of their prefix */
+    for (unsigned idx = _offl_buckets[_offl_bucket(pfx, pfx_len)]; idx != 0;
+         idx = _offl_next[idx - 1]) {
+        _nib_offl_entry_t *tmp = &_dsts[idx - 1];
+
+        if (((exact == NULL) || (tmp < exact)) &&
+            _offl_is_exact(tmp, next_hop, iface, pfx, pfx_len)) {
+            exact = tmp;
+        }
+    }
+    for (unsigned i = 0; (exact == NULL) && (dst == NULL) &&
+         (i < GNRC_IPV6_NIB_OFFL_NUMOF); i++) {
+        if (_dsts[i].next_hop == NULL) {
+            dst = &_dsts[i];
+        }
+    }
+#else   /* GNRC_IPV6_NIB_CONF_INDEX */
     for (unsigned i = 0; i < GNRC_IPV6_NIB_OFFL_NUMOF; i++) {
         _nib_offl_entry_t *tmp = &_dsts[i];
-        _nib_onl_entry_t *tmp_node = tmp->next_hop;
 
-        if ((tmp->pfx_len == pfx_len) &&                /* prefix length matches and */
-            (tmp_node != NULL) &&                       /* there is a next hop that */
-            (_nib_onl_get_if(tmp_node) == iface) &&     /* has a matching interface and */
-            _addr_equals(next_hop, tmp_node) &&         /* equal address to next_hop, also */
-            (ipv6_addr_match_prefix(&tmp->pfx, pfx) >= pfx_len)) {  /* the prefix matches */
-            /* exact match (or next hop address was previously unset) */
-            DEBUG("  %p is an exact match\n", (void *)tmp);
-            if (next_hop != NULL) {
-                memcpy(&tmp_node->ipv6, next_hop, sizeof(tmp_node->ipv6));
-            }
-            tmp->next_hop->mode |= _DST;
-            return tmp;
+        if (_offl_is_exact(tmp, next_hop, iface, pfx, pfx_len)) {
+            exact = tmp;
+            break;
         }
-        if ((dst == NULL) && (tmp_node == NULL)) {
+        if ((dst == NULL) && (tmp->next_hop == NULL)) {
             dst = tmp;
         }
     }
+#endif  /* GNRC_IPV6_NIB_CONF_INDEX */
+    if (exact != NULL) {
+        /* exact match (or next hop address was previously unset) */
+        DEBUG("  %p is an exact match\n", (void *)exact);
+        if (next_hop != NULL) {
+            memcpy(&exact->next_hop->ipv6, next_hop,
+                   sizeof(exact->next_hop->ipv6));
+            _onl_index(exact->next_hop);
+        }
+        exact->next_hop->mode |= _DST;
+        return exact;
+    }
     if (dst != NULL) {
         DEBUG("  using %p\n", (void *)dst);
         dst->next_hop = _nib_onl_alloc(next_hop, iface);
@@ -484,6 +684,9 @@ _nib_offl_entry_t *_nib_offl_alloc(const ipv6_addr_t *next_hop, unsigned iface,
         dst->next_hop->mode |= _DST;
         ipv6_addr_init_prefix(&dst->pfx, pfx, pfx_len);
         dst->pfx_len = pfx_len;
+#if GNRC_IPV6_NIB_CONF_INDEX
+        _offl_index(dst);
+#endif  /* GNRC_IPV6_NIB_CONF_INDEX */
     }
     return dst;
 }
@@ -515,6 +718,9 @@ void _nib_offl_clear(_nib_offl_entry_t *dst)
             dst->next_hop->mode &= ~(_DST);
             _nib_onl_clear(dst->next_hop);
         }
+#if GNRC_IPV6_NIB_CONF_INDEX
+        _offl_unindex(dst);
+#endif  /* GNRC_IPV6_NIB_CONF_INDEX */
         memset(dst, 0, sizeof(_nib_offl_entry_t));
     }
 }
@@ -541,10 +747,38 @@ bool _nib_offl_is_entry(const _nib_offl_entry_t *entry)
 static _nib_offl_entry_t *_nib_offl_get_match(const ipv6_addr_t *dst)
 {
     _nib_offl_entry_t *res = NULL;
-    uint8_t best_match = 0;
 
     DEBUG("nib: get match for destination %s from NIB\n",
           ipv6_addr_to_str(addr_str, dst, sizeof(addr_str)));
+#if GNRC_IPV6_NIB_CONF_INDEX
+    /* look up the prefixes of dst, longest first, for the lengths in use */
+    for (int len = IPV6_ADDR_BIT_LEN; len > 0; len--) {
+        if (_offl_lens[len / 8] == 0) {
+            /* skip the rest of this byte of the bitfield */
+            len &= ~0x7;
+            continue;
+        }
+        if (!bf_isset(_offl_lens, len)) {
+            continue;
+        }
+        for (unsigned idx = _offl_buckets[_offl_bucket(dst, len)]; idx != 0;
+             idx = _offl_next[idx - 1]) {
+            _nib_offl_entry_t *entry = &_dsts[idx - 1];
+
+            if (((res == NULL) || (entry < res)) &&
+                (entry->mode != _EMPTY) && (entry->pfx_len == len) &&
+                (ipv6_addr_match_prefix(&entry->pfx, dst) >= len)) {
+                res = entry;
+            }
+        }
+        if (res != NULL) {
+            DEBUG("nib: best match %s/%u\n",
+                  ipv6_addr_to_str(addr_str, &res->pfx, sizeof(addr_str)),
+                  res->pfx_len);
+            break;
+        }
+    }
+#else   /* GNRC_IPV6_NIB_CONF_INDEX */
     for (_nib_offl_entry_t *entry = _dsts; _in_dsts(entry); entry++) {
         if (entry->mode != _EMPTY) {
             uint8_t match = ipv6_addr_match_prefix(&entry->pfx, dst);
@@ -557,13 +791,15 @@ static _nib_offl_entry_t *_nib_offl_get_match(const ipv6_addr_t *dst)
                   ipv6_addr_to_str(addr_str, &entry->next_hop->ipv6,
                                    sizeof(addr_str)),
                   _nib_onl_get_if(entry->next_hop), match);
-            if ((match > best_match) && (match >= entry->pfx_len)) {
-                DEBUG("nib: best match (%u bits)\n", match);
+            /* longest prefix wins, the first one of equal length */
+            if ((match >= entry->pfx_len) &&
+                ((res == NULL) || (entry->pfx_len > res->pfx_len))) {
+                DEBUG("nib: best match (%u bits)\n", entry->pfx_len);
                 res = entry;
-                best_match = match;
             }
         }
     }
+#endif  /* GNRC_IPV6_NIB_CONF_INDEX */
     return res;
 }
 
@@ -622,6 +858,49 @@ int _nib_get_route(const ipv6_addr_t *dst, gnrc_pktsnip_t *pkt,
     return 0;
 }
 
+static inline bool _pl_on_link(const _nib_offl_entry_t *entry,
+                               const ipv6_addr_t *dst)
+{
+    return (entry->mode & _PL) && (entry->flags & _PFX_ON_LINK) &&
+           (ipv6_addr_match_prefix(dst, &entry->pfx) >= entry->pfx_len);
+}
+
+_nib_offl_entry_t *_nib_pl_get_on_link(const ipv6_addr_t *dst)
+{
+    _nib_offl_entry_t *res = NULL;
+
+#if GNRC_IPV6_NIB_CONF_INDEX
+    /* the first entry wins as with the iteration below, so the prefixes of
+     * dst are looked up for all the lengths in use */
+    for (unsigned len = 0; len <= IPV6_ADDR_BIT_LEN; len++) {
+        if (_offl_lens[len / 8] == 0) {
+            /* skip the rest of this byte of the bitfield */
+            len |= 0x7;
+            continue;
+        }
+        if (!bf_isset(_offl_lens, len)) {
+            continue;
+        }
+        for (unsigned idx = _offl_buckets[_offl_bucket(dst, len)]; idx != 0;
+             idx = _offl_next[idx - 1]) {
+            _nib_offl_entry_t *entry = &_dsts[idx - 1];
+
+            if (((res == NULL) || (entry < res)) &&
+                (entry->pfx_len == len) && _pl_on_link(entry, dst)) {
+                res = entry;
+            }
+        }
+    }
+#else   /* GNRC_IPV6_NIB_CONF_INDEX */
+    while ((res = _nib_offl_iter(res))) {
+        if (_pl_on_link(res, dst)) {
+            break;
+        }
+    }
+#endif  /* GNRC_IPV6_NIB_CONF_INDEX */
+    return res;
+}
+
 void _nib_pl_remove(_nib_offl_entry_t *nib_offl)
 {
     _nib_offl_remove(nib_offl, _PL);
@@ -795,6 +1074,7 @@ static void _override_node(const ipv6_addr_t *addr, unsigned iface,
         memcpy(&node->ipv6, addr, sizeof(node->ipv6));
     }
     _nib_onl_set_if(node, iface);
+    _onl_index(node);
 }
 
 static inline bool _node_unreachable(_nib_onl_entry_t *node)
@@ -811,17 +1091,15 @@ static inline bool _node_unreachable(_nib_onl_entry_t *node)
 
 uint32_t _evtimer_lookup(const void *ctx, uint16_t type)
 {
-    evtimer_msg_event_t *event = (evtimer_msg_event_t *)_nib_evtimer.events;
-    uint32_t offset = 0;
+    evtimer_event_t *ptr = NULL;
 
     DEBUG("nib: lookup ctx = %p, type = %04x\n", (void *)ctx, type);
-    while (event != NULL) {
-        offset += event->event.offset;
+    while ((ptr = evtimer_next(&_nib_evtimer, ptr)) != NULL) {
+        evtimer_msg_event_t *event = (evtimer_msg_event_t *)ptr;
         if ((event->msg.type == type) &&
             ((ctx == NULL) || (event->msg.content.ptr == ctx))) {
-            return offset;
+            return evtimer_remaining(&_nib_evtimer, ptr);
         }
-        event = (evtimer_msg_event_t *)event->event.next;
     }
     return UINT32_MAX;
 }
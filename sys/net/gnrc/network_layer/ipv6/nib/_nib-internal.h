@@ -654,6 +654,19 @@ _nib_offl_entry_t *_nib_pl_add(unsigned iface,
  */
 void _nib_pl_remove(_nib_offl_entry_t *nib_offl);
 
+/**
+ * @brief   Gets an on-link prefix list entry covering @p dst
+ *
+ * @pre     `(dst != NULL)`
+ *
+ * @param[in] dst   An IPv6 address.
+ *
+ * @return  The first prefix list entry with the on-link flag set whose prefix
+ *          matches @p dst.
+ * @return  NULL, if there is none.
+ */
+_nib_offl_entry_t *_nib_pl_get_on_link(const ipv6_addr_t *dst);
+
 #if GNRC_IPV6_NIB_CONF_ROUTER || DOXYGEN
 /**
  * @brief   Creates or gets an existing forwarding table entry by its prefix
@@ -84,13 +84,9 @@ static void _handle_rdnss_timeout(sock_udp_ep_t *dns_server);
 
 void gnrc_ipv6_nib_init(void)
 {
-    evtimer_event_t *tmp;
-
     mutex_lock(&_nib_mutex);
-    for (evtimer_event_t *ptr = _nib_evtimer.events;
-         (ptr != NULL) && (tmp = (ptr->next), 1);
-         ptr = tmp) {
-        evtimer_del((evtimer_t *)(&_nib_evtimer), ptr);
+    while (_nib_evtimer.events != NULL) {
+        evtimer_del((evtimer_t *)(&_nib_evtimer), _nib_evtimer.events);
     }
     _nib_init();
     mutex_unlock(&_nib_mutex);
@@ -150,7 +146,7 @@ void gnrc_ipv6_nib_init_iface(gnrc_netif_t *netif)
 
 static bool _on_link(const ipv6_addr_t *dst, unsigned *iface)
 {
-    _nib_offl_entry_t *entry = NULL;
+    _nib_offl_entry_t *entry;
 
 #if GNRC_IPV6_NIB_CONF_6LN
     if (*iface != 0) {
@@ -159,12 +155,9 @@ static bool _on_link(const ipv6_addr_t *dst, unsigned *iface)
         }
     }
 #endif  /* GNRC_IPV6_NIB_CONF_6LN */
-    while ((entry = _nib_offl_iter(entry))) {
-        if ((entry->mode & _PL) && (entry->flags & _PFX_ON_LINK) &&
-            (ipv6_addr_match_prefix(dst, &entry->pfx) >= entry->pfx_len)) {
-            *iface = _nib_onl_get_if(entry->next_hop);
-            return true;
-        }
+    if ((entry = _nib_pl_get_on_link(dst)) != NULL) {
+        *iface = _nib_onl_get_if(entry->next_hop);
+        return true;
     }
     return ipv6_addr_is_link_local(dst);
 }
@@ -47,13 +47,7 @@ static inline uint16_t _floor8(uint16_t length)
     return length & 0xf8U;
 }
 
-static inline size_t _min(size_t a, size_t b)
-{
-    return (a < b) ? a : b;
-}
-
-static gnrc_pktsnip_t *_build_frag_pkt(gnrc_pktsnip_t *pkt, size_t payload_len,
-                                       size_t size)
+static gnrc_pktsnip_t *_build_frag_pkt(gnrc_pktsnip_t *pkt, size_t hdr_size)
 {
     gnrc_netif_hdr_t *hdr = pkt->data, *new_hdr;
     gnrc_pktsnip_t *netif, *frag;
@@ -72,11 +66,10 @@ static gnrc_pktsnip_t *_build_frag_pkt(gnrc_pktsnip_t *pkt, size_t payload_len,
     new_hdr->rssi = hdr->rssi;
     new_hdr->lqi = hdr->lqi;
 
-    frag = gnrc_pktbuf_add(NULL, NULL, _min(size, payload_len),
-                           GNRC_NETTYPE_SIXLOWPAN);
+    frag = gnrc_pktbuf_add(NULL, NULL, hdr_size, GNRC_NETTYPE_SIXLOWPAN);
 
     if (frag == NULL) {
-        DEBUG("6lo frag: error allocating first fragment\n");
+        DEBUG("6lo frag: error allocating fragment header\n");
         gnrc_pktbuf_release(netif);
         return NULL;
     }
@@ -86,11 +79,77 @@ static gnrc_pktsnip_t *_build_frag_pkt(gnrc_pktsnip_t *pkt, size_t payload_len,
     return frag;
 }
 
+/* Makes the snips behind the netif header exclusive to the datagram, so that
+ * they can be handed on to the fragments. Only shared snips are copied, empty
+ * ones are dropped. */
+static bool _own_payload(gnrc_pktsnip_t *pkt)
+{
+    while (pkt->next != NULL) {
+        gnrc_pktsnip_t *snip = pkt->next;
+
+        if (snip->size == 0) {
+            /* unlink it without touching it, it may be shared: the rest of
+             * the datagram is held so that releasing it only drops the empty
+             * snip */
+            pkt->next = snip->next;
+            if (snip->next != NULL) {
+                gnrc_pktbuf_hold(snip->next, 1);
+            }
+            gnrc_pktbuf_release(snip);
+            continue;
+        }
+        snip = gnrc_pktbuf_start_write(snip);
+
+        if (snip == NULL) {
+            DEBUG("6lo frag: error duplicating shared snip\n");
+            return false;
+        }
+        pkt->next = snip;
+        pkt = snip;
+    }
+    return true;
+}
+
+/* Moves up to max_size bytes from the front of the datagram behind the netif
+ * header pkt into a list of its own. A snip crossing max_size is split with
+ * gnrc_pktbuf_mark(), so the payload is not copied into the fragments. */
+static gnrc_pktsnip_t *_take_payload(gnrc_pktsnip_t *pkt, size_t max_size,
+                                     uint16_t *size)
+{
+    gnrc_pktsnip_t *payload = NULL;
+
+    *size = 0;
+    while ((pkt->next != NULL) && (*size < max_size)) {
+        gnrc_pktsnip_t *snip = pkt->next;
+
+        if (snip->size > (max_size - *size)) {
+            gnrc_pktsnip_t *part = gnrc_pktbuf_mark(snip, max_size - *size,
+                                                    snip->type);
+
+            if (part == NULL) {
+                DEBUG("6lo frag: error splitting payload\n");
+                gnrc_pktbuf_release(payload);
+                return NULL;
+            }
+            /* the marked front part follows snip, take it out */
+            snip->next = part->next;
+            snip = part;
+        }
+        else {
+            pkt->next = snip->next;
+        }
+        snip->next = NULL;
+        *size += snip->size;
+        LL_APPEND(payload, snip);
+    }
+    return payload;
+}
+
 static uint16_t _send_1st_fragment(gnrc_netif_t *iface, gnrc_pktsnip_t *pkt,
                                    size_t payload_len, size_t datagram_size)
 {
-    gnrc_pktsnip_t *frag;
-    uint16_t local_offset = 0;
+    gnrc_pktsnip_t *frag, *payload;
+    uint16_t local_offset;
     /* payload_len: actual size of the packet vs
      * datagram_size: size of the uncompressed IPv6 packet */
     int payload_diff = (datagram_size - payload_len);
@@ -99,38 +158,27 @@ static uint16_t _send_1st_fragment(gnrc_netif_t *iface, gnrc_pktsnip_t *pkt,
     uint16_t max_frag_size = _floor8(iface->sixlo.max_frag_size + payload_diff -
                                      sizeof(sixlowpan_frag_t)) - payload_diff;
     sixlowpan_frag_t *hdr;
-    uint8_t *data;
 
     DEBUG("6lo frag: determined max_frag_size = %" PRIu16 "\n", max_frag_size);
 
-    frag = _build_frag_pkt(pkt, payload_len,
-                           max_frag_size + sizeof(sixlowpan_frag_t));
+    frag = _build_frag_pkt(pkt, sizeof(sixlowpan_frag_t));
 
     if (frag == NULL) {
         return 0;
     }
 
     hdr = frag->next->data;
-    data = (uint8_t *)(hdr + 1);
 
     hdr->disp_size = byteorder_htons((uint16_t)datagram_size);
     hdr->disp_size.u8[0] |= SIXLOWPAN_FRAG_1_DISP;
     hdr->tag = byteorder_htons(_tag);
 
-    pkt = pkt->next;    /* don't copy netif header */
-
-    while (pkt != NULL) {
-        size_t clen = _min(max_frag_size - local_offset, pkt->size);
-
-        memcpy(data + local_offset, pkt->data, clen);
-        local_offset += clen;
-
-        if (local_offset >= max_frag_size) {
-            break;
-        }
-
-        pkt = pkt->next;
+    /* the netif header stays with the datagram */
+    if ((payload = _take_payload(pkt, max_frag_size, &local_offset)) == NULL) {
+        gnrc_pktbuf_release(frag);
+        return 0;
     }
+    frag->next->next = payload;
 
     DEBUG("6lo frag: send first fragment (datagram size: %u, "
           "datagram tag: %" PRIu16 ", fragment size: %" PRIu16 ")\n",
@@ -143,26 +191,22 @@ static uint16_t _send_nth_fragment(gnrc_netif_t *iface, gnrc_pktsnip_t *pkt,
                                    size_t payload_len, size_t datagram_size,
                                    uint16_t offset)
 {
-    gnrc_pktsnip_t *frag;
+    gnrc_pktsnip_t *frag, *payload;
     /* since dispatches aren't supposed to go into subsequent fragments, we need not account
      * for payload difference as for the first fragment */
     uint16_t max_frag_size = _floor8(iface->sixlo.max_frag_size - sizeof(sixlowpan_frag_n_t));
-    uint16_t local_offset = 0, offset_count = 0;
+    uint16_t local_offset;
     sixlowpan_frag_n_t *hdr;
-    uint8_t *data;
 
     DEBUG("6lo frag: determined max_frag_size = %" PRIu16 "\n", max_frag_size);
 
-    frag = _build_frag_pkt(pkt,
-                           payload_len - offset + sizeof(sixlowpan_frag_n_t),
-                           max_frag_size + sizeof(sixlowpan_frag_n_t));
+    frag = _build_frag_pkt(pkt, sizeof(sixlowpan_frag_n_t));
 
     if (frag == NULL) {
         return 0;
     }
 
     hdr = frag->next->data;
-    data = (uint8_t *)(hdr + 1);
 
     /* XXX: truncation of datagram_size > 4095 may happen here */
     hdr->disp_size = byteorder_htons((uint16_t)datagram_size);
@@ -170,39 +214,13 @@ static uint16_t _send_nth_fragment(gnrc_netif_t *iface, gnrc_pktsnip_t *pkt,
     hdr->tag = byteorder_htons(_tag);
     /* don't mention payload diff in offset */
     hdr->offset = (uint8_t)((offset + (datagram_size - payload_len)) >> 3);
-    pkt = pkt->next;    /* don't copy netif header */
-
-    while ((pkt != NULL) && (offset_count != offset)) {   /* go to offset */
-        offset_count += (uint16_t)pkt->size;
-
-        if (offset_count > offset) {    /* we overshot */
-            /* => copy rest of partly send packet snip */
-            uint16_t pkt_offset = offset - (offset_count - ((uint16_t)pkt->size));
-            size_t clen = _min(max_frag_size, pkt->size - pkt_offset);
-
-            memcpy(data, ((uint8_t *)pkt->data) + pkt_offset, clen);
-            local_offset = clen;
-            pkt = pkt->next;
-            break;
-        }
-
-        pkt = pkt->next;
-    }
 
-    if (local_offset < max_frag_size) { /* copy other packet snips */
-        while (pkt != NULL) {
-            size_t clen = _min(max_frag_size - local_offset, pkt->size);
-
-            memcpy(data + local_offset, pkt->data, clen);
-            local_offset += clen;
-
-            if (local_offset == max_frag_size) {
-                break;
-            }
-
-            pkt = pkt->next;
-        }
+    /* the preceding fragments already took their part of the payload */
+    if ((payload = _take_payload(pkt, max_frag_size, &local_offset)) == NULL) {
+        gnrc_pktbuf_release(frag);
+        return 0;
     }
+    frag->next->next = payload;
 
     DEBUG("6lo frag: send subsequent fragment (datagram size: %u, "
           "datagram tag: %" PRIu16 ", offset: %" PRIu8 " (%u bytes), "
@@ -225,8 +243,10 @@ void gnrc_sixlowpan_frag_send(gnrc_pktsnip_t *pkt, void *ctx, unsigned page)
     gnrc_netif_t *iface = gnrc_netif_get_by_pid(fragment_msg->pid);
     uint16_t res;
     /* payload_len: actual size of the packet vs
-     * datagram_size: size of the uncompressed IPv6 packet */
-    size_t payload_len = gnrc_pkt_len(fragment_msg->pkt->next);
+     * datagram_size: size of the uncompressed IPv6 packet.
+     * The fragments sent so far took their payload out of the packet */
+    size_t payload_len = fragment_msg->offset +
+                         gnrc_pkt_len(fragment_msg->pkt->next);
     msg_t msg;
 
     assert((fragment_msg->pkt == pkt) || (pkt == NULL));
@@ -247,6 +267,11 @@ void gnrc_sixlowpan_frag_send(gnrc_pktsnip_t *pkt, void *ctx, unsigned page)
     if (fragment_msg->offset == 0) {
         /* increment tag for successive, fragmented datagrams */
         _tag++;
+        if (!_own_payload(fragment_msg->pkt)) {
+            gnrc_pktbuf_release(fragment_msg->pkt);
+            fragment_msg->pkt = NULL;
+            return;
+        }
         if ((res = _send_1st_fragment(iface, fragment_msg->pkt, payload_len, fragment_msg->datagram_size)) == 0) {
             /* error sending first fragment */
             DEBUG("6lo frag: error sending 1st fragment\n");
@@ -0,0 +1,561 @@
+/*
+ * Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup net_gnrc_pktbuf
+ * @{
+ *
+ * @file
+ * @brief   Packet buffer on pools of fixed size blocks
+ *
+ * Every pool is an array of equally sized blocks with a free list threaded
+ * through the unused ones, so a block is taken and given back in constant
+ * time. Snip descriptors have their own pool, data goes into the smallest
+ * free block it fits in. gnrc_pktbuf_mark() splits data by pointer, so a
+ * data block may be shared by several snips and has a reference count. A
+ * data pointer may point into its block, the block is found back by its
+ * offset in the pool.
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdio.h>
+#include <sys/types.h>
+
+#include "mutex.h"
+#include "utlist.h"
+#include "net/gnrc/pktbuf.h"
+#include "net/gnrc/nettype.h"
+#include "net/gnrc/pkt.h"
+
+#define ENABLE_DEBUG (0)
+#include "debug.h"
+
+#define _ALIGNMENT_MASK     (sizeof(uint64_t) - 1)
+#define _ALIGN(size)        (((size) + _ALIGNMENT_MASK) & ~(_ALIGNMENT_MASK))
+#define _WORDS(numof, size) (((numof) * _ALIGN(size)) / sizeof(uint64_t))
+
+#define _SNIP_SIZE          _ALIGN(sizeof(gnrc_pktsnip_t))
+
+enum {
+    POOL_SNIP = 0,
+    POOL_SMALL,
+    POOL_MEDIUM,
+    POOL_LARGE,
+    POOL_NUMOF,
+};
+
+typedef struct _free {
+    struct _free *next;
+} _free_t;
+
+typedef struct {
+    uint8_t *start;     /* first block */
+    uint16_t *refs;     /* snips sharing each block, NULL if never shared */
+    _free_t *free;      /* unused blocks */
+    uint16_t size;      /* size of a block */
+    uint16_t numof;     /* number of blocks */
+    uint16_t used;      /* blocks in use */
+#ifdef DEVELHELP
+    uint16_t max_used;  /* most blocks ever in use */
+    uint16_t failed;    /* allocations that found no block */
+#endif
+} _pool_t;
+
+static uint64_t _snips[_WORDS(GNRC_PKTBUF_SLAB_SNIP_NUMOF, sizeof(gnrc_pktsnip_t))];
+static uint64_t _small[_WORDS(GNRC_PKTBUF_SLAB_SMALL_NUMOF, GNRC_PKTBUF_SLAB_SMALL_SIZE)];
+static uint64_t _medium[_WORDS(GNRC_PKTBUF_SLAB_MEDIUM_NUMOF, GNRC_PKTBUF_SLAB_MEDIUM_SIZE)];
+static uint64_t _large[_WORDS(GNRC_PKTBUF_SLAB_LARGE_NUMOF, GNRC_PKTBUF_SLAB_LARGE_SIZE)];
+/* every user of a block is a snip, so the counts are bounded by the snip pool */
+static uint16_t _small_refs[GNRC_PKTBUF_SLAB_SMALL_NUMOF];
+static uint16_t _medium_refs[GNRC_PKTBUF_SLAB_MEDIUM_NUMOF];
+static uint16_t _large_refs[GNRC_PKTBUF_SLAB_LARGE_NUMOF];
+
+static _pool_t _pools[POOL_NUMOF] = {
+    { .start = (uint8_t *)_snips, .size = _SNIP_SIZE,
+      .numof = GNRC_PKTBUF_SLAB_SNIP_NUMOF },
+    { .start = (uint8_t *)_small, .refs = _small_refs,
+      .size = _ALIGN(GNRC_PKTBUF_SLAB_SMALL_SIZE),
+      .numof = GNRC_PKTBUF_SLAB_SMALL_NUMOF },
+    { .start = (uint8_t *)_medium, .refs = _medium_refs,
+      .size = _ALIGN(GNRC_PKTBUF_SLAB_MEDIUM_SIZE),
+      .numof = GNRC_PKTBUF_SLAB_MEDIUM_NUMOF },
+    { .start = (uint8_t *)_large, .refs = _large_refs,
+      .size = _ALIGN(GNRC_PKTBUF_SLAB_LARGE_SIZE),
+      .numof = GNRC_PKTBUF_SLAB_LARGE_NUMOF },
+};
+
+static mutex_t _mutex = MUTEX_INIT;
+
+/* internal gnrc_pktbuf functions */
+static gnrc_pktsnip_t *_create_snip(gnrc_pktsnip_t *next, const void *data, size_t size,
+                                    gnrc_nettype_t type);
+
+static inline void _set_pktsnip(gnrc_pktsnip_t *pkt, gnrc_pktsnip_t *next,
+                                void *data, size_t size, gnrc_nettype_t type)
+{
+    pkt->next = next;
+    pkt->data = data;
+    pkt->size = size;
+    pkt->type = type;
+    pkt->users = 1;
+#ifdef MODULE_GNRC_NETERR
+    pkt->err_sub = KERNEL_PID_UNDEF;
+#endif
+}
+
+static inline bool _pool_contains(const _pool_t *pool, const void *ptr)
+{
+    return (size_t)((const uint8_t *)ptr - pool->start) <
+           ((size_t)pool->size * pool->numof);
+}
+
+/* returns the index of the pool holding ptr, POOL_NUMOF if none does */
+static unsigned _pool_of(const void *ptr)
+{
+    unsigned i;
+
+    for (i = 0; i < POOL_NUMOF; i++) {
+        if (_pool_contains(&_pools[i], ptr)) {
+            break;
+        }
+    }
+    return i;
+}
+
+/* index of the block holding ptr in pool */
+static inline unsigned _index(const _pool_t *pool, const void *ptr)
+{
+    return ((const uint8_t *)ptr - pool->start) / pool->size;
+}
+
+static void *_alloc(unsigned i)
+{
+    _pool_t *pool = &_pools[i];
+    _free_t *block = pool->free;
+
+    if (block != NULL) {
+        pool->free = block->next;
+        pool->used++;
+        if (pool->refs != NULL) {
+            pool->refs[_index(pool, block)] = 1;
+        }
+#ifdef DEVELHELP
+        if (pool->used > pool->max_used) {
+            pool->max_used = pool->used;
+        }
+#endif
+    }
+    return block;
+}
+
+/* smallest free block of a data pool below limit that takes size bytes */
+static void *_alloc_data(size_t size, unsigned limit)
+{
+    for (unsigned i = POOL_SMALL; i < limit; i++) {
+        if ((size <= _pools[i].size) && (_pools[i].free != NULL)) {
+            return _alloc(i);
+        }
+    }
+#ifdef DEVELHELP
+    if (limit == POOL_NUMOF) {
+        for (unsigned i = POOL_SMALL; i < POOL_NUMOF; i++) {
+            if (size <= _pools[i].size) {
+                _pools[i].failed++;
+                break;
+            }
+        }
+    }
+#endif
+    DEBUG("pktbuf: no block left for %u bytes\n", (unsigned)size);
+    return NULL;
+}
+
+static void _free(void *ptr)
+{
+    unsigned i = _pool_of(ptr);
+
+    if (i == POOL_NUMOF) {
+        /* NULL or not from the packet buffer */
+        return;
+    }
+
+    _pool_t *pool = &_pools[i];
+    unsigned index = _index(pool, ptr);
+    _free_t *block = (_free_t *)(pool->start + (index * pool->size));
+
+    if ((pool->refs != NULL) && (--pool->refs[index] > 0)) {
+        /* still used by another part of a split section */
+        return;
+    }
+    assert(pool->used > 0);
+    block->next = pool->free;
+    pool->free = block;
+    pool->used--;
+}
+
+/* adds a user to the block holding ptr */
+static void _share(const void *ptr)
+{
+    unsigned i = _pool_of(ptr);
+
+    if ((i != POOL_NUMOF) && (_pools[i].refs != NULL)) {
+        uint16_t *refs = &_pools[i].refs[_index(&_pools[i], ptr)];
+
+        assert(*refs < UINT16_MAX);
+        (*refs)++;
+    }
+}
+
+/* checks if ptr is in a block used by no other snip */
+static bool _exclusive(const void *ptr)
+{
+    unsigned i = _pool_of(ptr);
+
+    return (i == POOL_NUMOF) || (_pools[i].refs == NULL) ||
+           (_pools[i].refs[_index(&_pools[i], ptr)] == 1);
+}
+
+/* bytes from ptr to the end of its block */
+static size_t _room(const void *ptr)
+{
+    unsigned i = _pool_of(ptr);
+
+    if (i == POOL_NUMOF) {
+        return 0;
+    }
+    return _pools[i].size -
+           (((const uint8_t *)ptr - _pools[i].start) % _pools[i].size);
+}
+
+void gnrc_pktbuf_init(void)
+{
+    mutex_lock(&_mutex);
+    for (unsigned i = 0; i < POOL_NUMOF; i++) {
+        _pool_t *pool = &_pools[i];
+
+        pool->free = NULL;
+        for (unsigned n = pool->numof; n > 0; n--) {
+            _free_t *block = (_free_t *)(pool->start + ((n - 1) * pool->size));
+            block->next = pool->free;
+            pool->free = block;
+        }
+        pool->used = 0;
+#ifdef DEVELHELP
+        pool->max_used = 0;
+        pool->failed = 0;
+#endif
+    }
+    mutex_unlock(&_mutex);
+}
+
+gnrc_pktsnip_t *gnrc_pktbuf_add(gnrc_pktsnip_t *next, const void *data, size_t size,
+                                gnrc_nettype_t type)
+{
+    gnrc_pktsnip_t *pkt;
+
+    if (size > GNRC_PKTBUF_SLAB_LARGE_SIZE) {
+        DEBUG("pktbuf: size (%u) > GNRC_PKTBUF_SLAB_LARGE_SIZE (%u)\n",
+              (unsigned)size, GNRC_PKTBUF_SLAB_LARGE_SIZE);
+        return NULL;
+    }
+    mutex_lock(&_mutex);
+    pkt = _create_snip(next, data, size, type);
+    mutex_unlock(&_mutex);
+    return pkt;
+}
+
+static gnrc_pktsnip_t *_mark(gnrc_pktsnip_t *pkt, size_t size, gnrc_nettype_t type)
+{
+    gnrc_pktsnip_t *header;
+    void *header_data;
+
+    if ((size == 0) || (pkt == NULL) || (size > pkt->size) || (pkt->data == NULL)) {
+        DEBUG("pktbuf: size == 0 (was %u) or pkt == NULL (was %p) or "
+              "size > pkt->size (was %u) or pkt->data == NULL (was %p)\n",
+              (unsigned)size, (void *)pkt, (pkt ? (unsigned)pkt->size : 0),
+              (pkt ? pkt->data : NULL));
+        return NULL;
+    }
+    /* create new snip descriptor for marked data */
+    header = _alloc(POOL_SNIP);
+    if (header == NULL) {
+        DEBUG("pktbuf: could not reallocate marked section.\n");
+        return NULL;
+    }
+    header_data = pkt->data;
+    if (pkt->size == size) {
+        pkt->data = NULL;
+    }
+    else {
+        /* split by pointer, both parts now use the block */
+        pkt->data = ((uint8_t *)pkt->data) + size;
+        _share(header_data);
+    }
+    pkt->size -= size;
+    _set_pktsnip(header, pkt->next, header_data, size, type);
+    pkt->next = header;
+    return header;
+}
+
+gnrc_pktsnip_t *gnrc_pktbuf_mark(gnrc_pktsnip_t *pkt, size_t size, gnrc_nettype_t type)
+{
+    gnrc_pktsnip_t *new;
+
+    mutex_lock(&_mutex);
+    new = _mark(pkt, size, type);
+    mutex_unlock(&_mutex);
+    return new;
+}
+
+static int _realloc_data(gnrc_pktsnip_t *pkt, size_t size)
+{
+    assert(pkt != NULL);
+    assert(((pkt->size == 0) && (pkt->data == NULL)) ||
+           ((pkt->size > 0) && (pkt->data != NULL)));
+    /* new size and old size are equal */
+    if (size == pkt->size) {
+        /* nothing to do */
+        return 0;
+    }
+    /* new size is 0 and data pointer isn't already NULL */
+    if ((size == 0) && (pkt->data != NULL)) {
+        /* set data pointer to NULL */
+        _free(pkt->data);
+        pkt->data = NULL;
+    }
+    else if ((pkt->data != NULL) && (size <= _room(pkt->data)) &&
+             ((size < pkt->size) || _exclusive(pkt->data))) {
+        /* fits in place without overwriting other parts of a split block,
+         * but give a large block back if a smaller one does */
+        void *data = _alloc_data(size, _pool_of(pkt->data));
+        if (data != NULL) {
+            memcpy(data, pkt->data, size);
+            _free(pkt->data);
+            pkt->data = data;
+        }
+    }
+    else {
+        void *data = _alloc_data(size, POOL_NUMOF);
+        if (data == NULL) {
+            DEBUG("pktbuf: error allocating new data section\n");
+            return ENOMEM;
+        }
+        if (pkt->data != NULL) {
+            memcpy(data, pkt->data, (pkt->size < size) ? pkt->size : size);
+            _free(pkt->data);
+        }
+        pkt->data = data;
+    }
+    pkt->size = size;
+    return 0;
+}
+
+int gnrc_pktbuf_realloc_data(gnrc_pktsnip_t *pkt, size_t size)
+{
+    int res;
+
+    mutex_lock(&_mutex);
+    res = _realloc_data(pkt, size);
+    mutex_unlock(&_mutex);
+    return res;
+}
+
+void gnrc_pktbuf_hold(gnrc_pktsnip_t *pkt, unsigned int num)
+{
+    mutex_lock(&_mutex);
+    while (pkt) {
+        pkt->users += num;
+        pkt = pkt->next;
+    }
+    mutex_unlock(&_mutex);
+}
+
+static void _release_error_locked(gnrc_pktsnip_t *pkt, uint32_t err)
+{
+    while (pkt) {
+        gnrc_pktsnip_t *tmp;
+        assert(_pool_contains(&_pools[POOL_SNIP], pkt));
+        assert(pkt->users > 0);
+        tmp = pkt->next;
+        if (pkt->users == 1) {
+            pkt->users = 0; /* not necessary but to be on the safe side */
+            _free(pkt->data);
+            _free(pkt);
+        }
+        else {
+            pkt->users--;
+        }
+        DEBUG("pktbuf: report status code %" PRIu32 "\n", err);
+        gnrc_neterr_report(pkt, err);
+        pkt = tmp;
+    }
+}
+
+void gnrc_pktbuf_release_error(gnrc_pktsnip_t *pkt, uint32_t err)
+{
+    mutex_lock(&_mutex);
+    _release_error_locked(pkt, err);
+    mutex_unlock(&_mutex);
+}
+
+gnrc_pktsnip_t *gnrc_pktbuf_start_write(gnrc_pktsnip_t *pkt)
+{
+    mutex_lock(&_mutex);
+    if ((pkt == NULL) || (pkt->size == 0)) {
+        mutex_unlock(&_mutex);
+        return NULL;
+    }
+    if (pkt->users > 1) {
+        gnrc_pktsnip_t *new;
+        new = _create_snip(pkt->next, pkt->data, pkt->size, pkt->type);
+        if (new != NULL) {
+            pkt->users--;
+        }
+        mutex_unlock(&_mutex);
+        return new;
+    }
+    mutex_unlock(&_mutex);
+    return pkt;
+}
+
+#ifdef DEVELHELP
+void gnrc_pktbuf_stats(void)
+{
+    static const char *names[POOL_NUMOF] = { "snip", "small", "medium", "large" };
+
+    mutex_lock(&_mutex);
+    printf("packet buffer: %u bytes in %u pools\n",
+           (unsigned)(sizeof(_snips) + sizeof(_small) + sizeof(_medium) +
+                      sizeof(_large)), POOL_NUMOF);
+    for (unsigned i = 0; i < POOL_NUMOF; i++) {
+        _pool_t *pool = &_pools[i];
+        printf("  %-6s %2u x %4u B: used %2u, max %2u, failed %u\n", names[i],
+               pool->numof, pool->size, pool->used, pool->max_used,
+               pool->failed);
+    }
+    mutex_unlock(&_mutex);
+}
+#endif
+
+#ifdef TEST_SUITES
+bool gnrc_pktbuf_is_empty(void)
+{
+    for (unsigned i = 0; i < POOL_NUMOF; i++) {
+        if (_pools[i].used != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool gnrc_pktbuf_is_sane(void)
+{
+    /* Invariants of this implementation:
+     *  - forall blocks in the free list of a pool: the block lies within the
+     *    pool, on a block boundary
+     *  - the free list of a pool holds numof - used blocks
+     */
+    for (unsigned i = 0; i < POOL_NUMOF; i++) {
+        _pool_t *pool = &_pools[i];
+        unsigned count = 0;
+
+        for (_free_t *ptr = pool->free; ptr != NULL; ptr = ptr->next) {
+            if (!_pool_contains(pool, ptr) ||
+                ((((uint8_t *)ptr) - pool->start) % pool->size) ||
+                (++count > pool->numof)) {
+                return false;
+            }
+        }
+        if (count != (unsigned)(pool->numof - pool->used)) {
+            return false;
+        }
+    }
+    return true;
+}
+#endif
+
+static gnrc_pktsnip_t *_create_snip(gnrc_pktsnip_t *next, const void *data, size_t size,
+                                    gnrc_nettype_t type)
+{
+    gnrc_pktsnip_t *pkt = _alloc(POOL_SNIP);
+    void *_data = NULL;
+
+    if (pkt == NULL) {
+        DEBUG("pktbuf: error allocating new packet snip\n");
+        return NULL;
+    }
+    if (size > 0) {
+        _data = _alloc_data(size, POOL_NUMOF);
+        if (_data == NULL) {
+            DEBUG("pktbuf: error allocating data for new packet snip\n");
+            _free(pkt);
+            return NULL;
+        }
+    }
+    _set_pktsnip(pkt, next, _data, size, type);
+    if ((data != NULL) && (size > 0)) {
+        memcpy(_data, data, size);
+    }
+    return pkt;
+}
+
+gnrc_pktsnip_t *gnrc_pktbuf_duplicate_upto(gnrc_pktsnip_t *pkt, gnrc_nettype_t type)
+{
+    mutex_lock(&_mutex);
+
+    bool is_shared = pkt->users > 1;
+    size_t size = gnrc_pkt_len_upto(pkt, type);
+
+    DEBUG("ipv6_ext: duplicating %d octets\n", (int) size);
+
+    gnrc_pktsnip_t *tmp;
+    gnrc_pktsnip_t *target = gnrc_pktsnip_search_type(pkt, type);
+    gnrc_pktsnip_t *next = (target == NULL) ? NULL : target->next;
+    gnrc_pktsnip_t *new = _create_snip(next, NULL, size, type);
+
+    if (new == NULL) {
+        mutex_unlock(&_mutex);
+
+        return NULL;
+    }
+
+    /* copy payloads */
+    for (tmp = pkt; tmp != NULL; tmp = tmp->next) {
+        uint8_t *dest = ((uint8_t *)new->data) + (size - tmp->size);
+
+        memcpy(dest, tmp->data, tmp->size);
+
+        size -= tmp->size;
+
+        if (tmp->type == type) {
+            break;
+        }
+    }
+
+    /* decrements reference counters */
+
+    if (target != NULL) {
+        target->next = NULL;
+    }
+
+    _release_error_locked(pkt, GNRC_NETERR_SUCCESS);
+
+    if (is_shared && (target != NULL)) {
+        target->next = next;
+    }
+
+    mutex_unlock(&_mutex);
+
+    return new;
+}
+
+/** @} */
@@ -66,6 +66,18 @@ static inline size_t _align(size_t size)
     return (size + _ALIGNMENT_MASK) & ~(_ALIGNMENT_MASK);
 }
 
+/* rounds a pointer into the packet buffer up to the next chunk boundary */
+static inline uint8_t *_align_ptr(const void *ptr)
+{
+    return &_pktbuf[_align((size_t)((const uint8_t *)ptr - _pktbuf))];
+}
+
+/* rounds a pointer into the packet buffer down to its chunk boundary */
+static inline uint8_t *_trunc_ptr(const void *ptr)
+{
+    return &_pktbuf[(size_t)((const uint8_t *)ptr - _pktbuf) & ~(_ALIGNMENT_MASK)];
+}
+
 static inline void _set_pktsnip(gnrc_pktsnip_t *pkt, gnrc_pktsnip_t *next,
                                 void *data, size_t size, gnrc_nettype_t type)
 {
@@ -107,8 +119,6 @@ gnrc_pktsnip_t *gnrc_pktbuf_add(gnrc_pktsnip_t *next, const void *data, size_t s
 gnrc_pktsnip_t *gnrc_pktbuf_mark(gnrc_pktsnip_t *pkt, size_t size, gnrc_nettype_t type)
 {
     gnrc_pktsnip_t *marked_snip;
-    /* size required for chunk */
-    size_t required_new_size = _align(size);
     void *new_data_marked;
 
     mutex_lock(&_mutex);
@@ -127,36 +137,31 @@ gnrc_pktsnip_t *gnrc_pktbuf_mark(gnrc_pktsnip_t *pkt, size_t size, gnrc_nettype_
         mutex_unlock(&_mutex);
         return NULL;
     }
-    /* marked data would not fit _unused_t marker => move data around to allow
-     * for proper free */
-    if ((pkt->size != size) && (size < required_new_size)) {
-        void *new_data_rest;
-        new_data_marked = _pktbuf_alloc(size);
-        if (new_data_marked == NULL) {
-            DEBUG("pktbuf: could not reallocate marked section.\n");
-            _pktbuf_free(marked_snip, sizeof(gnrc_pktsnip_t));
-            mutex_unlock(&_mutex);
-            return NULL;
+    new_data_marked = pkt->data;
+    /* the remainder stays where it is. If the split cuts a chunk, the chunk
+     * goes with the remainder and the (small) marked section is moved out of
+     * it, so that each section can be freed on its own */
+    if (pkt->size != size) {
+        uint8_t *rest = ((uint8_t *)pkt->data) + size;
+        uint8_t *split = _trunc_ptr(rest);
+
+        if (split != rest) {
+            new_data_marked = _pktbuf_alloc(size);
+            if (new_data_marked == NULL) {
+                DEBUG("pktbuf: could not reallocate marked section.\n");
+                _pktbuf_free(marked_snip, sizeof(gnrc_pktsnip_t));
+                mutex_unlock(&_mutex);
+                return NULL;
+            }
+            memcpy(new_data_marked, pkt->data, size);
+            if (split > (uint8_t *)pkt->data) {
+                _pktbuf_free(pkt->data, split - (uint8_t *)pkt->data);
+            }
         }
-        new_data_rest = _pktbuf_alloc(pkt->size - size);
-        if (new_data_rest == NULL) {
-            DEBUG("pktbuf: could not reallocate remaining section.\n");
-            _pktbuf_free(marked_snip, sizeof(gnrc_pktsnip_t));
-            _pktbuf_free(new_data_marked, size);
-            mutex_unlock(&_mutex);
-            return NULL;
-        }
-        memcpy(new_data_marked, pkt->data, size);
-        memcpy(new_data_rest, ((uint8_t *)pkt->data) + size, pkt->size - size);
-        _pktbuf_free(pkt->data, pkt->size);
-        marked_snip->data = new_data_marked;
-        pkt->data = new_data_rest;
+        pkt->data = rest;
     }
     else {
-        new_data_marked = pkt->data;
-        /* if (pkt->size - size) != 0 take remainder of data, otherwise set NULL */
-        pkt->data = (pkt->size != size) ? (((uint8_t *)pkt->data) + size) :
-                                          NULL;
+        pkt->data = NULL;
     }
     pkt->size -= size;
     _set_pktsnip(marked_snip, pkt->next, new_data_marked, size, type);
@@ -167,8 +172,6 @@ gnrc_pktsnip_t *gnrc_pktbuf_mark(gnrc_pktsnip_t *pkt, size_t size, gnrc_nettype_
 
 int gnrc_pktbuf_realloc_data(gnrc_pktsnip_t *pkt, size_t size)
 {
-    size_t aligned_size = _align(size);
-
     mutex_lock(&_mutex);
     assert(pkt != NULL);
     assert(((pkt->size == 0) && (pkt->data == NULL)) ||
@@ -199,9 +202,13 @@ int gnrc_pktbuf_realloc_data(gnrc_pktsnip_t *pkt, size_t size)
         _pktbuf_free(pkt->data, pkt->size);
         pkt->data = new_data;
     }
-    else if (_align(pkt->size) > aligned_size) {
-        _pktbuf_free(((uint8_t *)pkt->data) + aligned_size,
-                     pkt->size - aligned_size);
+    else {
+        uint8_t *old_end = _align_ptr(((uint8_t *)pkt->data) + pkt->size);
+        uint8_t *new_end = _align_ptr(((uint8_t *)pkt->data) + size);
+
+        if (old_end > new_end) {
+            _pktbuf_free(new_end, old_end - new_end);
+        }
     }
     pkt->size = size;
     mutex_unlock(&_mutex);
@@ -449,20 +456,29 @@ static inline _unused_t *_merge(_unused_t *a, _unused_t *b)
     return a;
 }
 
+/* frees all chunks overlapped by [data, data + size), data does not need to
+ * be aligned if the section owns its first chunk (see gnrc_pktbuf_mark()) */
 static void _pktbuf_free(void *data, size_t size)
 {
     size_t bytes_at_end;
-    _unused_t *new = (_unused_t *)data, *prev = NULL, *ptr = _first_unused;
+    _unused_t *new, *prev = NULL, *ptr = _first_unused;
+    uint8_t *start, *end;
 
     if (!_pktbuf_contains(data)) {
         return;
     }
-    while (ptr && (((void *)ptr) < data)) {
+    start = _trunc_ptr(data);
+    end = _align_ptr(((uint8_t *)data) + size);
+    if (end <= start) {
+        return;
+    }
+    new = (_unused_t *)start;
+    while (ptr && (ptr < new)) {
         prev = ptr;
         ptr = ptr->next;
     }
     new->next = ptr;
-    new->size = _align(size);
+    new->size = end - start;
     /* calculate number of bytes between new _unused_t chunk and end of packet
      * buffer */
     bytes_at_end = ((&_pktbuf[0] + GNRC_PKTBUF_SIZE) - (((uint8_t *)new) + new->size));
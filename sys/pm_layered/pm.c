@@ -22,6 +22,17 @@
 #include "periph/pm.h"
 #include "pm_layered.h"
 
+#ifdef MODULE_PM_LAYERED_TICKLESS
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "xtimer.h"
+#ifdef MODULE_RTCTIMERS_MILLIS
+#include "rtctimers-millis.h"
+#endif
+#endif
+
 #define ENABLE_DEBUG (0)
 #include "debug.h"
 
@@ -48,6 +59,75 @@ typedef union {
  */
 volatile pm_blocker_t pm_blocker = PM_BLOCKER_INITIAL;
 
+#ifdef MODULE_PM_LAYERED_TICKLESS
+static const uint32_t _latency[PM_NUM_MODES] = PM_WAKEUP_LATENCY_US;
+static pm_residency_t _residency[PM_NUM_MODES + 1];
+
+/**
+ * @brief Time until the next timer interrupt in microseconds, saturating
+ */
+static uint32_t _time_until_next(void)
+{
+    uint32_t us = UINT32_MAX;
+
+    uint32_t ticks = xtimer_time_until_next();
+    if (ticks != UINT32_MAX) {
+        uint64_t ticks_us = xtimer_usec_from_ticks64(xtimer_ticks64(ticks));
+        if (ticks_us < us) {
+            us = ticks_us;
+        }
+    }
+
+#ifdef MODULE_RTCTIMERS_MILLIS
+    uint32_t ms = rtctimers_millis_time_until_next();
+    if (ms < us / 1000) {
+        us = ms * 1000;
+    }
+#endif
+
+    return us;
+}
+
+/**
+ * @brief Goes up from @p mode to the first mode that wakes up in time
+ */
+static unsigned _fit(unsigned mode, uint32_t us)
+{
+    while ((mode < PM_NUM_MODES) && (_latency[mode] > us)) {
+        _residency[mode].denied++;
+        mode++;
+    }
+
+    return mode;
+}
+
+#ifndef PM_RESIDENCY_NOW_US
+/**
+ * @brief RTC milliseconds wrap around every week
+ */
+#define PM_RTC_WRAP_MS  (7UL * 24 * 60 * 60 * 1000)
+
+/**
+ * @brief Microseconds from the RTC, counted on from the weekly wrap around
+ */
+static uint64_t _rtc_now_us(void)
+{
+    static uint32_t last_ms;
+    static uint64_t now_us;
+
+    uint32_t ms = rtctimers_millis_now();
+    uint32_t elapsed = (ms >= last_ms) ? ms - last_ms : ms + PM_RTC_WRAP_MS - last_ms;
+
+    last_ms = ms;
+    now_us += (uint64_t)elapsed * 1000;
+
+    return now_us;
+}
+
+#define PM_RESIDENCY_NOW_US()   (_rtc_now_us())
+#endif
+#endif
+
 void pm_set_lowest(void)
 {
     pm_blocker_t blocker = pm_blocker;
@@ -62,7 +142,18 @@ void pm_set_lowest(void)
     /* set lowest mode if blocker is still the same */
     unsigned state = irq_disable();
     if (blocker.val_u32 == pm_blocker.val_u32) {
+#ifdef MODULE_PM_LAYERED_TICKLESS
+        /* timers can't change with interrupts disabled */
+        mode = _fit(mode, _time_until_next());
+        uint64_t start = PM_RESIDENCY_NOW_US();
+
+        pm_set(mode);
+
+        _residency[mode].entries++;
+        _residency[mode].time_us += PM_RESIDENCY_NOW_US() - start;
+#else
         pm_set(mode);
+#endif
     }
     
     irq_restore(state);    
@@ -88,6 +179,40 @@ void _pm_unblock(unsigned mode, const char *caller)
     DEBUG("pm: unblocking mode %u by %s (%d)\n", mode, caller, pm_blocker.val_u8[mode]);
 }
 
+#ifdef MODULE_PM_LAYERED_TICKLESS
+const pm_residency_t *pm_get_residency(void)
+{
+    return _residency;
+}
+
+void pm_reset_residency(void)
+{
+    unsigned state = irq_disable();
+    memset(_residency, 0, sizeof(_residency));
+    irq_restore(state);
+}
+
+void pm_print_residency(void)
+{
+    puts("mode | latency [us] |    entries |     denied | time [ms]");
+
+    for (unsigned mode = 0; mode <= PM_NUM_MODES; mode++) {
+        unsigned state = irq_disable();
+        pm_residency_t r = _residency[mode];
+        irq_restore(state);
+
+        if (mode < PM_NUM_MODES) {
+            printf("%4u | %12" PRIu32, mode, _latency[mode]);
+        }
+        else {
+            printf("none | %12s", "-");
+        }
+        printf(" | %10" PRIu32 " | %10" PRIu32 " | %" PRIu32 "\n",
+               r.entries, r.denied, (uint32_t)(r.time_us / 1000));
+    }
+}
+#endif
+
 #ifndef PROVIDES_PM_LAYERED_OFF
 void pm_off(void)
 {
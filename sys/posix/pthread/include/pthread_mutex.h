@@ -20,23 +20,41 @@
 #include <time.h>
 
 #include "mutex.h"
+#ifdef MODULE_CORE_PI_MUTEX
+#include "pi_mutex.h"
+#endif
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#if defined(MODULE_CORE_PI_MUTEX) || defined(DOXYGEN)
+/**
+ * @brief           Pthread mutex supporting the #PTHREAD_PRIO_INHERIT protocol.
+ * @details         Available with `USEMODULE += core_pi_mutex`, a mutex created
+ *                  with #PTHREAD_PRIO_INHERIT is a @ref pi_mutex_t and must be
+ *                  unlocked by the thread holding it.
+ *                  Otherwise it is the same as a RIOT mutex.
+ *                  Recursive locking is not supported.
+ */
+typedef struct {
+    pi_mutex_t mutex;   /**< Lock, plain mutex_t unless inheriting priority. */
+    int protocol;       /**< #PTHREAD_PRIO_NONE or #PTHREAD_PRIO_INHERIT. */
+} pthread_mutex_t;
+#else
 /**
  * @brief           Pthread mutexes are quite the same as RIOT mutexes.
  * @details         Recursive locking is not supported.
  *                  A thread can unlock a mutex even if it does not hold it.
  */
 typedef mutex_t pthread_mutex_t;
+#endif
 
 /**
  * @brief           Initialize a mutex.
  * @details         A zeroed out datum is initialized.
  * @param[in,out]   mutex       Mutex to initialize.
- * @param[in]       mutexattr   Unused.
+ * @param[in]       mutexattr   Only the protocol is used, can be `NULL`.
  * @returns         `0` on success. `-1` iff `mutex == NULL`.
  */
 int pthread_mutex_init(pthread_mutex_t *mutex, const pthread_mutexattr_t *mutexattr);
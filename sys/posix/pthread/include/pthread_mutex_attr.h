@@ -58,7 +58,7 @@ extern "C" {
  * @brief           If a thread attempts to acquire a held lock,
  *                  the holding thread gets its dynamic priority increased up to
  *                  the priority of the blocked thread
- * @note            Not implemented, yet.
+ * @note            Needs `USEMODULE += core_pi_mutex`.
  */
 #define PTHREAD_PRIO_NONE        0
 #define PTHREAD_PRIO_INHERIT     1
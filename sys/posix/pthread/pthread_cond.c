@@ -20,7 +20,7 @@
  */
 #include <errno.h>
 
-#include "pthread_cond.h"
+#include "pthread.h"
 #include "thread.h"
 #include "xtimer.h"
 #include "sched.h"
@@ -105,7 +105,21 @@ void _init_cond_wait(pthread_cond_t *cond, priority_queue_node_t *n)
     irq_restore(old_state);
 }
 
-int pthread_cond_wait(pthread_cond_t *cond, mutex_t *mutex)
+#ifdef MODULE_CORE_PI_MUTEX
+static void _mutex_unlock_and_sleep(pthread_mutex_t *mutex)
+{
+    if (mutex->protocol == PTHREAD_PRIO_INHERIT) {
+        pi_mutex_unlock_and_sleep(&mutex->mutex);
+    }
+    else {
+        mutex_unlock_and_sleep(&mutex->mutex.mutex);
+    }
+}
+#else
+#define _mutex_unlock_and_sleep(m)  mutex_unlock_and_sleep(m)
+#endif
+
+int pthread_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex)
 {
     if (cond == NULL) {
         return EINVAL;
@@ -113,14 +127,14 @@ int pthread_cond_wait(pthread_cond_t *cond, mutex_t *mutex)
     priority_queue_node_t n;
     _init_cond_wait(cond, &n);
 
-    mutex_unlock_and_sleep(mutex);
+    _mutex_unlock_and_sleep(mutex);
 
-    mutex_lock(mutex);
+    pthread_mutex_lock(mutex);
 
     return 0;
 }
 
-int pthread_cond_timedwait(pthread_cond_t *cond, mutex_t *mutex, const struct timespec *abstime)
+int pthread_cond_timedwait(pthread_cond_t *cond, pthread_mutex_t *mutex, const struct timespec *abstime)
 {
     if (cond == NULL) {
         return EINVAL;
@@ -138,7 +152,7 @@ int pthread_cond_timedwait(pthread_cond_t *cond, mutex_t *mutex, const struct ti
         _init_cond_wait(cond, &n);
         xtimer_set_wakeup64(&timer, (then - now), sched_active_pid);
 
-        mutex_unlock_and_sleep(mutex);
+        _mutex_unlock_and_sleep(mutex);
 
         if (n.data != -1u) {
             /* on signaling n.data is set to -1u */
@@ -151,10 +165,10 @@ int pthread_cond_timedwait(pthread_cond_t *cond, mutex_t *mutex, const struct ti
         xtimer_remove(&timer);
     }
     else {
-        mutex_unlock(mutex);
+        pthread_mutex_unlock(mutex);
         ret = ETIMEDOUT;
     }
-    mutex_lock(mutex);
+    pthread_mutex_lock(mutex);
     return ret;
 }
 
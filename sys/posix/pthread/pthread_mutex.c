@@ -21,15 +21,26 @@
 
 #include "pthread.h"
 
+#ifdef MODULE_CORE_PI_MUTEX
+#define _MUTEX(m)           (&(m)->mutex.mutex)
+#define _PRIO_INHERIT(m)    ((m)->protocol == PTHREAD_PRIO_INHERIT)
+#else
+#define _MUTEX(m)           (m)
+#endif
+
 int pthread_mutex_init(pthread_mutex_t *mutex, const pthread_mutexattr_t *mutexattr)
 {
-    (void) mutexattr;
-
     if (!mutex) {
         return -1;
     }
 
+#ifdef MODULE_CORE_PI_MUTEX
+    pi_mutex_init(&mutex->mutex);
+    mutex->protocol = mutexattr ? mutexattr->protocol : PTHREAD_PRIO_NONE;
+#else
+    (void) mutexattr;
     mutex_init(mutex);
+#endif
     return 0;
 }
 
@@ -45,9 +56,15 @@ int pthread_mutex_trylock(pthread_mutex_t *mutex)
         return -1;
     }
 
+#ifdef MODULE_CORE_PI_MUTEX
+    if (_PRIO_INHERIT(mutex)) {
+        return 1 - pi_mutex_trylock(&mutex->mutex);
+    }
+#endif
+
     /* mutex_trylock() returns 1 on success, and 0 otherwise. */
     /* We want the reverse. */
-    return 1 - mutex_trylock(mutex);
+    return 1 - mutex_trylock(_MUTEX(mutex));
 }
 
 int pthread_mutex_lock(pthread_mutex_t *mutex)
@@ -56,7 +73,14 @@ int pthread_mutex_lock(pthread_mutex_t *mutex)
         return -1;
     }
 
-    mutex_lock(mutex);
+#ifdef MODULE_CORE_PI_MUTEX
+    if (_PRIO_INHERIT(mutex)) {
+        pi_mutex_lock(&mutex->mutex);
+        return 0;
+    }
+#endif
+
+    mutex_lock(_MUTEX(mutex));
     return 0;
 }
 
@@ -73,6 +97,13 @@ int pthread_mutex_unlock(pthread_mutex_t *mutex)
         return -1;
     }
 
-    mutex_unlock(mutex);
+#ifdef MODULE_CORE_PI_MUTEX
+    if (_PRIO_INHERIT(mutex)) {
+        pi_mutex_unlock(&mutex->mutex);
+        return 0;
+    }
+#endif
+
+    mutex_unlock(_MUTEX(mutex));
     return 0;
 }
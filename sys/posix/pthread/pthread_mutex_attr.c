@@ -115,10 +115,17 @@ int pthread_mutexattr_setprotocol(pthread_mutexattr_t *attr, int protocol)
         return EINVAL;
     }
 
+#ifdef MODULE_CORE_PI_MUTEX
+    if (protocol == PTHREAD_PRIO_PROTECT) {
+        /* priority ceiling is not supported, yet */
+        return EINVAL;
+    }
+#else
     if (protocol != PTHREAD_PRIO_NONE) {
-        /* priority inheritance is not supported, yet */
+        /* priority inheritance needs core_pi_mutex */
         return EINVAL;
     }
+#endif
 
     attr->protocol = protocol;
     return 0;
@@ -24,6 +24,7 @@
 
 #include "rtctimers-millis.h"
 #include "irq.h"
+#include "bitarithm.h"
 
 /* WARNING! enabling this will have side effects and can lead to timer underflows. */
 #define ENABLE_DEBUG (0)
@@ -39,7 +40,9 @@ static rtctimers_millis_t *timer_list_head = NULL;
 static rtctimers_millis_t *overflow_list_head = NULL;
 static rtctimers_millis_t *long_list_head = NULL;
 
-static int _rtctimers_millis_set_absolute(rtctimers_millis_t *timer, uint32_t target);
+static rtctimers_millis_wakeup_stats_t _wakeup_stats;
+
+static int _rtctimers_millis_set_absolute(rtctimers_millis_t *timer, uint32_t target, uint32_t slack);
 static void _add_timer_to_list(rtctimers_millis_t **list_head, rtctimers_millis_t *timer);
 static void _add_timer_to_long_list(rtctimers_millis_t **list_head, rtctimers_millis_t *timer);
 static uint32_t _rtctimers_millis_lltimer_maximum(uint32_t target);
@@ -79,7 +82,12 @@ void rtctimers_millis_init(void)
 
 void rtctimers_millis_set(rtctimers_millis_t *timer, uint32_t offset)
 {
-    DEBUG("timer_set(): offset=%" PRIu32 " now=%" PRIu32 "\n", offset, rtctimers_millis_now());
+    rtctimers_millis_set_slack(timer, offset, 0);
+}
+
+void rtctimers_millis_set_slack(rtctimers_millis_t *timer, uint32_t offset, uint32_t slack)
+{
+    DEBUG("timer_set(): offset=%" PRIu32 " slack=%" PRIu32 " now=%" PRIu32 "\n", offset, slack, rtctimers_millis_now());
     if (!timer->callback) {
         DEBUG("timer_set(): timer has no callback.\n");
         return;
@@ -95,7 +103,7 @@ void rtctimers_millis_set(rtctimers_millis_t *timer, uint32_t offset)
         if (target >= RTCTIMERS_MILLIS_OVERFLOW_VALUE - RTCTIMERS_MILLIS_ISR_BACKOFF) {
             target -= (RTCTIMERS_MILLIS_OVERFLOW_VALUE - RTCTIMERS_MILLIS_ISR_BACKOFF);
         }
-        _rtctimers_millis_set_absolute(timer, target);
+        _rtctimers_millis_set_absolute(timer, target, slack);
     }
 }
 
@@ -120,7 +128,47 @@ static inline void _lltimer_set(uint32_t target)
     rtc_millis_set_alarm(_rtctimers_millis_lltimer_maximum(target), _periph_timer_callback, NULL);
 }
 
-int _rtctimers_millis_set_absolute(rtctimers_millis_t *timer, uint32_t target)
+/**
+ * @brief pick a target within [target, target + slack] to share a wakeup with
+ *        other timers
+ *
+ * Joins the first timer of this period expiring within the window, otherwise
+ * rounds the target down to the coarsest power of two boundary within the
+ * window so that timers set later can join it.
+ */
+static uint32_t _slack_target(uint32_t target, uint32_t slack, uint32_t now)
+{
+    uint32_t latest = target + slack;
+
+    if (!slack || (latest < target)) {
+        /* no slack or the window wraps */
+        return target;
+    }
+
+    /* keep the timer in its period */
+    if (latest >= RTCTIMERS_MILLIS_OVERFLOW_VALUE - RTCTIMERS_MILLIS_ISR_BACKOFF) {
+        latest = RTCTIMERS_MILLIS_OVERFLOW_VALUE - RTCTIMERS_MILLIS_ISR_BACKOFF - 1;
+    }
+    if (latest <= target) {
+        return target;
+    }
+
+    if (target >= now) {
+        for (rtctimers_millis_t *t = timer_list_head; t; t = t->next) {
+            if (t->target >= target) {
+                if (t->target <= latest) {
+                    _wakeup_stats.coalesced++;
+                    return t->target;
+                }
+                break;
+            }
+        }
+    }
+
+    return latest & ~((1UL << bitarithm_msb(latest - target)) - 1);
+}
+
+static int _rtctimers_millis_set_absolute(rtctimers_millis_t *timer, uint32_t target, uint32_t slack)
 {
     uint32_t now = rtctimers_millis_now();
     int res = 0;
@@ -138,6 +186,8 @@ int _rtctimers_millis_set_absolute(rtctimers_millis_t *timer, uint32_t target)
         _remove(timer);
     }
 
+    target = _slack_target(target, slack, now);
+
     timer->target = target;
     timer->long_target = _long_cnt;
     if (target < now) {
@@ -236,6 +286,27 @@ void rtctimers_millis_remove(rtctimers_millis_t *timer)
     irq_restore(state);
 }
 
+const rtctimers_millis_wakeup_stats_t *rtctimers_millis_get_wakeup_stats(void)
+{
+    return &_wakeup_stats;
+}
+
+uint32_t rtctimers_millis_time_until_next(void)
+{
+    unsigned state = irq_disable();
+    uint32_t now = rtctimers_millis_now();
+
+    /* the alarm is set to the overflow when no timer of this period is left */
+    uint32_t next = RTCTIMERS_MILLIS_OVERFLOW_VALUE;
+    if (timer_list_head) {
+        next = _rtctimers_millis_lltimer_maximum(timer_list_head->target);
+    }
+
+    irq_restore(state);
+
+    return (next > now) ? (next - now) : 0;
+}
+
 static uint32_t _time_left(uint32_t target, uint32_t reference)
 {
     uint32_t now = rtctimers_millis_now();
@@ -369,6 +440,7 @@ static void _timer_callback(void)
 {
     uint32_t next_target;
     uint32_t reference;
+    unsigned fired = 0;
 
     _in_handler = 1;
 
@@ -416,6 +488,7 @@ overflow:
 
         /* fire timer */
         _shoot(timer);
+        fired++;
     }
 
     /* possibly executing all callbacks took enough
@@ -460,6 +533,11 @@ overflow:
         }
     }
 
+    if (fired) {
+        _wakeup_stats.wakeups++;
+        _wakeup_stats.wakeups_saved += fired - 1;
+    }
+
     _in_handler = 0;
 
     /* set low level timer */
@@ -25,6 +25,7 @@
 
 #include "rtctimers.h"
 #include "irq.h"
+#include "bitarithm.h"
 
 #define ENABLE_DEBUG (0)
 #include "debug.h"
@@ -40,7 +41,9 @@ static rtctimers_t *timer_list_head = NULL;
 static rtctimers_t *overflow_list_head = NULL;
 static rtctimers_t *long_list_head = NULL;
 
-static int _rtctimers_set_absolute(rtctimers_t *timer, uint32_t target);
+static rtctimers_wakeup_stats_t _wakeup_stats;
+
+static int _rtctimers_set_absolute(rtctimers_t *timer, uint32_t target, uint32_t slack);
 static void _add_timer_to_list(rtctimers_t **list_head, rtctimers_t *timer);
 static void _add_timer_to_long_list(rtctimers_t **list_head, rtctimers_t *timer);
 static uint32_t _rtctimers_lltimer_maximum(uint32_t target);
@@ -86,7 +89,12 @@ void rtctimers_init(void)
 
 void rtctimers_set(rtctimers_t *timer, uint32_t offset)
 {
-    DEBUG("timer_set(): offset=%" PRIu32 " now=%" PRIu32 "\n", offset, rtctimers_now());
+    rtctimers_set_slack(timer, offset, 0);
+}
+
+void rtctimers_set_slack(rtctimers_t *timer, uint32_t offset, uint32_t slack)
+{
+    DEBUG("timer_set(): offset=%" PRIu32 " slack=%" PRIu32 " now=%" PRIu32 "\n", offset, slack, rtctimers_now());
     if (!timer->callback) {
         DEBUG("timer_set(): timer has no callback.\n");
         return;
@@ -105,7 +113,7 @@ void rtctimers_set(rtctimers_t *timer, uint32_t offset)
         if (target >= RTCTIMERS_OVERFLOW_VALUE - RTCTIMERS_ISR_BACKOFF) {
             target -= (RTCTIMERS_OVERFLOW_VALUE - RTCTIMERS_ISR_BACKOFF);
         }
-        _rtctimers_set_absolute(timer, target);
+        _rtctimers_set_absolute(timer, target, slack);
     }
 }
 
@@ -156,7 +164,47 @@ static void _lltimer_set(uint32_t target)
     rtc_set_alarm(&time, _periph_timer_callback, NULL);
 }
 
-int _rtctimers_set_absolute(rtctimers_t *timer, uint32_t target)
+/**
+ * @brief pick a target within [target, target + slack] to share a wakeup with
+ *        other timers
+ *
+ * Joins the first timer of this period expiring within the window, otherwise
+ * rounds the target down to the coarsest power of two boundary within the
+ * window so that timers set later can join it.
+ */
+static uint32_t _slack_target(uint32_t target, uint32_t slack, uint32_t now)
+{
+    uint32_t latest = target + slack;
+
+    if (!slack || (latest < target)) {
+        /* no slack or the window wraps */
+        return target;
+    }
+
+    /* keep the timer in its period */
+    if (latest >= RTCTIMERS_OVERFLOW_VALUE - RTCTIMERS_ISR_BACKOFF) {
+        latest = RTCTIMERS_OVERFLOW_VALUE - RTCTIMERS_ISR_BACKOFF - 1;
+    }
+    if (latest <= target) {
+        return target;
+    }
+
+    if (target >= now) {
+        for (rtctimers_t *t = timer_list_head; t; t = t->next) {
+            if (t->target >= target) {
+                if (t->target <= latest) {
+                    _wakeup_stats.coalesced++;
+                    return t->target;
+                }
+                break;
+            }
+        }
+    }
+
+    return latest & ~((1UL << bitarithm_msb(latest - target)) - 1);
+}
+
+static int _rtctimers_set_absolute(rtctimers_t *timer, uint32_t target, uint32_t slack)
 {
     uint32_t now = rtctimers_now();
     int res = 0;
@@ -174,6 +222,8 @@ int _rtctimers_set_absolute(rtctimers_t *timer, uint32_t target)
         _remove(timer);
     }
 
+    target = _slack_target(target, slack, now);
+
     timer->target = target;
     timer->long_target = _long_cnt;
     if (target < now) {
@@ -272,6 +322,11 @@ void rtctimers_remove(rtctimers_t *timer)
     irq_restore(state);
 }
 
+const rtctimers_wakeup_stats_t *rtctimers_get_wakeup_stats(void)
+{
+    return &_wakeup_stats;
+}
+
 static uint32_t _time_left(uint32_t target, uint32_t reference)
 {
     uint32_t now = rtctimers_now();
@@ -405,6 +460,7 @@ static void _timer_callback(void)
 {
     uint32_t next_target;
     uint32_t reference;
+    unsigned fired = 0;
 
     _in_handler = 1;
 
@@ -450,6 +506,7 @@ overflow:
 
         /* fire timer */
         _shoot(timer);
+        fired++;
     }
 
     /* possibly executing all callbacks took enough
@@ -495,6 +552,11 @@ overflow:
         }
     }
 
+    if (fired) {
+        _wakeup_stats.wakeups++;
+        _wakeup_stats.wakeups_saved += fired - 1;
+    }
+
     _in_handler = 0;
 
     /* set low level timer */
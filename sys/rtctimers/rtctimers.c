@@ -67,6 +67,15 @@ void rtctimers_set_msg(rtctimers_t *timer, uint32_t offset, msg_t *msg, kernel_p
 	rtctimers_set(timer, offset);
 }
 
+void rtctimers_set_msg_slack(rtctimers_t *timer, uint32_t offset, uint32_t slack,
+                             msg_t *msg, kernel_pid_t target_pid) {
+	timer->callback = _callback_msg;
+	timer->arg = (void *) msg;
+
+	msg->sender_pid = target_pid;
+	rtctimers_set_slack(timer, offset, slack);
+}
+
 #ifdef __cplusplus
 }
 #endif
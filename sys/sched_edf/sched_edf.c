@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     sys_sched_edf
+ * @{
+ *
+ * @file
+ * @brief       Earliest deadline first scheduling implementation
+ *
+ * @}
+ */
+
+#include <string.h>
+#include <inttypes.h>
+
+#include "irq.h"
+#include "sched.h"
+#include "thread.h"
+#include "sched_edf.h"
+
+#define ENABLE_DEBUG    (0)
+#include "debug.h"
+
+sched_edf_t sched_edf[KERNEL_PID_LAST + 1];
+
+/**
+ * @brief   Tells whether @p a has to run before @p b
+ *
+ * Threads without a pending deadline come after all the others, so among
+ * them the run queue stays FIFO.
+ */
+static int _before(const thread_t *a, const thread_t *b)
+{
+    const sched_edf_t *ea = &sched_edf[a->pid];
+    const sched_edf_t *eb = &sched_edf[b->pid];
+
+    if (!ea->pending) {
+        return 0;
+    }
+    if (!eb->pending) {
+        return 1;
+    }
+
+    return (int32_t)(ea->deadline - eb->deadline) < 0;
+}
+
+/**
+ * @brief   Inserts @p thread behind the threads due at the same time or
+ *          earlier
+ */
+static void _insert(clist_node_t *runqueue, thread_t *thread)
+{
+    clist_node_t *last = runqueue->next;
+
+    if ((last == NULL) ||
+        !_before(thread, container_of(last, thread_t, rq_entry))) {
+        clist_rpush(runqueue, &thread->rq_entry);
+        return;
+    }
+
+    /* there is a later one, at the latest the last one */
+    clist_node_t *prev = last;
+    clist_node_t *node = prev->next;
+
+    while (!_before(thread, container_of(node, thread_t, rq_entry))) {
+        prev = node;
+        node = node->next;
+    }
+
+    thread->rq_entry.next = node;
+    prev->next = &thread->rq_entry;
+}
+
+void sched_edf_thread_init(kernel_pid_t pid)
+{
+    memset(&sched_edf[pid], 0, sizeof(sched_edf_t));
+}
+
+void sched_edf_release(thread_t *thread)
+{
+    sched_edf_t *edf = &sched_edf[thread->pid];
+
+    if (edf->relative) {
+        edf->deadline = xtimer_now().ticks32 + edf->relative;
+        edf->pending = 1;
+    }
+
+    _insert(&sched_runqueues[SCHED_EDF_PRIO], thread);
+}
+
+void sched_edf_complete(thread_t *thread)
+{
+    sched_edf_t *edf = &sched_edf[thread->pid];
+
+    if (edf->pending) {
+        if ((int32_t)(xtimer_now().ticks32 - edf->deadline) > 0) {
+            DEBUG("sched_edf: thread %" PRIkernel_pid " missed its deadline\n",
+                  thread->pid);
+            edf->misses++;
+        }
+        edf->pending = 0;
+    }
+}
+
+void sched_edf_requeue(thread_t *thread)
+{
+    clist_node_t *runqueue = &sched_runqueues[SCHED_EDF_PRIO];
+
+    if (clist_find(runqueue, &thread->rq_entry)) {
+        clist_remove(runqueue, &thread->rq_entry);
+    }
+
+    _insert(runqueue, thread);
+}
+
+int sched_edf_preempt(void)
+{
+    clist_node_t *head = clist_lpeek(&sched_runqueues[SCHED_EDF_PRIO]);
+
+    return (head != NULL) &&
+           (head != (clist_node_t *)&sched_active_thread->rq_entry);
+}
+
+void sched_edf_set_deadline(kernel_pid_t pid, uint32_t us)
+{
+    uint32_t ticks = xtimer_ticks_from_usec(us).ticks32;
+
+    /* do not round a short deadline down to none */
+    if (us && !ticks) {
+        ticks = 1;
+    }
+
+    unsigned state = irq_disable();
+    sched_edf[pid].relative = ticks;
+    irq_restore(state);
+}
@@ -0,0 +1,216 @@
+/*
+ * Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     sys_sched_prof
+ * @{
+ *
+ * @file
+ * @brief       Thread profiler implementation
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "bitarithm.h"
+#include "irq.h"
+#include "sched.h"
+#include "thread.h"
+#include "sched_prof.h"
+
+#define SCHED_PROF_VERSION  (1)
+
+sched_prof_t sched_prof[KERNEL_PID_LAST + 1];
+
+void sched_prof_thread_init(kernel_pid_t pid)
+{
+    memset(&sched_prof[pid], 0, sizeof(sched_prof_t));
+}
+
+void sched_prof_switch(kernel_pid_t prev, kernel_pid_t next)
+{
+    uint32_t now = SCHED_PROF_NOW();
+
+    if (prev != KERNEL_PID_UNDEF) {
+        sched_prof[prev].runtime += now - sched_prof[prev].last;
+    }
+
+    sched_prof_t *p = &sched_prof[next];
+
+    if (p->woken) {
+        uint32_t latency = now - p->woken_at;
+        unsigned bucket = bitarithm_msb(latency | 1) >> 1;
+
+        if (bucket >= SCHED_PROF_LAT_BUCKETS) {
+            bucket = SCHED_PROF_LAT_BUCKETS - 1;
+        }
+        if (p->lat_hist[bucket] < UINT16_MAX) {
+            p->lat_hist[bucket]++;
+        }
+        if (latency > p->lat_max) {
+            p->lat_max = latency;
+        }
+
+        p->woken = 0;
+    }
+
+    p->last = now;
+    p->switches++;
+}
+
+void sched_prof_reset(void)
+{
+    unsigned state = irq_disable();
+
+    uint32_t now = SCHED_PROF_NOW();
+
+    for (kernel_pid_t i = KERNEL_PID_FIRST; i <= KERNEL_PID_LAST; i++) {
+        sched_prof_t *p = &sched_prof[i];
+
+        p->runtime = 0;
+        p->switches = 0;
+        p->lat_max = 0;
+        memset(p->lat_hist, 0, sizeof(p->lat_hist));
+        p->msg_hwm = 0;
+
+        /* the running thread is accounted from now on */
+        if (i == sched_active_pid) {
+            p->last = now;
+        }
+    }
+
+    irq_restore(state);
+}
+
+static int _stack_free(const thread_t *thread)
+{
+#if defined(DEVELHELP) || defined(SCHED_TEST_STACK)
+    return thread_measure_stack_free(thread->stack_start);
+#else
+    (void)thread;
+    return -1;
+#endif
+}
+
+static uint8_t *_put(uint8_t *buf, uint64_t value, unsigned len)
+{
+    for (unsigned i = 0; i < len; i++) {
+        *buf++ = value & 0xFF;
+        value >>= 8;
+    }
+    return buf;
+}
+
+size_t sched_prof_export_thread(kernel_pid_t pid, uint8_t *buf)
+{
+    const thread_t *thread = (const thread_t *)sched_threads[pid];
+
+    if (thread == NULL) {
+        return 0;
+    }
+
+    int stack_free = _stack_free(thread);
+
+    /* copy to have consistent counters */
+    unsigned state = irq_disable();
+    sched_prof_t p = sched_prof[pid];
+    irq_restore(state);
+
+    uint8_t *pos = buf;
+    pos = _put(pos, pid, 1);
+    pos = _put(pos, thread->priority, 1);
+    pos = _put(pos, (stack_free < 0) ? 0xFFFF : (unsigned)stack_free, 2);
+    pos = _put(pos, p.runtime, 8);
+    pos = _put(pos, p.switches, 4);
+    pos = _put(pos, p.lat_max, 4);
+    for (unsigned i = 0; i < SCHED_PROF_LAT_BUCKETS; i++) {
+        pos = _put(pos, p.lat_hist[i], 2);
+    }
+    pos = _put(pos, p.msg_hwm, 2);
+
+    return pos - buf;
+}
+
+size_t sched_prof_export_header(uint8_t *buf)
+{
+    uint8_t *pos = buf;
+    *pos++ = 'S';
+    *pos++ = 'P';
+    pos = _put(pos, SCHED_PROF_VERSION, 1);
+    pos = _put(pos, SCHED_PROF_RECORD_LEN, 1);
+    pos = _put(pos, SCHED_PROF_HZ, 4);
+
+    return pos - buf;
+}
+
+size_t sched_prof_export(uint8_t *buf, size_t len)
+{
+    if (len < SCHED_PROF_HDR_LEN) {
+        return 0;
+    }
+
+    size_t pos = sched_prof_export_header(buf);
+
+    for (kernel_pid_t i = KERNEL_PID_FIRST; i <= KERNEL_PID_LAST; i++) {
+        if (len - pos < SCHED_PROF_RECORD_LEN) {
+            break;
+        }
+        pos += sched_prof_export_thread(i, &buf[pos]);
+    }
+
+    return pos;
+}
+
+void sched_prof_print(void)
+{
+    printf("\tpid | "
+#ifdef DEVELHELP
+           "%-20s | "
+#endif
+           "runtime [ms] | switches | lat. max | lat. <4^1 .. <4^%u, more"
+           " | msg hwm | stack free\n",
+#ifdef DEVELHELP
+           "name",
+#endif
+           SCHED_PROF_LAT_BUCKETS - 1);
+
+    for (kernel_pid_t i = KERNEL_PID_FIRST; i <= KERNEL_PID_LAST; i++) {
+        const thread_t *thread = (const thread_t *)sched_threads[i];
+
+        if (thread == NULL) {
+            continue;
+        }
+
+        int stack_free = _stack_free(thread);
+
+        unsigned state = irq_disable();
+        sched_prof_t p = sched_prof[i];
+        irq_restore(state);
+
+        printf("\t%3" PRIkernel_pid
+#ifdef DEVELHELP
+               " | %-20s"
+#endif
+               " | %12" PRIu32 " | %8" PRIu32 " | %8" PRIu32 " |",
+               i,
+#ifdef DEVELHELP
+               thread->name,
+#endif
+               (uint32_t)(p.runtime * 1000 / SCHED_PROF_HZ),
+               p.switches, p.lat_max);
+
+        for (unsigned b = 0; b < SCHED_PROF_LAT_BUCKETS; b++) {
+            printf(" %u", p.lat_hist[b]);
+        }
+
+        printf(" | %7u | %10i\n", p.msg_hwm, stack_free);
+    }
+}
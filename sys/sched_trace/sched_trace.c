@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     sys_sched_trace
+ * @{
+ *
+ * @file
+ * @brief       Scheduler trace implementation
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "irq.h"
+#include "sched.h"
+#include "thread.h"
+#include "xtimer.h"
+#include "sched_trace.h"
+
+#if (SCHED_TRACE_SIZE & (SCHED_TRACE_SIZE - 1))
+#error "SCHED_TRACE_SIZE must be a power of two"
+#endif
+
+/* records per line of the dump */
+#define DUMP_LINE_RECORDS   (8)
+
+static sched_trace_rec_t _ring[SCHED_TRACE_SIZE];
+/* number of records written since the last clear, the ring holds the
+ * latest SCHED_TRACE_SIZE of them */
+static uint32_t _count;
+static bool _enabled = true;
+
+void sched_trace_record(uint8_t event, uint8_t arg8, uint16_t arg16)
+{
+    unsigned state = irq_disable();
+
+    if (_enabled) {
+        sched_trace_rec_t *rec = &_ring[_count++ & (SCHED_TRACE_SIZE - 1)];
+
+        rec->time = SCHED_TRACE_NOW();
+        rec->event = irq_is_in() ? (event | SCHED_TRACE_IN_ISR) : event;
+        rec->arg8 = arg8;
+        rec->arg16 = arg16;
+    }
+
+    irq_restore(state);
+}
+
+void sched_trace_enable(bool enable)
+{
+    _enabled = enable;
+}
+
+void sched_trace_clear(void)
+{
+    unsigned state = irq_disable();
+    _count = 0;
+    irq_restore(state);
+}
+
+static void _print_record(const sched_trace_rec_t *rec)
+{
+    /* little endian, as in memory on the supported CPUs */
+    printf("%02x%02x%02x%02x%02x%02x%02x%02x",
+           (unsigned)(rec->time & 0xFF), (unsigned)((rec->time >> 8) & 0xFF),
+           (unsigned)((rec->time >> 16) & 0xFF), (unsigned)(rec->time >> 24),
+           rec->event, rec->arg8,
+           rec->arg16 & 0xFF, rec->arg16 >> 8);
+}
+
+void sched_trace_dump(void)
+{
+    bool enabled = _enabled;
+    _enabled = false;
+
+    uint32_t num = (_count < SCHED_TRACE_SIZE) ? _count : SCHED_TRACE_SIZE;
+
+    printf("trace: hz=%" PRIu32 " count=%" PRIu32 " records=%" PRIu32 "\n",
+           (uint32_t)SCHED_TRACE_HZ, _count, num);
+
+#ifdef DEVELHELP
+    for (kernel_pid_t i = KERNEL_PID_FIRST; i <= KERNEL_PID_LAST; i++) {
+        const thread_t *thread = (const thread_t *)sched_threads[i];
+
+        if (thread != NULL) {
+            printf("trace: thread %" PRIkernel_pid " %s\n", i, thread->name);
+        }
+    }
+#endif
+
+    for (uint32_t i = 0; i < num; i++) {
+        if ((i % DUMP_LINE_RECORDS) == 0) {
+            printf("trace: ");
+        }
+
+        _print_record(&_ring[(_count - num + i) & (SCHED_TRACE_SIZE - 1)]);
+
+        if (((i % DUMP_LINE_RECORDS) == DUMP_LINE_RECORDS - 1) || (i == num - 1)) {
+            puts("");
+        }
+    }
+
+    puts("trace: end");
+
+    _enabled = enabled;
+}
@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     sys_shell_commands
+ * @{
+ *
+ * @file
+ * @brief       Shell command for the power mode residency
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "pm_layered.h"
+
+int _pm_handler(int argc, char **argv)
+{
+    if (argc < 2) {
+        pm_print_residency();
+    }
+    else if (strcmp(argv[1], "reset") == 0) {
+        pm_reset_residency();
+    }
+    else {
+        printf("usage: %s [reset]\n", argv[0]);
+        return 1;
+    }
+
+    return 0;
+}
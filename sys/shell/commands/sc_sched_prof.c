@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     sys_shell_commands
+ * @{
+ *
+ * @file
+ * @brief       Shell commands for the thread profiler
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "sched_prof.h"
+
+static void _print_hex(const uint8_t *buf, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        printf("%02x", buf[i]);
+    }
+}
+
+int _sched_prof_handler(int argc, char **argv)
+{
+    if (argc < 2) {
+        sched_prof_print();
+        return 0;
+    }
+
+    if (strcmp(argv[1], "reset") == 0) {
+        sched_prof_reset();
+    }
+    else if (strcmp(argv[1], "bin") == 0) {
+        /* same data as sched_prof_export(), one record at a time */
+        uint8_t buf[SCHED_PROF_RECORD_LEN];
+
+        _print_hex(buf, sched_prof_export_header(buf));
+
+        for (kernel_pid_t i = KERNEL_PID_FIRST; i <= KERNEL_PID_LAST; i++) {
+            _print_hex(buf, sched_prof_export_thread(i, buf));
+        }
+        puts("");
+    }
+    else {
+        printf("usage: %s [reset|bin]\n", argv[0]);
+        return 1;
+    }
+
+    return 0;
+}
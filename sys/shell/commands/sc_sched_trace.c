@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     sys_shell_commands
+ * @{
+ *
+ * @file
+ * @brief       Shell commands for the scheduler trace
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "sched_trace.h"
+
+int _sched_trace_handler(int argc, char **argv)
+{
+    if ((argc < 2) || (strcmp(argv[1], "dump") == 0)) {
+        sched_trace_dump();
+    }
+    else if (strcmp(argv[1], "clear") == 0) {
+        sched_trace_clear();
+    }
+    else if (strcmp(argv[1], "on") == 0) {
+        sched_trace_enable(true);
+    }
+    else if (strcmp(argv[1], "off") == 0) {
+        sched_trace_enable(false);
+    }
+    else {
+        printf("usage: %s [dump|clear|on|off]\n", argv[0]);
+        return 1;
+    }
+
+    return 0;
+}
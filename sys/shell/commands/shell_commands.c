@@ -33,10 +33,22 @@ extern int _id_handler(int argc, char **argv);
 extern int _heap_handler(int argc, char **argv);
 #endif
 
+#ifdef MODULE_PM_LAYERED_TICKLESS
+extern int _pm_handler(int argc, char **argv);
+#endif
+
 #ifdef MODULE_PS
 extern int _ps_handler(int argc, char **argv);
 #endif
 
+#ifdef MODULE_SCHED_PROF
+extern int _sched_prof_handler(int argc, char **argv);
+#endif
+
+#ifdef MODULE_SCHED_TRACE
+extern int _sched_trace_handler(int argc, char **argv);
+#endif
+
 #ifdef MODULE_SHT1X
 extern int _get_temperature_handler(int argc, char **argv);
 extern int _get_humidity_handler(int argc, char **argv);
@@ -150,9 +162,18 @@ const shell_command_t _shell_command_list[] = {
 #ifdef MODULE_LPC_COMMON
     {"heap", "Shows the heap state for the LPC2387 on the command shell.", _heap_handler},
 #endif
+#ifdef MODULE_PM_LAYERED_TICKLESS
+    {"pm", "Prints or resets the time spent in each power mode.", _pm_handler},
+#endif
 #ifdef MODULE_PS
     {"ps", "Prints information about running threads.", _ps_handler},
 #endif
+#ifdef MODULE_SCHED_PROF
+    {"prof", "Prints, resets or dumps in hex thread profiling counters.", _sched_prof_handler},
+#endif
+#ifdef MODULE_SCHED_TRACE
+    {"trace", "Dumps, clears, starts or stops the scheduler trace.", _sched_trace_handler},
+#endif
 #ifdef MODULE_SHT1X
     {"temp", "Prints measured temperature.", _get_temperature_handler},
     {"hum", "Prints measured humidity.", _get_humidity_handler},
@@ -156,6 +156,12 @@ void _xtimer_set_msg(xtimer_t *timer, uint32_t offset, msg_t *msg, kernel_pid_t
     _xtimer_set(timer, offset);
 }
 
+void _xtimer_set_msg_slack(xtimer_t *timer, uint32_t offset, uint32_t slack, msg_t *msg, kernel_pid_t target_pid)
+{
+    _setup_msg(timer, msg, target_pid);
+    _xtimer_set_slack(timer, offset, slack);
+}
+
 void _xtimer_set_msg64(xtimer_t *timer, uint64_t offset, msg_t *msg, kernel_pid_t target_pid)
 {
     _setup_msg(timer, msg, target_pid);
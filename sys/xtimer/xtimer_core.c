@@ -26,6 +26,7 @@
 
 #include "xtimer.h"
 #include "irq.h"
+#include "bitarithm.h"
 
 /* WARNING! enabling this will have side effects and can lead to timer underflows. */
 #define ENABLE_DEBUG 0
@@ -44,6 +45,9 @@ static xtimer_t *timer_list_head = NULL;
 static xtimer_t *overflow_list_head = NULL;
 static xtimer_t *long_list_head = NULL;
 
+static xtimer_wakeup_stats_t _wakeup_stats;
+
+static int _set_absolute(xtimer_t *timer, uint32_t target, uint32_t slack);
 static void _add_timer_to_list(xtimer_t **list_head, xtimer_t *timer);
 static void _add_timer_to_long_list(xtimer_t **list_head, xtimer_t *timer);
 static void _shoot(xtimer_t *timer);
@@ -131,8 +135,13 @@ void _xtimer_set64(xtimer_t *timer, uint32_t offset, uint32_t long_offset)
 
 void _xtimer_set(xtimer_t *timer, uint32_t offset)
 {
-    DEBUG("timer_set(): offset=%" PRIu32 " now=%" PRIu32 " (%" PRIu32 ")\n",
-          offset, xtimer_now().ticks32, _xtimer_lltimer_now());
+    _xtimer_set_slack(timer, offset, 0);
+}
+
+void _xtimer_set_slack(xtimer_t *timer, uint32_t offset, uint32_t slack)
+{
+    DEBUG("timer_set(): offset=%" PRIu32 " slack=%" PRIu32 " now=%" PRIu32 " (%" PRIu32 ")\n",
+          offset, slack, xtimer_now().ticks32, _xtimer_lltimer_now());
     if (!timer->callback) {
         DEBUG("timer_set(): timer has no callback.\n");
         return;
@@ -146,7 +155,7 @@ void _xtimer_set(xtimer_t *timer, uint32_t offset)
     }
     else {
         uint32_t target = _xtimer_now() + offset;
-        _xtimer_set_absolute(timer, target);
+        _set_absolute(timer, target, slack);
     }
 }
 
@@ -171,7 +180,54 @@ static inline void _lltimer_set(uint32_t target)
     timer_set_absolute(XTIMER_DEV, XTIMER_CHAN, _xtimer_lltimer_mask(target));
 }
 
+/**
+ * @brief pick a target within [target, target + slack] to share a wakeup with
+ *        other timers
+ *
+ * Joins the first timer of this period expiring within the window, otherwise
+ * rounds the target down to the coarsest power of two boundary within the
+ * window so that timers set later can join it.
+ */
+static uint32_t _slack_target(uint32_t target, uint32_t slack, uint32_t now)
+{
+    uint32_t latest = target + slack;
+
+    if (!slack || (latest < target)) {
+        /* no slack or the window wraps */
+        return target;
+    }
+#if XTIMER_MASK
+    /* keep the timer in its low-level timer period */
+    if ((latest & XTIMER_MASK) != (target & XTIMER_MASK)) {
+        latest = target | ~XTIMER_MASK;
+    }
+#endif
+
+    if ((target >= now) && _this_high_period(target)) {
+        for (xtimer_t *t = timer_list_head; t; t = t->next) {
+            if (t->target >= target) {
+                if (t->target <= latest) {
+                    _wakeup_stats.coalesced++;
+                    return t->target;
+                }
+                break;
+            }
+        }
+    }
+
+    if (latest == target) {
+        return target;
+    }
+
+    return latest & ~((1UL << bitarithm_msb(latest - target)) - 1);
+}
+
 int _xtimer_set_absolute(xtimer_t *timer, uint32_t target)
+{
+    return _set_absolute(timer, target, 0);
+}
+
+static int _set_absolute(xtimer_t *timer, uint32_t target, uint32_t slack)
 {
     uint32_t now = _xtimer_now();
     int res = 0;
@@ -191,6 +247,8 @@ int _xtimer_set_absolute(xtimer_t *timer, uint32_t target)
         _remove(timer);
     }
 
+    target = _slack_target(target, slack, now);
+
     timer->target = target;
     timer->long_target = _long_cnt;
     if (target < now) {
@@ -289,6 +347,51 @@ void xtimer_remove(xtimer_t *timer)
     irq_restore(state);
 }
 
+const xtimer_wakeup_stats_t *xtimer_get_wakeup_stats(void)
+{
+    return &_wakeup_stats;
+}
+
+uint32_t xtimer_time_until_next(void)
+{
+    unsigned state = irq_disable();
+    uint32_t now = _xtimer_now();
+    uint32_t res = UINT32_MAX;
+
+    if (timer_list_head) {
+        /* may already be due, waiting for the interrupt */
+        if (timer_list_head->target > now) {
+            res = timer_list_head->target - now;
+        }
+        else {
+            res = 0;
+        }
+    }
+    else if (overflow_list_head) {
+        /* expires after the wrap around of now */
+        res = overflow_list_head->target - now;
+    }
+    else if (long_list_head) {
+        xtimer_t *timer = long_list_head;
+        if (((timer->long_target == _long_cnt) && (timer->target > now)) ||
+            ((timer->long_target == _long_cnt + 1) && (timer->target <= now))) {
+            res = timer->target - now;
+        }
+    }
+
+#if XTIMER_MASK
+    /* the low-level timer interrupts at its own overflow */
+    uint32_t overflow = _xtimer_lltimer_mask(0xFFFFFFFF) - _xtimer_lltimer_now();
+    if (overflow < res) {
+        res = overflow;
+    }
+#endif
+
+    irq_restore(state);
+
+    return res;
+}
+
 static uint32_t _time_left(uint32_t target, uint32_t reference)
 {
     uint32_t now = _xtimer_lltimer_now();
@@ -435,6 +538,7 @@ static void _timer_callback(void)
 {
     uint32_t next_target;
     uint32_t reference;
+    unsigned fired = 0;
 
     _in_handler = 1;
 
@@ -483,6 +587,7 @@ overflow:
 
         /* fire timer */
         _shoot(timer);
+        fired++;
     }
 
     /* possibly executing all callbacks took enough
@@ -530,6 +635,11 @@ overflow:
         }
     }
 
+    if (fired) {
+        _wakeup_stats.wakeups++;
+        _wakeup_stats.wakeups_saved += fired - 1;
+    }
+
     _in_handler = 0;
 
     /* set low level timer */
@@ -0,0 +1,702 @@
+/**
+ * Copyright (C) 2015 Kaspar Schleiser <kaspar@schleiser.de>
+ * Copyright (C) 2016 Eistec AB
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup sys_xtimer
+ *
+ * @{
+ * @file
+ * @brief xtimer core functionality based on a hierarchical timing wheel
+ *
+ * Used in place of xtimer_core.c with the xtimer_wheel pseudomodule.
+ *
+ * Timers are kept in doubly linked slot lists. A timer expiring at @p t goes
+ * to the finest level whose slots still reach @p t from the wheel's base
+ * time, into the slot selected by the bits of @p t of that level. A per-level
+ * bitmap of non-empty slots gives the next slot to come due without walking
+ * any list. When a slot comes due its timers are moved to the finer levels,
+ * those of a finest slot to the sorted list of due timers, which drives the
+ * low-level timer the same way the timer list of xtimer_core.c does.
+ *
+ * @author Kaspar Schleiser <kaspar@schleiser.de>
+ * @author Joakim Nohlgård <joakim.nohlgard@eistec.se>
+ * @}
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "board.h"
+#include "periph/timer.h"
+#include "periph_conf.h"
+
+#include "xtimer.h"
+#include "irq.h"
+#include "bitarithm.h"
+
+/* WARNING! enabling this will have side effects and can lead to timer underflows. */
+#define ENABLE_DEBUG 0
+#include "debug.h"
+
+#if XTIMER_WHEEL_BITS > 5
+#error "XTIMER_WHEEL_BITS must be at most 5, slot bitmaps are 32 bit wide"
+#endif
+
+#if XTIMER_WHEEL_SLOT_SHIFT >= XTIMER_WIDTH
+#error "XTIMER_WHEEL_SLOT_SHIFT must be less than XTIMER_WIDTH"
+#endif
+
+#define WHEEL_SLOTS         (1U << XTIMER_WHEEL_BITS)
+#define WHEEL_SLOT_MASK     (WHEEL_SLOTS - 1)
+#define WHEEL_SHIFT(level)  (XTIMER_WHEEL_SLOT_SHIFT + (level) * XTIMER_WHEEL_BITS)
+#define WHEEL_TOP_SHIFT     WHEEL_SHIFT(XTIMER_WHEEL_LEVELS - 1)
+#define WHEEL_NEVER         (UINT64_MAX)
+
+/* bits of the time kept by the low-level timer */
+#define LLTIMER_MAX         _xtimer_lltimer_mask(0xFFFFFFFF)
+
+static volatile int _in_handler = 0;
+
+static volatile uint32_t _long_cnt = 0;
+#if XTIMER_MASK
+volatile uint32_t _xtimer_high_cnt = 0;
+#endif
+
+static xtimer_t *_wheel[XTIMER_WHEEL_LEVELS][WHEEL_SLOTS];
+static uint32_t _wheel_used[XTIMER_WHEEL_LEVELS];
+
+/* timers of the finest slots that came due, sorted by target */
+static xtimer_t *_due_list_head = NULL;
+
+/* timers beyond the coarsest level, unsorted */
+static xtimer_t *_far_list_head = NULL;
+/* time the earliest of them fits into the coarsest level */
+static uint64_t _far_check = WHEEL_NEVER;
+
+/* start of the finest slot all timers are placed relative to */
+static uint64_t _base = 0;
+
+/* low-level timer state */
+static uint64_t _next_armed = WHEEL_NEVER;
+static int _period_end = 0;
+static uint32_t _period_end_ref = 0;
+static uint32_t _reference = 0;
+
+static xtimer_wakeup_stats_t _wakeup_stats;
+
+static inline void xtimer_spin_until(uint32_t value);
+
+static int _set_absolute(xtimer_t *timer, uint32_t target, uint32_t slack);
+static void _add(xtimer_t *timer);
+static void _remove(xtimer_t *timer);
+static void _shoot(xtimer_t *timer);
+static void _lltimer_arm(uint64_t when);
+
+static void _timer_callback(void);
+static void _periph_timer_callback(void *arg, int chan);
+
+static inline int _is_set(xtimer_t *timer)
+{
+    return (timer->target || timer->long_target);
+}
+
+static inline uint64_t _target64(const xtimer_t *timer)
+{
+    return ((uint64_t)timer->long_target << 32) | timer->target;
+}
+
+/**
+ * @brief start of the current low-level timer period
+ */
+static inline uint64_t _period(void)
+{
+#if XTIMER_MASK
+    return ((uint64_t)_long_cnt << 32) | _xtimer_high_cnt;
+#else
+    return (uint64_t)_long_cnt << 32;
+#endif
+}
+
+static inline void xtimer_spin_until(uint32_t target) {
+#if XTIMER_MASK
+    target = _xtimer_lltimer_mask(target);
+#endif
+    while (_xtimer_lltimer_now() > target);
+    while (_xtimer_lltimer_now() < target);
+}
+
+void xtimer_init(void)
+{
+    /* initialize low-level timer */
+    timer_init(XTIMER_DEV, XTIMER_HZ, _periph_timer_callback, NULL);
+
+    /* register initial overflow tick */
+    _period_end = 1;
+    _period_end_ref = 0;
+    _next_armed = LLTIMER_MAX;
+    timer_set_absolute(XTIMER_DEV, XTIMER_CHAN, LLTIMER_MAX);
+}
+
+static void _xtimer_now_internal(uint32_t *short_term, uint32_t *long_term)
+{
+    uint32_t before, after, long_value;
+
+    /* loop to cope with possible overflow of _xtimer_now() */
+    do {
+        before = _xtimer_now();
+        long_value = _long_cnt;
+        after = _xtimer_now();
+
+    } while(before > after);
+
+    *short_term = after;
+    *long_term = long_value;
+}
+
+uint64_t _xtimer_now64(void)
+{
+    uint32_t short_term, long_term;
+    _xtimer_now_internal(&short_term, &long_term);
+
+    return ((uint64_t)long_term<<32) + short_term;
+}
+
+void _xtimer_set64(xtimer_t *timer, uint32_t offset, uint32_t long_offset)
+{
+    DEBUG(" _xtimer_set64() offset=%" PRIu32 " long_offset=%" PRIu32 "\n", offset, long_offset);
+    if (!long_offset) {
+        /* timer fits into the short timer */
+        _xtimer_set(timer, (uint32_t) offset);
+    }
+    else {
+        int state = irq_disable();
+        if (_is_set(timer)) {
+            _remove(timer);
+        }
+
+        _xtimer_now_internal(&timer->target, &timer->long_target);
+        timer->target += offset;
+        timer->long_target += long_offset;
+        if (timer->target < offset) {
+            timer->long_target++;
+        }
+
+        _add(timer);
+        irq_restore(state);
+        DEBUG("xtimer_set64(): added longterm timer (long_target=%" PRIu32 " target=%" PRIu32 ")\n",
+                timer->long_target, timer->target);
+    }
+}
+
+void _xtimer_set(xtimer_t *timer, uint32_t offset)
+{
+    _xtimer_set_slack(timer, offset, 0);
+}
+
+void _xtimer_set_slack(xtimer_t *timer, uint32_t offset, uint32_t slack)
+{
+    DEBUG("timer_set(): offset=%" PRIu32 " slack=%" PRIu32 " now=%" PRIu32 " (%" PRIu32 ")\n",
+          offset, slack, xtimer_now().ticks32, _xtimer_lltimer_now());
+    if (!timer->callback) {
+        DEBUG("timer_set(): timer has no callback.\n");
+        return;
+    }
+
+    xtimer_remove(timer);
+
+    if (offset < XTIMER_BACKOFF) {
+        _xtimer_spin(offset);
+        _shoot(timer);
+    }
+    else {
+        uint32_t target = _xtimer_now() + offset;
+        _set_absolute(timer, target, slack);
+    }
+}
+
+static void _periph_timer_callback(void *arg, int chan)
+{
+    (void)arg;
+    (void)chan;
+    _timer_callback();
+}
+
+static void _shoot(xtimer_t *timer)
+{
+    timer->callback(timer->arg);
+}
+
+/**
+ * @brief pick a target within [target, target + slack] to share a wakeup with
+ *        other timers
+ *
+ * Rounds the target down to the coarsest power of two boundary within the
+ * window, timers with overlapping windows end up on the same boundary and
+ * fire in one callback.
+ */
+static uint32_t _slack_target(uint32_t target, uint32_t slack)
+{
+    uint32_t latest = target + slack;
+
+    if (!slack || (latest < target)) {
+        /* no slack or the window wraps */
+        return target;
+    }
+#if XTIMER_MASK
+    /* keep the timer in its low-level timer period */
+    if ((latest & XTIMER_MASK) != (target & XTIMER_MASK)) {
+        latest = target | ~XTIMER_MASK;
+    }
+#endif
+
+    if (latest == target) {
+        return target;
+    }
+
+    return latest & ~((1UL << bitarithm_msb(latest - target)) - 1);
+}
+
+int _xtimer_set_absolute(xtimer_t *timer, uint32_t target)
+{
+    return _set_absolute(timer, target, 0);
+}
+
+static int _set_absolute(xtimer_t *timer, uint32_t target, uint32_t slack)
+{
+    uint32_t now = _xtimer_now();
+    int res = 0;
+
+    DEBUG("timer_set_absolute(): now=%" PRIu32 " target=%" PRIu32 "\n", now, target);
+
+    if ((target >= now) && ((target - XTIMER_BACKOFF) < now)) {
+        /* backoff */
+        xtimer_remove(timer);
+        xtimer_spin_until(target + XTIMER_BACKOFF);
+        _shoot(timer);
+        return 0;
+    }
+
+    unsigned state = irq_disable();
+    if (_is_set(timer)) {
+        _remove(timer);
+    }
+
+    target = _slack_target(target, slack);
+
+    timer->target = target;
+    timer->long_target = _long_cnt;
+    if (target < now) {
+        timer->long_target++;
+    }
+
+    _add(timer);
+
+    irq_restore(state);
+
+    return res;
+}
+
+static void _link(xtimer_t **link, xtimer_t *timer)
+{
+    timer->next = *link;
+    if (timer->next) {
+        timer->next->pprev = &timer->next;
+    }
+    timer->pprev = link;
+    *link = timer;
+}
+
+static void _unlink(xtimer_t *timer)
+{
+    xtimer_t **link = timer->pprev;
+
+    *link = timer->next;
+    if (timer->next) {
+        timer->next->pprev = link;
+        return;
+    }
+
+    /* last timer gone, clear the slot's bit if the link is a slot head */
+    uintptr_t n = ((uintptr_t)link - (uintptr_t)&_wheel[0][0]) / sizeof(_wheel[0][0]);
+    if (((uintptr_t)link >= (uintptr_t)&_wheel[0][0]) &&
+        (n < XTIMER_WHEEL_LEVELS * WHEEL_SLOTS)) {
+        _wheel_used[n / WHEEL_SLOTS] &= ~(1UL << (n % WHEEL_SLOTS));
+    }
+}
+
+/**
+ * @brief find the earliest non-empty slot
+ *
+ * @return  start time of the slot, WHEEL_NEVER if the wheel is empty
+ */
+static uint64_t _next_slot(unsigned *level_out, unsigned *idx_out)
+{
+    uint64_t next = WHEEL_NEVER;
+
+    for (unsigned level = 0; level < XTIMER_WHEEL_LEVELS; level++) {
+        uint32_t used = _wheel_used[level];
+        if (!used) {
+            continue;
+        }
+
+        uint64_t base_slot = _base >> WHEEL_SHIFT(level);
+        unsigned cur = base_slot & WHEEL_SLOT_MASK;
+
+        /* rotate the bitmap so that the bit of the current slot comes first */
+        if (cur) {
+            used = (used >> cur) | (used << (WHEEL_SLOTS - cur));
+#if XTIMER_WHEEL_BITS < 5
+            used &= (1UL << WHEEL_SLOTS) - 1;
+#endif
+        }
+        unsigned dist = bitarithm_lsb(used);
+
+        uint64_t start = (base_slot + dist) << WHEEL_SHIFT(level);
+        if (start < next) {
+            next = start;
+            *level_out = level;
+            *idx_out = (cur + dist) & WHEEL_SLOT_MASK;
+        }
+    }
+
+    return next;
+}
+
+/**
+ * @brief put timer to the due list or the slot matching its target
+ *
+ * @return  time the timer has to be looked at again
+ */
+static uint64_t _place(xtimer_t *timer)
+{
+    uint64_t target = _target64(timer);
+
+    if ((target >> XTIMER_WHEEL_SLOT_SHIFT) <= (_base >> XTIMER_WHEEL_SLOT_SHIFT)) {
+        /* expires within the current finest slot, keep sorted */
+        xtimer_t **link = &_due_list_head;
+        while (*link && _target64(*link) <= target) {
+            link = &((*link)->next);
+        }
+        _link(link, timer);
+        return target;
+    }
+
+    for (unsigned level = 0; level < XTIMER_WHEEL_LEVELS; level++) {
+        uint64_t slot = target >> WHEEL_SHIFT(level);
+        if (slot - (_base >> WHEEL_SHIFT(level)) < WHEEL_SLOTS) {
+            unsigned idx = slot & WHEEL_SLOT_MASK;
+            _link(&_wheel[level][idx], timer);
+            _wheel_used[level] |= 1UL << idx;
+            return slot << WHEEL_SHIFT(level);
+        }
+    }
+
+    if (!_far_list_head) {
+        _far_check = WHEEL_NEVER;
+    }
+    _link(&_far_list_head, timer);
+
+    uint64_t check = ((target >> WHEEL_TOP_SHIFT) - (WHEEL_SLOTS - 1)) << WHEEL_TOP_SHIFT;
+    if (check < _far_check) {
+        _far_check = check;
+    }
+    return _far_check;
+}
+
+/**
+ * @brief move the wheel's base up to @p now, but not past a non-empty slot
+ */
+static void _advance_base(uint64_t now)
+{
+    unsigned level, idx;
+    uint64_t next = _next_slot(&level, &idx);
+
+    if (now < next) {
+        next = now;
+    }
+    next &= ~(((uint64_t)1 << XTIMER_WHEEL_SLOT_SHIFT) - 1);
+
+    if (next > _base) {
+        _base = next;
+    }
+}
+
+/**
+ * @brief move timers of all slots that came due by @p now to the finer
+ *        levels or to the due list
+ */
+static void _cascade(uint64_t now)
+{
+    unsigned level, idx;
+    uint64_t start;
+
+    while ((start = _next_slot(&level, &idx)) <= now) {
+        xtimer_t *list = _wheel[level][idx];
+
+        _wheel[level][idx] = NULL;
+        _wheel_used[level] &= ~(1UL << idx);
+
+        if (start > _base) {
+            _base = start;
+        }
+
+        while (list) {
+            xtimer_t *timer = list;
+            list = timer->next;
+            _place(timer);
+        }
+    }
+
+    _advance_base(now);
+
+    if (_far_list_head && (_far_check <= now)) {
+        xtimer_t *list = _far_list_head;
+
+        _far_list_head = NULL;
+        _far_check = WHEEL_NEVER;
+
+        while (list) {
+            xtimer_t *timer = list;
+            list = timer->next;
+            _place(timer);
+        }
+    }
+}
+
+static uint64_t _next_event(void)
+{
+    unsigned level, idx;
+    uint64_t next = _next_slot(&level, &idx);
+
+    if (_due_list_head && (_target64(_due_list_head) < next)) {
+        next = _target64(_due_list_head);
+    }
+    if (_far_list_head && (_far_check < next)) {
+        next = _far_check;
+    }
+
+    return next;
+}
+
+static void _add(xtimer_t *timer)
+{
+    uint64_t now = _xtimer_now64();
+
+    /* don't place new timers relative to a base left behind long ago */
+    _advance_base(now);
+
+    uint64_t when = _place(timer);
+
+    if (when < _next_armed) {
+        _lltimer_arm(when);
+    }
+}
+
+static void _remove(xtimer_t *timer)
+{
+    /* the low-level timer is left as it is, an early wakeup finds nothing due */
+    _unlink(timer);
+    timer->target = 0;
+    timer->long_target = 0;
+}
+
+void xtimer_remove(xtimer_t *timer)
+{
+    int state = irq_disable();
+    if (_is_set(timer)) {
+        _remove(timer);
+    }
+    irq_restore(state);
+}
+
+const xtimer_wakeup_stats_t *xtimer_get_wakeup_stats(void)
+{
+    return &_wakeup_stats;
+}
+
+uint32_t xtimer_time_until_next(void)
+{
+    unsigned state = irq_disable();
+    uint64_t now = _xtimer_now64();
+    uint64_t next = _next_event();
+    /* the low-level timer may be armed earlier, e.g. at its overflow */
+    if (_next_armed < next) {
+        next = _next_armed;
+    }
+    irq_restore(state);
+
+    if (next <= now) {
+        return 0;
+    }
+    if ((next - now) > UINT32_MAX) {
+        return UINT32_MAX;
+    }
+    return next - now;
+}
+
+/**
+ * @brief set low-level timer from thread context
+ */
+static void _lltimer_arm(uint64_t when)
+{
+    if (_in_handler) {
+        return;
+    }
+
+    if (_period_end && (_xtimer_lltimer_now() < _period_end_ref)) {
+        /* period is over, pending callback will rearm */
+        return;
+    }
+
+    uint64_t now = _period() | _xtimer_lltimer_now();
+    if (when < now + XTIMER_ISR_BACKOFF) {
+        when = now + XTIMER_ISR_BACKOFF;
+    }
+    else if (when >= now + XTIMER_OVERHEAD + XTIMER_ISR_BACKOFF) {
+        when -= XTIMER_OVERHEAD;
+    }
+
+    if ((when & ~(uint64_t)LLTIMER_MAX) == _period()) {
+        _period_end = 0;
+        _next_armed = when;
+        DEBUG("_lltimer_arm(): setting %" PRIu32 "\n", (uint32_t)when & LLTIMER_MAX);
+        timer_set_absolute(XTIMER_DEV, XTIMER_CHAN, (uint32_t)when & LLTIMER_MAX);
+    }
+    else if (!_period_end) {
+        _period_end = 1;
+        _period_end_ref = (uint32_t)now & LLTIMER_MAX;
+        _next_armed = _period() | LLTIMER_MAX;
+        timer_set_absolute(XTIMER_DEV, XTIMER_CHAN, LLTIMER_MAX);
+    }
+}
+
+/**
+ * @brief handle low-level timer overflow, advance to next short timer period
+ */
+static void _next_period(void)
+{
+#if XTIMER_MASK
+    /* advance <32bit mask register */
+    _xtimer_high_cnt += ~XTIMER_MASK + 1;
+    if (_xtimer_high_cnt == 0) {
+        /* high_cnt overflowed, so advance >32bit counter */
+        _long_cnt++;
+    }
+#else
+    /* advance >32bit counter */
+    _long_cnt++;
+#endif
+}
+
+/**
+ * @brief current time from within the callback, keeps track of overflows
+ */
+static uint64_t _isr_now(void)
+{
+    uint32_t now = _xtimer_lltimer_now();
+
+    if (now < _reference) {
+        DEBUG("_isr_now(): overflowed while in the callback\n");
+        _next_period();
+    }
+    _reference = now;
+
+    return _period() | now;
+}
+
+/**
+ * @brief main xtimer callback function
+ */
+static void _timer_callback(void)
+{
+    uint32_t next_target;
+    unsigned fired = 0;
+
+    _in_handler = 1;
+
+    if (_period_end) {
+        DEBUG("_timer_callback(): tick\n");
+        _period_end = 0;
+        _next_period();
+
+        /* make sure the timer counter also arrived
+         * in the next timer period */
+        while (_xtimer_lltimer_now() == LLTIMER_MAX) {}
+        _reference = 0;
+    }
+    else {
+        _reference = _xtimer_lltimer_now();
+    }
+
+    while (1) {
+        uint64_t now = _isr_now();
+
+        _cascade(now + XTIMER_ISR_BACKOFF);
+
+        /* fire timers that are close to expiring */
+        if (_due_list_head && (_target64(_due_list_head) < now + XTIMER_ISR_BACKOFF)) {
+            xtimer_t *timer = _due_list_head;
+
+            /* make sure we don't fire too early */
+            while (_isr_now() < _target64(timer)) {}
+
+            _unlink(timer);
+
+            /* make sure timer is recognized as being already fired */
+            timer->target = 0;
+            timer->long_target = 0;
+
+            _shoot(timer);
+            fired++;
+            continue;
+        }
+
+        uint64_t next = _next_event();
+
+        now = _isr_now();
+        if ((next & ~(uint64_t)LLTIMER_MAX) == _period()) {
+            /* schedule callback on next event in this period */
+            next_target = ((uint32_t)next & LLTIMER_MAX) - XTIMER_OVERHEAD;
+
+            /* make sure we're not setting a time in the past */
+            if (next_target < (((uint32_t)now & LLTIMER_MAX) + XTIMER_ISR_BACKOFF)) {
+                continue;
+            }
+
+            _next_armed = next - XTIMER_OVERHEAD;
+            break;
+        }
+
+        /* nothing due in this period, schedule callback on next overflow */
+        uint32_t now32 = (uint32_t)now & LLTIMER_MAX;
+        if (_xtimer_lltimer_mask(now32 + XTIMER_ISR_BACKOFF) < now32) {
+            /* spin until next period, then advance */
+            while (_xtimer_lltimer_now() >= now32) {}
+            _next_period();
+            _reference = 0;
+            continue;
+        }
+
+        next_target = LLTIMER_MAX;
+        _next_armed = _period() | LLTIMER_MAX;
+        _period_end = 1;
+        _period_end_ref = now32;
+        break;
+    }
+
+    if (fired) {
+        _wakeup_stats.wakeups++;
+        _wakeup_stats.wakeups_saved += fired - 1;
+    }
+
+    _in_handler = 0;
+
+    /* set low level timer */
+    DEBUG("_timer_callback(): setting %" PRIu32 "\n", next_target);
+    timer_set_absolute(XTIMER_DEV, XTIMER_CHAN, next_target);
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       evtimer add/remove benchmark
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "evtimer.h"
+#include "xtimer.h"
+
+#ifndef BENCH_EVENTS_MAX
+#define BENCH_EVENTS_MAX    (1000U)
+#endif
+
+#define BENCH_RESCHED       (1000U)
+#define OFFSET_MIN_MS       (60LU * 60LU * MS_PER_SEC)
+
+static evtimer_t evtimer;
+static evtimer_event_t events[BENCH_EVENTS_MAX];
+static uint32_t seed = 1;
+
+/* the same sequence for both backends */
+static uint32_t _rand(void)
+{
+    seed = seed * 1103515245 + 12345;
+    return seed >> 8;
+}
+
+static void _callback(evtimer_event_t *event)
+{
+    (void)event;
+    puts("unexpected event");
+}
+
+static uint32_t _ns_per_op(uint32_t start, unsigned ops)
+{
+    return ((xtimer_now_usec() - start) * 1000LU) / ops;
+}
+
+static void _bench(unsigned count)
+{
+    uint32_t start;
+    uint32_t add, resched, del;
+
+    start = xtimer_now_usec();
+    for (unsigned i = 0; i < count; i++) {
+        events[i].offset = OFFSET_MIN_MS + (_rand() % OFFSET_MIN_MS);
+        evtimer_add(&evtimer, &events[i]);
+    }
+    add = _ns_per_op(start, count);
+
+    start = xtimer_now_usec();
+    for (unsigned i = 0; i < BENCH_RESCHED; i++) {
+        evtimer_event_t *event = &events[_rand() % count];
+        evtimer_del(&evtimer, event);
+        event->offset = OFFSET_MIN_MS + (_rand() % OFFSET_MIN_MS);
+        evtimer_add(&evtimer, event);
+    }
+    resched = _ns_per_op(start, BENCH_RESCHED);
+
+    start = xtimer_now_usec();
+    for (unsigned i = 0; i < count; i++) {
+        evtimer_del(&evtimer, &events[i]);
+    }
+    del = _ns_per_op(start, count);
+
+    printf("{ \"events\" : %u, \"add_ns\" : %" PRIu32 ", \"resched_ns\" : %"
+           PRIu32 ", \"del_ns\" : %" PRIu32 " }\n", count, add, resched, del);
+}
+
+int main(void)
+{
+#ifdef MODULE_EVTIMER_HEAP
+    puts("evtimer benchmark: pairing heap");
+#else
+    puts("evtimer benchmark: sorted list");
+#endif
+
+    evtimer_init(&evtimer, _callback);
+
+    for (unsigned count = 10; count <= BENCH_EVENTS_MAX; count *= 10) {
+        _bench(count);
+    }
+    puts("done");
+
+    return 0;
+}
@@ -0,0 +1,24 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+#
+# This file is subject to the terms and conditions of the GNU Lesser
+# General Public License v2.1. See the file LICENSE in the top level
+# directory for more details.
+
+import os
+import sys
+
+
+def testfunc(child):
+    child.expect(r"evtimer benchmark: (sorted list|pairing heap)")
+    for count in (10, 100, 1000):
+        child.expect(r"{ \"events\" : %d, \"add_ns\" : \d+, "
+                     r"\"resched_ns\" : \d+, \"del_ns\" : \d+ }" % count)
+    child.expect_exact("done")
+
+
+if __name__ == "__main__":
+    sys.path.append(os.path.join(os.environ['RIOTTOOLS'], 'testrunner'))
+    from testrunner import run
+    sys.exit(run(testfunc))
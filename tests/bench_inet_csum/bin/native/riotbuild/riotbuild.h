@@ -0,0 +1,27 @@
+/* DO NOT edit this file, your changes will be overwritten and won't take any effect! */
+/* Generated from CFLAGS: -DDEVELHELP -Werror -Wno-implicit-fallthrough -Wall -Wextra -pedantic -std=gnu99 -m32 -fstack-protector-all -ffunction-sections -fdata-sections -DDEBUG_ASSERT_VERBOSE -DBOARD_NATIVE="native" -DRIOT_BOARD=BOARD_NATIVE -DCPU_NATIVE="native" -DRIOT_CPU=CPU_NATIVE -DMCU_NATIVE="native" -DRIOT_MCU=MCU_NATIVE -fno-delete-null-pointer-checks -fdiagnostics-color -Wstrict-prototypes -Wold-style-definition -Werror=strict-prototypes -Werror=old-style-definition -fno-common -Wall -Wextra -Wmissing-include-dirs -DMODULE_AUTO_INIT -DMODULE_BOARD -DMODULE_CORE -DMODULE_CORE_MSG -DMODULE_CPU -DMODULE_DIV -DMODULE_INET_CSUM -DMODULE_NATIVE_DRIVERS -DMODULE_PERIPH -DMODULE_PERIPH_COMMON -DMODULE_PERIPH_GPIO -DMODULE_PERIPH_PM -DMODULE_PERIPH_TIMER -DMODULE_PERIPH_UART -DMODULE_SYS -DMODULE_XTIMER -DRIOT_VERSION="2018.07" */
+#define DEVELHELP 1
+#define DEBUG_ASSERT_VERBOSE 1
+#define BOARD_NATIVE "native"
+#define RIOT_BOARD BOARD_NATIVE
+#define CPU_NATIVE "native"
+#define RIOT_CPU CPU_NATIVE
+#define MCU_NATIVE "native"
+#define RIOT_MCU MCU_NATIVE
+#define MODULE_AUTO_INIT 1
+#define MODULE_BOARD 1
+#define MODULE_CORE 1
+#define MODULE_CORE_MSG 1
+#define MODULE_CPU 1
+#define MODULE_DIV 1
+#define MODULE_INET_CSUM 1
+#define MODULE_NATIVE_DRIVERS 1
+#define MODULE_PERIPH 1
+#define MODULE_PERIPH_COMMON 1
+#define MODULE_PERIPH_GPIO 1
+#define MODULE_PERIPH_PM 1
+#define MODULE_PERIPH_TIMER 1
+#define MODULE_PERIPH_UART 1
+#define MODULE_SYS 1
+#define MODULE_XTIMER 1
+#define RIOT_VERSION "2018.07"
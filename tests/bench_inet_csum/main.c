@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       inet_csum throughput benchmark
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+
+#include "board.h"
+#include "periph_conf.h"
+#include "net/inet_csum.h"
+#include "xtimer.h"
+
+#ifndef BENCH_BYTES
+#define BENCH_BYTES         (256U * 1024U)
+#endif
+
+#define BUF_SIZE            (1500U)
+
+static const uint16_t sizes[] = { 64, 128, 256, 512, 1024, 1500 };
+
+/* one extra word to checksum the buffer at an odd address */
+static uint32_t buf[(BUF_SIZE / sizeof(uint32_t)) + 1];
+
+static volatile uint16_t result;
+
+/* the previous implementation, byte pair by byte pair */
+static uint16_t _csum_ref(uint16_t sum, const uint8_t *buf, uint16_t len,
+                          size_t accum_len)
+{
+    uint32_t csum = sum;
+
+    if (len == 0) {
+        return csum;
+    }
+    if (accum_len & 1) {
+        csum += *buf;
+        buf++;
+        len--;
+        accum_len++;
+    }
+    for (unsigned i = 0; i < (len >> 1); buf += 2, i++) {
+        csum += (uint16_t)(*buf << 8) + *(buf + 1);
+    }
+    if ((accum_len + len) & 1) {
+        csum += (uint16_t)(*buf << 8);
+    }
+    while (csum >> 16) {
+        uint16_t carry = csum >> 16;
+        csum = (csum & 0xffff) + carry;
+    }
+    return csum;
+}
+
+static uint32_t _run(uint16_t (*csum)(uint16_t, const uint8_t *, uint16_t,
+                                      size_t), uint16_t size)
+{
+    unsigned rounds = BENCH_BYTES / (2 * size);
+    uint32_t start = xtimer_now_usec();
+
+    for (unsigned i = 0; i < rounds; i++) {
+        result = csum(0, (uint8_t *)buf, size, 0);
+        result = csum(0, ((uint8_t *)buf) + 1, size, 0);
+    }
+
+    uint32_t elapsed = xtimer_now_usec() - start;
+
+    if (elapsed == 0) {
+        elapsed = 1;
+    }
+#ifdef CLOCK_CORECLOCK
+    return ((uint64_t)rounds * 2 * size * 1000U * US_PER_SEC) /
+           ((uint64_t)elapsed * CLOCK_CORECLOCK);
+#else
+    return ((uint64_t)rounds * 2 * size) / elapsed;
+#endif
+}
+
+int main(void)
+{
+#ifdef CLOCK_CORECLOCK
+    puts("inet_csum benchmark, bytes per kcycle");
+#else
+    puts("inet_csum benchmark, bytes per us");
+#endif
+
+    for (unsigned i = 0; i < (sizeof(buf) / sizeof(buf[0])); i++) {
+        buf[i] = rand();
+    }
+
+    for (unsigned i = 0; i < (sizeof(sizes) / sizeof(sizes[0])); i++) {
+        uint16_t size = sizes[i];
+
+        for (unsigned offset = 0; offset < 2; offset++) {
+            const uint8_t *data = ((uint8_t *)buf) + offset;
+
+            for (unsigned accum_len = 0; accum_len < 2; accum_len++) {
+                if (inet_csum_slice(0x1234, data, size, accum_len) !=
+                    _csum_ref(0x1234, data, size, accum_len)) {
+                    printf("mismatch at size %u\n", (unsigned)size);
+                    return 1;
+                }
+            }
+        }
+        printf("{ \"size\" : %u, \"ref\" : %" PRIu32 ", \"new\" : %" PRIu32
+               " }\n", (unsigned)size, _run(_csum_ref, size),
+               _run(inet_csum_slice, size));
+    }
+
+    puts("done");
+
+    return 0;
+}
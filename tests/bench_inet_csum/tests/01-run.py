@@ -0,0 +1,23 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+#
+# This file is subject to the terms and conditions of the GNU Lesser
+# General Public License v2.1. See the file LICENSE in the top level
+# directory for more details.
+
+import os
+import sys
+
+
+def testfunc(child):
+    child.expect(r"inet_csum benchmark, bytes per (kcycle|us)")
+    for size in (64, 128, 256, 512, 1024, 1500):
+        child.expect(r"{ \"size\" : %d, \"ref\" : \d+, \"new\" : \d+ }" % size)
+    child.expect_exact("done")
+
+
+if __name__ == "__main__":
+    sys.path.append(os.path.join(os.environ['RIOTTOOLS'], 'testrunner'))
+    from testrunner import run
+    sys.exit(run(testfunc, timeout=60))
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Measure LoRaLAN gateway device list lookup cost
+ *
+ * @author      Oleg Artamonov
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "random.h"
+#include "xtimer.h"
+
+#include "ls-gate-device-list.h"
+
+#ifndef TEST_LOOKUPS
+#define TEST_LOOKUPS    (20000U)
+#endif
+
+static ls_gate_devices_t devlist;
+static uint64_t node_ids[LS_GATE_MAX_NODES];
+
+static const unsigned test_sizes[] = { 100, 1000, 10000 };
+
+/* Reference lookup, walks the whole list like the gateway used to */
+static ls_gate_node_t *scan_by_nodeid(ls_gate_devices_t *devs, uint64_t nodeid)
+{
+    for (uint32_t i = 0; i < LS_GATE_MAX_NODES; i++) {
+        if (devs->nodes_free_list[i]) {
+            continue;
+        }
+
+        if (devs->nodes[i].node_id == nodeid) {
+            return &devs->nodes[i];
+        }
+    }
+
+    return NULL;
+}
+
+static uint32_t per_lookup_ns(uint32_t start)
+{
+    return (uint64_t)(xtimer_now_usec() - start) * 1000 / TEST_LOOKUPS;
+}
+
+static int run(unsigned num_nodes)
+{
+    ls_devlist_init(&devlist);
+
+    for (unsigned i = 0; i < num_nodes; i++) {
+        /* Make sure IDs are unique, but spread them over the whole EUI-64 range */
+        node_ids[i] = ((uint64_t)random_uint32() << 32) | i;
+        uint32_t nonce = random_uint32() | 1;
+
+        if (ls_devlist_add(&devlist, node_ids[i], 0, nonce, NULL) == NULL) {
+            printf("error: unable to add node %u\n", i);
+            return -1;
+        }
+
+        /* Fill nonce history, so replay check works on full lists */
+        for (unsigned k = 1; k < LS_GATE_NONCES_PER_DEVICE; k++) {
+            add_nonce(&devlist, node_ids[i], random_uint32() | 1);
+        }
+    }
+
+    uint32_t found = 0;
+    uint32_t start = xtimer_now_usec();
+    for (unsigned i = 0; i < TEST_LOOKUPS; i++) {
+        found += (scan_by_nodeid(&devlist, node_ids[i % num_nodes]) != NULL);
+    }
+    uint32_t scan_ns = per_lookup_ns(start);
+
+    start = xtimer_now_usec();
+    for (unsigned i = 0; i < TEST_LOOKUPS; i++) {
+        found += (ls_devlist_get_by_nodeid(&devlist, node_ids[i % num_nodes]) != NULL);
+    }
+    uint32_t index_ns = per_lookup_ns(start);
+
+    start = xtimer_now_usec();
+    for (unsigned i = 0; i < TEST_LOOKUPS; i++) {
+        /* Fresh nonces are the common case on join */
+        found += ls_devlist_check_nonce(&devlist, node_ids[i % num_nodes], random_uint32() | 1);
+    }
+    uint32_t nonce_ns = per_lookup_ns(start);
+
+    if (found < 2 * TEST_LOOKUPS) {
+        puts("error: lookup failed");
+        return -1;
+    }
+
+    printf("{ \"nodes\" : %u, \"scan_ns\" : %" PRIu32 ", \"index_ns\" : %" PRIu32
+           ", \"nonce_ns\" : %" PRIu32 " }\n", num_nodes, scan_ns, index_ns, nonce_ns);
+
+    return 0;
+}
+
+int main(void)
+{
+    puts("LoRaLAN gateway device list benchmark");
+
+    for (unsigned i = 0; i < sizeof(test_sizes) / sizeof(test_sizes[0]); i++) {
+        if (test_sizes[i] > LS_GATE_MAX_NODES) {
+            break;
+        }
+
+        if (run(test_sizes[i]) < 0) {
+            puts("[FAILURE]");
+            return 1;
+        }
+    }
+
+    puts("[SUCCESS]");
+
+    return 0;
+}
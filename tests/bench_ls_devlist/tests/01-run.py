@@ -0,0 +1,24 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+#
+# This file is subject to the terms and conditions of the GNU Lesser
+# General Public License v2.1. See the file LICENSE in the top level
+# directory for more details.
+
+import os
+import sys
+
+
+def testfunc(child):
+    for nodes in (100, 1000, 10000):
+        child.expect(r"{ \"nodes\" : %d, \"scan_ns\" : \d+, "
+                     r"\"index_ns\" : \d+, \"nonce_ns\" : \d+ }"
+                     % nodes)
+    child.expect_exact("[SUCCESS]")
+
+
+if __name__ == "__main__":
+    sys.path.append(os.path.join(os.environ['RIOTTOOLS'], 'testrunner'))
+    from testrunner import run
+    sys.exit(run(testfunc))
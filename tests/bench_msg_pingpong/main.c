@@ -28,8 +28,14 @@
 #define TEST_DURATION       (1000000U)
 #endif
 
+#ifndef TEST_BATCH_MAX
+#define TEST_BATCH_MAX      (16U)
+#endif
+
 volatile unsigned _flag = 0;
 static char _stack[THREAD_STACKSIZE_MAIN];
+static char _batch_stack[THREAD_STACKSIZE_MAIN];
+static msg_t _queue[TEST_BATCH_MAX];
 
 static void _timer_callback(void*arg)
 {
@@ -50,6 +56,20 @@ static void *_second_thread(void *arg)
     return NULL;
 }
 
+static void *_batch_thread(void *arg)
+{
+    (void)arg;
+    msg_t test[TEST_BATCH_MAX];
+
+    msg_init_queue(_queue, TEST_BATCH_MAX);
+
+    while(1) {
+        msg_receive_many(test, TEST_BATCH_MAX);
+    }
+
+    return NULL;
+}
+
 int main(void)
 {
     printf("main starting\n");
@@ -61,21 +81,43 @@ int main(void)
                                        _second_thread,
                                        NULL,
                                        "second_thread");
+    kernel_pid_t batch_other = thread_create(_batch_stack,
+                                             sizeof(_batch_stack),
+                                             (THREAD_PRIORITY_MAIN - 1),
+                                             THREAD_CREATE_STACKTEST,
+                                             _batch_thread,
+                                             NULL,
+                                             "batch_thread");
 
     xtimer_t timer;
     timer.callback = _timer_callback;
 
-    msg_t test;
+    msg_t test[TEST_BATCH_MAX];
 
     uint32_t n = 0;
 
     xtimer_set(&timer, TEST_DURATION);
     while(!_flag) {
-        msg_send(&test, other);
+        msg_send(&test[0], other);
         n++;
     }
 
     printf("{ \"result\" : %"PRIu32" }\n", n);
 
+    /* Same with batches sent by msg_try_send_many() to another receiver with
+     * a queue, every batch costs a single wakeup of the receiver which drains
+     * it with msg_receive_many() */
+    for (unsigned batch = 1; batch <= TEST_BATCH_MAX; batch <<= 1) {
+        n = 0;
+        _flag = 0;
+
+        xtimer_set(&timer, TEST_DURATION);
+        while(!_flag) {
+            n += msg_try_send_many(test, batch, batch_other);
+        }
+
+        printf("{ \"batch\" : %u, \"result\" : %"PRIu32" }\n", batch, n);
+    }
+
     return 0;
 }
@@ -13,6 +13,8 @@ import sys
 
 def testfunc(child):
     child.expect(r"{ \"result\" : \d+ }")
+    for batch in (1, 2, 4, 8, 16):
+        child.expect(r"{ \"batch\" : %d, \"result\" : \d+ }" % batch)
 
 
 if __name__ == "__main__":
@@ -0,0 +1,201 @@
+/*
+ * Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       NIB neighbor, route and next hop lookup benchmark
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "net/ethernet.h"
+#include "net/gnrc/ipv6/nib.h"
+#include "net/gnrc/ipv6/nib/conf.h"
+#include "net/gnrc/ipv6/nib/ft.h"
+#include "net/gnrc/ipv6/nib/nc.h"
+#include "net/gnrc/netif/ethernet.h"
+#include "net/netdev_test.h"
+#include "xtimer.h"
+
+#ifndef BENCH_LOOKUPS
+#define BENCH_LOOKUPS       (20000U)
+#endif
+
+#define NEXT_HOPS           (4U)
+#define NEIGHBORS           (GNRC_IPV6_NIB_NUMOF - NEXT_HOPS)
+#define ROUTES              (GNRC_IPV6_NIB_OFFL_NUMOF)
+
+static netdev_test_t _netdev;
+static char _netif_stack[THREAD_STACKSIZE_DEFAULT];
+
+static int _get_device_type(netdev_t *dev, void *value, size_t max_len)
+{
+    (void)dev;
+    (void)max_len;
+    *((uint16_t *)value) = NETDEV_TYPE_ETHERNET;
+    return sizeof(uint16_t);
+}
+
+static int _get_max_packet_size(netdev_t *dev, void *value, size_t max_len)
+{
+    (void)dev;
+    (void)max_len;
+    *((uint16_t *)value) = ETHERNET_DATA_LEN;
+    return sizeof(uint16_t);
+}
+
+static int _get_address(netdev_t *dev, void *value, size_t max_len)
+{
+    static const uint8_t addr[] = { 0xce, 0xab, 0xfe, 0xad, 0xf7, 0x26 };
+
+    (void)dev;
+    (void)max_len;
+    memcpy(value, addr, sizeof(addr));
+    return sizeof(addr);
+}
+
+/* the next hop lookup needs an interface to resolve to, nothing is sent over
+ * it since all neighbors are set manually */
+static gnrc_netif_t *_netif_init(void)
+{
+    netdev_test_setup(&_netdev, 0);
+    netdev_test_set_get_cb(&_netdev, NETOPT_DEVICE_TYPE, _get_device_type);
+    netdev_test_set_get_cb(&_netdev, NETOPT_MAX_PACKET_SIZE,
+                           _get_max_packet_size);
+    netdev_test_set_get_cb(&_netdev, NETOPT_ADDRESS, _get_address);
+    return gnrc_netif_ethernet_create(_netif_stack, sizeof(_netif_stack),
+                                      GNRC_NETIF_PRIO, "bench_eth",
+                                      &_netdev.netdev);
+}
+
+/* fe80::<n> */
+static void _neighbor(ipv6_addr_t *addr, unsigned n)
+{
+    ipv6_addr_set_link_local_prefix(addr);
+    addr->u16[6] = byteorder_htons(n >> 16);
+    addr->u16[7] = byteorder_htons(n);
+}
+
+/* 2001:db8::<n>/128 for three out of four routes, 2001:db8:<n>::/64 for the
+ * rest, and a destination covered by each */
+static unsigned _route(ipv6_addr_t *pfx, ipv6_addr_t *dst, unsigned n)
+{
+    ipv6_addr_set_unspecified(pfx);
+    pfx->u16[0] = byteorder_htons(0x2001);
+    pfx->u16[1] = byteorder_htons(0x0db8);
+    if ((n % 4) == 3) {
+        pfx->u16[2] = byteorder_htons(n);
+        *dst = *pfx;
+        dst->u16[7] = byteorder_htons(0x1234);
+        return 64;
+    }
+    pfx->u16[7] = byteorder_htons(n);
+    *dst = *pfx;
+    return 128;
+}
+
+static uint32_t _per_sec(uint32_t start)
+{
+    uint32_t elapsed = xtimer_now_usec() - start;
+
+    if (elapsed == 0) {
+        elapsed = 1;
+    }
+    return ((uint64_t)BENCH_LOOKUPS * US_PER_SEC) / elapsed;
+}
+
+int main(void)
+{
+    ipv6_addr_t addr, pfx;
+    gnrc_ipv6_nib_ft_t fte;
+    gnrc_ipv6_nib_nc_t nce;
+    gnrc_netif_t *netif;
+    uint32_t start, nc_per_sec, ft_per_sec, nh_per_sec;
+
+    printf("NIB lookup benchmark, index: %u\n", GNRC_IPV6_NIB_CONF_INDEX);
+
+    if ((netif = _netif_init()) == NULL) {
+        puts("no interface");
+        return 1;
+    }
+    /* next hops first, so they are neighbors as well */
+    for (unsigned i = 0; i < (NEXT_HOPS + NEIGHBORS); i++) {
+        _neighbor(&addr, i);
+        if (gnrc_ipv6_nib_nc_set(&addr, netif->pid, NULL, 0) != 0) {
+            printf("neighbor cache full at %u\n", i);
+            return 1;
+        }
+    }
+    for (unsigned i = 0; i < ROUTES; i++) {
+        ipv6_addr_t next_hop;
+        unsigned pfx_len = _route(&pfx, &addr, i);
+
+        _neighbor(&next_hop, i % NEXT_HOPS);
+        if (gnrc_ipv6_nib_ft_add(&pfx, pfx_len, &next_hop, netif->pid,
+                                 0) != 0) {
+            printf("forwarding table full at %u\n", i);
+            return 1;
+        }
+    }
+
+    start = xtimer_now_usec();
+    for (unsigned i = 0; i < BENCH_LOOKUPS; i++) {
+        _neighbor(&addr, NEXT_HOPS + (i % NEIGHBORS));
+        if (gnrc_ipv6_nib_nc_set(&addr, netif->pid, NULL, 0) != 0) {
+            puts("neighbor lost");
+            return 1;
+        }
+    }
+    nc_per_sec = _per_sec(start);
+
+    start = xtimer_now_usec();
+    for (unsigned i = 0; i < BENCH_LOOKUPS; i++) {
+        unsigned pfx_len = _route(&pfx, &addr, i % ROUTES);
+
+        if ((gnrc_ipv6_nib_ft_get(&addr, NULL, &fte) != 0) ||
+            (fte.dst_len != pfx_len)) {
+            puts("route lost");
+            return 1;
+        }
+    }
+    ft_per_sec = _per_sec(start);
+
+    /* as for every forwarded packet: the destination is neither a neighbor
+     * nor covered by an on-link prefix, so the route is looked up and its
+     * next hop resolved from the neighbor cache */
+    start = xtimer_now_usec();
+    for (unsigned i = 0; i < BENCH_LOOKUPS; i++) {
+        ipv6_addr_t next_hop;
+
+        _route(&pfx, &addr, i % ROUTES);
+        _neighbor(&next_hop, (i % ROUTES) % NEXT_HOPS);
+        if ((gnrc_ipv6_nib_get_next_hop_l2addr(&addr, netif, NULL,
+                                               &nce) != 0) ||
+            !ipv6_addr_equal(&nce.ipv6, &next_hop)) {
+            puts("next hop lost");
+            return 1;
+        }
+    }
+    nh_per_sec = _per_sec(start);
+
+    printf("{ \"neighbors\" : %u, \"routes\" : %u, \"nc_per_sec\" : %" PRIu32
+           ", \"ft_per_sec\" : %" PRIu32 ", \"nh_per_sec\" : %" PRIu32 " }\n",
+           (unsigned)NEIGHBORS, (unsigned)ROUTES, nc_per_sec, ft_per_sec,
+           nh_per_sec);
+
+    puts("done");
+
+    return 0;
+}
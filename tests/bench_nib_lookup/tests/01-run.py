@@ -0,0 +1,24 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+#
+# This file is subject to the terms and conditions of the GNU Lesser
+# General Public License v2.1. See the file LICENSE in the top level
+# directory for more details.
+
+import os
+import sys
+
+
+def testfunc(child):
+    child.expect(r"NIB lookup benchmark, index: [01]")
+    child.expect(r"{ \"neighbors\" : \d+, \"routes\" : \d+, "
+                 r"\"nc_per_sec\" : \d+, \"ft_per_sec\" : \d+, "
+                 r"\"nh_per_sec\" : \d+ }")
+    child.expect_exact("done")
+
+
+if __name__ == "__main__":
+    sys.path.append(os.path.join(os.environ['RIOTTOOLS'], 'testrunner'))
+    from testrunner import run
+    sys.exit(run(testfunc, timeout=120))
@@ -0,0 +1,203 @@
+/*
+ * Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       gnrc_pktbuf allocation trace benchmark
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "net/gnrc/pktbuf.h"
+#include "xtimer.h"
+
+#ifndef BENCH_STEPS
+#define BENCH_STEPS         (20000U)
+#endif
+
+#define TX_QUEUE_LEN        (4U)
+#define RX_QUEUE_LEN        (2U)
+#define REASS_NUMOF         (2U)
+#define PROBE_INTERVAL      (16U)
+#define PROBE_SIZE          (1280U)
+
+#define NETIF_HDR_SIZE      (16U)
+#define IPV6_HDR_SIZE       (40U)
+#define UDP_HDR_SIZE        (8U)
+
+typedef struct {
+    gnrc_pktsnip_t *pkt;
+    size_t len;
+    unsigned expires;
+} held_t;
+
+static held_t tx_queue[TX_QUEUE_LEN];
+static held_t rx_queue[RX_QUEUE_LEN];
+static held_t reass[REASS_NUMOF];
+
+static uint32_t seed = 1;
+static uint32_t ops, failed, probe_failed, min_held;
+static size_t held;
+
+/* the same trace for every implementation */
+static uint32_t _rand(uint32_t min, uint32_t max)
+{
+    seed = seed * 1103515245 + 12345;
+    return min + ((seed >> 8) % (max - min + 1));
+}
+
+static gnrc_pktsnip_t *_add(gnrc_pktsnip_t *next, size_t size)
+{
+    gnrc_pktsnip_t *pkt = gnrc_pktbuf_add(next, NULL, size, GNRC_NETTYPE_UNDEF);
+
+    ops++;
+    if (pkt == NULL) {
+        failed++;
+        if (next != NULL) {
+            gnrc_pktbuf_release(next);
+            ops++;
+        }
+    }
+    return pkt;
+}
+
+static void _drop(held_t *slot)
+{
+    if (slot->pkt != NULL) {
+        gnrc_pktbuf_release(slot->pkt);
+        ops++;
+        held -= slot->len;
+        slot->pkt = NULL;
+    }
+}
+
+static void _hold(held_t *slot, gnrc_pktsnip_t *pkt, unsigned expires)
+{
+    _drop(slot);
+    slot->pkt = pkt;
+    slot->len = gnrc_pkt_len(pkt);
+    slot->expires = expires;
+    held += slot->len;
+}
+
+static void _send_udp(unsigned step)
+{
+    gnrc_pktsnip_t *pkt = _add(NULL, _rand(8, 100));
+
+    if ((pkt == NULL) || ((pkt = _add(pkt, UDP_HDR_SIZE)) == NULL) ||
+        ((pkt = _add(pkt, IPV6_HDR_SIZE)) == NULL) ||
+        ((pkt = _add(pkt, NETIF_HDR_SIZE)) == NULL)) {
+        return;
+    }
+    _hold(&tx_queue[step % TX_QUEUE_LEN], pkt, 0);
+}
+
+static void _receive_frame(unsigned step)
+{
+    gnrc_pktsnip_t *pkt = _add(NULL, _rand(40, 127));
+    gnrc_pktsnip_t *hdr;
+
+    if (pkt == NULL) {
+        return;
+    }
+    if ((hdr = _add(NULL, NETIF_HDR_SIZE)) == NULL) {
+        gnrc_pktbuf_release(pkt);
+        ops++;
+        return;
+    }
+    /* the interface header goes to the end, as in gnrc_netif, then the
+     * dispatch and the UDP header are marked */
+    LL_APPEND(pkt, hdr);
+    ops += 2;
+    if ((gnrc_pktbuf_mark(pkt, _rand(2, 6), GNRC_NETTYPE_UNDEF) == NULL) ||
+        (gnrc_pktbuf_mark(pkt, UDP_HDR_SIZE, GNRC_NETTYPE_UNDEF) == NULL)) {
+        failed++;
+    }
+    _hold(&rx_queue[step % RX_QUEUE_LEN], pkt, 0);
+}
+
+static void _reassemble(unsigned step)
+{
+    for (unsigned i = 0; i < REASS_NUMOF; i++) {
+        if (reass[i].pkt == NULL) {
+            gnrc_pktsnip_t *pkt = _add(NULL, _rand(200, 1280));
+            if (pkt != NULL) {
+                _hold(&reass[i], pkt, step + _rand(50, 400));
+            }
+            return;
+        }
+    }
+}
+
+static void _probe(void)
+{
+    gnrc_pktsnip_t *pkt = gnrc_pktbuf_add(NULL, NULL, PROBE_SIZE,
+                                          GNRC_NETTYPE_UNDEF);
+
+    if (pkt == NULL) {
+        probe_failed++;
+        if ((min_held == 0) || (held < min_held)) {
+            min_held = held;
+        }
+    }
+    else {
+        gnrc_pktbuf_release(pkt);
+    }
+}
+
+int main(void)
+{
+#if defined(MODULE_GNRC_PKTBUF_SLAB)
+    puts("pktbuf benchmark: slab");
+#elif defined(MODULE_GNRC_PKTBUF_MALLOC)
+    puts("pktbuf benchmark: malloc");
+#else
+    puts("pktbuf benchmark: static");
+#endif
+
+    uint32_t start = xtimer_now_usec();
+
+    for (unsigned step = 0; step < BENCH_STEPS; step++) {
+        uint32_t kind = _rand(0, 99);
+
+        if (kind < 45) {
+            _send_udp(step);
+        }
+        else if (kind < 90) {
+            _receive_frame(step);
+        }
+        else if (kind < 95) {
+            _reassemble(step);
+        }
+        for (unsigned i = 0; i < REASS_NUMOF; i++) {
+            if ((reass[i].pkt != NULL) && (reass[i].expires == step)) {
+                _drop(&reass[i]);
+            }
+        }
+        if ((step % PROBE_INTERVAL) == 0) {
+            _probe();
+        }
+    }
+
+    uint32_t elapsed = xtimer_now_usec() - start;
+
+    printf("{ \"ops_per_sec\" : %" PRIu32 ", \"failed\" : %" PRIu32
+           ", \"probe_failed\" : %" PRIu32 ", \"min_held_at_probe_fail\" : %"
+           PRIu32 " }\n", (uint32_t)(((uint64_t)ops * US_PER_SEC) / elapsed),
+           failed, probe_failed, min_held);
+
+    puts("done");
+
+    return 0;
+}
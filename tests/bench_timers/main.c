@@ -43,6 +43,9 @@
 #include "print_results.h"
 #include "spin_random.h"
 #include "bench_timers_config.h"
+#if TEST_XTIMER_LOAD
+#include "xtimer_load.h"
+#endif
 
 #ifndef TEST_TRACE
 #define TEST_TRACE 0
@@ -737,6 +740,9 @@ int main(void)
     print_u32_dec(spin_max);
     print("\n", 1);
     estimate_cpu_overhead();
+#if TEST_XTIMER_LOAD
+    xtimer_load_test();
+#endif
 #ifdef MODULE_PERIPH_RTT
     rtt_begin = rtt_get_counter();
 #endif
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2018 Eistec AB
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       xtimer set/remove cost versus the number of armed timers
+ *
+ * Timers are armed at random offsets, as with many independent timeouts
+ * pending, so list based implementations have to walk about half of them on
+ * every insertion.
+ *
+ * @}
+ */
+
+#include <stdint.h>
+
+#include "fmt.h"
+#include "matstat.h"
+#include "random.h"
+#include "xtimer.h"
+#include "periph/timer.h"
+
+#include "bench_timers_config.h"
+#include "xtimer_load.h"
+
+static xtimer_t background[TEST_XTIMER_LOAD_MAX];
+
+static void nop(void *arg)
+{
+    (void)arg;
+}
+
+static uint32_t random_offset(void)
+{
+    return random_uint32_range(TEST_XTIMER_LOAD_OFFSET_MIN, TEST_XTIMER_LOAD_OFFSET_MAX);
+}
+
+static void print_stats(const matstat_state_t *state)
+{
+    print_str(" ");
+    print_s32_dec(matstat_mean(state));
+    print_str(" ");
+    print_s32_dec(state->min);
+    print_str(" ");
+    print_s32_dec(state->max);
+}
+
+static void measure(unsigned armed)
+{
+    matstat_state_t set_state = MATSTAT_STATE_INIT;
+    matstat_state_t remove_state = MATSTAT_STATE_INIT;
+    xtimer_t probe = {
+        .target = 0,
+        .long_target = 0,
+        .callback = nop,
+        .arg = NULL,
+    };
+
+    for (unsigned k = 0; k < TEST_XTIMER_LOAD_ITERATIONS; ++k) {
+        uint32_t offset = random_offset();
+
+        unsigned int t0 = timer_read(TIM_REF_DEV);
+        _xtimer_set(&probe, offset);
+        unsigned int t1 = timer_read(TIM_REF_DEV);
+        xtimer_remove(&probe);
+        unsigned int t2 = timer_read(TIM_REF_DEV);
+
+        /* skip samples spanning a wrap of a narrow reference timer */
+        if ((t1 < t0) || (t2 < t1)) {
+            continue;
+        }
+        matstat_add(&set_state, t1 - t0);
+        matstat_add(&remove_state, t2 - t1);
+    }
+
+    print_u32_dec(armed);
+    print_stats(&set_state);
+    print_stats(&remove_state);
+    print("\n", 1);
+}
+
+void xtimer_load_test(void)
+{
+    unsigned armed = 0;
+
+    print_str("xtimer load test, costs in reference timer ticks\n");
+    print_str("armed set(mean min max) remove(mean min max)\n");
+
+    for (unsigned num = 0; num <= TEST_XTIMER_LOAD_MAX; num = (num ? num * 2 : 1)) {
+        while (armed < num) {
+            background[armed].callback = nop;
+            background[armed].arg = NULL;
+            background[armed].target = 0;
+            background[armed].long_target = 0;
+            _xtimer_set(&background[armed], random_offset());
+            ++armed;
+        }
+        measure(armed);
+    }
+
+    for (unsigned k = 0; k < armed; ++k) {
+        xtimer_remove(&background[k]);
+    }
+    print_str("xtimer load test done\n");
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2018 Eistec AB
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       xtimer set/remove cost versus the number of armed timers
+ *
+ * @}
+ */
+
+#ifndef XTIMER_LOAD_H
+#define XTIMER_LOAD_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Maximum number of background timers armed during the test
+ */
+#ifndef TEST_XTIMER_LOAD_MAX
+#define TEST_XTIMER_LOAD_MAX (128)
+#endif
+
+/**
+ * @brief   Number of set/remove pairs measured per number of armed timers
+ */
+#ifndef TEST_XTIMER_LOAD_ITERATIONS
+#define TEST_XTIMER_LOAD_ITERATIONS (256)
+#endif
+
+/**
+ * @brief   Range of the timer offsets used, in xtimer ticks
+ *
+ * Long enough for none of the timers to fire while the test is running.
+ */
+#ifndef TEST_XTIMER_LOAD_OFFSET_MIN
+#define TEST_XTIMER_LOAD_OFFSET_MIN (XTIMER_HZ)
+#endif
+#ifndef TEST_XTIMER_LOAD_OFFSET_MAX
+#define TEST_XTIMER_LOAD_OFFSET_MAX (XTIMER_HZ * 60)
+#endif
+
+/**
+ * @brief   Measure the cost of _xtimer_set and xtimer_remove with a growing
+ *          number of timers armed in the background
+ *
+ * Costs are printed in TIM_REF_DEV ticks. All background timers are removed
+ * before returning.
+ *
+ * @pre TIM_REF_DEV must be initialized and running, and the random module
+ * seeded.
+ */
+void xtimer_load_test(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* XTIMER_LOAD_H */
@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       prioritized event queue test application
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "thread.h"
+#include "event/prio.h"
+#include "xtimer.h"
+
+#define SLOW_US         (100U * US_PER_MS)
+#define POST_DELAY_US   (10U * US_PER_MS)
+
+typedef struct {
+    event_t super;
+    unsigned id;
+} test_event_t;
+
+static event_prio_queue_t queue = EVENT_PRIO_QUEUE_INIT;
+
+static char urgent_stack[THREAD_STACKSIZE_DEFAULT];
+static char general_stack[THREAD_STACKSIZE_DEFAULT];
+
+static unsigned order[EVENT_PRIO_LEVELS];
+static unsigned order_len;
+
+static uint32_t posted;
+static uint32_t latency;
+
+static void record(event_t *event)
+{
+    order[order_len++] = ((test_event_t *)event)->id;
+}
+
+static void slow(event_t *event)
+{
+    (void)event;
+    uint32_t start = xtimer_now_usec();
+    while ((xtimer_now_usec() - start) < SLOW_US) {}
+}
+
+static void urgent(event_t *event)
+{
+    (void)event;
+    latency = xtimer_now_usec() - posted;
+}
+
+static test_event_t events[EVENT_PRIO_LEVELS];
+static event_t slow_event = { .handler = slow };
+static event_t urgent_event = { .handler = urgent };
+
+static void *urgent_worker(void *arg)
+{
+    (void)arg;
+    event_prio_loop_max(&queue, 0);
+    return NULL;
+}
+
+static void *general_worker(void *arg)
+{
+    (void)arg;
+    event_prio_loop(&queue);
+    return NULL;
+}
+
+int main(void)
+{
+    puts("event_prio test application.");
+
+    /* both below main, the urgent one above the general one */
+    thread_create(urgent_stack, sizeof(urgent_stack), THREAD_PRIORITY_MAIN + 1,
+                  THREAD_CREATE_STACKTEST, urgent_worker, NULL, "urgent");
+    thread_create(general_stack, sizeof(general_stack), THREAD_PRIORITY_MAIN + 2,
+                  THREAD_CREATE_STACKTEST, general_worker, NULL, "general");
+    xtimer_usleep(POST_DELAY_US);
+
+    /* queued while the workers can't run, handled by priority */
+    static const unsigned prios[EVENT_PRIO_LEVELS] = { 3, 1, 2, 0 };
+    for (unsigned i = 0; i < EVENT_PRIO_LEVELS; i++) {
+        events[i].super.handler = record;
+        events[i].id = prios[i];
+        event_prio_post(&queue, &events[i].super, prios[i]);
+    }
+    xtimer_usleep(POST_DELAY_US);
+
+    printf("order:");
+    for (unsigned i = 0; i < order_len; i++) {
+        printf(" %u", order[i]);
+    }
+    puts("");
+
+    int ok = (order_len == EVENT_PRIO_LEVELS);
+    for (unsigned i = 0; ok && (i < order_len); i++) {
+        ok = (order[i] == i);
+    }
+
+    /* an urgent event is not held up by a slow one in progress */
+    event_prio_post(&queue, &slow_event, EVENT_PRIO_LEVELS - 1);
+    xtimer_usleep(POST_DELAY_US);
+    posted = xtimer_now_usec();
+    event_prio_post(&queue, &urgent_event, 0);
+    xtimer_usleep(SLOW_US);
+
+    printf("urgent latency: %" PRIu32 " us\n", latency);
+    ok = ok && (latency < SLOW_US / 2);
+
+    puts(ok ? "test successful." : "test failed.");
+
+    return 0;
+}
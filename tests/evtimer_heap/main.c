@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup tests
+ * @{
+ *
+ * @file
+ * @brief    evtimer_heap test application
+ *
+ * Runs the evtimer_msg and evtimer_underflow scenarios with the pairing heap
+ * backend, removing the root and an inner event of the heap in between.
+ *
+ * @}
+ */
+
+#include <stdio.h>
+
+#include "evtimer_msg.h"
+#include "thread.h"
+#include "msg.h"
+#include "xtimer.h"
+
+#define WORKER_MSG_QUEUE_SIZE   (8)
+
+msg_t worker_msg_queue[WORKER_MSG_QUEUE_SIZE];
+static char worker_stack[THREAD_STACKSIZE_MAIN];
+static evtimer_t evtimer;
+static evtimer_msg_event_t events[] = {
+    { .event = { .offset = 1000 }, .msg = { .content = { .ptr = "supposed to be 1000" } } },
+    { .event = { .offset = 1500 }, .msg = { .content = { .ptr = "supposed to be 1500" } } },
+    { .event = { .offset = 659 }, .msg = { .content = { .ptr = "supposed to be 659" } } },
+    { .event = { .offset = 3954 }, .msg = { .content = { .ptr = "supposed to be 3954" } } },
+};
+static evtimer_msg_event_t deleted[] = {
+    { .event = { .offset = 300 }, .msg = { .content = { .ptr = "deleted 300" } } },
+    { .event = { .offset = 2500 }, .msg = { .content = { .ptr = "deleted 2500" } } },
+};
+static evtimer_msg_event_t underflow[] = {
+    { .event = { .offset = 0 }, .msg = { .content = { .ptr = "1" } } },
+    { .event = { .offset = 0 }, .msg = { .content = { .ptr = "2" } } },
+    { .event = { .offset = 0 }, .msg = { .content = { .ptr = "3" } } },
+    { .event = { .offset = 0 }, .msg = { .content = { .ptr = "4" } } },
+    { .event = { .offset = 0 }, .msg = { .content = { .ptr = "5" } } },
+    { .event = { .offset = 0 }, .msg = { .content = { .ptr = "6" } } },
+    { .event = { .offset = 0 }, .msg = { .content = { .ptr = "7" } } },
+    { .event = { .offset = 0 }, .msg = { .content = { .ptr = "8" } } },
+};
+
+#define NEVENTS ((unsigned)(sizeof(events) / sizeof(evtimer_msg_event_t)))
+#define NDELETED ((unsigned)(sizeof(deleted) / sizeof(evtimer_msg_event_t)))
+#define NUNDERFLOW ((unsigned)(sizeof(underflow) / sizeof(evtimer_msg_event_t)))
+
+void *worker_thread(void *arg)
+{
+    int count = 0;
+    (void) arg;
+
+    msg_init_queue(worker_msg_queue, WORKER_MSG_QUEUE_SIZE);
+    while (1) {
+        char *ctx;
+        msg_t m;
+        uint32_t now;
+
+        msg_receive(&m);
+        now = xtimer_now_usec() / US_PER_MS;
+        ctx = m.content.ptr;
+        printf("At %6" PRIu32 " ms received msg %i: \"%s\"\n", now, count++, ctx);
+    }
+}
+
+int main(void)
+{
+    uint32_t now = xtimer_now_usec() / US_PER_MS;
+
+    evtimer_init_msg(&evtimer);
+
+    /* create worker thread */
+    kernel_pid_t pid = thread_create(worker_stack, sizeof(worker_stack),
+                                     THREAD_PRIORITY_MAIN - 1,
+                                     THREAD_CREATE_STACKTEST,
+                                     worker_thread, NULL, "worker");
+    printf("Testing evtimer_heap (start time = %" PRIu32 " ms)\n", now);
+    for (unsigned i = 0; i < NEVENTS; i++) {
+        evtimer_add_msg(&evtimer, &events[i], pid);
+    }
+    /* the first one becomes the root of the heap, the second one a child */
+    for (unsigned i = 0; i < NDELETED; i++) {
+        evtimer_add_msg(&evtimer, &deleted[i], pid);
+    }
+    for (unsigned i = 0; i < NDELETED; i++) {
+        evtimer_del(&evtimer, &deleted[i].event);
+    }
+    printf("Are the reception times of all %u msgs close to the supposed values?\n",
+           NEVENTS);
+
+    xtimer_sleep(5);
+
+    puts("Testing underflow");
+    while (1) {
+        for (unsigned i = 0; i < NUNDERFLOW; i++) {
+            evtimer_add_msg(&evtimer, &underflow[i], pid);
+        }
+    }
+}
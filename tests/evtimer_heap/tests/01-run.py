@@ -0,0 +1,46 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+#
+# This file is subject to the terms and conditions of the GNU Lesser
+# General Public License v2.1. See the file LICENSE in the top level
+# directory for more details.
+
+from __future__ import print_function
+import os
+import sys
+
+ACCEPTED_ERROR = 20
+SUPPOSED = [659, 1000, 1500, 3954]
+UNDERFLOW_ROUNDS = 100
+
+
+def testfunc(child):
+    child.expect(r"Testing evtimer_heap \(start time = (\d+) ms\)")
+    timer_offset = int(child.match.group(1))
+    child.expect(r"Are the reception times of all (\d+) msgs close to the supposed values?")
+    numof = int(child.match.group(1))
+    assert(numof == len(SUPPOSED))
+
+    # deleted events must not show up in between
+    for i in range(numof):
+        child.expect(r'At \s*(\d+) ms received msg %i: "supposed to be (\d+)"' % i)
+        assert(int(child.match.group(2)) == SUPPOSED[i])
+        exp = int(child.match.group(2)) + timer_offset
+        assert(int(child.match.group(1)) in range(exp - ACCEPTED_ERROR, exp + ACCEPTED_ERROR + 1))
+        print(".", end="", flush=True)
+    print("")
+
+    child.expect_exact("Testing underflow")
+    for i in range(UNDERFLOW_ROUNDS):
+        for j in range(8):
+            child.expect(r'received msg \d+: "%i"' % (j + 1))
+        print(".", end="", flush=True)
+    print("")
+    print("All tests successful")
+
+
+if __name__ == "__main__":
+    sys.path.append(os.path.join(os.environ['RIOTTOOLS'], 'testrunner'))
+    from testrunner import run
+    sys.exit(run(testfunc))
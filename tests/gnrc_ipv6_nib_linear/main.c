@@ -0,0 +1,34 @@
+/*
+ * Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup tests
+ * @{
+ *
+ * @file
+ * @brief    Runs the gnrc_ipv6_nib unit tests without the NIB index
+ *
+ * The unit tests application builds the NIB with @ref
+ * GNRC_IPV6_NIB_CONF_INDEX enabled, so the linear lookups get an application
+ * of their own.
+ *
+ * @}
+ */
+
+#include "embUnit.h"
+
+#include "tests-gnrc_ipv6_nib.h"
+
+int main(void)
+{
+    TESTS_START();
+    tests_gnrc_ipv6_nib();
+    TESTS_END();
+
+    return 0;
+}
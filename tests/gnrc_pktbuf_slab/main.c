@@ -0,0 +1,33 @@
+/*
+ * Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup tests
+ * @{
+ *
+ * @file
+ * @brief    Runs the gnrc_pktbuf unit tests with gnrc_pktbuf_slab
+ *
+ * The unit tests application links a single packet buffer implementation,
+ * gnrc_pktbuf_static, so the pools get an application of their own.
+ *
+ * @}
+ */
+
+#include "embUnit.h"
+
+#include "tests-pktbuf.h"
+
+int main(void)
+{
+    TESTS_START();
+    tests_pktbuf();
+    TESTS_END();
+
+    return 0;
+}
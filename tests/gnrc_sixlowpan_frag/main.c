@@ -0,0 +1,271 @@
+/*
+ * Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Tests sending of 6LoWPAN fragments
+ *
+ * A 1280 byte datagram spread over several snips is fragmented with the
+ * interface header pointing to the test thread, so the fragments are compared
+ * byte by byte against the datagram as they arrive.
+ *
+ * @}
+ */
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "embUnit.h"
+#include "msg.h"
+#include "net/gnrc/netapi.h"
+#include "net/gnrc/netif.h"
+#include "net/gnrc/netif/hdr.h"
+#include "net/gnrc/netif/ieee802154.h"
+#include "net/gnrc/pktbuf.h"
+#include "net/gnrc/sixlowpan/frag.h"
+#include "net/netdev_test.h"
+#include "net/sixlowpan.h"
+#include "thread.h"
+#include "xtimer.h"
+
+#define TEST_MAX_FRAG_SIZE  (102U)
+/* size of the uncompressed IPv6 datagram, without the 6LoWPAN dispatch */
+#define TEST_DATAGRAM_SIZE  (1280U)
+/* dispatch plus floor8(TEST_MAX_FRAG_SIZE - 4 - 1) bytes of the datagram */
+#define TEST_FRAG_1_SIZE    (97U)
+/* floor8(TEST_MAX_FRAG_SIZE - 5) */
+#define TEST_FRAG_N_SIZE    (96U)
+#define TEST_FRAG_NUMOF     (14U)
+#define TEST_QUEUE_SIZE     (8U)
+
+static char _netif_stack[THREAD_STACKSIZE_SMALL];
+static netdev_test_t _ieee802154_dev;
+static gnrc_netif_t *_netif;
+static msg_t _queue[TEST_QUEUE_SIZE];
+
+static const uint8_t _dst[] = { 0x02, 0x00, 0x00, 0xff,
+                                0xfe, 0x00, 0x00, 0x01 };
+static uint8_t _datagram[1 + TEST_DATAGRAM_SIZE];
+
+/* state of the datagram being received */
+static unsigned _frags;
+static size_t _pos;
+static uint16_t _tag;
+
+static int _get_netdev_device_type(netdev_t *netdev, void *value, size_t max_len)
+{
+    assert(max_len == sizeof(uint16_t));
+    (void)netdev;
+
+    *((uint16_t *)value) = NETDEV_TYPE_IEEE802154;
+    return sizeof(uint16_t);
+}
+
+static int _get_netdev_max_packet_size(netdev_t *netdev, void *value,
+                                       size_t max_len)
+{
+    assert(max_len == sizeof(uint16_t));
+    (void)netdev;
+
+    *((uint16_t *)value) = TEST_MAX_FRAG_SIZE;
+    return sizeof(uint16_t);
+}
+
+static int _get_netdev_src_len(netdev_t *netdev, void *value, size_t max_len)
+{
+    (void)netdev;
+    assert(max_len == sizeof(uint16_t));
+    *((uint16_t *)value) = sizeof(eui64_t);
+    return sizeof(uint16_t);
+}
+
+static void _set_up(void)
+{
+    gnrc_pktbuf_init();
+    /* remove messages */
+    while (msg_avail()) {
+        msg_t msg;
+        msg_receive(&msg);
+    }
+    _frags = 0;
+    _pos = 0;
+}
+
+/* uncompressed dispatch, IPv6 header and UDP header, an empty snip and the
+ * payload split unevenly, so fragments span and split snips */
+static gnrc_pktsnip_t *_build_datagram(gnrc_pktsnip_t **ipv6)
+{
+    static const size_t sizes[] = { 1 + 40, 8, 0, 500, 1, 731 };
+    gnrc_pktsnip_t *netif_hdr, *pkt = NULL;
+    size_t offset = sizeof(_datagram);
+
+    for (int i = (sizeof(sizes) / sizeof(sizes[0])) - 1; i >= 0; i--) {
+        offset -= sizes[i];
+        pkt = gnrc_pktbuf_add(pkt, (sizes[i] > 0) ? &_datagram[offset] : NULL,
+                              sizes[i], (i == 0) ? GNRC_NETTYPE_SIXLOWPAN
+                                                 : GNRC_NETTYPE_UNDEF);
+        if (pkt == NULL) {
+            return NULL;
+        }
+    }
+    netif_hdr = gnrc_netif_hdr_build(NULL, 0, (uint8_t *)_dst, sizeof(_dst));
+    if (netif_hdr == NULL) {
+        gnrc_pktbuf_release(pkt);
+        return NULL;
+    }
+    /* send the fragments to us instead of the interface */
+    ((gnrc_netif_hdr_t *)netif_hdr->data)->if_pid = thread_getpid();
+    netif_hdr->next = pkt;
+    *ipv6 = pkt;
+    return netif_hdr;
+}
+
+static void _check_fragment(gnrc_pktsnip_t *pkt)
+{
+    gnrc_pktsnip_t *frag = pkt->next;
+    size_t size = (_frags == 0) ? TEST_FRAG_1_SIZE : TEST_FRAG_N_SIZE;
+    uint8_t *hdr;
+
+    if (size > (sizeof(_datagram) - _pos)) {
+        size = sizeof(_datagram) - _pos;
+    }
+    TEST_ASSERT_EQUAL_INT(GNRC_NETTYPE_NETIF, pkt->type);
+    TEST_ASSERT_NOT_NULL(frag);
+    hdr = frag->data;
+    if (_frags == 0) {
+        TEST_ASSERT_EQUAL_INT(sizeof(sixlowpan_frag_t), frag->size);
+        TEST_ASSERT_EQUAL_INT(SIXLOWPAN_FRAG_1_DISP | (TEST_DATAGRAM_SIZE >> 8),
+                              hdr[0]);
+        _tag = (hdr[2] << 8) | hdr[3];
+    }
+    else {
+        TEST_ASSERT_EQUAL_INT(sizeof(sixlowpan_frag_n_t), frag->size);
+        TEST_ASSERT_EQUAL_INT(SIXLOWPAN_FRAG_N_DISP | (TEST_DATAGRAM_SIZE >> 8),
+                              hdr[0]);
+        TEST_ASSERT_EQUAL_INT(_tag, (hdr[2] << 8) | hdr[3]);
+        /* offset into the datagram, without the dispatch, in units of 8 */
+        TEST_ASSERT_EQUAL_INT((_pos - 1) / 8, hdr[4]);
+    }
+    TEST_ASSERT_EQUAL_INT(TEST_DATAGRAM_SIZE & 0xff, hdr[1]);
+    TEST_ASSERT_EQUAL_INT(size, gnrc_pkt_len(frag->next));
+    for (gnrc_pktsnip_t *snip = frag->next; snip != NULL; snip = snip->next) {
+        TEST_ASSERT_EQUAL_INT(0, memcmp(&_datagram[_pos], snip->data,
+                                        snip->size));
+        _pos += snip->size;
+    }
+    _frags++;
+    gnrc_pktbuf_release(pkt);
+}
+
+static void _fragment(bool shared)
+{
+    gnrc_sixlowpan_msg_frag_t *fragment_msg = gnrc_sixlowpan_msg_frag_get();
+    gnrc_pktsnip_t *pkt, *ipv6 = NULL;
+    msg_t msg;
+
+    TEST_ASSERT_NOT_NULL(fragment_msg);
+    TEST_ASSERT_NOT_NULL((pkt = _build_datagram(&ipv6)));
+    if (shared) {
+        /* someone else still holds the datagram, e.g. for retransmission */
+        gnrc_pktbuf_hold(ipv6, 1);
+    }
+    fragment_msg->pid = _netif->pid;
+    fragment_msg->pkt = pkt;
+    fragment_msg->datagram_size = TEST_DATAGRAM_SIZE;
+    fragment_msg->offset = 0;
+
+    gnrc_sixlowpan_frag_send(pkt, fragment_msg, 0);
+    while (msg_try_receive(&msg) > 0) {
+        switch (msg.type) {
+            case GNRC_SIXLOWPAN_MSG_FRAG_SND:
+                gnrc_sixlowpan_frag_send(NULL, msg.content.ptr, 0);
+                break;
+            case GNRC_NETAPI_MSG_TYPE_SND:
+                _check_fragment(msg.content.ptr);
+                break;
+            default:
+                TEST_FAIL("unexpected message");
+                break;
+        }
+    }
+    TEST_ASSERT_EQUAL_INT(TEST_FRAG_NUMOF, _frags);
+    TEST_ASSERT_EQUAL_INT(sizeof(_datagram), _pos);
+    TEST_ASSERT_NULL(fragment_msg->pkt);
+    if (shared) {
+        /* the holder's view of the datagram must be left untouched */
+        TEST_ASSERT_EQUAL_INT(sizeof(_datagram), gnrc_pkt_len(ipv6));
+        _pos = 0;
+        for (gnrc_pktsnip_t *snip = ipv6; snip != NULL; snip = snip->next) {
+            if (snip->size == 0) {
+                continue;
+            }
+            TEST_ASSERT_EQUAL_INT(0, memcmp(&_datagram[_pos], snip->data,
+                                            snip->size));
+            _pos += snip->size;
+        }
+        gnrc_pktbuf_release(ipv6);
+    }
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
+static void test_frag_send__exclusive(void)
+{
+    _fragment(false);
+}
+
+static void test_frag_send__shared(void)
+{
+    _fragment(true);
+}
+
+static Test *tests_gnrc_sixlowpan_frag(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_frag_send__exclusive),
+        new_TestFixture(test_frag_send__shared),
+    };
+
+    EMB_UNIT_TESTCALLER(tests, _set_up, NULL, fixtures);
+
+    return (Test *)&tests;
+}
+
+static void _init_interface(void)
+{
+    netdev_test_setup(&_ieee802154_dev, NULL);
+    netdev_test_set_get_cb(&_ieee802154_dev, NETOPT_DEVICE_TYPE,
+                           _get_netdev_device_type);
+    netdev_test_set_get_cb(&_ieee802154_dev, NETOPT_MAX_PACKET_SIZE,
+                           _get_netdev_max_packet_size);
+    netdev_test_set_get_cb(&_ieee802154_dev, NETOPT_SRC_LEN,
+                           _get_netdev_src_len);
+    _netif = gnrc_netif_ieee802154_create(
+            _netif_stack, THREAD_STACKSIZE_SMALL, GNRC_NETIF_PRIO,
+            "dummy_netif", (netdev_t *)&_ieee802154_dev);
+    assert(_netif != NULL);
+    xtimer_usleep(500); /* wait for thread to start */
+}
+
+int main(void)
+{
+    _datagram[0] = SIXLOWPAN_UNCOMP;
+    for (unsigned i = 1; i < sizeof(_datagram); i++) {
+        _datagram[i] = (uint8_t)(i ^ (i >> 8));
+    }
+    msg_init_queue(_queue, TEST_QUEUE_SIZE);
+    _init_interface();
+
+    TESTS_START();
+    TESTS_RUN(tests_gnrc_sixlowpan_frag());
+    TESTS_END();
+
+    return 0;
+}
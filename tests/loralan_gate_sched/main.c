@@ -0,0 +1,339 @@
+/*
+ * Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Drive LoRaLAN gateway channel scheduler with virtual radios
+ *
+ * @author      Oleg Artamonov
+ *
+ * @}
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "irq.h"
+#include "xtimer.h"
+#include "net/netdev.h"
+
+#include "ls-gate-scheduler.h"
+
+#define AIRTIME_US          (20U * US_PER_MS)
+#define RX1_LENGTH_US       (50U * US_PER_MS)
+#define DUTY_CYCLE          (10U)
+#define UPLINK_PERIOD_US    (100U * US_PER_MS)
+#define TEST_DURATION_US    (2U * US_PER_SEC)
+
+/* Min. time between transmissions allowed by the duty cycle */
+#define MIN_GAP_US          (AIRTIME_US * (100 - DUTY_CYCLE) / DUTY_CYCLE)
+
+/* Every channel must send at least this many replies during the test */
+#define MIN_REPLIES         ((TEST_DURATION_US / (AIRTIME_US + MIN_GAP_US)) * 7 / 10)
+
+#define REPLY_LEN           (16U)
+#define UPLINK_LEN          (16U)
+
+#define EVENT_RX            (1U << 0)
+#define EVENT_TX            (1U << 1)
+
+/**
+ * @brief Virtual transceiver, packets take AIRTIME_US on air
+ */
+typedef struct {
+    netdev_t netdev;
+    volatile unsigned events;       /* Events reported by the next isr() call */
+    volatile bool transmitting;
+    volatile bool running;
+    uint32_t tx_end;
+
+    xtimer_t tx_timer;
+    xtimer_t uplink_timer;
+
+    ls_frame_fifo_t fifo;
+    ls_sched_t sched;
+
+    unsigned uplinks;
+    unsigned uplinks_lost;
+    unsigned replies;
+    unsigned replies_dropped;
+    uint32_t min_gap;
+} vradio_t;
+
+static vradio_t radios[1 + 2 + 4];
+
+static void raise_event(vradio_t *r, unsigned event)
+{
+    r->events |= event;
+    r->netdev.event_callback(&r->netdev, NETDEV_EVENT_ISR, r->netdev.event_callback_arg);
+}
+
+static void tx_done_cb(void *arg)
+{
+    vradio_t *r = arg;
+
+    r->transmitting = false;
+    r->tx_end = xtimer_now_usec();
+    r->replies++;
+
+    raise_event(r, EVENT_TX);
+}
+
+static void uplink_cb(void *arg)
+{
+    vradio_t *r = arg;
+
+    if (!r->running) {
+        return;
+    }
+
+    /* Radio is half-duplex */
+    if (r->transmitting) {
+        r->uplinks_lost++;
+    }
+    else {
+        r->uplinks++;
+        raise_event(r, EVENT_RX);
+    }
+
+    xtimer_set(&r->uplink_timer, UPLINK_PERIOD_US);
+}
+
+static int _send(netdev_t *dev, const iolist_t *iolist)
+{
+    vradio_t *r = (vradio_t *) dev;
+
+    if (r->transmitting) {
+        return -EBUSY;
+    }
+
+    if (r->replies) {
+        uint32_t gap = xtimer_now_usec() - r->tx_end;
+        if (gap < r->min_gap) {
+            r->min_gap = gap;
+        }
+    }
+
+    r->transmitting = true;
+    xtimer_set(&r->tx_timer, AIRTIME_US);
+
+    return iolist->iol_len;
+}
+
+static int _recv(netdev_t *dev, void *buf, size_t len, void *info)
+{
+    (void) dev;
+
+    if (buf == NULL) {
+        return UPLINK_LEN;
+    }
+
+    memset(buf, 0, len);
+
+    netdev_sx127x_lora_packet_info_t *packet_info = info;
+    packet_info->rssi = -80;
+    packet_info->snr = 10;
+    packet_info->lqi = 0;
+
+    return UPLINK_LEN;
+}
+
+static int _init(netdev_t *dev)
+{
+    (void) dev;
+    return 0;
+}
+
+static void _isr(netdev_t *dev)
+{
+    vradio_t *r = (vradio_t *) dev;
+
+    unsigned state = irq_disable();
+    unsigned events = r->events;
+    r->events = 0;
+    irq_restore(state);
+
+    if (events & EVENT_TX) {
+        dev->event_callback(dev, NETDEV_EVENT_TX_COMPLETE, dev->event_callback_arg);
+    }
+
+    if (events & EVENT_RX) {
+        dev->event_callback(dev, NETDEV_EVENT_RX_COMPLETE, dev->event_callback_arg);
+    }
+}
+
+static int _get(netdev_t *dev, netopt_t opt, void *val, size_t max_len)
+{
+    (void) dev;
+    (void) opt;
+    (void) val;
+    (void) max_len;
+    return -ENOTSUP;
+}
+
+static int _set(netdev_t *dev, netopt_t opt, const void *val, size_t len)
+{
+    (void) dev;
+    (void) opt;
+    (void) val;
+    return len;
+}
+
+static const netdev_driver_t vradio_driver = {
+    .send = _send,
+    .recv = _recv,
+    .init = _init,
+    .isr = _isr,
+    .get = _get,
+    .set = _set,
+};
+
+/* Gateway answers every uplink */
+static void recv_cb(void *arg, uint8_t *buf, size_t len, netdev_sx127x_lora_packet_info_t *info)
+{
+    (void) buf;
+    (void) len;
+    (void) info;
+
+    vradio_t *r = arg;
+
+    ls_frame_t *frame = ls_frame_fifo_reserve(&r->fifo);
+    if (frame == NULL) {
+        r->replies_dropped++;
+        return;
+    }
+
+    memset(frame, 0, sizeof(ls_frame_t));
+    ls_frame_fifo_commit(&r->fifo);
+
+    ls_sched_kick(&r->sched);
+}
+
+static int prepare_cb(void *arg, ls_frame_t *frame)
+{
+    (void) arg;
+    (void) frame;
+    return REPLY_LEN;
+}
+
+static const ls_sched_cb_t sched_cb = {
+    .setup = NULL,
+    .prepare = prepare_cb,
+    .recv = recv_cb,
+};
+
+static int run(vradio_t *set, unsigned num)
+{
+    for (unsigned i = 0; i < num; i++) {
+        vradio_t *r = &set[i];
+
+        r->netdev.driver = &vradio_driver;
+        r->tx_timer.callback = tx_done_cb;
+        r->tx_timer.arg = r;
+        r->uplink_timer.callback = uplink_cb;
+        r->uplink_timer.arg = r;
+        r->min_gap = UINT32_MAX;
+
+        ls_frame_fifo_init(&r->fifo);
+
+        ls_sched_params_t params = {
+            .device = &r->netdev,
+            .fifo = &r->fifo,
+            .cb = &sched_cb,
+            .arg = r,
+            .rx1_length = RX1_LENGTH_US,
+            .duty_cycle = DUTY_CYCLE,
+        };
+
+        if (!ls_sched_init(&r->sched, &params)) {
+            puts("error: unable to start channel thread");
+            return -1;
+        }
+    }
+
+    /* Uplinks of different radios are not aligned */
+    for (unsigned i = 0; i < num; i++) {
+        set[i].running = true;
+        xtimer_set(&set[i].uplink_timer, (i + 1) * 7 * US_PER_MS);
+    }
+
+    xtimer_usleep(TEST_DURATION_US);
+
+    for (unsigned i = 0; i < num; i++) {
+        set[i].running = false;
+        xtimer_remove(&set[i].uplink_timer);
+    }
+
+    /* Let the queued replies go out */
+    for (unsigned i = 0; i < num; i++) {
+        while (!ls_frame_fifo_empty(&set[i].fifo) || set[i].transmitting) {
+            xtimer_usleep(AIRTIME_US);
+        }
+    }
+
+    /* Channel threads account the last transmissions */
+    xtimer_usleep(AIRTIME_US);
+
+    unsigned uplinks = 0;
+    unsigned replies = 0;
+    uint32_t min_gap = UINT32_MAX;
+    int res = 0;
+
+    for (unsigned i = 0; i < num; i++) {
+        vradio_t *r = &set[i];
+
+        uplinks += r->uplinks;
+        replies += r->replies;
+
+        if (r->min_gap < min_gap) {
+            min_gap = r->min_gap;
+        }
+
+        if (r->replies < MIN_REPLIES) {
+            printf("error: channel %u sent %u replies only\n", i, r->replies);
+            res = -1;
+        }
+
+        if (r->sched.stats.tx_frames != r->replies) {
+            printf("error: channel %u counted %" PRIu32 " of %u replies\n",
+                   i, r->sched.stats.tx_frames, r->replies);
+            res = -1;
+        }
+    }
+
+    if (min_gap < MIN_GAP_US) {
+        printf("error: duty-cycle off-time violated, gap %" PRIu32 " us\n", min_gap);
+        res = -1;
+    }
+
+    printf("{ \"radios\" : %u, \"uplinks\" : %u, \"replies\" : %u, "
+           "\"replies_per_radio\" : %u, \"min_gap_ms\" : %" PRIu32 " }\n",
+           num, uplinks, replies, replies / num, min_gap / US_PER_MS);
+
+    return res;
+}
+
+int main(void)
+{
+    puts("LoRaLAN gateway channel scheduler test");
+
+    int res = 0;
+
+    res |= run(&radios[0], 1);
+    res |= run(&radios[1], 2);
+    res |= run(&radios[3], 4);
+
+    puts((res == 0) ? "[SUCCESS]" : "[FAILURE]");
+
+    return 0;
+}
@@ -0,0 +1,604 @@
+/*
+ * Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       LoRaLAN network load test with simulated transceivers
+ *
+ * @author      Oleg Artamonov
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "msg.h"
+#include "thread.h"
+#include "random.h"
+#include "xtimer.h"
+
+#include "sx127x_sim.h"
+
+#include "ls-mac.h"
+#include "ls-crypto.h"
+#include "ls-gate.h"
+#include "ls-init-device.h"
+
+#ifndef NUM_NODES
+#define NUM_NODES           (1000)
+#endif
+
+#ifndef NUM_CHANNELS
+#define NUM_CHANNELS        (8)
+#endif
+
+#if NUM_NODES > LS_GATE_MAX_NODES
+#error "Gateway can't hold all the nodes, increase LS_GATE_MAX_NODES"
+#endif
+
+#define DATARATE            (LS_DR5)
+#define FIRST_FREQUENCY     (868100000UL)
+#define CHANNEL_SPACING     (200000UL)
+
+#define JOIN_SPREAD_US      (60U * US_PER_SEC)  /**< Nodes start joining within this time */
+#define UPLINK_PERIOD_US    (60U * US_PER_SEC)
+#define UPLINKS_PER_NODE    (2)
+#define UPLINK_LEN          (16)
+
+#define ACK_TIMEOUT_US      (3U * US_PER_SEC)   /**< Same as RX windows of the end device */
+#define BACKOFF_MIN_US      (2U * US_PER_SEC)
+#define BACKOFF_MAX_US      (6U * US_PER_SEC)
+#define MAX_TRIES           (3)                 /**< Transmissions of a confirmed uplink */
+
+#define TEST_DURATION_US    (JOIN_SPREAD_US + UPLINKS_PER_NODE * UPLINK_PERIOD_US + 60U * US_PER_SEC)
+
+/* Nodes are spread between 100 and 130 dB from the gateway */
+#define PATH_LOSS_MIN       (100)
+#define PATH_LOSS_RANGE     (31)
+
+/* Packets lost regardless of collisions, e.g. due to fading */
+#define RANDOM_LOSS         (2)
+
+#define MSG_TYPE_ISR        (0x5401)
+#define MSG_TYPE_TIMER      (0x5402)
+
+#define NODES_QUEUE_SIZE    (2048)
+
+typedef enum {
+    NODE_IDLE = 0,      /**< Waits for the next transmission */
+    NODE_JOIN_TX,
+    NODE_JOIN_RX,
+    NODE_UPLINK_TX,
+    NODE_UPLINK_RX,
+    NODE_DONE,
+} node_state_t;
+
+/**
+ * @brief Virtual end device, talks LoRaLAN over a simulated transceiver
+ */
+typedef struct {
+    sx127x_sim_t radio;
+    uint16_t idx;
+    node_state_t state;
+
+    uint64_t dev_id;
+    uint32_t dev_nonce;
+    ls_addr_t addr;
+    ls_session_keys_t keys;
+    bool joined;
+
+    uint8_t fid;
+    uint8_t tries;
+    uint8_t uplinks;            /* Uplinks done, acknowledged or not */
+
+    uint32_t first_tx;          /* Start of the join or uplink exchange */
+    uint32_t tx_end;            /* End of the last transmission */
+
+    uint16_t timer_seq;         /* Distinguishes stale timer messages */
+    xtimer_t timer;
+    msg_t timer_msg;
+} node_t;
+
+typedef struct {
+    unsigned joined;
+    unsigned join_requests;
+    uint64_t join_latency_sum;
+    uint32_t join_latency_max;
+
+    unsigned uplinks;           /* Uplink exchanges started by joined nodes */
+    unsigned uplink_tx;         /* Uplink transmissions including retries */
+    unsigned acked;
+    unsigned lost;
+    unsigned adr_commands;      /* Acks carrying new link settings */
+    uint64_t turnaround_sum;
+    uint32_t turnaround_max;
+    uint32_t first_uplink;
+    uint32_t last_ack;
+
+    unsigned done;
+} results_t;
+
+static uint8_t join_key[AES_KEY_SIZE] = {
+    0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6,
+    0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C
+};
+
+static const uint64_t app_id = 0x0000000100000001ULL;
+
+static node_t nodes[NUM_NODES];
+static results_t results;
+
+static sx127x_sim_t gate_radios[NUM_CHANNELS];
+static ls_gate_channel_t channels[NUM_CHANNELS];
+static ls_gate_t gate;
+
+static volatile unsigned gate_uplinks;
+static volatile unsigned gate_mismatches;
+
+static kernel_pid_t nodes_pid;
+static char nodes_stack[THREAD_STACKSIZE_MAIN];
+static msg_t nodes_queue[NODES_QUEUE_SIZE];
+
+/* Simulated network has no RTC, gateway time comes from xtimer */
+uint32_t rtctimers_millis_now(void)
+{
+    return xtimer_now_usec() / US_PER_MS;
+}
+
+static uint32_t node_joined_cb(ls_gate_node_t *node)
+{
+    (void) node;
+    return random_uint32();
+}
+
+/* Every uplink carries the node ID, so the gateway checks the whole crypto path */
+static void app_data_received_cb(ls_gate_node_t *node, ls_gate_channel_t *ch,
+                                 uint8_t *buf, size_t bufsize, uint8_t status)
+{
+    (void) ch;
+    (void) status;
+
+    uint64_t node_id = node->node_id;
+
+    if (bufsize != UPLINK_LEN || memcmp(buf, &node_id, sizeof(node_id)) != 0) {
+        gate_mismatches++;
+        return;
+    }
+
+    gate_uplinks++;
+}
+
+static void init_gate(void)
+{
+    gate.settings.gate_id = 0x00000001FFFFFFFFULL;
+    gate.settings.join_key = join_key;
+
+    gate.channels = channels;
+    gate.num_channels = NUM_CHANNELS;
+
+    gate.node_joined_cb = node_joined_cb;
+    gate.app_data_received_cb = app_data_received_cb;
+
+    for (unsigned i = 0; i < NUM_CHANNELS; i++) {
+        sx127x_sim_params_t params = { .path_loss = 0 };
+        sx127x_sim_setup(&gate_radios[i], &params);
+
+        channels[i].dr = DATARATE;
+        channels[i].frequency = FIRST_FREQUENCY + i * CHANNEL_SPACING;
+        channels[i].duty_cycle = 0;
+        channels[i]._internal.device = &gate_radios[i].netdev;
+    }
+}
+
+static void set_timer(node_t *node, uint32_t offset)
+{
+    node->timer_seq++;
+    node->timer_msg.type = MSG_TYPE_TIMER;
+    node->timer_msg.content.value = ((uint32_t) node->timer_seq << 16) | node->idx;
+
+    xtimer_set_msg(&node->timer, offset, &node->timer_msg, nodes_pid);
+}
+
+static void backoff(node_t *node)
+{
+    node->state = NODE_IDLE;
+    set_timer(node, random_uint32_range(BACKOFF_MIN_US, BACKOFF_MAX_US));
+}
+
+static void radio_set_state(node_t *node, netopt_state_t state)
+{
+    netdev_t *dev = &node->radio.netdev;
+    dev->driver->set(dev, NETOPT_STATE, &state, sizeof(state));
+}
+
+static void send_frame(node_t *node, ls_frame_t *frame, size_t payload_size)
+{
+    netdev_t *dev = &node->radio.netdev;
+
+    iolist_t iol = {
+        .iol_base = frame,
+        .iol_len = sizeof(ls_header_t) + sizeof(ls_payload_len_t) + payload_size,
+    };
+
+    dev->driver->send(dev, &iol);
+}
+
+static void send_join_req(node_t *node)
+{
+    ls_frame_t frame;
+    size_t size;
+
+    /* Gate accepts every nonce once */
+    node->dev_nonce = random_uint32();
+
+    ls_join_req_caps_t req = {
+        .req = {
+            .dev_id = node->dev_id,
+            .app_id = app_id,
+            .dev_nonce = node->dev_nonce,
+            .node_class = LS_ED_CLASS_A,
+        },
+        .caps = LS_JOIN_CAP_ADR,
+    };
+
+    ls_assemble_frame(LS_ADDR_UNDEFINED, LS_UL_JOIN_REQ, (uint8_t *) &req, sizeof(req), &frame);
+    ls_encrypt_frame(join_key, join_key, &frame, &size);
+
+    node->state = NODE_JOIN_TX;
+    results.join_requests++;
+
+    send_frame(node, &frame, size);
+}
+
+static void send_uplink(node_t *node)
+{
+    ls_frame_t frame;
+    size_t size;
+
+    uint8_t data[UPLINK_LEN] = { 0 };
+    memcpy(data, &node->dev_id, sizeof(node->dev_id));
+
+    ls_assemble_frame(node->addr, LS_UL_CONF, data, sizeof(data), &frame);
+    frame.header.fid = node->fid;
+    ls_session_encrypt_frame(&node->keys, &frame, &size);
+
+    node->state = NODE_UPLINK_TX;
+    results.uplink_tx++;
+
+    send_frame(node, &frame, size);
+}
+
+static void next_uplink(node_t *node, uint32_t delay)
+{
+    if (node->uplinks >= UPLINKS_PER_NODE) {
+        node->state = NODE_DONE;
+        results.done++;
+        return;
+    }
+
+    node->state = NODE_IDLE;
+    node->tries = 0;
+    node->fid++;
+
+    set_timer(node, delay);
+}
+
+static void join_ack(node_t *node, ls_frame_t *frame)
+{
+    if (frame->payload.len != sizeof(ls_join_ack_t) || !ls_validate_frame_mic(join_key, frame)) {
+        return;
+    }
+
+    ls_decrypt_frame_payload(join_key, frame);
+
+    ls_join_ack_t ack;
+    memcpy(&ack, frame->payload.data, sizeof(ack));
+
+    /* Join ack for another node */
+    if (ack.dev_id != node->dev_id) {
+        return;
+    }
+
+    xtimer_remove(&node->timer);
+    radio_set_state(node, NETOPT_STATE_SLEEP);
+
+    node->addr = ack.addr;
+    node->joined = true;
+    ls_session_keys_derive(&node->keys, node->dev_nonce, ack.app_nonce, ack.addr);
+
+    uint32_t latency = xtimer_now_usec() - node->first_tx;
+    results.joined++;
+    results.join_latency_sum += latency;
+    if (latency > results.join_latency_max) {
+        results.join_latency_max = latency;
+    }
+
+    /* Uplinks of all the nodes are spread over the period */
+    next_uplink(node, random_uint32_range(0, UPLINK_PERIOD_US));
+}
+
+static void uplink_ack(node_t *node, ls_frame_t *frame)
+{
+    if (frame->header.dev_addr != node->addr || !ls_validate_frame_mic(node->keys.mic_key, frame)) {
+        return;
+    }
+
+    xtimer_remove(&node->timer);
+    radio_set_state(node, NETOPT_STATE_SLEEP);
+
+    /* Switch to the link settings chosen by the gateway */
+    if (frame->header.type == LS_DL_ADR_REQ) {
+        ls_session_crypt_payload(&node->keys, frame);
+
+        ls_adr_req_t req;
+        memcpy(&req, frame->payload.data, sizeof(req));
+
+        netdev_t *dev = &node->radio.netdev;
+        int16_t power = req.tx_power;
+
+        ls_setup_sx127x(dev, (ls_datarate_t) req.dr, req.frequency);
+        dev->driver->set(dev, NETOPT_TX_POWER, &power, sizeof(power));
+
+        results.adr_commands++;
+    }
+
+    uint32_t now = xtimer_now_usec();
+    uint32_t turnaround = now - node->tx_end;
+
+    results.acked++;
+    results.last_ack = now;
+    results.turnaround_sum += turnaround;
+    if (turnaround > results.turnaround_max) {
+        results.turnaround_max = turnaround;
+    }
+
+    node->uplinks++;
+    next_uplink(node, UPLINK_PERIOD_US - (now - node->first_tx) % UPLINK_PERIOD_US);
+}
+
+static void node_recv(node_t *node)
+{
+    static ls_frame_t frame;
+
+    netdev_t *dev = &node->radio.netdev;
+    netdev_sx127x_lora_packet_info_t info;
+
+    /* Damaged packets are dropped, receiver keeps listening */
+    int len = dev->driver->recv(dev, NULL, 0, NULL);
+    if (len < 0) {
+        return;
+    }
+
+    len = dev->driver->recv(dev, &frame, sizeof(frame), &info);
+    if (len < 0 || !ls_validate_frame((uint8_t *) &frame, len)) {
+        return;
+    }
+
+    /* Other nodes' uplinks are on the same channel */
+    if (node->state == NODE_JOIN_RX && frame.header.type == LS_DL_JOIN_ACK) {
+        join_ack(node, &frame);
+    }
+    else if (node->state == NODE_UPLINK_RX &&
+             (frame.header.type == LS_DL_ACK || frame.header.type == LS_DL_ADR_REQ)) {
+        uplink_ack(node, &frame);
+    }
+}
+
+static void node_event_cb(netdev_t *dev, netdev_event_t event, void *arg)
+{
+    (void) arg;
+    node_t *node = (node_t *) dev;
+
+    switch (event) {
+        case NETDEV_EVENT_ISR: {
+            msg_t msg = { .type = MSG_TYPE_ISR, .content.ptr = node };
+            if (msg_send(&msg, nodes_pid) <= 0) {
+                puts("error: nodes thread queue is full");
+            }
+            break;
+        }
+
+        case NETDEV_EVENT_TX_COMPLETE:
+            /* Node listens for the answer right after the transmission */
+            node->tx_end = xtimer_now_usec();
+            node->state = (node->state == NODE_JOIN_TX) ? NODE_JOIN_RX : NODE_UPLINK_RX;
+            radio_set_state(node, NETOPT_STATE_IDLE);
+            set_timer(node, ACK_TIMEOUT_US);
+            break;
+
+        case NETDEV_EVENT_RX_COMPLETE:
+            node_recv(node);
+            break;
+
+        default:
+            break;
+    }
+}
+
+static void node_timer(node_t *node)
+{
+    switch (node->state) {
+        case NODE_IDLE:
+            node->tries++;
+
+            if (!node->joined) {
+                if (node->tries == 1) {
+                    node->first_tx = xtimer_now_usec();
+                }
+                send_join_req(node);
+                break;
+            }
+
+            if (node->tries == 1) {
+                node->first_tx = xtimer_now_usec();
+                results.uplinks++;
+                if (!results.first_uplink) {
+                    results.first_uplink = node->first_tx;
+                }
+            }
+            send_uplink(node);
+            break;
+
+        case NODE_JOIN_RX:
+            /* Joins are retried till the end of the test */
+            radio_set_state(node, NETOPT_STATE_SLEEP);
+            backoff(node);
+            break;
+
+        case NODE_UPLINK_RX:
+            radio_set_state(node, NETOPT_STATE_SLEEP);
+
+            if (node->tries >= MAX_TRIES) {
+                results.lost++;
+                node->uplinks++;
+                next_uplink(node, random_uint32_range(BACKOFF_MIN_US, BACKOFF_MAX_US));
+            }
+            else {
+                backoff(node);
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+static void *nodes_thread(void *arg)
+{
+    (void) arg;
+
+    msg_init_queue(nodes_queue, NODES_QUEUE_SIZE);
+
+    for (unsigned i = 0; i < NUM_NODES; i++) {
+        node_t *node = &nodes[i];
+
+        sx127x_sim_params_t params = { .path_loss = PATH_LOSS_MIN + (i * 7) % PATH_LOSS_RANGE };
+        sx127x_sim_setup(&node->radio, &params);
+
+        node->idx = i;
+        node->dev_id = 0x0000000200000000ULL + i;
+
+        netdev_t *dev = &node->radio.netdev;
+        dev->event_callback = node_event_cb;
+        dev->driver->init(dev);
+        ls_setup_sx127x(dev, DATARATE, FIRST_FREQUENCY + (i % NUM_CHANNELS) * CHANNEL_SPACING);
+
+        set_timer(node, random_uint32_range(0, JOIN_SPREAD_US));
+    }
+
+    msg_t msg;
+
+    while (1) {
+        msg_receive(&msg);
+
+        switch (msg.type) {
+            case MSG_TYPE_ISR: {
+                netdev_t *dev = msg.content.ptr;
+                dev->driver->isr(dev);
+                break;
+            }
+
+            case MSG_TYPE_TIMER: {
+                node_t *node = &nodes[msg.content.value & 0xFFFF];
+
+                if ((msg.content.value >> 16) == node->timer_seq) {
+                    node_timer(node);
+                }
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+
+    return NULL;
+}
+
+static void print_results(void)
+{
+    sx127x_sim_stats_t air = { 0 };
+    ls_sched_stats_t sched = { 0 };
+
+    for (unsigned i = 0; i < NUM_CHANNELS; i++) {
+        air.rx_collisions += gate_radios[i].stats.rx_collisions;
+        sched.tx_frames += channels[i]._internal.sched.stats.tx_frames;
+        sched.rx_frames += channels[i]._internal.sched.stats.rx_frames;
+    }
+
+    uint32_t uplink_time = results.last_ack - results.first_uplink;
+
+    printf("{ \"nodes\" : %u, \"channels\" : %u, \"joined\" : %u, \"join_requests\" : %u, "
+           "\"join_latency_avg_ms\" : %" PRIu32 ", \"join_latency_max_ms\" : %" PRIu32 " }\n",
+           NUM_NODES, NUM_CHANNELS, results.joined, results.join_requests,
+           (uint32_t) (results.joined ? results.join_latency_sum / results.joined / US_PER_MS : 0),
+           results.join_latency_max / US_PER_MS);
+
+    printf("{ \"uplinks\" : %u, \"transmissions\" : %u, \"acked\" : %u, \"lost\" : %u, "
+           "\"adr_commands\" : %u, \"uplinks_per_min\" : %" PRIu32 ", "
+           "\"ack_turnaround_avg_ms\" : %" PRIu32 ", \"ack_turnaround_max_ms\" : %" PRIu32 " }\n",
+           results.uplinks, results.uplink_tx, results.acked, results.lost, results.adr_commands,
+           (uint32_t) (uplink_time ? (uint64_t) results.acked * 60 * US_PER_SEC / uplink_time : 0),
+           (uint32_t) (results.acked ? results.turnaround_sum / results.acked / US_PER_MS : 0),
+           results.turnaround_max / US_PER_MS);
+
+    printf("{ \"gate_rx\" : %" PRIu32 ", \"gate_tx\" : %" PRIu32 ", \"gate_collisions\" : %" PRIu32 ", "
+           "\"gate_uplinks\" : %u }\n",
+           sched.rx_frames, sched.tx_frames, air.rx_collisions, gate_uplinks);
+}
+
+int main(void)
+{
+    puts("LoRaLAN network load test with simulated transceivers");
+
+    sx127x_sim_set_loss(RANDOM_LOSS);
+    init_gate();
+
+    if (ls_gate_init(&gate) != LS_GATE_OK) {
+        puts("error: unable to initialize the gateway");
+        return 1;
+    }
+
+    nodes_pid = thread_create(nodes_stack, sizeof(nodes_stack), THREAD_PRIORITY_MAIN - 1,
+                              THREAD_CREATE_STACKTEST, nodes_thread, NULL, "nodes");
+
+    /* Poll for the end of the test */
+    uint32_t start = xtimer_now_usec();
+    while ((results.done < NUM_NODES) && (xtimer_now_usec() - start < TEST_DURATION_US)) {
+        xtimer_sleep(1);
+    }
+
+    print_results();
+
+    int res = 0;
+
+    if (results.joined < NUM_NODES * 9 / 10) {
+        printf("error: %u of %u nodes joined\n", results.joined, NUM_NODES);
+        res = -1;
+    }
+
+    if (results.acked < results.uplinks * 8 / 10) {
+        printf("error: %u of %u uplinks acknowledged\n", results.acked, results.uplinks);
+        res = -1;
+    }
+
+    /* Node gets ack only for the uplink received by the gateway */
+    if (gate_uplinks < results.acked || gate_mismatches) {
+        printf("error: gateway got %u uplinks, %u damaged\n", gate_uplinks, gate_mismatches);
+        res = -1;
+    }
+
+    puts((res == 0) ? "[SUCCESS]" : "[FAILURE]");
+
+    return 0;
+}
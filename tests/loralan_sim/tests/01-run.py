@@ -0,0 +1,29 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+#
+# This file is subject to the terms and conditions of the GNU Lesser
+# General Public License v2.1. See the file LICENSE in the top level
+# directory for more details.
+
+import os
+import sys
+
+
+def testfunc(child):
+    child.expect(r"{ \"nodes\" : \d+, \"channels\" : \d+, \"joined\" : \d+, "
+                 r"\"join_requests\" : \d+, \"join_latency_avg_ms\" : \d+, "
+                 r"\"join_latency_max_ms\" : \d+ }")
+    child.expect(r"{ \"uplinks\" : \d+, \"transmissions\" : \d+, \"acked\" : \d+, "
+                 r"\"lost\" : \d+, \"uplinks_per_min\" : \d+, "
+                 r"\"ack_turnaround_avg_ms\" : \d+, \"ack_turnaround_max_ms\" : \d+ }")
+    child.expect(r"{ \"gate_rx\" : \d+, \"gate_tx\" : \d+, "
+                 r"\"gate_collisions\" : \d+, \"gate_uplinks\" : \d+ }")
+    child.expect_exact("[SUCCESS]")
+
+
+if __name__ == "__main__":
+    sys.path.append(os.path.join(os.environ['RIOTTOOLS'], 'testrunner'))
+    from testrunner import run
+    # Network runs in real time for up to 4 minutes
+    sys.exit(run(testfunc, timeout=300))
@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup tests
+ * @{
+ *
+ * @file
+ * @brief       Measures the wait of a high priority thread for a mutex held
+ *              by a low priority one, with and without priority inheritance
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include "thread.h"
+#include "mutex.h"
+#include "pi_mutex.h"
+#include "xtimer.h"
+
+#ifndef ROUNDS
+#define ROUNDS          (10U)
+#endif
+
+#ifndef HOLD_US
+#define HOLD_US         (10U * US_PER_MS)
+#endif
+
+#ifndef MID_BUSY_US
+#define MID_BUSY_US     (100U * US_PER_MS)
+#endif
+
+static mutex_t res_mtx = MUTEX_INIT;
+static pi_mutex_t res_pi_mtx = PI_MUTEX_INIT;
+static int use_pi;
+
+static uint32_t max_wait;
+
+static char stack_high[THREAD_STACKSIZE_DEFAULT];
+static char stack_mid[THREAD_STACKSIZE_DEFAULT];
+static char stack_low[THREAD_STACKSIZE_DEFAULT];
+
+static kernel_pid_t pid_low;
+static kernel_pid_t pid_mid;
+static kernel_pid_t pid_high;
+
+static void res_lock(void)
+{
+    if (use_pi) {
+        pi_mutex_lock(&res_pi_mtx);
+    }
+    else {
+        mutex_lock(&res_mtx);
+    }
+}
+
+static void res_unlock(void)
+{
+    if (use_pi) {
+        pi_mutex_unlock(&res_pi_mtx);
+    }
+    else {
+        mutex_unlock(&res_mtx);
+    }
+}
+
+static void busy_wait(uint32_t us)
+{
+    uint32_t start = xtimer_now_usec();
+    while ((xtimer_now_usec() - start) < us) {}
+}
+
+static void *t_low_handler(void *arg)
+{
+    (void) arg;
+
+    while (1) {
+        thread_sleep();
+
+        res_lock();
+        thread_wakeup(pid_mid);
+        busy_wait(HOLD_US);
+        res_unlock();
+    }
+
+    return NULL;
+}
+
+static void *t_mid_handler(void *arg)
+{
+    (void) arg;
+
+    while (1) {
+        thread_sleep();
+
+        thread_wakeup(pid_high);
+        busy_wait(MID_BUSY_US);
+    }
+
+    return NULL;
+}
+
+static void *t_high_handler(void *arg)
+{
+    (void) arg;
+
+    while (1) {
+        thread_sleep();
+
+        uint32_t start = xtimer_now_usec();
+        res_lock();
+        uint32_t wait = xtimer_now_usec() - start;
+        res_unlock();
+
+        if (wait > max_wait) {
+            max_wait = wait;
+        }
+    }
+
+    return NULL;
+}
+
+static uint32_t run(int pi)
+{
+    use_pi = pi;
+    max_wait = 0;
+
+    for (unsigned i = 0; i < ROUNDS; i++) {
+        /* the round is over when all of them sleep again */
+        thread_wakeup(pid_low);
+    }
+
+    return max_wait;
+}
+
+int main(void)
+{
+    puts("pi_mutex test: wait of a high priority thread for a mutex");
+
+    pid_low = thread_create(stack_low, sizeof(stack_low),
+                            THREAD_PRIORITY_MAIN - 1,
+                            THREAD_CREATE_STACKTEST,
+                            t_low_handler, NULL, "t_low");
+
+    pid_mid = thread_create(stack_mid, sizeof(stack_mid),
+                            THREAD_PRIORITY_MAIN - 2,
+                            THREAD_CREATE_STACKTEST,
+                            t_mid_handler, NULL, "t_mid");
+
+    pid_high = thread_create(stack_high, sizeof(stack_high),
+                             THREAD_PRIORITY_MAIN - 3,
+                             THREAD_CREATE_STACKTEST,
+                             t_high_handler, NULL, "t_high");
+
+    uint32_t wait = run(0);
+    printf("mutex_t: max. wait %" PRIu32 " us\n", wait);
+
+    uint32_t wait_pi = run(1);
+    printf("pi_mutex_t: max. wait %" PRIu32 " us\n", wait_pi);
+
+    if (wait_pi < HOLD_US + MID_BUSY_US / 2) {
+        puts("SUCCESS");
+    }
+    else {
+        puts("FAILURE");
+    }
+
+    return 0;
+}
@@ -22,7 +22,7 @@
 #include "pthread.h"
 #include "thread.h"
 
-static mutex_t mutex = MUTEX_INIT;
+static pthread_mutex_t mutex;
 static pthread_cond_t cv;
 static volatile int is_finished;
 static volatile long count;
@@ -38,14 +38,16 @@ static void *second_thread(void *arg)
 {
     (void) arg;
     while (1) {
-        mutex_lock(&mutex);
+        pthread_mutex_lock(&mutex);
 
         if (is_finished == 1) {
             break;
         }
 
         pthread_cond_signal(&cv);
-        mutex_unlock_and_sleep(&mutex);
+        /* main has a lower priority, it can't run before this thread sleeps */
+        pthread_mutex_unlock(&mutex);
+        thread_sleep();
     }
     return NULL;
 }
@@ -56,6 +58,7 @@ int main(void)
     count = 0;
     is_finished = 0;
     expected_value = 1000ul * 1000ul;
+    pthread_mutex_init(&mutex, NULL);
     pthread_cond_init(&cv, NULL);
 
     kernel_pid_t pid = thread_create(stack,sizeof(stack), THREAD_PRIORITY_MAIN - 1,
@@ -63,7 +66,7 @@ int main(void)
                                      second_thread, NULL, "second_thread");
 
     while (1) {
-        mutex_lock(&mutex);
+        pthread_mutex_lock(&mutex);
         thread_wakeup(pid);
         count++;
 
@@ -74,12 +77,12 @@ int main(void)
         if (count == expected_value) {
             puts("condition fulfilled.");
             is_finished = 1;
-            mutex_unlock(&mutex);
+            pthread_mutex_unlock(&mutex);
             break;
         }
 
         pthread_cond_wait(&cv, &mutex);
-        mutex_unlock(&mutex);
+        pthread_mutex_unlock(&mutex);
     }
 
     puts("SUCCESS");
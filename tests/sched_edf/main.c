@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup tests
+ * @{
+ *
+ * @file
+ * @brief       Checks the run order and the deadline miss counting of
+ *              threads scheduled by deadline
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include "thread.h"
+#include "sched_edf.h"
+#include "xtimer.h"
+
+#define EARLY_DEADLINE_US   (10U * US_PER_MS)
+#define LATE_DEADLINE_US    (50U * US_PER_MS)
+#define ROUND_US            (200U * US_PER_MS)
+
+#define NUM_THREADS         (3U)
+
+static char stacks[NUM_THREADS][THREAD_STACKSIZE_DEFAULT];
+static kernel_pid_t pids[NUM_THREADS];
+static const char *names[NUM_THREADS] = { "t_fifo", "t_late", "t_early" };
+static const uint32_t deadlines[NUM_THREADS] = {
+    0, LATE_DEADLINE_US, EARLY_DEADLINE_US
+};
+
+static unsigned order[NUM_THREADS];
+static unsigned order_len;
+static uint32_t busy_us;
+
+static void busy_wait(uint32_t us)
+{
+    uint32_t start = xtimer_now_usec();
+    while ((xtimer_now_usec() - start) < us) {}
+}
+
+static void *handler(void *arg)
+{
+    unsigned idx = (unsigned)(uintptr_t)arg;
+
+    sched_edf_set_deadline(thread_getpid(), deadlines[idx]);
+
+    while (1) {
+        thread_sleep();
+
+        order[order_len++] = idx;
+        busy_wait(busy_us);
+    }
+
+    return NULL;
+}
+
+static void round_run(uint32_t us)
+{
+    busy_us = us;
+    order_len = 0;
+
+    /* in order of creation, the reverse of the deadlines */
+    for (unsigned i = 0; i < NUM_THREADS; i++) {
+        thread_wakeup(pids[i]);
+    }
+
+    xtimer_usleep(ROUND_US);
+}
+
+int main(void)
+{
+    puts("sched_edf test: run order and deadline misses");
+
+    for (unsigned i = 0; i < NUM_THREADS; i++) {
+        pids[i] = thread_create(stacks[i], sizeof(stacks[i]), SCHED_EDF_PRIO,
+                                THREAD_CREATE_STACKTEST, handler,
+                                (void *)(uintptr_t)i, names[i]);
+    }
+
+    /* let them set their deadlines and go to sleep */
+    xtimer_usleep(ROUND_US);
+
+    /* the thread with the earliest deadline goes first, the one without a
+     * deadline last */
+    round_run(0);
+
+    printf("order:");
+    for (unsigned i = 0; i < order_len; i++) {
+        printf(" %s", names[order[i]]);
+    }
+    puts("");
+
+    int res = (order_len == NUM_THREADS) && (order[0] == 2) &&
+              (order[1] == 1) && (order[2] == 0);
+
+    /* t_early runs first and takes longer than its deadline, so does t_late
+     * waiting for it */
+    round_run(EARLY_DEADLINE_US * 3);
+
+    printf("misses: t_late %" PRIu32 " t_early %" PRIu32 "\n",
+           sched_edf_misses(pids[1]), sched_edf_misses(pids[2]));
+
+    res = res && (sched_edf_misses(pids[1]) == 1) &&
+          (sched_edf_misses(pids[2]) == 1);
+
+    puts(res ? "SUCCESS" : "FAILURE");
+
+    return 0;
+}
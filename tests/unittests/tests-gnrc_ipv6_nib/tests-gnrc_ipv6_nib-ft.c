@@ -34,12 +34,8 @@
 
 static void set_up(void)
 {
-    evtimer_event_t *tmp;
-
-    for (evtimer_event_t *ptr = _nib_evtimer.events;
-         (ptr != NULL) && (tmp = (ptr->next), 1);
-         ptr = tmp) {
-        evtimer_del((evtimer_t *)(&_nib_evtimer), ptr);
+    while (_nib_evtimer.events != NULL) {
+        evtimer_del((evtimer_t *)(&_nib_evtimer), _nib_evtimer.events);
     }
     _nib_init();
 }
@@ -178,6 +174,41 @@ static void test_nib_ft_get__success4(void)
     TEST_ASSERT_EQUAL_INT(IFACE, fte.iface);
 }
 
+/*
+ * Adds a host route that matches the destination in all but the last bit, a
+ * route with a shorter prefix and a route with a longer prefix, both covering
+ * the destination, then tries to get the destination. The shorter prefix is
+ * added first and matches as many bits of the destination as the longer one.
+ * Expected result: gnrc_ipv6_nib_ft_get() returns route with the longer prefix
+ */
+static void test_nib_ft_get__success5(void)
+{
+    gnrc_ipv6_nib_ft_t fte;
+    static const ipv6_addr_t dst = { .u64 = { { .u8 = GLOBAL_PREFIX },
+                                              { .u64 = TEST_UINT64 } } };
+    static const ipv6_addr_t next_hop1 = { .u64 = { { .u8 = LINK_LOCAL_PREFIX },
+                                                  { .u64 = TEST_UINT64 } } };
+    static const ipv6_addr_t next_hop2 = { .u64 = { { .u8 = LINK_LOCAL_PREFIX },
+                                                  { .u64 = TEST_UINT64 + 1 } } };
+    static const ipv6_addr_t next_hop3 = { .u64 = { { .u8 = LINK_LOCAL_PREFIX },
+                                                  { .u64 = TEST_UINT64 + 2 } } };
+    ipv6_addr_t host = dst;
+
+    bf_toggle(host.u8, IPV6_ADDR_BIT_LEN - 1);
+    TEST_ASSERT_EQUAL_INT(0, gnrc_ipv6_nib_ft_add(&host, IPV6_ADDR_BIT_LEN,
+                                                  &next_hop3, IFACE, 0));
+    TEST_ASSERT_EQUAL_INT(0, gnrc_ipv6_nib_ft_add(&dst, GLOBAL_PREFIX_LEN - 1,
+                                                  &next_hop2, IFACE, 0));
+    TEST_ASSERT_EQUAL_INT(0, gnrc_ipv6_nib_ft_add(&dst, GLOBAL_PREFIX_LEN,
+                                                  &next_hop1, IFACE, 0));
+    TEST_ASSERT_EQUAL_INT(0, gnrc_ipv6_nib_ft_get(&dst, NULL, &fte));
+    TEST_ASSERT(ipv6_addr_match_prefix(&dst, &fte.dst) >= GLOBAL_PREFIX_LEN);
+    TEST_ASSERT(ipv6_addr_equal(&next_hop1, &fte.next_hop));
+    TEST_ASSERT_EQUAL_INT(GLOBAL_PREFIX_LEN, fte.dst_len);
+    /* we can't make any sure assumption on fte.primary */
+    TEST_ASSERT_EQUAL_INT(IFACE, fte.iface);
+}
+
 /*
  * Tries to create a forwarding table entry for the default route (::) with
  * NULL as next hop.
@@ -727,6 +758,7 @@ Test *tests_gnrc_ipv6_nib_ft_tests(void)
         new_TestFixture(test_nib_ft_get__success2),
         new_TestFixture(test_nib_ft_get__success3),
         new_TestFixture(test_nib_ft_get__success4),
+        new_TestFixture(test_nib_ft_get__success5),
         new_TestFixture(test_nib_ft_add__EINVAL_def_route_next_hop_NULL),
         new_TestFixture(test_nib_ft_add__EINVAL_iface0),
         new_TestFixture(test_nib_ft_add__ENOMEM_diff_def_router),
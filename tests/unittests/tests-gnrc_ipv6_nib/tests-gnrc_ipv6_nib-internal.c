@@ -1674,6 +1674,56 @@ static void test_nib_pl_remove(void)
     TEST_ASSERT_NULL(_nib_offl_iter(NULL));
 }
 
+/*
+ * Creates a prefix list entry without the on-link flag and a forwarding table
+ * entry with the flag, both covering an address, then looks up an on-link
+ * prefix for the address.
+ * Expected result: _nib_pl_get_on_link() returns NULL
+ */
+static void test_nib_pl_get_on_link__not_on_link(void)
+{
+    _nib_offl_entry_t *dst;
+    static const ipv6_addr_t next_hop = { .u64 = { { .u8 = LINK_LOCAL_PREFIX },
+                                                 { .u64 = TEST_UINT64 } } };
+    static const ipv6_addr_t pfx = { .u64 = { { .u8 = GLOBAL_PREFIX } } };
+    static const ipv6_addr_t addr = { .u64 = { { .u8 = GLOBAL_PREFIX },
+                                             { .u64 = TEST_UINT64 } } };
+
+    TEST_ASSERT_NOT_NULL(_nib_pl_add(IFACE, &pfx, GLOBAL_PREFIX_LEN,
+                                     UINT32_MAX, UINT32_MAX));
+    TEST_ASSERT_NOT_NULL((dst = _nib_ft_add(&next_hop, IFACE, &pfx,
+                                            GLOBAL_PREFIX_LEN + 1)));
+    dst->flags |= _PFX_ON_LINK;
+    TEST_ASSERT_NULL(_nib_pl_get_on_link(&addr));
+}
+
+/*
+ * Creates two on-link prefix list entries of different lengths on different
+ * interfaces, both covering an address, then looks up an on-link prefix for
+ * the address and for an address outside of both.
+ * Expected result: _nib_pl_get_on_link() returns the entry created first for
+ * the first address and NULL for the second one
+ */
+static void test_nib_pl_get_on_link__success(void)
+{
+    _nib_offl_entry_t *dst1, *dst2;
+    static const ipv6_addr_t pfx = { .u64 = { { .u8 = GLOBAL_PREFIX } } };
+    static const ipv6_addr_t addr = { .u64 = { { .u8 = GLOBAL_PREFIX },
+                                             { .u64 = TEST_UINT64 } } };
+    ipv6_addr_t other = addr;
+
+    bf_toggle(other.u8, GLOBAL_PREFIX_LEN - 1);
+    TEST_ASSERT_NOT_NULL((dst1 = _nib_pl_add(IFACE, &pfx, GLOBAL_PREFIX_LEN,
+                                             UINT32_MAX, UINT32_MAX)));
+    TEST_ASSERT_NOT_NULL((dst2 = _nib_pl_add(IFACE + 1, &pfx,
+                                             GLOBAL_PREFIX_LEN + 1,
+                                             UINT32_MAX, UINT32_MAX)));
+    dst1->flags |= _PFX_ON_LINK;
+    dst2->flags |= _PFX_ON_LINK;
+    TEST_ASSERT(dst1 == _nib_pl_get_on_link(&addr));
+    TEST_ASSERT_NULL(_nib_pl_get_on_link(&other));
+}
+
 /*
  * Creates a forwarding table entry.
  * Expected result: new entry should contain the given address and interface
@@ -1991,6 +2041,8 @@ Test *tests_gnrc_ipv6_nib_internal_tests(void)
 #endif
         new_TestFixture(test_nib_pl_add__success),
         new_TestFixture(test_nib_pl_remove),
+        new_TestFixture(test_nib_pl_get_on_link__not_on_link),
+        new_TestFixture(test_nib_pl_get_on_link__success),
         new_TestFixture(test_nib_ft_add__success),
         new_TestFixture(test_nib_ft_remove),
 #if GNRC_IPV6_NIB_CONF_MULTIHOP_P6C
@@ -13,6 +13,7 @@
  */
 #include <errno.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "embUnit.h"
 
@@ -165,6 +166,60 @@ static void test_inet_csum__empty_app_buffer(void)
     TEST_ASSERT_EQUAL_INT(hdr_expected, pyld_sum);
 }
 
+static void test_inet_csum__any_alignment(void)
+{
+    /* source: https://www.cloudshark.org/captures/ea72fbab241b (No. 1) */
+    uint8_t data[] = {
+        0xc0, 0xa8, 0x01, 0x91, 0x4b, 0x4b, 0x4b, 0x4b, /* IPv4 source + dest*/
+        0xf6, 0xfb, 0x00, 0x35, 0x00, 0x27, 0xd1, 0xa2, /* UDP header */
+        0xa5, 0x6f, 0x01, 0x00, 0x00, 0x01, 0x00, 0x00, /* DNS payload */
+        0x00, 0x00, 0x00, 0x00, 0x09, 0x74, 0x65, 0x73,
+        0x74, 0x2d, 0x69, 0x70, 0x76, 0x36, 0x03, 0x63,
+        0x6f, 0x6d, 0x00, 0x00, 0x01, 0x00, 0x01,
+    };
+    uint8_t buf[sizeof(data) + 8];
+
+    for (unsigned offset = 0; offset < 8; offset++) {
+        memcpy(&buf[offset], data, sizeof(data));
+        TEST_ASSERT_EQUAL_INT(0xffff, inet_csum(17 + 39, &buf[offset],
+                                                sizeof(data)));
+        /* split into two slices at every position */
+        for (unsigned split = 1; split < sizeof(data); split++) {
+            uint16_t sum = inet_csum_slice(17 + 39, &buf[offset], split, 0);
+
+            sum = inet_csum_slice(sum, &buf[offset + split],
+                                  sizeof(data) - split, split);
+            TEST_ASSERT_EQUAL_INT(0xffff, sum);
+        }
+    }
+}
+
+static void test_inet_csum__update16(void)
+{
+    /* source: https://tools.ietf.org/html/rfc1624#section-4 */
+    TEST_ASSERT_EQUAL_INT(0x0000, inet_csum_update16(0xdd2f, 0x5555, 0x3285));
+}
+
+static void test_inet_csum__update(void)
+{
+    /* source: http://en.wikipedia.org/w/index.php?title=IPv4_header_checksum&oldid=645516564 */
+    uint8_t data[] = {
+        0x45, 0x00, 0x00, 0x73, 0x00, 0x00, 0x40, 0x00,
+        0x40, 0x11, 0xb8, 0x61, 0xc0, 0xa8, 0x00, 0x01,
+        0xc0, 0xa8, 0x00, 0xc7,
+    };
+    const uint8_t new_dst[] = { 0x0a, 0x00, 0x17, 0x2a };
+    uint16_t csum;
+
+    /* rewrite the destination address */
+    csum = inet_csum_update((data[10] << 8) | data[11], &data[16], new_dst,
+                            sizeof(new_dst));
+    memcpy(&data[16], new_dst, sizeof(new_dst));
+    data[10] = 0;
+    data[11] = 0;
+    TEST_ASSERT_EQUAL_INT((uint16_t)~inet_csum(0, data, sizeof(data)), csum);
+}
+
 Test *tests_inet_csum_tests(void)
 {
     EMB_UNIT_TESTFIXTURES(fixtures) {
@@ -176,6 +231,9 @@ Test *tests_inet_csum_tests(void)
         new_TestFixture(test_inet_csum__odd_len),
         new_TestFixture(test_inet_csum__two_app_snips),
         new_TestFixture(test_inet_csum__empty_app_buffer),
+        new_TestFixture(test_inet_csum__any_alignment),
+        new_TestFixture(test_inet_csum__update16),
+        new_TestFixture(test_inet_csum__update),
     };
 
     EMB_UNIT_TESTCALLER(inet_csum_tests, NULL, NULL, fixtures);
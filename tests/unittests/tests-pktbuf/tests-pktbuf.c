@@ -37,6 +37,13 @@ typedef struct __attribute__((packed)) {
 }
 test_pktbuf_struct_t;
 
+#ifdef MODULE_GNRC_PKTBUF_SLAB
+/* the pools hold only a few blocks of the size of a large packet */
+#define TEST_PKTBUF_SUCCESS_SIZE    (GNRC_PKTBUF_SLAB_SMALL_SIZE)
+#else
+#define TEST_PKTBUF_SUCCESS_SIZE    ((GNRC_PKTBUF_SIZE / 10) + 4)
+#endif
+
 static void set_up(void)
 {
     gnrc_pktbuf_init();
@@ -207,12 +214,12 @@ static void test_pktbuf_add__success(void)
     gnrc_pktsnip_t *pkt, *pkt_prev = NULL;
 
     for (int i = 0; i < 9; i++) {
-        pkt = gnrc_pktbuf_add(NULL, NULL, (GNRC_PKTBUF_SIZE / 10) + 4, GNRC_NETTYPE_TEST);
+        pkt = gnrc_pktbuf_add(NULL, NULL, TEST_PKTBUF_SUCCESS_SIZE, GNRC_NETTYPE_TEST);
 
         TEST_ASSERT_NOT_NULL(pkt);
         TEST_ASSERT_NULL(pkt->next);
         TEST_ASSERT_NOT_NULL(pkt->data);
-        TEST_ASSERT_EQUAL_INT((GNRC_PKTBUF_SIZE / 10) + 4, pkt->size);
+        TEST_ASSERT_EQUAL_INT(TEST_PKTBUF_SUCCESS_SIZE, pkt->size);
         TEST_ASSERT_EQUAL_INT(GNRC_NETTYPE_TEST, pkt->type);
         TEST_ASSERT_EQUAL_INT(1, pkt->users);
 
@@ -245,7 +252,9 @@ static void test_pktbuf_add__packed_struct(void)
     TEST_ASSERT_EQUAL_INT(data.s64, data_cpy->s64);
 }
 
-#ifndef MODULE_GNRC_PKTBUF_MALLOC   /* alignment-handling left to malloc, so no certainty here */
+/* alignment-handling left to malloc, so no certainty here, fixed size blocks
+ * leave no holes */
+#if !defined(MODULE_GNRC_PKTBUF_MALLOC) && !defined(MODULE_GNRC_PKTBUF_SLAB)
 static void test_pktbuf_add__unaligned_in_aligned_hole(void)
 {
     gnrc_pktsnip_t *pkt1 = gnrc_pktbuf_add(NULL, NULL, 8, GNRC_NETTYPE_TEST);
@@ -468,6 +477,34 @@ static void test_pktbuf_mark__success_small(void)
     TEST_ASSERT(gnrc_pktbuf_is_empty());
 }
 
+static void test_pktbuf_mark__no_copy(void)
+{
+    gnrc_pktsnip_t *pkt1 = gnrc_pktbuf_add(NULL, TEST_STRING16, sizeof(TEST_STRING16),
+                                           GNRC_NETTYPE_TEST);
+    gnrc_pktsnip_t *pkt2;
+    uint8_t *data;
+
+    TEST_ASSERT_NOT_NULL(pkt1);
+    data = pkt1->data;
+    TEST_ASSERT_NOT_NULL((pkt2 = gnrc_pktbuf_mark(pkt1, 3, GNRC_NETTYPE_UNDEF)));
+    TEST_ASSERT(gnrc_pktbuf_is_sane());
+    /* the rest of the data stays in place */
+    TEST_ASSERT(pkt1->data == data + 3);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(TEST_STRING16, pkt2->data, pkt2->size));
+
+    /* freeing the header must not free the start of the rest */
+    gnrc_pktbuf_remove_snip(pkt1, pkt2);
+    pkt2 = gnrc_pktbuf_add(NULL, TEST_STRING12, 12, GNRC_NETTYPE_TEST);
+    TEST_ASSERT_NOT_NULL(pkt2);
+    TEST_ASSERT(gnrc_pktbuf_is_sane());
+    TEST_ASSERT_EQUAL_INT(0, memcmp(TEST_STRING16 + 3, pkt1->data, pkt1->size));
+
+    /* check if everything can be cleaned up */
+    gnrc_pktbuf_release(pkt1);
+    gnrc_pktbuf_release(pkt2);
+    TEST_ASSERT(gnrc_pktbuf_is_empty());
+}
+
 static void test_pktbuf_mark__success_equally_sized(void)
 {
     gnrc_pktsnip_t *pkt1 = gnrc_pktbuf_add(NULL, TEST_STRING16, sizeof(TEST_STRING16),
@@ -834,7 +871,7 @@ Test *tests_pktbuf_tests(void)
 #endif
         new_TestFixture(test_pktbuf_add__success),
         new_TestFixture(test_pktbuf_add__packed_struct),
-#ifndef MODULE_GNRC_PKTBUF_MALLOC
+#if !defined(MODULE_GNRC_PKTBUF_MALLOC) && !defined(MODULE_GNRC_PKTBUF_SLAB)
         new_TestFixture(test_pktbuf_add__unaligned_in_aligned_hole),
 #endif
         new_TestFixture(test_pktbuf_add__0_sized_release),
@@ -846,6 +883,7 @@ Test *tests_pktbuf_tests(void)
         new_TestFixture(test_pktbuf_mark__success_large),
         new_TestFixture(test_pktbuf_mark__success_aligned),
         new_TestFixture(test_pktbuf_mark__success_small),
+        new_TestFixture(test_pktbuf_mark__no_copy),
         new_TestFixture(test_pktbuf_mark__success_equally_sized),
         new_TestFixture(test_pktbuf_realloc_data__size_0),
 #ifndef MODULE_GNRC_PKTBUF_MALLOC
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2018 Unwired Devices LLC <info@unwds.com>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       xtimer_time_until_next() test application
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "xtimer.h"
+
+#define NUMOF       (3U)
+#define OFFSET_US   (100000U)
+/* allowed error: time passing while the timers are set */
+#define MARGIN_US   (1000U)
+
+/* narrow low-level timers interrupt at their overflow and the timing wheel at
+ * slot boundaries, both possibly well before the timer */
+#if (XTIMER_WIDTH < 32) || defined(MODULE_XTIMER_WHEEL)
+#define EARLY_OK    (1)
+#else
+#define EARLY_OK    (0)
+#endif
+
+static void _cb(void *arg)
+{
+    (void)arg;
+}
+
+static int _check(uint32_t expected_us)
+{
+    uint32_t us = xtimer_usec_from_ticks(xtimer_ticks(xtimer_time_until_next()));
+
+    printf("next in %" PRIu32 " us, expected %" PRIu32 " us\n", us, expected_us);
+
+    return (us <= expected_us) && ((us + MARGIN_US >= expected_us) || EARLY_OK);
+}
+
+int main(void)
+{
+    puts("xtimer_time_until_next test application.");
+
+    static xtimer_t timers[NUMOF];
+    int ok = 1;
+
+    for (unsigned i = 0; i < NUMOF; i++) {
+        timers[i].callback = _cb;
+        timers[i].arg = NULL;
+        /* latest first, the earliest one is looked up */
+        xtimer_set(&timers[i], OFFSET_US * (NUMOF - i));
+    }
+
+    ok = ok && _check(OFFSET_US);
+
+    xtimer_remove(&timers[NUMOF - 1]);
+    ok = ok && _check(OFFSET_US * 2);
+
+    for (unsigned i = 0; i < NUMOF; i++) {
+        xtimer_remove(&timers[i]);
+    }
+
+    puts(ok ? "test successful." : "test failed.");
+
+    return 0;
+}
@@ -79,6 +79,8 @@ typedef enum {
     UNWDS_CUSTOMER_MODULE_ID = 100,
     /* System module 126 */
     UNWDS_CONFIG_MODULE_ID = 126,
+    /* Aggregated reports of several modules 127 */
+    UNWDS_BATCH_MODULE_ID = 127,
 } UNWDS_MODULE_IDS_t;
 
 #endif
@@ -208,7 +208,7 @@ static void *timer_thread(void *arg)
         callback(&data);
 
         /* Restart after delay */
-        rtctimers_millis_set_msg(&timer, 60000 * adc_config.publish_period_sec, &timer_msg, timer_pid);
+        rtctimers_millis_set_msg_slack(&timer, 60000 * adc_config.publish_period_sec, UNWDS_PUBLISH_SLACK_MS, &timer_msg, timer_pid);
     }
 
     return NULL;
@@ -220,7 +220,7 @@ static void set_period (int period) {
 
     /* Don't restart timer if new period is zero */
     if (adc_config.publish_period_sec) {
-        rtctimers_millis_set_msg(&timer, 60000 * adc_config.publish_period_sec, &timer_msg, timer_pid);
+        rtctimers_millis_set_msg_slack(&timer, 60000 * adc_config.publish_period_sec, UNWDS_PUBLISH_SLACK_MS, &timer_msg, timer_pid);
         printf("[umdk-" _UMDK_NAME_ "] Period set to %d minutes\n", adc_config.publish_period_sec);
     } else {
         puts("[umdk-" _UMDK_NAME_ "] Timer stopped");
@@ -305,7 +305,7 @@ void umdk_adc_init(uwnds_cb_t *event_callback)
     timer_pid = thread_create(stack, UMDK_ADC_STACK_SIZE, THREAD_PRIORITY_MAIN - 1, THREAD_CREATE_STACKTEST, timer_thread, NULL, "ADC thread");
 
     /* Start publishing timer */
-    rtctimers_millis_set_msg(&timer, 60000 * adc_config.publish_period_sec, &timer_msg, timer_pid);
+    rtctimers_millis_set_msg_slack(&timer, 60000 * adc_config.publish_period_sec, UNWDS_PUBLISH_SLACK_MS, &timer_msg, timer_pid);
 }
 
 static void reply_ok(module_data_t *reply)
@@ -168,8 +168,9 @@ static void *handler(void *arg)
 
         /* Restart timer */
         if (conf_counter.publish_period) {
-            rtctimers_millis_set_msg(&publishing_timer, \
+            rtctimers_millis_set_msg_slack(&publishing_timer, \
                               1000*UMDK_COUNTER_VALUE_PERIOD_PER_SEC * conf_counter.publish_period, \
+                              UNWDS_PUBLISH_SLACK_MS, \
                               &publishing_msg, handler_pid);
         }
         gpio_irq_enable(UMDK_COUNTER_BTN);
@@ -198,8 +199,9 @@ static int set_period(int period) {
     conf_counter.publish_period = period;
     save_config();
 
-    rtctimers_millis_set_msg(&publishing_timer,
+    rtctimers_millis_set_msg_slack(&publishing_timer,
                       1000*UMDK_COUNTER_VALUE_PERIOD_PER_SEC * conf_counter.publish_period,
+                      UNWDS_PUBLISH_SLACK_MS,
                       &publishing_msg, handler_pid);
     printf("[umdk-" _UMDK_NAME_ "] Period set to %d hour (s)\n", conf_counter.publish_period);
     
@@ -274,8 +276,9 @@ void umdk_counter_init(uwnds_cb_t *event_callback)
                                 THREAD_CREATE_STACKTEST, handler, NULL, _UMDK_NAME_ " thread");
 
     /* Start publishing timer */
-    rtctimers_millis_set_msg(&publishing_timer, \
+    rtctimers_millis_set_msg_slack(&publishing_timer, \
                       1000*UMDK_COUNTER_VALUE_PERIOD_PER_SEC * conf_counter.publish_period, \
+                      UNWDS_PUBLISH_SLACK_MS, \
                       &publishing_msg, handler_pid);
                       
     /* Configure periodic timer  */